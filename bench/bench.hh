@@ -0,0 +1,82 @@
+#pragma once
+
+// shared helpers of the benchmark executables (see bench/CMakeLists.txt)
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+#include <polymesh/Mesh.hh>
+
+namespace polymesh::bench
+{
+/// minimal position type (fulfills the field3 requirements)
+struct vec3
+{
+    float x = 0, y = 0, z = 0;
+
+    vec3() = default;
+    vec3(float x, float y, float z) : x(x), y(y), z(z) {}
+
+    float& operator[](int i) { return (&x)[i]; }
+    float const& operator[](int i) const { return (&x)[i]; }
+
+    vec3 operator+(vec3 const& r) const { return {x + r.x, y + r.y, z + r.z}; }
+    vec3 operator-(vec3 const& r) const { return {x - r.x, y - r.y, z - r.z}; }
+    vec3 operator*(float s) const { return {x * s, y * s, z * s}; }
+};
+
+// found via ADL (e.g. by decimate)
+inline float dot(vec3 const& a, vec3 const& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+inline vec3 cross(vec3 const& a, vec3 const& b) { return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x}; }
+
+/// best wall time of f() over the given number of runs (in ms)
+template <class F>
+double best_of_ms(int runs, F&& f)
+{
+    auto best = 1e30;
+    for (auto r = 0; r < runs; ++r)
+    {
+        auto const t0 = std::chrono::steady_clock::now();
+        f();
+        auto const t1 = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::milli>(t1 - t0).count());
+    }
+    return best;
+}
+
+/// triangle index buffer of an n x n vertex grid (2 (n-1)^2 triangles, row by row)
+inline std::vector<index_value_t> grid_triangles(int n)
+{
+    std::vector<index_value_t> indices;
+    indices.reserve(6 * size_t(n - 1) * size_t(n - 1));
+    for (auto y = 0; y + 1 < n; ++y)
+        for (auto x = 0; x + 1 < n; ++x)
+        {
+            auto const a = index_value_t(y) * n + x;
+            auto const b = a + 1, c = a + n, d = c + 1;
+            indices.insert(indices.end(), {a, b, d, a, d, c});
+        }
+    return indices;
+}
+
+/// clears m and builds an n x n vertex grid with 2 (n-1)^2 triangles
+/// if pos is not null, the grid is a wavy height field over [0, 1]^2
+inline void make_grid(Mesh& m, int n, vertex_attribute<vec3>* pos = nullptr)
+{
+    m.clear();
+    m.vertices().reserve(index_value_t(n) * n);
+    for (auto i = 0; i < n * n; ++i)
+        m.vertices().add();
+    m.build_from_triangles(grid_triangles(n));
+
+    if (pos)
+        for (auto y = 0; y < n; ++y)
+            for (auto x = 0; x < n; ++x)
+            {
+                auto const u = float(x) / float(n - 1), v = float(y) / float(n - 1);
+                (*pos)[m[vertex_index(index_value_t(y) * n + x)]] = {u, v, 0.05f * std::sin(20 * u) * std::cos(15 * v)};
+            }
+}
+}
@@ -0,0 +1,89 @@
+// bulk construction (build_from_triangles / build_from_polygons) vs. incremental vertices().add() + faces().add(...)
+//
+// usage: polymesh-bench-bulk_build [grid size = 1000]
+//
+// coherent input is the grid row by row, shuffled input has randomly relabeled vertices and a random face order
+// all timings include adding the vertices
+
+#include <cstdio>
+#include <cstdlib>
+#include <numeric>
+#include <random>
+
+#include <polymesh/Mesh.hh>
+
+#include "bench.hh"
+
+namespace pm = polymesh;
+
+namespace
+{
+void add_vertices(pm::Mesh& m, pm::index_value_t cnt)
+{
+    m.vertices().reserve(cnt);
+    for (pm::index_value_t i = 0; i < cnt; ++i)
+        m.vertices().add();
+}
+}
+
+int main(int argc, char** argv)
+{
+    auto const n = argc > 1 ? std::atoi(argv[1]) : 1000;
+    auto const v_cnt = pm::index_value_t(n) * n;
+
+    auto const coherent = pm::bench::grid_triangles(n);
+    auto const f_cnt = pm::index_value_t(coherent.size() / 3);
+
+    auto shuffled = coherent;
+    {
+        std::mt19937 rng(7);
+        auto relabel = std::vector<pm::index_value_t>(size_t(v_cnt));
+        std::iota(relabel.begin(), relabel.end(), pm::index_value_t(0));
+        std::shuffle(relabel.begin(), relabel.end(), rng);
+        auto order = std::vector<pm::index_value_t>(size_t(f_cnt));
+        std::iota(order.begin(), order.end(), pm::index_value_t(0));
+        std::shuffle(order.begin(), order.end(), rng);
+        for (size_t f = 0; f < order.size(); ++f)
+            for (auto k = 0; k < 3; ++k)
+                shuffled[3 * f + k] = relabel[size_t(coherent[3 * size_t(order[f]) + k])];
+    }
+
+    std::vector<int> const face_sizes(size_t(f_cnt), 3);
+
+    std::printf("%d x %d grid (%d vertices, %d triangles), best of 5\n", n, n, int(v_cnt), int(f_cnt));
+    for (auto is_shuffled : {false, true})
+    {
+        auto const& indices = is_shuffled ? shuffled : coherent;
+
+        pm::Mesh m;
+        auto const t_incremental = pm::bench::best_of_ms(5, [&] {
+            m.clear();
+            add_vertices(m, v_cnt);
+            m.faces().reserve(f_cnt);
+            for (size_t i = 0; i < indices.size(); i += 3)
+                m.faces().add(m[pm::vertex_index(indices[i + 0])], m[pm::vertex_index(indices[i + 1])], m[pm::vertex_index(indices[i + 2])]);
+        });
+        auto const f_incremental = m.faces().size();
+
+        auto const t_triangles = pm::bench::best_of_ms(5, [&] {
+            m.clear();
+            add_vertices(m, v_cnt);
+            m.build_from_triangles(indices);
+        });
+        auto const f_triangles = m.faces().size();
+
+        auto const t_polygons = pm::bench::best_of_ms(5, [&] {
+            m.clear();
+            add_vertices(m, v_cnt);
+            m.build_from_polygons(face_sizes, indices);
+        });
+        auto const f_polygons = m.faces().size();
+
+        std::printf("%s input:\n", is_shuffled ? "shuffled" : "coherent");
+        std::printf("  incremental           %8.1f ms\n", t_incremental);
+        std::printf("  build_from_triangles  %8.1f ms  %5.2fx\n", t_triangles, t_incremental / t_triangles);
+        std::printf("  build_from_polygons   %8.1f ms  %5.2fx\n", t_polygons, t_incremental / t_polygons);
+        if (f_incremental != f_cnt || f_triangles != f_cnt || f_polygons != f_cnt)
+            std::printf("  MISMATCH of face counts: %d / %d / %d\n", int(f_incremental), int(f_triangles), int(f_polygons));
+    }
+}
@@ -0,0 +1,161 @@
+// compares decimate and decimate_parallel (time and quality) on a wavy height field
+//
+// usage: polymesh-bench-decimate [grid size = 700] [target vertex fraction = 0.05] [max threads = hardware threads]
+//
+// quality is the final quadric error (sum of squared distances to the planes of the collapsed input faces),
+// averaged over the remaining vertices
+
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+#include <polymesh/algorithms/decimate.hh>
+#include <polymesh/parallel.hh>
+
+#include "bench.hh"
+
+namespace pm = polymesh;
+using pm::bench::vec3;
+
+namespace
+{
+/// plane distance error quadric: x^T A x + 2 b^T x + c
+struct quadric
+{
+    double A[6] = {}; // xx xy xz yy yz zz
+    double b[3] = {};
+    double c = 0;
+
+    static quadric plane(vec3 const& p, vec3 const& n)
+    {
+        quadric q;
+        auto const d = -(double(n.x) * p.x + double(n.y) * p.y + double(n.z) * p.z);
+        q.A[0] = double(n.x) * n.x;
+        q.A[1] = double(n.x) * n.y;
+        q.A[2] = double(n.x) * n.z;
+        q.A[3] = double(n.y) * n.y;
+        q.A[4] = double(n.y) * n.z;
+        q.A[5] = double(n.z) * n.z;
+        q.b[0] = d * n.x;
+        q.b[1] = d * n.y;
+        q.b[2] = d * n.z;
+        q.c = d * d;
+        return q;
+    }
+
+    float operator()(vec3 const& p) const
+    {
+        double const x = p.x, y = p.y, z = p.z;
+        auto const e = A[0] * x * x + 2 * A[1] * x * y + 2 * A[2] * x * z + A[3] * y * y + 2 * A[4] * y * z + A[5] * z * z //
+                       + 2 * (b[0] * x + b[1] * y + b[2] * z) + c;
+        return float(std::max(e, 0.0));
+    }
+
+    quadric operator+(quadric const& r) const
+    {
+        quadric q;
+        for (auto i = 0; i < 6; ++i)
+            q.A[i] = A[i] + r.A[i];
+        for (auto i = 0; i < 3; ++i)
+            q.b[i] = b[i] + r.b[i];
+        q.c = c + r.c;
+        return q;
+    }
+};
+
+/// halfedge collapses keep the position of the target vertex (quadric has no closest_point)
+struct config : pm::decimate_config<vec3, quadric>
+{
+    pm::vertex_attribute<vec3> const* pos = nullptr;
+
+    vec3 collapsed_pos(pm::halfedge_handle h, quadric const&) const { return (*pos)[h.vertex_to()]; }
+};
+
+struct result
+{
+    double ms = 0;
+    double avg_error = 0;
+    pm::index_value_t faces = 0;
+    pm::decimate_stats stats;
+};
+
+template <class DecimateF>
+result run(int n, pm::index_value_t target, DecimateF&& decimate)
+{
+    pm::Mesh m;
+    auto pos = m.vertices().make_attribute<vec3>();
+    pm::bench::make_grid(m, n, &pos);
+
+    auto errors = m.vertices().make_attribute<quadric>();
+    for (auto f : m.faces())
+    {
+        auto const p0 = pos[f.any_halfedge().vertex_from()];
+        auto const p1 = pos[f.any_halfedge().vertex_to()];
+        auto const p2 = pos[f.any_halfedge().next().vertex_to()];
+        auto const n = cross(p1 - p0, p2 - p0);
+        auto const q = quadric::plane(p0, n * (1 / std::sqrt(dot(n, n))));
+        for (auto v : f.vertices())
+            errors[v] = errors[v] + q;
+    }
+
+    result r;
+    config cfg;
+    cfg.target_vertex_count = target;
+    cfg.pos = &pos;
+    cfg.stats = &r.stats;
+    r.ms = pm::bench::best_of_ms(1, [&] { decimate(m, pos, errors, cfg); });
+
+    for (auto v : m.vertices())
+        r.avg_error += errors[v](pos[v]);
+    r.avg_error /= double(m.vertices().size());
+    r.faces = m.faces().size();
+    return r;
+}
+
+void print(char const* name, result const& r, result const& serial)
+{
+    std::printf("%-32s %9.1f ms  %6.2fx  faces %8d  avg error %.4e (%+5.1f%%)  rounds %4d  rejected %7d\n", name, r.ms, serial.ms / r.ms,
+                int(r.faces), r.avg_error, 100 * (r.avg_error / serial.avg_error - 1), r.stats.rounds, r.stats.rejected_collapses);
+}
+}
+
+int main(int argc, char** argv)
+{
+    auto const n = argc > 1 ? std::atoi(argv[1]) : 700;
+    auto const fraction = argc > 2 ? std::atof(argv[2]) : 0.05;
+    auto const target = pm::index_value_t(double(n) * n * fraction);
+    auto const hw = int(std::max(1u, std::thread::hardware_concurrency()));
+    auto const max_threads = argc > 3 ? std::atoi(argv[3]) : hw;
+
+    // 1, 2, 4, ..., max_threads
+    std::vector<int> thread_counts;
+    for (auto t = 1; t < max_threads; t *= 2)
+        thread_counts.push_back(t);
+    thread_counts.push_back(max_threads);
+
+    std::printf("%d x %d grid (%d faces) -> %d vertices, %d hardware threads\n", n, n, 2 * (n - 1) * (n - 1), int(target), hw);
+
+    auto const serial = run(n, target, [](auto& m, auto& pos, auto& errors, auto const& cfg) { pm::decimate(m, pos, errors, cfg); });
+    print("decimate", serial, serial);
+
+    for (auto batch_fraction : {0.1f, 0.25f})
+    {
+        char name[64];
+        auto const seq = pm::executor::sequential();
+        auto const r = run(n, target, [&](auto& m, auto& pos, auto& errors, auto const& cfg) { //
+            pm::decimate_parallel(m, pos, errors, cfg, seq, batch_fraction);
+        });
+        std::snprintf(name, sizeof(name), "decimate_parallel %.2f sequential", batch_fraction);
+        print(name, r, serial);
+
+        for (auto threads : thread_counts)
+        {
+            auto const exec = pm::executor::pool(threads);
+            auto const r = run(n, target, [&](auto& m, auto& pos, auto& errors, auto const& cfg) { //
+                pm::decimate_parallel(m, pos, errors, cfg, exec, batch_fraction);
+            });
+            std::snprintf(name, sizeof(name), "decimate_parallel %.2f %2d threads", batch_fraction, threads);
+            print(name, r, serial);
+        }
+    }
+}
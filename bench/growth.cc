@@ -0,0 +1,55 @@
+// grows a mesh one primitive at a time with 0, 4, and 16 attached float attributes
+// (vertex, face, and halfedge attributes for vertices, faces, and edges respectively)
+//
+// usage: polymesh-bench-growth [primitive count = 2000000]
+//
+// faces and edges are allocated via the low level api (no topology), i.e. this measures the growth of
+// the topology arrays and attributes (reserve / resize_from), not faces().add(...)
+
+#include <cstdio>
+#include <cstdlib>
+
+#include <polymesh/Mesh.hh>
+#include <polymesh/low_level_api.hh>
+
+#include "bench.hh"
+
+namespace pm = polymesh;
+
+namespace
+{
+template <template <class> class AttributeT, class AddF>
+double grow(int attr_cnt, AddF&& add)
+{
+    return pm::bench::best_of_ms(5, [&] {
+        pm::Mesh m;
+        std::vector<AttributeT<float>> attrs;
+        for (auto i = 0; i < attr_cnt; ++i)
+            attrs.emplace_back(m, 1.f);
+        add(m);
+    });
+}
+}
+
+int main(int argc, char** argv)
+{
+    auto const n = argc > 1 ? std::atoi(argv[1]) : 2000000;
+
+    std::printf("adding %d primitives (best of 5, including mesh and attribute construction)\n", n);
+    for (auto attr_cnt : {0, 4, 16})
+    {
+        auto const tv = grow<pm::vertex_attribute>(attr_cnt, [&](pm::Mesh& m) {
+            for (auto i = 0; i < n; ++i)
+                m.vertices().add();
+        });
+        auto const tf = grow<pm::face_attribute>(attr_cnt, [&](pm::Mesh& m) {
+            for (auto i = 0; i < n; ++i)
+                pm::low_level_api(m).alloc_face();
+        });
+        auto const te = grow<pm::halfedge_attribute>(attr_cnt, [&](pm::Mesh& m) {
+            for (auto i = 0; i < n; ++i)
+                pm::low_level_api(m).alloc_edge();
+        });
+        std::printf("%2d attributes: vertices %7.1f ms  faces %7.1f ms  edges %7.1f ms\n", attr_cnt, tv, tf, te);
+    }
+}
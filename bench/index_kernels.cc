@@ -0,0 +1,86 @@
+// attribute kernels over handle ranges (for (auto f : m.faces()) a[f] ...) vs. index-only for_each_index
+//
+// usage: polymesh-bench-index_kernels [grid size = 1000]
+//
+// runs on the compact grid and again after removing every 10th face
+// to inspect the codegen, compile with e.g. -O3 -fopt-info-vec (GCC)
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#include <polymesh/Mesh.hh>
+#include <polymesh/properties.hh>
+
+#include "bench.hh"
+
+namespace pm = polymesh;
+using pm::bench::vec3;
+
+namespace
+{
+// noinline: keeps the kernels separate functions so that their codegen can be compared
+
+[[gnu::noinline]] void scale_handles(pm::Mesh const& m, pm::face_attribute<float>& a, pm::face_attribute<float> const& w, float s)
+{
+    for (auto f : m.faces())
+        a[f] = a[f] * s + w[f];
+}
+[[gnu::noinline]] void scale_indices(pm::Mesh const& m, pm::face_attribute<float>& a, pm::face_attribute<float> const& w, float s)
+{
+    m.faces().for_each_index(a, w, [s](float& x, float y) { x = x * s + y; });
+}
+
+[[gnu::noinline]] void normalize_handles(pm::Mesh const& m, pm::vertex_attribute<vec3>& pos, vec3 center, float scale)
+{
+    for (auto v : m.vertices())
+        pos[v] = (pos[v] - center) * scale;
+}
+[[gnu::noinline]] void normalize_indices(pm::Mesh const& m, pm::vertex_attribute<vec3>& pos, vec3 center, float scale)
+{
+    m.vertices().for_each_index(pos, [=](vec3& p) { p = (p - center) * scale; });
+}
+
+[[gnu::noinline]] pm::face_attribute<float> areas_handles(pm::vertex_attribute<vec3> const& pos)
+{
+    return pos.mesh().faces().map([&](pm::face_handle f) { return pm::triangle_area(f, pos); });
+}
+[[gnu::noinline]] pm::face_attribute<float> areas_indices(pm::vertex_attribute<vec3> const& pos) { return pm::triangle_areas(pos); }
+}
+
+int main(int argc, char** argv)
+{
+    auto const n = argc > 1 ? std::atoi(argv[1]) : 1000;
+
+    pm::Mesh m;
+    auto pos = m.vertices().make_attribute<vec3>();
+    pm::bench::make_grid(m, n, &pos);
+    auto a = m.faces().make_attribute<float>(1.f);
+    auto const w = m.faces().make_attribute<float>(0.5f);
+
+    for (auto removed : {false, true})
+    {
+        if (removed)
+        {
+            for (pm::index_value_t i = 0; i < m.all_faces().size(); i += 10)
+                m.faces().remove(m[pm::face_index(i)]);
+            for (auto v : m.vertices())
+                if (v.is_isolated())
+                    m.vertices().remove(v);
+        }
+
+        std::printf("%s (%d faces), best of 7\n", removed ? "every 10th face removed" : "compact", int(m.faces().size()));
+        std::printf("  scale      handles %6.2f ms  indices %6.2f ms\n", //
+                    pm::bench::best_of_ms(7, [&] { scale_handles(m, a, w, 0.999f); }), pm::bench::best_of_ms(7, [&] { scale_indices(m, a, w, 0.999f); }));
+        std::printf("  normalize  handles %6.2f ms  indices %6.2f ms\n", //
+                    pm::bench::best_of_ms(7, [&] { normalize_handles(m, pos, {}, 1.f); }),
+                    pm::bench::best_of_ms(7, [&] { normalize_indices(m, pos, {}, 1.f); }));
+
+        auto sum_handles = 0.0, sum_indices = 0.0;
+        std::printf("  tri areas  handles %6.2f ms  indices %6.2f ms\n", //
+                    pm::bench::best_of_ms(7, [&] { sum_handles = areas_handles(pos).sum(); }),
+                    pm::bench::best_of_ms(7, [&] { sum_indices = areas_indices(pos).sum(); }));
+        if (std::abs(sum_handles - sum_indices) > 1e-3 * sum_handles)
+            std::printf("  MISMATCH of triangle areas: %f vs %f\n", sum_handles, sum_indices);
+    }
+}
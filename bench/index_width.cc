@@ -0,0 +1,52 @@
+// bandwidth cost of the primitive index width (build once with and once without POLYMESH_INDEX_64 and compare)
+//
+// usage: polymesh-bench-index_width [grid size = 1000]
+
+#include <cstdio>
+#include <cstdlib>
+
+#include <polymesh/Mesh.hh>
+
+#include "bench.hh"
+
+namespace pm = polymesh;
+
+int main(int argc, char** argv)
+{
+    auto const n = argc > 1 ? std::atoi(argv[1]) : 1000;
+
+    pm::Mesh m;
+    pm::bench::make_grid(m, n);
+
+    // one index per vertex and face, four per halfedge (to vertex, face, next, prev)
+    auto const topology_bytes = sizeof(pm::index_value_t) * (size_t(m.all_vertices().size()) + size_t(m.all_faces().size()) + 4 * size_t(m.all_halfedges().size()));
+    std::printf("%d bit indices, %d faces, topology %.1f MB, best of 5\n", int(8 * sizeof(pm::index_value_t)), int(m.faces().size()), double(topology_bytes) / 1e6);
+
+    auto valence = m.vertices().make_attribute<int>();
+    auto const t_valence = pm::bench::best_of_ms(5, [&] {
+        for (auto v : m.vertices())
+            valence[v] = int(v.outgoing_halfedges().size());
+    });
+
+    volatile int64_t sink = 0;
+    auto const t_face_ring = pm::bench::best_of_ms(5, [&] {
+        int64_t s = 0;
+        for (auto f : m.faces())
+            for (auto v : f.vertices())
+                s += v.idx.value;
+        sink = s;
+    });
+    (void)sink;
+
+    auto t_compactify = 1e30;
+    for (auto r = 0; r < 3; ++r)
+    {
+        pm::bench::make_grid(m, n);
+        for (pm::index_value_t i = 0; i < m.all_faces().size(); i += 3)
+            m.faces().remove(m[pm::face_index(i)]);
+        t_compactify = std::min(t_compactify, pm::bench::best_of_ms(1, [&] { m.compactify(); }));
+    }
+    std::printf("vertex ring valence        %7.2f ms\n", t_valence);
+    std::printf("face ring vertex sum       %7.2f ms\n", t_face_ring);
+    std::printf("compactify (1/3 removed)   %7.2f ms\n", t_compactify);
+}
@@ -0,0 +1,76 @@
+// read_obj throughput (MB/s) on a generated obj file, sequential vs. parallel chunk parsing
+//
+// usage: polymesh-bench-obj_read [grid size = 1500] [threads = hardware threads]
+//
+// the file (positions, tex coords, normals, and "f v/t/n" triangles) is written once to the temp directory
+// timings include building the topology
+
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+#include <polymesh/formats/obj.hh>
+#include <polymesh/parallel.hh>
+
+#include "bench.hh"
+
+namespace pm = polymesh;
+
+namespace
+{
+void write_grid_obj(std::string const& filename, int n)
+{
+    std::ofstream out(filename);
+    for (auto y = 0; y < n; ++y)
+        for (auto x = 0; x < n; ++x)
+        {
+            auto const u = float(x) / float(n - 1), v = float(y) / float(n - 1);
+            out << "v " << u << " " << v << " " << 0.05f * std::sin(20 * u) * std::cos(15 * v) << "\n";
+            out << "vt " << u << " " << v << "\n";
+            out << "vn 0 0 1\n";
+        }
+
+    auto const indices = pm::bench::grid_triangles(n);
+    for (size_t i = 0; i < indices.size(); i += 3)
+    {
+        out << "f";
+        for (auto k = 0; k < 3; ++k)
+        {
+            auto const idx = indices[i + k] + 1;
+            out << " " << idx << "/" << idx << "/" << idx;
+        }
+        out << "\n";
+    }
+}
+}
+
+int main(int argc, char** argv)
+{
+    auto const n = argc > 1 ? std::atoi(argv[1]) : 1500;
+    auto const threads = argc > 2 ? std::atoi(argv[2]) : int(std::max(1u, std::thread::hardware_concurrency()));
+
+    auto const filename = (std::filesystem::temp_directory_path() / "polymesh-bench-obj_read.obj").string();
+    write_grid_obj(filename, n);
+    auto const mb = double(std::filesystem::file_size(filename)) / (1024 * 1024);
+
+    std::printf("%s: %.1f MB, %d vertices, %d triangles, best of 3\n", filename.c_str(), mb, n * n, 2 * (n - 1) * (n - 1));
+
+    auto const measure = [&](char const* name, pm::executor const& exec) {
+        pm::Mesh m;
+        auto pos = m.vertices().make_attribute<std::array<float, 3>>();
+        auto ok = true;
+        auto const ms = pm::bench::best_of_ms(3, [&] { ok = pm::read_obj(filename, m, pos, exec) && ok; });
+        std::printf("%-24s %8.1f ms  %7.1f MB/s  (%d faces%s)\n", name, ms, mb / (ms / 1000), int(m.faces().size()), ok ? "" : ", ERRORS");
+    };
+
+    measure("sequential", pm::executor::sequential());
+
+    char name[64];
+    std::snprintf(name, sizeof(name), "pool with %d threads", threads);
+    measure(name, pm::executor::pool(threads));
+
+    std::error_code ec;
+    std::filesystem::remove(filename, ec);
+}
@@ -0,0 +1,66 @@
+// throughput of iterating the valid faces, edges, and halfedges of a non-compact mesh
+//
+// usage: polymesh-bench-valid_iteration [grid size = 1000]
+//
+// a random subset of faces (0%, 10%, 50%) is removed via the low level api (keeping the rest of the topology intact),
+// then half of the edges that became free are removed as well
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+#include <polymesh/Mesh.hh>
+#include <polymesh/low_level_api.hh>
+
+#include "bench.hh"
+
+namespace pm = polymesh;
+
+int main(int argc, char** argv)
+{
+    auto const n = argc > 1 ? std::atoi(argv[1]) : 1000;
+
+    std::printf("%d x %d grid, best of 7\n", n, n);
+    for (auto ratio : {0.0, 0.1, 0.5})
+    {
+        pm::Mesh m;
+        pm::bench::make_grid(m, n);
+
+        std::mt19937 rng(7);
+        std::uniform_real_distribution<double> uniform;
+        auto const ll = pm::low_level_api(m);
+        auto const f_cnt = m.all_faces().size();
+        auto const e_cnt = m.all_edges().size();
+        for (pm::index_value_t i = 0; i < f_cnt; ++i)
+            if (uniform(rng) < ratio)
+                ll.remove_face(pm::face_index(i));
+        for (pm::index_value_t i = 0; i < e_cnt; ++i)
+            if (ll.is_free(pm::halfedge_index(2 * i)) && ll.is_free(pm::halfedge_index(2 * i + 1)) && uniform(rng) < 0.5)
+                ll.remove_edge(pm::edge_index(i));
+
+        // sums of indices keep the loops from being optimized away
+        volatile int64_t sink = 0;
+        auto const tf = pm::bench::best_of_ms(7, [&] {
+            int64_t s = 0;
+            for (auto f : m.faces())
+                s += f.idx.value;
+            sink = s;
+        });
+        auto const te = pm::bench::best_of_ms(7, [&] {
+            int64_t s = 0;
+            for (auto e : m.edges())
+                s += e.idx.value;
+            sink = s;
+        });
+        auto const th = pm::bench::best_of_ms(7, [&] {
+            int64_t s = 0;
+            for (auto h : m.halfedges())
+                s += h.idx.value;
+            sink = s;
+        });
+        (void)sink;
+
+        std::printf("removed faces %3.0f%% (edges %4.1f%%): faces %6.2f ms  edges %6.2f ms  halfedges %6.2f ms\n", 100 * ratio,
+                    100.0 * double(ll.size_removed_edges()) / double(e_cnt), tf, te, th);
+    }
+}
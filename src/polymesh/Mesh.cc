@@ -1,18 +1,154 @@
 #include "Mesh.hh"
 
+#include <algorithm>
+#include <functional>
 #include <map>
 #include <set>
+#include <unordered_map>
 
 #include "assert.hh"
 #include "debug.hh"
 
+#include "detail/attribute_pool.hh"
 #include "detail/permutation.hh"
 #include "detail/split_vector.hh"
+#include "parallel.hh"
 
 using namespace polymesh;
 
+Mesh::Mesh(memory_resource& resource)
+  : mResource(&resource),
+    mFaceToHalfedge(&resource),
+    mVertexToOutgoingHalfedge(&resource),
+    mHalfedgeToVertex(&resource),
+    mHalfedgeToFace(&resource),
+    mHalfedgeToNextHalfedge(&resource),
+    mHalfedgeToPrevHalfedge(&resource),
+    mRemovedVertexBits(&resource),
+    mRemovedFaceBits(&resource),
+    mRemovedEdgeBits(&resource)
+{
+}
+
+Mesh::~Mesh()
+{
+    delete mVertexAttrPool;
+    delete mFaceAttrPool;
+    delete mEdgeAttrPool;
+    delete mHalfedgeAttrPool;
+}
 
-void Mesh::reserve_faces(int capacity)
+namespace
+{
+void enable_pool(detail::attribute_pool*& pool, memory_resource* upstream, index_value_t capacity, size_t bytes_per_element, int attribute_count, executor const* exec)
+{
+    if (!pool)
+        pool = new detail::attribute_pool(upstream, capacity);
+    pool->reserve(bytes_per_element, attribute_count);
+    if (exec)
+        pool->set_executor(exec);
+}
+
+}
+
+template <class tag>
+void Mesh::resize_attributes(primitive_attribute_base<tag>* attrs, detail::attribute_pool* pool, index_value_t new_capacity, index_value_t old_size)
+{
+    if (!pool || !pool->begin_resize(new_capacity))
+    {
+        for (auto a = attrs; a; a = a->mNextAttribute)
+            a->resize_from(old_size);
+        return;
+    }
+
+    // one allocation for all pooled attributes, then every attribute copies its own column
+    if (pool->get_executor())
+    {
+        std::vector<primitive_attribute_base<tag>*> attr_list;
+        for (auto a = attrs; a; a = a->mNextAttribute)
+            attr_list.push_back(a);
+        pool->get_executor()->run(int(attr_list.size()), [&](int i) { attr_list[i]->resize_from(old_size); });
+    }
+    else
+    {
+        for (auto a = attrs; a; a = a->mNextAttribute)
+            a->resize_from(old_size);
+    }
+
+    pool->end_resize();
+}
+
+void Mesh::enable_attribute_pool(vertex_tag, size_t bytes_per_element, int attribute_count, executor const* exec)
+{
+    enable_pool(mVertexAttrPool, mResource, mVerticesCapacity, bytes_per_element, attribute_count, exec);
+}
+void Mesh::enable_attribute_pool(face_tag, size_t bytes_per_element, int attribute_count, executor const* exec)
+{
+    enable_pool(mFaceAttrPool, mResource, mFacesCapacity, bytes_per_element, attribute_count, exec);
+}
+void Mesh::enable_attribute_pool(edge_tag, size_t bytes_per_element, int attribute_count, executor const* exec)
+{
+    enable_pool(mEdgeAttrPool, mResource, mHalfedgesCapacity >> 1, bytes_per_element, attribute_count, exec);
+}
+void Mesh::enable_attribute_pool(halfedge_tag, size_t bytes_per_element, int attribute_count, executor const* exec)
+{
+    enable_pool(mHalfedgeAttrPool, mResource, mHalfedgesCapacity, bytes_per_element, attribute_count, exec);
+}
+
+memory_resource* Mesh::attribute_resource(vertex_tag, bool poolable) const
+{
+    return mVertexAttrPool && poolable ? mVertexAttrPool : mResource;
+}
+memory_resource* Mesh::attribute_resource(face_tag, bool poolable) const
+{
+    return mFaceAttrPool && poolable ? mFaceAttrPool : mResource;
+}
+memory_resource* Mesh::attribute_resource(edge_tag, bool poolable) const
+{
+    return mEdgeAttrPool && poolable ? mEdgeAttrPool : mResource;
+}
+memory_resource* Mesh::attribute_resource(halfedge_tag, bool poolable) const
+{
+    return mHalfedgeAttrPool && poolable ? mHalfedgeAttrPool : mResource;
+}
+
+void Mesh::resize_vertex_attributes(index_value_t old_size) { resize_attributes(mVertexAttrs, mVertexAttrPool, mVerticesCapacity, old_size); }
+void Mesh::resize_face_attributes(index_value_t old_size) { resize_attributes(mFaceAttrs, mFaceAttrPool, mFacesCapacity, old_size); }
+void Mesh::resize_halfedge_attributes(index_value_t old_halfedge_size)
+{
+    resize_attributes(mEdgeAttrs, mEdgeAttrPool, mHalfedgesCapacity >> 1, old_halfedge_size >> 1);
+    resize_attributes(mHalfedgeAttrs, mHalfedgeAttrPool, mHalfedgesCapacity, old_halfedge_size);
+}
+
+void Mesh::clear_removed_bits()
+{
+    std::fill_n(mRemovedVertexBits.get(), mRemovedVertexBits.size(), 0);
+    std::fill_n(mRemovedFaceBits.get(), mRemovedFaceBits.size(), 0);
+    std::fill_n(mRemovedEdgeBits.get(), mRemovedEdgeBits.size(), 0);
+}
+
+void Mesh::rebuild_removed_bits()
+{
+    auto const rebuild = [](unique_array<uint64_t>& bits, index_value_t size, index_value_t removed_cnt, auto&& is_removed) {
+        std::fill_n(bits.get(), bits.size(), 0);
+        if (removed_cnt == 0)
+            return;
+
+        auto const words = size_t((size + 63) >> 6);
+        if (bits.size() < words)
+            bits = unique_array<uint64_t>(words, bits.resource());
+
+        for (index_value_t i = 0; i < size; ++i)
+            if (is_removed(i))
+                bits[i >> 6] |= uint64_t(1) << (i & 63);
+    };
+
+    rebuild(mRemovedVertexBits, mVerticesSize, mRemovedVertices, [&](index_value_t i) { return mVertexToOutgoingHalfedge[i].value == -2; });
+    rebuild(mRemovedFaceBits, mFacesSize, mRemovedFaces, [&](index_value_t i) { return mFaceToHalfedge[i].is_invalid(); });
+    rebuild(mRemovedEdgeBits, mHalfedgesSize >> 1, mRemovedHalfedges, [&](index_value_t i) { return mHalfedgeToVertex[i << 1].is_invalid(); });
+}
+
+void Mesh::reserve_faces(index_value_t capacity)
 {
     if (mFacesCapacity >= capacity)
         return;
@@ -21,11 +157,10 @@ void Mesh::reserve_faces(int capacity)
     mFacesCapacity = capacity;
     detail::reserve(mFacesSize, mFacesCapacity, mFaceToHalfedge);
 
-    for (auto a = mFaceAttrs; a; a = a->mNextAttribute)
-        a->resize_from(old_size);
+    resize_face_attributes(old_size);
 }
 
-void Mesh::reserve_vertices(int capacity)
+void Mesh::reserve_vertices(index_value_t capacity)
 {
     if (mVerticesCapacity >= capacity)
         return;
@@ -34,13 +169,12 @@ void Mesh::reserve_vertices(int capacity)
     mVerticesCapacity = capacity;
     detail::reserve(mVerticesSize, mVerticesCapacity, mVertexToOutgoingHalfedge);
 
-    for (auto a = mVertexAttrs; a; a = a->mNextAttribute)
-        a->resize_from(old_size);
+    resize_vertex_attributes(old_size);
 }
 
-void Mesh::reserve_edges(int capacity) { reserve_halfedges(capacity << 1); }
+void Mesh::reserve_edges(index_value_t capacity) { reserve_halfedges(capacity << 1); }
 
-void Mesh::reserve_halfedges(int capacity)
+void Mesh::reserve_halfedges(index_value_t capacity)
 {
     if (mHalfedgesCapacity >= capacity)
         return;
@@ -49,23 +183,21 @@ void Mesh::reserve_halfedges(int capacity)
     mHalfedgesCapacity = capacity;
     detail::reserve(mHalfedgesSize, mHalfedgesCapacity, mHalfedgeToFace, mHalfedgeToVertex, mHalfedgeToNextHalfedge, mHalfedgeToPrevHalfedge);
 
-    for (auto a = mHalfedgeAttrs; a; a = a->mNextAttribute)
-        a->resize_from(old_size);
-    for (auto a = mEdgeAttrs; a; a = a->mNextAttribute)
-        a->resize_from(old_size >> 1);
+    resize_halfedge_attributes(old_size);
 }
 
-void Mesh::alloc_primitives(int vertices, int faces, int halfedges)
+void Mesh::alloc_primitives(index_value_t vertices, index_value_t faces, index_value_t halfedges)
 {
     POLYMESH_ASSERT(vertices >= 0 && faces >= 0 && halfedges >= 0);
 
-    POLYMESH_ASSERT(size_all_vertices() + int64_t(vertices) <= int64_t(std::numeric_limits<int>::max()) && "polymesh only supports 2^31 primitives");
-    POLYMESH_ASSERT(size_all_faces() + int64_t(faces) <= int64_t(std::numeric_limits<int>::max()) && "polymesh only supports 2^31 primitives");
-    POLYMESH_ASSERT(size_all_halfedges() + int64_t(halfedges) <= int64_t(std::numeric_limits<int>::max()) && "polymesh only supports 2^31 primitives");
+    POLYMESH_ASSERT(vertices <= std::numeric_limits<index_value_t>::max() - size_all_vertices() && "index overflow (define POLYMESH_INDEX_64 for more than 2^31 primitives)");
+    POLYMESH_ASSERT(faces <= std::numeric_limits<index_value_t>::max() - size_all_faces() && "index overflow (define POLYMESH_INDEX_64 for more than 2^31 primitives)");
+    POLYMESH_ASSERT(halfedges <= std::numeric_limits<index_value_t>::max() - size_all_halfedges() && "index overflow (define POLYMESH_INDEX_64 for more than 2^31 primitives)");
 
     auto vCnt = size_all_vertices() + vertices;
     auto fCnt = size_all_faces() + faces;
     auto hCnt = size_all_halfedges() + halfedges;
+    ++mTopologyVersion;
 
     // alloc space
     auto old_v_size = mVerticesSize;
@@ -80,242 +212,692 @@ void Mesh::alloc_primitives(int vertices, int faces, int halfedges)
 
     // notify attributes
     if (v_capacity_changed)
-        for (auto p = mVertexAttrs; p; p = p->mNextAttribute)
-            p->resize_from(old_v_size);
-
+        resize_vertex_attributes(old_v_size);
     if (f_capacity_changed)
-        for (auto p = mFaceAttrs; p; p = p->mNextAttribute)
-            p->resize_from(old_f_size);
-
+        resize_face_attributes(old_f_size);
     if (h_capacity_changed)
+        resize_halfedge_attributes(old_h_size);
+}
+
+
+std::vector<index_value_t> Mesh::build_from_polygons(span<int const> face_sizes, span<index_value_t const> indices)
+{
+    auto const f_cnt = index_value_t(face_sizes.size());
+
+    std::vector<index_value_t> offsets(f_cnt + 1);
+    std::vector<index_value_t> corner_faces(indices.size());
+    offsets[0] = 0;
+    for (index_value_t f = 0; f < f_cnt; ++f)
     {
-        for (auto p = mEdgeAttrs; p; p = p->mNextAttribute)
-            p->resize_from(old_h_size >> 1);
-        for (auto p = mHalfedgeAttrs; p; p = p->mNextAttribute)
-            p->resize_from(old_h_size);
+        POLYMESH_ASSERT(face_sizes[f] >= 0);
+        offsets[f + 1] = offsets[f] + face_sizes[f];
+        POLYMESH_ASSERT(offsets[f + 1] <= index_value_t(indices.size()) && "face sizes do not match index count");
+        std::fill(corner_faces.begin() + offsets[f], corner_faces.begin() + offsets[f + 1], f);
     }
+
+    return build_from_faces(f_cnt, [&](index_value_t f) { return offsets[f]; }, [&](index_value_t c) { return corner_faces[c]; }, indices);
 }
 
+std::vector<index_value_t> Mesh::build_from_triangles(span<index_value_t const> indices)
+{
+    POLYMESH_ASSERT(indices.size() % 3 == 0 && "triangle index buffers must contain 3 indices per face");
+
+    return build_from_faces(index_value_t(indices.size() / 3), [](index_value_t f) { return 3 * f; }, [](index_value_t c) { return c / 3; }, indices);
+}
+
+template <class OffsetF, class FaceOfF>
+std::vector<index_value_t> Mesh::build_from_faces(index_value_t face_cnt, OffsetF&& offset_of, FaceOfF&& face_of, span<index_value_t const> indices)
+{
+    POLYMESH_ASSERT(mFacesSize == 0 && mHalfedgesSize == 0 && "bulk construction requires a mesh without faces and edges");
+    POLYMESH_ASSERT(int64_t(indices.size()) == int64_t(offset_of(face_cnt)));
+
+    // Terminology:
+    //   corner c of face f is the half-edge from vs[c] to to_vertex(c)
+    //   a fan of vertex v is a maximal sequence of corners around v connected via opposite(prev(c))
+    //
+    // NOTE: bulk construction is dominated by memory traffic, thus temporary memory is kept to three indices per corner
+    //       (non-manifold input takes a sequential slow path with two more)
+
+    auto const v_cnt = size_all_vertices();
+    auto const c_cnt = index_value_t(indices.size());
+    auto const vs = indices.data();
+
+    auto const next_corner = [&](index_value_t c) {
+        auto const f = face_of(c);
+        return c + 1 == offset_of(f + 1) ? offset_of(f) : c + 1;
+    };
+    auto const prev_corner = [&](index_value_t c) {
+        auto const f = face_of(c);
+        return c == offset_of(f) ? offset_of(f + 1) - 1 : c - 1;
+    };
+    auto const to_vertex = [&](index_value_t c) { return vs[next_corner(c)]; };
+
+    std::vector<char> face_valid(face_cnt, true);
+    std::vector<index_value_t> v_tmp(v_cnt, -1);                       // per-vertex scratch
+    std::vector<index_value_t> v_out_start(v_cnt + 1);                 // CSR offsets of outgoing corners per vertex
+    std::vector<std::pair<index_value_t, index_value_t>> c_out(c_cnt); // CSR of (to vertex, corner) per vertex, later: half-edge of each corner
+    std::vector<index_value_t> c_opposite(c_cnt, -1);                  // corner of an accepted face in the other direction
+
+    // reject degenerated faces (less than 3 vertices, removed vertices, duplicated vertices)
+    auto const check_removed = mRemovedVertices > 0;
+    for (index_value_t f = 0; f < face_cnt; ++f)
+    {
+        auto const c_begin = offset_of(f);
+        auto const c_end = offset_of(f + 1);
+        auto valid = c_end - c_begin >= 3;
+
+        for (auto c = c_begin; c < c_end; ++c)
+        {
+            auto const v = vs[c];
+            POLYMESH_ASSERT(0 <= v && v < v_cnt && "vertex index out of bounds");
+
+            if (check_removed && mVertexToOutgoingHalfedge[v].value == -2)
+                valid = false;
+        }
+
+        // small faces are checked pairwise, large ones via stamps
+        if (c_end - c_begin <= 8)
+        {
+            for (auto c0 = c_begin; c0 < c_end; ++c0)
+                for (auto c1 = c0 + 1; c1 < c_end; ++c1)
+                    if (vs[c0] == vs[c1])
+                        valid = false;
+        }
+        else
+        {
+            for (auto c = c_begin; c < c_end; ++c)
+            {
+                if (v_tmp[vs[c]] == f)
+                    valid = false;
+                v_tmp[vs[c]] = f;
+            }
+        }
+
+        face_valid[f] = valid;
+        if (valid)
+            for (auto c = c_begin; c < c_end; ++c)
+                ++v_out_start[vs[c] + 1];
+    }
+
+    // build outgoing corner lists (counting sort, stable w.r.t. corner order)
+    for (index_value_t v = 0; v < v_cnt; ++v)
+        v_out_start[v + 1] += v_out_start[v];
+    for (index_value_t f = 0; f < face_cnt; ++f)
+        if (face_valid[f])
+            for (auto c = offset_of(f); c < offset_of(f + 1); ++c)
+                c_out[v_out_start[vs[c]]++] = {to_vertex(c), c};
+    for (auto v = v_cnt; v > 0; --v) // v_out_start[v] was advanced to the end of list v
+        v_out_start[v] = v_out_start[v - 1];
+    v_out_start[0] = 0;
+
+    // find duplicated directed edges
+    auto any_duplicates = false;
+    {
+        auto& last_from = v_tmp;
+        std::fill(last_from.begin(), last_from.end(), -1);
+        for (index_value_t v = 0; v < v_cnt; ++v)
+            for (auto i = v_out_start[v]; i < v_out_start[v + 1]; ++i)
+            {
+                auto const v_to = c_out[i].first;
+                if (last_from[v_to] == v)
+                    any_duplicates = true;
+                last_from[v_to] = v;
+            }
+    }
+
+    // walks the fan starting at corner c (outgoing from vs[c])
+    // calls on_corner for each corner on the fan and returns the last corner (whose prev has no opposite)
+    // for closed fans, returns -1 after visiting each corner once
+    auto const walk_fan = [&](index_value_t c_start, auto&& on_corner) -> index_value_t {
+        auto c = c_start;
+        while (true)
+        {
+            on_corner(c);
+            auto const c_next = c_opposite[prev_corner(c)];
+            if (c_next < 0)
+                return c;
+            if (c_next == c_start)
+                return -1;
+            c = c_next;
+        }
+    };
+
+    // fast path: without duplicated directed edges, opposite corners are unique
+    // vertices may have several open fans (non-manifold but representable)
+    // a closed fan together with any other fan is not representable
+    auto any_conflicts = any_duplicates;
+    if (!any_duplicates)
+    {
+        // pair up opposite corners (each edge is found from its smaller vertex)
+        for (index_value_t v = 0; v < v_cnt; ++v)
+            for (auto i = v_out_start[v]; i < v_out_start[v + 1]; ++i)
+            {
+                auto const [v_to, c] = c_out[i];
+                if (v_to < v)
+                    continue;
+
+                for (auto j = v_out_start[v_to]; j < v_out_start[v_to + 1]; ++j)
+                    if (c_out[j].first == v)
+                    {
+                        c_opposite[c] = c_out[j].second;
+                        c_opposite[c_out[j].second] = c;
+                        break;
+                    }
+            }
+
+        for (index_value_t v = 0; v < v_cnt && !any_conflicts; ++v)
+        {
+            index_value_t corner_cnt = v_out_start[v + 1] - v_out_start[v];
+            index_value_t fan_corner_cnt = 0;
+            auto open_fan_cnt = 0;
+            for (auto i = v_out_start[v]; i < v_out_start[v + 1]; ++i)
+            {
+                auto const c = c_out[i].second;
+                if (c_opposite[c] < 0)
+                {
+                    ++open_fan_cnt;
+                    walk_fan(c, [&](index_value_t) { ++fan_corner_cnt; });
+                }
+            }
+
+            if (fan_corner_cnt == corner_cnt)
+                continue; // only open fans
+
+            if (open_fan_cnt == 0)
+            {
+                walk_fan(c_out[v_out_start[v]].second, [&](index_value_t) { ++fan_corner_cnt; });
+                if (fan_corner_cnt == corner_cnt)
+                    continue; // single closed fan
+            }
+
+            any_conflicts = true;
+        }
+    }
+
+    // slow path: replay all faces in input order (like repeated faces().add(...)), a face is rejected if
+    //   - one of its directed edges is already used by an accepted face
+    //   - one of its vertices is already surrounded by a closed fan
+    //   - it would close a fan of a vertex that has other fans
+    // fans are tracked via union-find over accepted corners
+    if (any_conflicts)
+    {
+        std::fill(c_opposite.begin(), c_opposite.end(), -1);
+
+        auto& added_corners = v_tmp;
+        std::fill(added_corners.begin(), added_corners.end(), 0);
+        std::vector<char> v_closed(v_cnt, false);
+        std::vector<index_value_t> parent(c_cnt);
+        std::vector<index_value_t> fan_size(c_cnt); // only valid for roots
+
+        auto const find = [&](index_value_t c) {
+            while (parent[c] != c)
+                c = parent[c] = parent[parent[c]];
+            return c;
+        };
+
+        // the accepted corner from v_from to v_to of a face before f (outgoing lists are sorted by corner), -1 if none
+        auto const accepted_corner = [&](index_value_t v_from, index_value_t v_to, index_value_t f) -> index_value_t {
+            auto const c_begin = offset_of(f);
+            for (auto i = v_out_start[v_from]; i < v_out_start[v_from + 1]; ++i)
+            {
+                auto const [to, ci] = c_out[i];
+                if (ci >= c_begin)
+                    break;
+                if (to == v_to && face_valid[face_of(ci)])
+                    return ci;
+            }
+            return -1;
+        };
+
+        // accepted corners before and after c in the fan around vs[c], -1 if none
+        auto const fan_neighbors = [&](index_value_t c, index_value_t f) -> std::pair<index_value_t, index_value_t> {
+            auto const v = vs[c];
+            auto const c_prev = accepted_corner(v, vs[prev_corner(c)], f);
+            auto const c_opp = accepted_corner(to_vertex(c), v, f);
+            return {c_prev, c_opp < 0 ? -1 : next_corner(c_opp)};
+        };
+
+        for (index_value_t f = 0; f < face_cnt; ++f)
+        {
+            if (!face_valid[f])
+                continue;
+
+            auto const c_begin = offset_of(f);
+            auto const c_end = offset_of(f + 1);
+
+            auto accept = true;
+            for (auto c = c_begin; c < c_end && accept; ++c)
+            {
+                auto const v = vs[c];
+                if (v_closed[v] || accepted_corner(v, to_vertex(c), f) >= 0)
+                    accept = false;
+                else
+                {
+                    auto const [cp, cn] = fan_neighbors(c, f);
+                    if (cp >= 0 && cn >= 0 && find(cp) == find(cn) && fan_size[find(cp)] < added_corners[v])
+                        accept = false;
+                }
+            }
+
+            if (!accept)
+            {
+                face_valid[f] = false;
+                continue;
+            }
+
+            for (auto c = c_begin; c < c_end; ++c)
+            {
+                auto const v = vs[c];
+                parent[c] = c;
+                fan_size[c] = 1;
+                ++added_corners[v];
+
+                auto const [cp, cn] = fan_neighbors(c, f);
+                for (auto c_n : {cp, cn})
+                {
+                    if (c_n < 0)
+                        continue;
+
+                    auto const ra = find(c);
+                    auto const rb = find(c_n);
+                    if (ra == rb)
+                        v_closed[v] = true; // second link into the same fan
+                    else
+                    {
+                        parent[rb] = ra;
+                        fan_size[ra] += fan_size[rb];
+                    }
+                }
+
+                auto const c_opp = accepted_corner(to_vertex(c), v, f);
+                if (c_opp >= 0)
+                {
+                    c_opposite[c] = c_opp;
+                    c_opposite[c_opp] = c;
+                }
+            }
+        }
+    }
 
-void Mesh::permute_vertices(std::vector<int> const& p)
+    // count primitives
+    std::vector<index_value_t> rejected_faces;
+    index_value_t new_f_cnt = 0;
+    index_value_t corner_cnt = 0;
+    index_value_t boundary_cnt = 0;
+    for (index_value_t f = 0; f < face_cnt; ++f)
+    {
+        if (!face_valid[f])
+        {
+            rejected_faces.push_back(f);
+            continue;
+        }
+
+        ++new_f_cnt;
+        for (auto c = offset_of(f); c < offset_of(f + 1); ++c)
+        {
+            ++corner_cnt;
+            if (c_opposite[c] < 0)
+                ++boundary_cnt;
+        }
+    }
+    POLYMESH_ASSERT((corner_cnt + boundary_cnt) % 2 == 0);
+
+    // write topology
+    // edges are created in order of first appearance
+    alloc_primitives(0, new_f_cnt, corner_cnt + boundary_cnt);
+
+    // half-edge of each corner (reuses the memory of the outgoing lists)
+    auto const c_halfedge = [&](index_value_t c) -> index_value_t& { return c_out[c].first; };
+    for (auto& [h, c] : c_out)
+        h = -1;
+    for (index_value_t f = 0, fi = 0, e_cnt = 0; f < face_cnt; ++f)
+    {
+        if (!face_valid[f])
+            continue;
+
+        auto const c_begin = offset_of(f);
+        auto const c_end = offset_of(f + 1);
+
+        for (auto c = c_begin; c < c_end; ++c)
+            if (c_halfedge(c) < 0)
+            {
+                auto const h = 2 * e_cnt++;
+                c_halfedge(c) = h;
+                if (c_opposite[c] >= 0)
+                    c_halfedge(c_opposite[c]) = h + 1;
+            }
+
+        // prefer a half-edge with free opposite (boundary face invariant)
+        auto f_h = c_halfedge(c_begin);
+        for (auto c = c_begin; c < c_end; ++c)
+        {
+            auto const c_next = c + 1 == c_end ? c_begin : c + 1;
+            auto const c_prev = c == c_begin ? c_end - 1 : c - 1;
+            auto const h = c_halfedge(c);
+            mHalfedgeToVertex[h] = vertex_index(vs[c_next]);
+            mHalfedgeToFace[h] = face_index(fi);
+            mHalfedgeToNextHalfedge[h] = halfedge_index(c_halfedge(c_next));
+            mHalfedgeToPrevHalfedge[h] = halfedge_index(c_halfedge(c_prev));
+            mVertexToOutgoingHalfedge[vs[c]] = halfedge_index(h);
+
+            if (c_opposite[c] < 0)
+            {
+                f_h = h;
+
+                // free opposite half-edge, next/prev are set below
+                mHalfedgeToVertex[h ^ 1] = vertex_index(vs[c]);
+                mHalfedgeToFace[h ^ 1] = face_index::invalid;
+            }
+        }
+        mFaceToHalfedge[fi] = halfedge_index(f_h);
+        ++fi;
+    }
+
+    // link boundaries: each open fan k of a vertex starts with the incoming free half-edge i_k and ends with the outgoing free half-edge o_k
+    // fans are chained cyclically via next(i_k) = o_(k+1)
+    {
+        auto& last_in = v_out_start;
+        auto& first_out = v_tmp;
+        std::fill(last_in.begin(), last_in.end(), -1);
+
+        auto const link = [&](index_value_t h_in, index_value_t h_out) {
+            mHalfedgeToNextHalfedge[h_in] = halfedge_index(h_out);
+            mHalfedgeToPrevHalfedge[h_out] = halfedge_index(h_in);
+        };
+
+        for (index_value_t c = 0; c < c_cnt; ++c)
+        {
+            if (c_opposite[c] >= 0 || !face_valid[face_of(c)])
+                continue;
+
+            auto const v = vs[c];
+            auto const c_last = walk_fan(c, [](index_value_t) {});
+            POLYMESH_ASSERT(c_last >= 0);
+
+            auto const h_in = c_halfedge(c) ^ 1;
+            auto const h_out = c_halfedge(prev_corner(c_last)) ^ 1;
+
+            if (last_in[v] < 0)
+                first_out[v] = h_out;
+            else
+                link(last_in[v], h_out);
+            last_in[v] = h_in;
+
+            // boundary vertex invariant: outgoing half-edge is free
+            mVertexToOutgoingHalfedge[v] = halfedge_index(h_out);
+        }
+
+        for (index_value_t v = 0; v < v_cnt; ++v)
+            if (last_in[v] >= 0)
+                link(last_in[v], first_out[v]);
+    }
+
+    return rejected_faces;
+}
+
+void Mesh::permute_vertices(std::vector<index_value_t> const& p, executor const& exec, permute_scratch* scratch)
 {
     POLYMESH_ASSERT(detail::is_valid_permutation(p));
-    POLYMESH_ASSERT(int(p.size()) == mVerticesSize);
+    POLYMESH_ASSERT(index_value_t(p.size()) == mVerticesSize);
+    ++mTopologyVersion;
 
-    // calculate transpositions
-    auto ts = detail::transpositions_of(p);
+    permute_scratch local_scratch;
+    auto& tmp = scratch ? *scratch : local_scratch;
 
-    // apply them
-    for (auto t : ts)
-        std::swap(mVertexToOutgoingHalfedge[t.first], mVertexToOutgoingHalfedge[t.second]);
+    auto& new_to_old = tmp.new_to_old;
+    detail::invert_permutation(p, new_to_old, exec);
+
+    // gather vertices
+    detail::permute_by_gather(mVertexToOutgoingHalfedge.get(), new_to_old, tmp, exec);
 
     // fix half-edges
-    for (auto& h_to : detail::range(mHalfedgesSize, mHalfedgeToVertex))
+    detail::parallel_for(exec, mHalfedgesSize, [&](index_value_t i) {
+        auto& h_to = mHalfedgeToVertex[i];
         if (h_to.is_valid())
             h_to.value = p[h_to.value];
+    });
+
+    // removed primitives moved as well
+    rebuild_removed_bits();
 
     // update attributes
     for (auto a = mVertexAttrs; a; a = a->mNextAttribute)
-        a->apply_transpositions(ts);
+        a->apply_gather(new_to_old, tmp, exec);
 }
 
-void Mesh::permute_faces(std::vector<int> const& p)
+void Mesh::permute_faces(std::vector<index_value_t> const& p, executor const& exec, permute_scratch* scratch)
 {
     POLYMESH_ASSERT(detail::is_valid_permutation(p));
-    POLYMESH_ASSERT(int(p.size()) == mFacesSize);
+    POLYMESH_ASSERT(index_value_t(p.size()) == mFacesSize);
+    ++mTopologyVersion;
+
+    permute_scratch local_scratch;
+    auto& tmp = scratch ? *scratch : local_scratch;
 
-    // calculate transpositions
-    auto ts = detail::transpositions_of(p);
+    auto& new_to_old = tmp.new_to_old;
+    detail::invert_permutation(p, new_to_old, exec);
 
-    // apply them
-    for (auto t : ts)
-        std::swap(mFaceToHalfedge[t.first], mFaceToHalfedge[t.second]);
+    // gather faces
+    detail::permute_by_gather(mFaceToHalfedge.get(), new_to_old, tmp, exec);
 
     // fix half-edges
-    for (auto& h_f : detail::range(mHalfedgesSize, mHalfedgeToFace))
+    detail::parallel_for(exec, mHalfedgesSize, [&](index_value_t i) {
+        auto& h_f = mHalfedgeToFace[i];
         if (h_f.is_valid())
             h_f.value = p[h_f.value];
+    });
+
+    // removed primitives moved as well
+    rebuild_removed_bits();
 
     // update attributes
     for (auto a = mFaceAttrs; a; a = a->mNextAttribute)
-        a->apply_transpositions(ts);
+        a->apply_gather(new_to_old, tmp, exec);
 }
 
-void Mesh::permute_edges(std::vector<int> const& p)
+void Mesh::permute_edges(std::vector<index_value_t> const& p, executor const& exec, permute_scratch* scratch)
 {
     POLYMESH_ASSERT(detail::is_valid_permutation(p));
-    POLYMESH_ASSERT(int(p.size() * 2) == mHalfedgesSize);
-
-    std::vector<int> hp(p.size() * 2);
-    for (auto i = 0u; i < p.size(); ++i)
-    {
-        hp[i * 2 + 0] = p[i] * 2 + 0;
-        hp[i * 2 + 1] = p[i] * 2 + 1;
-    }
-    POLYMESH_ASSERT(detail::is_valid_permutation(hp));
-
-    // calculate transpositions
-    std::vector<std::pair<int, int>> edge_ts;
-    std::vector<std::pair<int, int>> halfedge_ts;
-
-    detail::apply_permutation(p, [&](int i, int j) {
-        edge_ts.emplace_back(i, j);
-        halfedge_ts.emplace_back((i << 1) + 0, (j << 1) + 0);
-        halfedge_ts.emplace_back((i << 1) + 1, (j << 1) + 1);
-    });
-
-    // apply them
-    for (auto t : halfedge_ts)
-    {
-        std::swap(mHalfedgeToFace[t.first], mHalfedgeToFace[t.second]);
-        std::swap(mHalfedgeToVertex[t.first], mHalfedgeToVertex[t.second]);
-        std::swap(mHalfedgeToNextHalfedge[t.first], mHalfedgeToNextHalfedge[t.second]);
-        std::swap(mHalfedgeToPrevHalfedge[t.first], mHalfedgeToPrevHalfedge[t.second]);
-    }
+    POLYMESH_ASSERT(index_value_t(p.size() * 2) == mHalfedgesSize);
+    ++mTopologyVersion;
+
+    permute_scratch local_scratch;
+    auto& tmp = scratch ? *scratch : local_scratch;
+
+    // both half-edges of an edge move together
+    auto& e_new_to_old = tmp.new_to_old;
+    auto& h_new_to_old = tmp.halfedge_new_to_old;
+    detail::invert_permutation(p, e_new_to_old, exec);
+    h_new_to_old.resize(mHalfedgesSize);
+    detail::parallel_for(exec, mHalfedgesSize, [&](index_value_t i) { h_new_to_old[i] = (e_new_to_old[i >> 1] << 1) + (i & 1); });
+
+    auto remap_h = [&](halfedge_index& h) {
+        if (h.value >= 0)
+            h.value = (p[h.value >> 1] << 1) + (h.value & 1);
+    };
+
+    // gather half-edges
+    detail::permute_by_gather(mHalfedgeToFace.get(), h_new_to_old, tmp, exec);
+    detail::permute_by_gather(mHalfedgeToVertex.get(), h_new_to_old, tmp, exec);
+    detail::permute_by_gather(mHalfedgeToNextHalfedge.get(), h_new_to_old, tmp, exec);
+    detail::permute_by_gather(mHalfedgeToPrevHalfedge.get(), h_new_to_old, tmp, exec);
 
     // fix half-edges
-    for (auto& v_out : detail::range(mVerticesSize, mVertexToOutgoingHalfedge))
-        if (v_out.value >= 0)
-            v_out.value = hp[v_out.value];
-
-    for (auto& f_h : detail::range(mFacesSize, mFaceToHalfedge))
-        if (f_h.value >= 0)
-            f_h.value = hp[f_h.value];
-
-    for (auto& h_next : detail::range(mHalfedgesSize, mHalfedgeToNextHalfedge))
-        if (h_next.value >= 0)
-            h_next.value = hp[h_next.value];
+    detail::parallel_for(exec, mVerticesSize, [&](index_value_t i) { remap_h(mVertexToOutgoingHalfedge[i]); });
+    detail::parallel_for(exec, mFacesSize, [&](index_value_t i) { remap_h(mFaceToHalfedge[i]); });
+    detail::parallel_for(exec, mHalfedgesSize, [&](index_value_t i) {
+        remap_h(mHalfedgeToNextHalfedge[i]);
+        remap_h(mHalfedgeToPrevHalfedge[i]);
+    });
 
-    for (auto& h_prev : detail::range(mHalfedgesSize, mHalfedgeToPrevHalfedge))
-        if (h_prev.value >= 0)
-            h_prev.value = hp[h_prev.value];
+    // removed primitives moved as well
+    rebuild_removed_bits();
 
     // update attributes
     for (auto a = mEdgeAttrs; a; a = a->mNextAttribute)
-        a->apply_transpositions(edge_ts);
+        a->apply_gather(e_new_to_old, tmp, exec);
     for (auto a = mHalfedgeAttrs; a; a = a->mNextAttribute)
-        a->apply_transpositions(halfedge_ts);
+        a->apply_gather(h_new_to_old, tmp, exec);
 }
 
-void Mesh::compactify()
+namespace
 {
-    if (is_compact())
-        return;
-
-    auto ll = low_level_api(this);
+/// computes new_to_old (and optionally old_to_new) for all primitives where is_valid(i) holds
+/// uses a parallel prefix sum over chunks
+template <class IsValidF>
+void compute_remapping(executor const& exec, index_value_t size, IsValidF&& is_valid, std::vector<index_value_t>& new_to_old, std::vector<index_value_t>* old_to_new, std::vector<index_value_t>& chunk_offsets)
+{
+    auto const chunk_cnt = detail::chunk_count(exec, size);
+
+    // count valid primitives per chunk
+    chunk_offsets.assign(chunk_cnt + 1, 0);
+    detail::parallel_chunks(exec, size, [&](int chunk, index_value_t begin, index_value_t end) {
+        index_value_t cnt = 0;
+        for (auto i = begin; i < end; ++i)
+            if (is_valid(i))
+                ++cnt;
+        chunk_offsets[chunk + 1] = cnt;
+    });
 
-    // calculate remappings
-    int v_cnt = size_all_vertices();
-    int f_cnt = size_all_faces();
-    int e_cnt = size_all_edges();
-    int h_cnt = size_all_halfedges();
-    std::vector<int> v_new_to_old;
-    std::vector<int> f_new_to_old;
-    std::vector<int> e_new_to_old;
-    std::vector<int> h_new_to_old;
-    v_new_to_old.reserve(v_cnt);
-    f_new_to_old.reserve(f_cnt);
-    e_new_to_old.reserve(e_cnt);
-    h_new_to_old.reserve(h_cnt);
-    std::vector<int> h_old_to_new(h_cnt, -1);
-    std::vector<int> v_old_to_new(v_cnt, -1);
-    std::vector<int> f_old_to_new(f_cnt, -1);
-
-    for (auto i = 0; i < v_cnt; ++i)
-        if (!ll.is_removed(vertex_index(i)))
+    // exclusive scan
+    for (auto i = 0; i < chunk_cnt; ++i)
+        chunk_offsets[i + 1] += chunk_offsets[i];
+
+    // write maps
+    new_to_old.resize(chunk_offsets[chunk_cnt]);
+    if (old_to_new)
+        old_to_new->resize(size);
+    detail::parallel_chunks(exec, size, [&](int chunk, index_value_t begin, index_value_t end) {
+        auto idx = chunk_offsets[chunk];
+        for (auto i = begin; i < end; ++i)
         {
-            v_old_to_new[i] = (int)v_new_to_old.size();
-            v_new_to_old.push_back(i);
+            if (is_valid(i))
+            {
+                if (old_to_new)
+                    (*old_to_new)[i] = idx;
+                new_to_old[idx++] = i;
+            }
+            else if (old_to_new)
+                (*old_to_new)[i] = -1;
         }
+    });
+}
+}
 
-    for (auto i = 0; i < f_cnt; ++i)
-        if (!ll.is_removed(face_index(i)))
-        {
-            f_old_to_new[i] = (int)f_new_to_old.size();
-            f_new_to_old.push_back(i);
-        }
+void Mesh::compactify()
+{
+    if (is_compact())
+        return;
 
-    for (auto i = 0; i < e_cnt; ++i)
-        if (!ll.is_removed(edge_index(i)))
-            e_new_to_old.push_back(i);
+    compactify(executor::sequential());
+}
 
-    for (auto i = 0; i < h_cnt; ++i)
-        if (!ll.is_removed(halfedge_index(i)))
-        {
-            h_old_to_new[i] = (int)h_new_to_old.size();
-            h_new_to_old.push_back(i);
-        }
+void Mesh::compactify(executor const& exec, compactify_scratch* scratch)
+{
+    if (is_compact())
+        return;
 
-    // apply remappings (map[new_prim_id] = old_prim_id)
-
-    for (auto i = 0u; i < v_new_to_old.size(); ++i)
-        mVertexToOutgoingHalfedge[i] = mVertexToOutgoingHalfedge[v_new_to_old[i]];
-    for (auto i = 0u; i < f_new_to_old.size(); ++i)
-        mFaceToHalfedge[i] = mFaceToHalfedge[f_new_to_old[i]];
-    for (auto i = 0u; i < h_new_to_old.size(); ++i)
-    {
-        mHalfedgeToFace[i] = mHalfedgeToFace[h_new_to_old[i]];
-        mHalfedgeToVertex[i] = mHalfedgeToVertex[h_new_to_old[i]];
-        mHalfedgeToNextHalfedge[i] = mHalfedgeToNextHalfedge[h_new_to_old[i]];
-        mHalfedgeToPrevHalfedge[i] = mHalfedgeToPrevHalfedge[h_new_to_old[i]];
-    }
-
-    detail::resize(mVerticesSize, mVerticesCapacity, int(v_new_to_old.size()), mVertexToOutgoingHalfedge);
-    detail::resize(mFacesSize, mFacesCapacity, int(f_new_to_old.size()), mFaceToHalfedge);
-    detail::resize(mHalfedgesSize, mHalfedgesCapacity, int(h_new_to_old.size()), mHalfedgeToFace, mHalfedgeToVertex, mHalfedgeToNextHalfedge, mHalfedgeToPrevHalfedge);
-
-    for (auto& v_out : detail::range(mVerticesSize, mVertexToOutgoingHalfedge))
-        if (v_out.value >= 0)
-            v_out.value = h_old_to_new[v_out.value];
-
-    for (auto& f_h : detail::range(mFacesSize, mFaceToHalfedge))
-        if (f_h.value >= 0)
-            f_h.value = h_old_to_new[f_h.value];
-
-    for (auto& h_next : detail::range(mHalfedgesSize, mHalfedgeToNextHalfedge))
-        if (h_next.value >= 0)
-            h_next.value = h_old_to_new[h_next.value];
-    for (auto& h_prev : detail::range(mHalfedgesSize, mHalfedgeToPrevHalfedge))
-        if (h_prev.value >= 0)
-            h_prev.value = h_old_to_new[h_prev.value];
-    for (auto& h_f : detail::range(mHalfedgesSize, mHalfedgeToFace))
-        if (h_f.value >= 0)
-            h_f.value = f_old_to_new[h_f.value];
-    for (auto& h_v : detail::range(mHalfedgesSize, mHalfedgeToVertex))
-        if (h_v.value >= 0)
-            h_v.value = v_old_to_new[h_v.value];
+    auto ll = low_level_api(this);
 
-    for (auto a = mVertexAttrs; a; a = a->mNextAttribute)
-        a->apply_remapping(v_new_to_old);
-    for (auto a = mFaceAttrs; a; a = a->mNextAttribute)
-        a->apply_remapping(f_new_to_old);
-    for (auto a = mEdgeAttrs; a; a = a->mNextAttribute)
-        a->apply_remapping(e_new_to_old);
-    for (auto a = mHalfedgeAttrs; a; a = a->mNextAttribute)
-        a->apply_remapping(h_new_to_old);
+    compactify_scratch local_scratch;
+    auto& tmp = scratch ? *scratch : local_scratch;
+
+    // calculate remappings (map[new_prim_id] = old_prim_id)
+    auto& v_new_to_old = tmp.v_new_to_old;
+    auto& f_new_to_old = tmp.f_new_to_old;
+    auto& e_new_to_old = tmp.e_new_to_old;
+    auto& h_new_to_old = tmp.h_new_to_old;
+    auto& v_old_to_new = tmp.v_old_to_new;
+    auto& f_old_to_new = tmp.f_old_to_new;
+    auto& h_old_to_new = tmp.h_old_to_new;
+
+    compute_remapping(
+        exec, size_all_vertices(), [&](index_value_t i) { return !ll.is_removed(vertex_index(i)); }, v_new_to_old, &v_old_to_new, tmp.chunk_offsets);
+    compute_remapping(
+        exec, size_all_faces(), [&](index_value_t i) { return !ll.is_removed(face_index(i)); }, f_new_to_old, &f_old_to_new, tmp.chunk_offsets);
+    compute_remapping(
+        exec, size_all_halfedges(), [&](index_value_t i) { return !ll.is_removed(halfedge_index(i)); }, h_new_to_old, &h_old_to_new, tmp.chunk_offsets);
+
+    // both half-edges of an edge are always removed together
+    e_new_to_old.resize(h_new_to_old.size() >> 1);
+    detail::parallel_for(exec, index_value_t(e_new_to_old.size()), [&](index_value_t i) { e_new_to_old[i] = h_new_to_old[i << 1] >> 1; });
+
+    auto const v_cnt = index_value_t(v_new_to_old.size());
+    auto const f_cnt = index_value_t(f_new_to_old.size());
+    auto const h_cnt = index_value_t(h_new_to_old.size());
+
+    // gather topology into new (tightly allocated) arrays and remap the stored indices
+    // NOTE: an in-place gather cannot be parallelized
+    auto vertex_to_outgoing = unique_array<halfedge_index>::uninitialized(v_cnt, mResource);
+    auto face_to_halfedge = unique_array<halfedge_index>::uninitialized(f_cnt, mResource);
+    auto halfedge_to_vertex = unique_array<vertex_index>::uninitialized(h_cnt, mResource);
+    auto halfedge_to_face = unique_array<face_index>::uninitialized(h_cnt, mResource);
+    auto halfedge_to_next = unique_array<halfedge_index>::uninitialized(h_cnt, mResource);
+    auto halfedge_to_prev = unique_array<halfedge_index>::uninitialized(h_cnt, mResource);
+
+    auto remap_h = [&](halfedge_index h) { return h.value >= 0 ? halfedge_index(h_old_to_new[h.value]) : h; };
+    auto remap_f = [&](face_index f) { return f.value >= 0 ? face_index(f_old_to_new[f.value]) : f; };
+    auto remap_v = [&](vertex_index v) { return v.value >= 0 ? vertex_index(v_old_to_new[v.value]) : v; };
+
+    detail::parallel_for(exec, v_cnt, [&](index_value_t i) { vertex_to_outgoing[i] = remap_h(mVertexToOutgoingHalfedge[v_new_to_old[i]]); });
+    detail::parallel_for(exec, f_cnt, [&](index_value_t i) { face_to_halfedge[i] = remap_h(mFaceToHalfedge[f_new_to_old[i]]); });
+    detail::parallel_for(exec, h_cnt, [&](index_value_t i) {
+        auto const h = h_new_to_old[i];
+        halfedge_to_vertex[i] = remap_v(mHalfedgeToVertex[h]);
+        halfedge_to_face[i] = remap_f(mHalfedgeToFace[h]);
+        halfedge_to_next[i] = remap_h(mHalfedgeToNextHalfedge[h]);
+        halfedge_to_prev[i] = remap_h(mHalfedgeToPrevHalfedge[h]);
+    });
 
-    // shrink to fit
     auto old_v_size = mVerticesSize;
     auto old_f_size = mFacesSize;
     auto old_h_size = mHalfedgesSize;
 
-    detail::shrink_to_fit(mVerticesSize, mVerticesCapacity, mVertexToOutgoingHalfedge);
-    detail::shrink_to_fit(mFacesSize, mFacesCapacity, mFaceToHalfedge);
-    detail::shrink_to_fit(mHalfedgesSize, mHalfedgesCapacity, mHalfedgeToFace, mHalfedgeToVertex, mHalfedgeToNextHalfedge, mHalfedgeToPrevHalfedge);
-
-    for (auto a = mVertexAttrs; a; a = a->mNextAttribute)
-        a->resize_from(old_v_size);
-    for (auto a = mFaceAttrs; a; a = a->mNextAttribute)
-        a->resize_from(old_f_size);
-    for (auto a = mEdgeAttrs; a; a = a->mNextAttribute)
-        a->resize_from(old_h_size >> 1);
-    for (auto a = mHalfedgeAttrs; a; a = a->mNextAttribute)
-        a->resize_from(old_h_size);
+    mVertexToOutgoingHalfedge = std::move(vertex_to_outgoing);
+    mFaceToHalfedge = std::move(face_to_halfedge);
+    mHalfedgeToVertex = std::move(halfedge_to_vertex);
+    mHalfedgeToFace = std::move(halfedge_to_face);
+    mHalfedgeToNextHalfedge = std::move(halfedge_to_next);
+    mHalfedgeToPrevHalfedge = std::move(halfedge_to_prev);
+
+    mVerticesSize = mVerticesCapacity = v_cnt;
+    mFacesSize = mFacesCapacity = f_cnt;
+    mHalfedgesSize = mHalfedgesCapacity = h_cnt;
+
+    // remap and shrink attributes (one task per attribute)
+    std::vector<std::function<void()>> attr_tasks;
+    auto add_attr_tasks = [&](auto* attrs, std::vector<index_value_t> const& new_to_old, index_value_t old_size) {
+        for (auto a = attrs; a; a = a->mNextAttribute)
+            attr_tasks.emplace_back([a, &new_to_old, old_size] {
+                a->apply_remapping(new_to_old);
+                a->resize_from(old_size);
+            });
+    };
+    add_attr_tasks(mVertexAttrs, v_new_to_old, old_v_size);
+    add_attr_tasks(mFaceAttrs, f_new_to_old, old_f_size);
+    add_attr_tasks(mEdgeAttrs, e_new_to_old, old_h_size >> 1);
+    add_attr_tasks(mHalfedgeAttrs, h_new_to_old, old_h_size);
+
+    // pooled attributes are copied into one new allocation per primitive kind
+    // NOTE: the old allocation stays valid until end_resize, thus remapping before the copy is fine
+    detail::attribute_pool* pools[] = {mVertexAttrPool, mFaceAttrPool, mEdgeAttrPool, mHalfedgeAttrPool};
+    index_value_t const pool_capacities[] = {v_cnt, f_cnt, h_cnt >> 1, h_cnt};
+    bool pool_resized[4] = {};
+    for (auto i = 0; i < 4; ++i)
+        pool_resized[i] = pools[i] && pools[i]->begin_resize(pool_capacities[i]);
+
+    exec.run(int(attr_tasks.size()), [&](int i) { attr_tasks[i](); });
+
+    for (auto i = 0; i < 4; ++i)
+        if (pool_resized[i])
+            pools[i]->end_resize();
 
     mRemovedFaces = 0;
     mRemovedHalfedges = 0;
     mRemovedVertices = 0;
     mCompact = true;
+    clear_removed_bits();
+    ++mTopologyVersion;
 }
 
 void Mesh::clear()
@@ -353,6 +935,8 @@ void Mesh::clear()
     mRemovedHalfedges = 0;
     mRemovedVertices = 0;
     mCompact = true;
+    clear_removed_bits();
+    ++mTopologyVersion;
 }
 
 void Mesh::shrink_to_fit()
@@ -361,26 +945,21 @@ void Mesh::shrink_to_fit()
     {
         detail::shrink_to_fit(mVerticesSize, mVerticesCapacity, mVertexToOutgoingHalfedge);
 
-        for (auto a = mVertexAttrs; a; a = a->mNextAttribute)
-            a->resize_from(mVerticesSize);
+        resize_vertex_attributes(mVerticesSize);
     }
 
     if (mFacesCapacity > mFacesSize)
     {
         detail::shrink_to_fit(mFacesSize, mFacesCapacity, mFaceToHalfedge);
 
-        for (auto a = mFaceAttrs; a; a = a->mNextAttribute)
-            a->resize_from(mFacesSize);
+        resize_face_attributes(mFacesSize);
     }
 
     if (mHalfedgesCapacity > mHalfedgesSize)
     {
         detail::shrink_to_fit(mHalfedgesSize, mHalfedgesCapacity, mHalfedgeToFace, mHalfedgeToVertex, mHalfedgeToNextHalfedge, mHalfedgeToPrevHalfedge);
 
-        for (auto a = mEdgeAttrs; a; a = a->mNextAttribute)
-            a->resize_from(mHalfedgesSize >> 1);
-        for (auto a = mHalfedgeAttrs; a; a = a->mNextAttribute)
-            a->resize_from(mHalfedgesSize);
+        resize_halfedge_attributes(mHalfedgesSize);
     }
 }
 
@@ -390,32 +969,31 @@ void Mesh::reset()
     {
         detail::clear(mVerticesSize, mVerticesCapacity, mVertexToOutgoingHalfedge);
 
-        for (auto a = mVertexAttrs; a; a = a->mNextAttribute)
-            a->resize_from(0);
+        resize_vertex_attributes(0);
     }
 
     if (mFacesCapacity > 0)
     {
         detail::clear(mFacesSize, mFacesCapacity, mFaceToHalfedge);
 
-        for (auto a = mFaceAttrs; a; a = a->mNextAttribute)
-            a->resize_from(0);
+        resize_face_attributes(0);
     }
 
     if (mHalfedgesCapacity > 0)
     {
         detail::clear(mHalfedgesSize, mHalfedgesCapacity, mHalfedgeToFace, mHalfedgeToVertex, mHalfedgeToNextHalfedge, mHalfedgeToPrevHalfedge);
 
-        for (auto a = mEdgeAttrs; a; a = a->mNextAttribute)
-            a->resize_from(0);
-        for (auto a = mHalfedgeAttrs; a; a = a->mNextAttribute)
-            a->resize_from(0);
+        resize_halfedge_attributes(0);
     }
 
     mRemovedFaces = 0;
     mRemovedHalfedges = 0;
     mRemovedVertices = 0;
     mCompact = true;
+    mRemovedVertexBits.reset();
+    mRemovedFaceBits.reset();
+    mRemovedEdgeBits.reset();
+    ++mTopologyVersion;
 }
 
 void Mesh::copy_from(const Mesh& m)
@@ -443,16 +1021,13 @@ void Mesh::copy_from(const Mesh& m)
     mRemovedHalfedges = m.mRemovedHalfedges;
     mRemovedVertices = m.mRemovedVertices;
     mCompact = m.mCompact;
+    ++mTopologyVersion;
+    rebuild_removed_bits();
 
     // resize attributes
-    for (auto a = mVertexAttrs; a; a = a->mNextAttribute)
-        a->resize_from(old_v_size);
-    for (auto a = mFaceAttrs; a; a = a->mNextAttribute)
-        a->resize_from(old_f_size);
-    for (auto a = mEdgeAttrs; a; a = a->mNextAttribute)
-        a->resize_from(old_h_size >> 1);
-    for (auto a = mHalfedgeAttrs; a; a = a->mNextAttribute)
-        a->resize_from(old_h_size);
+    resize_vertex_attributes(old_v_size);
+    resize_face_attributes(old_f_size);
+    resize_halfedge_attributes(old_h_size);
 }
 
 void Mesh::assert_consistency() const
@@ -462,20 +1037,20 @@ void Mesh::assert_consistency() const
 
     // check correct counts
     {
-        auto vertex_cnt = 0;
-        auto face_cnt = 0;
-        auto edge_cnt = 0;
-        auto halfedge_cnt = 0;
+        index_value_t vertex_cnt = 0;
+        index_value_t face_cnt = 0;
+        index_value_t edge_cnt = 0;
+        index_value_t halfedge_cnt = 0;
 
-        auto valid_vertex_cnt = 0;
-        auto valid_face_cnt = 0;
-        auto valid_edge_cnt = 0;
-        auto valid_halfedge_cnt = 0;
+        index_value_t valid_vertex_cnt = 0;
+        index_value_t valid_face_cnt = 0;
+        index_value_t valid_edge_cnt = 0;
+        index_value_t valid_halfedge_cnt = 0;
 
-        auto invalid_vertex_cnt = 0;
-        auto invalid_face_cnt = 0;
-        auto invalid_edge_cnt = 0;
-        auto invalid_halfedge_cnt = 0;
+        index_value_t invalid_vertex_cnt = 0;
+        index_value_t invalid_face_cnt = 0;
+        index_value_t invalid_edge_cnt = 0;
+        index_value_t invalid_halfedge_cnt = 0;
 
         for (auto h : all_vertices())
         {
@@ -551,6 +1126,15 @@ void Mesh::assert_consistency() const
         POLYMESH_ASSERT(invalid_edge_cnt * 2 == invalid_halfedge_cnt);
         POLYMESH_ASSERT(valid_edge_cnt * 2 == valid_halfedge_cnt);
         POLYMESH_ASSERT(edge_cnt * 2 == halfedge_cnt);
+
+        // removed bitsets
+        auto const bit_of = [](unique_array<uint64_t> const& bits, index_value_t i) { return (i >> 6) < index_value_t(bits.size()) && ((bits[i >> 6] >> (i & 63)) & 1); };
+        for (auto v : all_vertices())
+            POLYMESH_ASSERT(bit_of(mRemovedVertexBits, v.idx.value) == v.is_removed());
+        for (auto f : all_faces())
+            POLYMESH_ASSERT(bit_of(mRemovedFaceBits, f.idx.value) == f.is_removed());
+        for (auto e : all_edges())
+            POLYMESH_ASSERT(bit_of(mRemovedEdgeBits, e.idx.value) == e.is_removed());
     }
 
     // check validity
@@ -770,8 +1354,8 @@ void Mesh::assert_consistency() const
 
     // check derived counts
     {
-        auto v_e_sum = 0;
-        [[maybe_unused]] auto f_h_sum = 0;
+        index_value_t v_e_sum = 0;
+        [[maybe_unused]] index_value_t f_h_sum = 0;
 
         for (auto v : vertices())
         {
@@ -817,7 +1401,7 @@ void Mesh::assert_consistency() const
     }
 
     // check half-edge uniqueness
-    std::map<int, std::set<int>> hes;
+    std::map<index_value_t, std::set<index_value_t>> hes;
     for (auto h : halfedges())
     {
         auto v0 = h.vertex_from().idx.value;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
 #include <vector>
 
 #include "fwd.hh"
@@ -9,13 +10,34 @@
 #include "cursors.hh"
 #include "detail/unique_array.hh"
 #include "detail/unique_ptr.hh"
+#include "memory_resource.hh"
 #include "ranges.hh"
+#include "span.hh"
 
 // often used helper
 #include "low_level_api.hh"
 
 namespace polymesh
 {
+namespace detail
+{
+class attribute_pool;
+}
+
+/// reusable temporary memory for Mesh::compactify
+/// (the content is unspecified between calls)
+struct compactify_scratch
+{
+    std::vector<index_value_t> v_new_to_old;
+    std::vector<index_value_t> f_new_to_old;
+    std::vector<index_value_t> e_new_to_old;
+    std::vector<index_value_t> h_new_to_old;
+    std::vector<index_value_t> v_old_to_new;
+    std::vector<index_value_t> f_old_to_new;
+    std::vector<index_value_t> h_old_to_new;
+    std::vector<index_value_t> chunk_offsets;
+};
+
 /**
  * @brief Half-edge Mesh Data Structure
  *
@@ -36,8 +58,6 @@ namespace polymesh
  * For more concept documents see:
  *  * http://kaba.hilvi.org/homepage/blog/halfedge/halfedge.htm
  *  * https://www.openmesh.org/media/Documentations/OpenMesh-Doc-Latest/a03930.html
- *
- * Currently a mesh consumes 120 bytes without any data
  */
 class Mesh
 {
@@ -103,13 +123,38 @@ public:
     /// Removes all invalid/removed primitives
     /// NOTE: cheap no-op if already compact
     void compactify();
+    /// Same as compactify() but remappings, topology, and attributes are processed in parallel via the executor (see parallel.hh)
+    /// If scratch is provided, its memory is reused for the remapping tables (avoids reallocations for repeated compactions)
+    /// NOTE: attributes are updated concurrently (one task per attribute)
+    void compactify(executor const& exec, compactify_scratch* scratch = nullptr);
+
+    /// Incremented by every topological change (adding, removing, or reconnecting primitives, compactify, clear, ...)
+    /// Used to detect stale derived data (e.g. adjacency_snapshot)
+    /// NOTE: direct writes through the references returned by low_level_api are not tracked
+    uint64_t topology_version() const { return mTopologyVersion; }
 
     /// Asserts that mesh invariants hold, e.g. that the half-edge stored in a face actually bounds that face
     void assert_consistency() const;
 
+    // bulk construction
+public:
+    /// Adds all faces of an index buffer in a single pass (much faster than repeated faces().add(...))
+    /// face_sizes[i] is the number of vertices of the i-th face, indices contains all faces back-to-back (in CCW order)
+    /// Indices refer to existing vertices and the mesh must not contain any faces or edges yet
+    /// Faces are added in input order and a face is skipped iff faces().add(...) would reject it after adding all previous faces
+    /// (degenerate faces, already used directed edges, vertices with a closed fan next to another fan)
+    /// Returns the (input) indices of all skipped faces
+    std::vector<index_value_t> build_from_polygons(span<int const> face_sizes, span<index_value_t const> indices);
+    /// Same as build_from_polygons but for a pure triangle index buffer (3 indices per face)
+    std::vector<index_value_t> build_from_triangles(span<index_value_t const> indices);
+
     // ctor
 public:
     Mesh() = default;
+    /// topology and all attributes of this mesh are allocated from the given resource (see memory_resource.hh)
+    /// NOTE: the resource must outlive the mesh and all of its attributes
+    explicit Mesh(memory_resource& resource);
+    ~Mesh();
 
     /// Meshes can be neither moved nor copied because attributes depend on the Mesh address
     Mesh(Mesh const&) = delete;
@@ -119,41 +164,47 @@ public:
 
     /// Creates a new mesh and returns a unique_ptr to it
     static unique_ptr<Mesh> create() { return make_unique<Mesh>(); }
+    static unique_ptr<Mesh> create(memory_resource& resource) { return make_unique<Mesh>(resource); }
 
     /// Clears this mesh and copies mesh topology, NOT attributes!
     void copy_from(Mesh const& m);
-    /// Creates a new mesh and calls copy_from(*this);
+    /// Creates a new mesh (with the same memory resource) and calls copy_from(*this);
     /// Note: does NOT copy attributes!
     unique_ptr<Mesh> copy() const;
 
+    /// the resource that topology and attributes are allocated from
+    memory_resource* resource() const { return mResource; }
+
     // internal primitives
 private:
+    memory_resource* mResource = memory_resource::heap();
+
     unique_array<halfedge_index> mFaceToHalfedge;
-    int mFacesSize = 0;
-    int mFacesCapacity = 0;
+    index_value_t mFacesSize = 0;
+    index_value_t mFacesCapacity = 0;
 
     unique_array<halfedge_index> mVertexToOutgoingHalfedge;
-    int mVerticesSize = 0;
-    int mVerticesCapacity = 0;
+    index_value_t mVerticesSize = 0;
+    index_value_t mVerticesCapacity = 0;
 
     unique_array<vertex_index> mHalfedgeToVertex;
     unique_array<face_index> mHalfedgeToFace;
     unique_array<halfedge_index> mHalfedgeToNextHalfedge;
     unique_array<halfedge_index> mHalfedgeToPrevHalfedge;
-    int mHalfedgesSize = 0;
-    int mHalfedgesCapacity = 0;
+    index_value_t mHalfedgesSize = 0;
+    index_value_t mHalfedgesCapacity = 0;
 
     // primitive size
 private:
-    int size_all_faces() const { return (int)mFacesSize; }
-    int size_all_vertices() const { return (int)mVerticesSize; }
-    int size_all_edges() const { return (int)mHalfedgesSize >> 1; }
-    int size_all_halfedges() const { return (int)mHalfedgesSize; }
+    index_value_t size_all_faces() const { return mFacesSize; }
+    index_value_t size_all_vertices() const { return mVerticesSize; }
+    index_value_t size_all_edges() const { return mHalfedgesSize >> 1; }
+    index_value_t size_all_halfedges() const { return mHalfedgesSize; }
 
-    int size_valid_faces() const { return (int)mFacesSize - mRemovedFaces; }
-    int size_valid_vertices() const { return (int)mVerticesSize - mRemovedVertices; }
-    int size_valid_edges() const { return ((int)mHalfedgesSize - mRemovedHalfedges) >> 1; }
-    int size_valid_halfedges() const { return (int)mHalfedgesSize - mRemovedHalfedges; }
+    index_value_t size_valid_faces() const { return mFacesSize - mRemovedFaces; }
+    index_value_t size_valid_vertices() const { return mVerticesSize - mRemovedVertices; }
+    index_value_t size_valid_edges() const { return (mHalfedgesSize - mRemovedHalfedges) >> 1; }
+    index_value_t size_valid_halfedges() const { return mHalfedgesSize - mRemovedHalfedges; }
 
     // primitive access
 private:
@@ -181,29 +232,55 @@ private:
     edge_index alloc_edge();
     /// Allocates a given amount of vertices, faces, and halfedges
     /// NOTE: leaves ALL of them in an unspecified state
-    void alloc_primitives(int vertices, int faces, int halfedges);
+    void alloc_primitives(index_value_t vertices, index_value_t faces, index_value_t halfedges);
 
     // reserves a certain number of primitives
-    void reserve_faces(int capacity);
-    void reserve_vertices(int capacity);
-    void reserve_edges(int capacity);
-    void reserve_halfedges(int capacity);
+    void reserve_faces(index_value_t capacity);
+    void reserve_vertices(index_value_t capacity);
+    void reserve_edges(index_value_t capacity);
+    void reserve_halfedges(index_value_t capacity);
+
+    // bulk construction
+private:
+    /// shared implementation of build_from_polygons/triangles
+    /// offset_of(f) is the first index of face f in indices (offset_of(face_cnt) == indices.size())
+    /// face_of(i) is the face that contains indices[i]
+    template <class OffsetF, class FaceOfF>
+    std::vector<index_value_t> build_from_faces(index_value_t face_cnt, OffsetF&& offset_of, FaceOfF&& face_of, span<index_value_t const> indices);
 
     // primitive reordering
 private:
     /// applies an index remapping to all face indices (p[curr_idx] = new_idx)
-    void permute_faces(std::vector<int> const& p);
+    /// topology arrays and attributes are gathered in parallel (see detail/permutation.hh)
+    void permute_faces(std::vector<index_value_t> const& p, executor const& exec, permute_scratch* scratch);
     /// applies an index remapping to all edge (and half-edge) indices (p[curr_idx] = new_idx)
-    void permute_edges(std::vector<int> const& p);
+    void permute_edges(std::vector<index_value_t> const& p, executor const& exec, permute_scratch* scratch);
     /// applies an index remapping to all vertices indices (p[curr_idx] = new_idx)
-    void permute_vertices(std::vector<int> const& p);
+    void permute_vertices(std::vector<index_value_t> const& p, executor const& exec, permute_scratch* scratch);
 
     // internal state
 private:
     bool mCompact = true;
-    int mRemovedFaces = 0;
-    int mRemovedVertices = 0;
-    int mRemovedHalfedges = 0;
+    index_value_t mRemovedFaces = 0;
+    index_value_t mRemovedVertices = 0;
+    index_value_t mRemovedHalfedges = 0;
+    uint64_t mTopologyVersion = 0;
+
+    // removed primitives as bitsets (bit i is set iff primitive i is removed)
+    // valid iteration skips whole words of removed primitives (see low_level_api::next_valid_idx_from)
+    // grown lazily by set_removed (indices beyond the bitset are not removed), zeroed when no removed primitives remain
+    // NOTE: edges and half-edges share one bitset
+    unique_array<uint64_t> mRemovedVertexBits;
+    unique_array<uint64_t> mRemovedFaceBits;
+    unique_array<uint64_t> mRemovedEdgeBits;
+
+    /// sets bit idx, grows the bitset to cover capacity bits if necessary
+    static void set_removed_bit(unique_array<uint64_t>& bits, index_value_t idx, index_value_t capacity);
+    static void unset_removed_bit(unique_array<uint64_t>& bits, index_value_t idx);
+    /// zeroes all bitsets (keeps the memory)
+    void clear_removed_bits();
+    /// recomputes the bitsets from the topology (after it was changed without set_removed, e.g. permuted or loaded)
+    void rebuild_removed_bits();
 
     // attributes
 private:
@@ -222,6 +299,32 @@ private:
     void register_attr(primitive_attribute_base<halfedge_tag>* attr) const;
     void deregister_attr(primitive_attribute_base<halfedge_tag>* attr) const;
 
+    // optional pooled storage of trivially copyable attributes (owned, see detail/attribute_pool.hh)
+    detail::attribute_pool* mVertexAttrPool = nullptr;
+    detail::attribute_pool* mFaceAttrPool = nullptr;
+    detail::attribute_pool* mEdgeAttrPool = nullptr;
+    detail::attribute_pool* mHalfedgeAttrPool = nullptr;
+
+    void enable_attribute_pool(vertex_tag, size_t bytes_per_element, int attribute_count, executor const* exec);
+    void enable_attribute_pool(face_tag, size_t bytes_per_element, int attribute_count, executor const* exec);
+    void enable_attribute_pool(edge_tag, size_t bytes_per_element, int attribute_count, executor const* exec);
+    void enable_attribute_pool(halfedge_tag, size_t bytes_per_element, int attribute_count, executor const* exec);
+
+    /// the resource for the data of an attribute (the pool if enabled and poolable, otherwise resource())
+    memory_resource* attribute_resource(vertex_tag, bool poolable) const;
+    memory_resource* attribute_resource(face_tag, bool poolable) const;
+    memory_resource* attribute_resource(edge_tag, bool poolable) const;
+    memory_resource* attribute_resource(halfedge_tag, bool poolable) const;
+
+    /// calls resize_from(old_size) on all attributes after the capacity changed
+    /// (pooled attributes are moved to one new allocation, in parallel if the pool has an executor)
+    void resize_vertex_attributes(index_value_t old_size);
+    void resize_face_attributes(index_value_t old_size);
+    /// edge AND halfedge attributes
+    void resize_halfedge_attributes(index_value_t old_halfedge_size);
+    template <class tag>
+    static void resize_attributes(primitive_attribute_base<tag>* attrs, detail::attribute_pool* pool, index_value_t new_capacity, index_value_t old_size);
+
     // friends
 private:
     // for attribute registration
@@ -240,6 +343,7 @@ private:
 
 #include "impl/impl_attributes.hh"
 #include "impl/impl_cursors.hh"
+#include "impl/impl_iterators.hh"
 #include "impl/impl_low_level_api_base.hh"
 #include "impl/impl_low_level_api_mutable.hh"
 #include "impl/impl_mesh.hh"
@@ -1,7 +1,6 @@
 #pragma once
 
 // TODO:
-// - vertex clustering
 // - more subdivision
 // - direct smoothing
 // - cutting
@@ -34,3 +33,4 @@
 #include "algorithms/topology.hh"
 #include "algorithms/tracing.hh"
 #include "algorithms/triangulate.hh"
+#include "algorithms/vertex_clustering.hh"
@@ -8,8 +8,12 @@
 
 #include <polymesh/std/hash.hh>
 
+#include <algorithm>
+#include <cmath>
 #include <unordered_map>
 
+using polymesh::index_value_t;
+
 void polymesh::optimize_for_face_traversal(polymesh::Mesh& m)
 {
     m.faces().permute(cache_coherent_face_layout(m));
@@ -24,13 +28,308 @@ void polymesh::optimize_for_vertex_traversal(polymesh::Mesh& m)
     optimize_faces_for_vertices(m);
 }
 
-void polymesh::optimize_for_rendering(polymesh::Mesh& m)
+namespace
+{
+/// vertices of all valid faces in CSR format
+struct face_vertex_table
+{
+    std::vector<index_value_t> offsets;
+    std::vector<index_value_t> vertices;
+
+    index_value_t size() const { return index_value_t(offsets.size()) - 1; }
+    int triangle_count(index_value_t f) const { return int(offsets[f + 1] - offsets[f] - 2); }
+};
+
+/// NOTE: face i of the table is the i-th valid face (i.e. the same index iff the mesh is compact)
+face_vertex_table face_vertices_of(polymesh::Mesh const& m)
 {
-    // TODO
-    POLYMESH_ASSERT(0 && "TODO");
+    face_vertex_table t;
+    t.offsets.reserve(m.faces().size() + 1);
+    t.vertices.reserve(m.halfedges().size());
+    t.offsets.push_back(0);
+    for (auto f : m.faces())
+    {
+        for (auto v : f.vertices())
+            t.vertices.push_back(v.idx.value);
+        t.offsets.push_back(index_value_t(t.vertices.size()));
+    }
+    return t;
 }
 
-std::vector<int> polymesh::cache_coherent_face_layout(const polymesh::Mesh& m)
+/// simulates a FIFO post-transform vertex cache when rendering the faces in the given order
+/// returns the number of misses (i.e. transformed vertices)
+index_value_t simulate_vertex_cache(face_vertex_table const& t, std::vector<index_value_t> const& order, index_value_t v_cnt, int cache_size)
+{
+    // a vertex is cached iff less than cache_size vertices entered the cache since it did
+    std::vector<index_value_t> cache_time(v_cnt, -cache_size);
+    index_value_t time = 0;
+    for (auto f : order)
+        for (auto i = t.offsets[f]; i < t.offsets[f + 1]; ++i)
+        {
+            auto const v = t.vertices[i];
+            if (time - cache_time[v] >= cache_size)
+                cache_time[v] = time++;
+        }
+    return time;
+}
+
+/// Tipsify (Sander, Nehab, Barczak: "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw", 2007)
+/// faces are emitted by fanning around vertices, the next fanning vertex is a recently used one that will still be cached afterwards
+/// returns the faces in render order (generalized to polygons)
+/// if flushes is not null, it receives the positions in the order where the cache was most likely flushed
+std::vector<index_value_t> tipsify(face_vertex_table const& t, index_value_t v_cnt, int cache_size, std::vector<index_value_t>* flushes = nullptr)
+{
+    auto const f_cnt = t.size();
+
+    // faces per vertex (CSR)
+    std::vector<index_value_t> vf_offsets(v_cnt + 1, 0);
+    for (auto v : t.vertices)
+        ++vf_offsets[v + 1];
+    for (index_value_t v = 0; v < v_cnt; ++v)
+        vf_offsets[v + 1] += vf_offsets[v];
+    std::vector<index_value_t> vf_faces(t.vertices.size());
+    {
+        std::vector<index_value_t> fill(vf_offsets.begin(), vf_offsets.end() - 1);
+        for (index_value_t f = 0; f < f_cnt; ++f)
+            for (auto i = t.offsets[f]; i < t.offsets[f + 1]; ++i)
+                vf_faces[fill[t.vertices[i]]++] = f;
+    }
+
+    // number of not yet emitted faces per vertex
+    std::vector<index_value_t> live(v_cnt);
+    for (index_value_t v = 0; v < v_cnt; ++v)
+        live[v] = vf_offsets[v + 1] - vf_offsets[v];
+
+    std::vector<index_value_t> cache_time(v_cnt, 0);
+    std::vector<char> emitted(f_cnt, false);
+    std::vector<index_value_t> dead_end_stack;
+    std::vector<index_value_t> candidates;
+    std::vector<index_value_t> order;
+    order.reserve(f_cnt);
+
+    index_value_t time = cache_size + 1;
+    index_value_t cursor = 0;
+    auto const next_unprocessed = [&]() -> index_value_t {
+        while (cursor < v_cnt && live[cursor] == 0)
+            ++cursor;
+        return cursor < v_cnt ? cursor : -1;
+    };
+
+    auto fan_v = next_unprocessed();
+    while (fan_v >= 0)
+    {
+        // emit all remaining faces around fan_v
+        candidates.clear();
+        for (auto i = vf_offsets[fan_v]; i < vf_offsets[fan_v + 1]; ++i)
+        {
+            auto const f = vf_faces[i];
+            if (emitted[f])
+                continue;
+
+            emitted[f] = true;
+            order.push_back(f);
+            for (auto j = t.offsets[f]; j < t.offsets[f + 1]; ++j)
+            {
+                auto const v = t.vertices[j];
+                dead_end_stack.push_back(v);
+                candidates.push_back(v);
+                --live[v];
+                if (time - cache_time[v] > cache_size)
+                    cache_time[v] = time++;
+            }
+        }
+
+        // next fanning vertex: prefer the oldest candidate that is still cached after its fan was emitted
+        fan_v = -1;
+        index_value_t best_priority = -1;
+        for (auto v : candidates)
+        {
+            if (live[v] == 0)
+                continue;
+
+            index_value_t priority = 0;
+            if (time - cache_time[v] + 2 * live[v] <= cache_size)
+                priority = time - cache_time[v];
+
+            if (priority > best_priority)
+            {
+                best_priority = priority;
+                fan_v = v;
+            }
+        }
+
+        // dead end: most recently used vertex with remaining faces, otherwise the next one in index order
+        while (fan_v < 0 && !dead_end_stack.empty())
+        {
+            auto const v = dead_end_stack.back();
+            dead_end_stack.pop_back();
+            if (live[v] > 0)
+            {
+                fan_v = v;
+                if (flushes && time - cache_time[v] > cache_size)
+                    flushes->push_back(index_value_t(order.size()));
+            }
+        }
+        if (fan_v < 0)
+        {
+            fan_v = next_unprocessed();
+            if (flushes && fan_v >= 0)
+                flushes->push_back(index_value_t(order.size()));
+        }
+    }
+
+    POLYMESH_ASSERT(index_value_t(order.size()) == f_cnt);
+    return order;
+}
+
+/// [curr_idx] = new_idx from a list of indices in the new order
+std::vector<index_value_t> remapping_of(std::vector<index_value_t> const& order)
+{
+    std::vector<index_value_t> p(order.size());
+    for (index_value_t i = 0; i < index_value_t(order.size()); ++i)
+        p[order[i]] = i;
+    return p;
+}
+
+void apply_rendering_layout(polymesh::Mesh& m, std::vector<index_value_t> const& face_order)
+{
+    m.faces().permute(remapping_of(face_order));
+    m.vertices().permute(polymesh::first_use_vertex_layout(m));
+    polymesh::optimize_edges_for_faces(m);
+}
+}
+
+void polymesh::optimize_for_rendering(polymesh::Mesh& m, int cache_size)
+{
+    if (m.faces().empty())
+        return;
+    POLYMESH_ASSERT(m.faces().size() == m.all_faces().size() && "non-compact currently not supported");
+
+    auto const t = face_vertices_of(m);
+    apply_rendering_layout(m, tipsify(t, m.all_vertices().size(), cache_size));
+}
+
+void polymesh::detail::optimize_for_rendering_overdraw(polymesh::Mesh& m, std::vector<std::array<double, 3>> const& pos, int cache_size, float overdraw_threshold)
+{
+    if (m.faces().empty())
+        return;
+    POLYMESH_ASSERT(m.faces().size() == m.all_faces().size() && "non-compact currently not supported");
+
+    auto const v_cnt = m.all_vertices().size();
+    auto const t = face_vertices_of(m);
+
+    std::vector<index_value_t> flushes;
+    auto const order = tipsify(t, v_cnt, cache_size, &flushes);
+    auto const total_misses = simulate_vertex_cache(t, order, v_cnt, cache_size);
+
+    index_value_t total_tris = 0;
+    for (index_value_t f = 0; f < t.size(); ++f)
+        total_tris += t.triangle_count(f);
+    auto const target_acmr = overdraw_threshold * double(total_misses) / std::max(index_value_t(1), total_tris);
+
+    // split into clusters at cache flushes and once the ACMR of the current cluster (starting with an empty cache) is good enough
+    // i.e. rendering clusters in any order costs at most overdraw_threshold times the cache misses
+    std::vector<index_value_t> cluster_starts;
+    {
+        std::vector<index_value_t> cache_time(v_cnt, -cache_size);
+        index_value_t time = 0;
+        size_t next_flush = 0;
+        index_value_t misses = 0;
+        index_value_t tris = 0;
+        for (index_value_t i = 0; i < index_value_t(order.size()); ++i)
+        {
+            while (next_flush < flushes.size() && flushes[next_flush] < i)
+                ++next_flush;
+
+            auto const is_flush = next_flush < flushes.size() && flushes[next_flush] == i;
+            if (i == 0 || is_flush || (tris > 0 && misses <= target_acmr * tris))
+            {
+                cluster_starts.push_back(i);
+                time += cache_size; // flush
+                misses = 0;
+                tris = 0;
+            }
+
+            auto const f = order[i];
+            for (auto j = t.offsets[f]; j < t.offsets[f + 1]; ++j)
+            {
+                auto const v = t.vertices[j];
+                if (time - cache_time[v] >= cache_size)
+                {
+                    cache_time[v] = time++;
+                    ++misses;
+                }
+            }
+            tris += t.triangle_count(f);
+        }
+        cluster_starts.push_back(index_value_t(order.size()));
+    }
+
+    // area-weighted centroid and normal (Newell) of a range of faces in the order
+    struct moments
+    {
+        std::array<double, 3> centroid = {{0, 0, 0}};
+        std::array<double, 3> normal = {{0, 0, 0}};
+        double area = 0;
+    };
+    auto const add_face = [&](moments& r, index_value_t f) {
+        std::array<double, 3> n = {{0, 0, 0}};
+        std::array<double, 3> c = {{0, 0, 0}};
+        auto const cnt = t.offsets[f + 1] - t.offsets[f];
+        for (auto i = 0; i < cnt; ++i)
+        {
+            auto const& p0 = pos[t.vertices[t.offsets[f] + i]];
+            auto const& p1 = pos[t.vertices[t.offsets[f] + (i + 1) % cnt]];
+            n[0] += (p0[1] - p1[1]) * (p0[2] + p1[2]);
+            n[1] += (p0[2] - p1[2]) * (p0[0] + p1[0]);
+            n[2] += (p0[0] - p1[0]) * (p0[1] + p1[1]);
+            for (auto d = 0; d < 3; ++d)
+                c[d] += p0[d] / cnt;
+        }
+        auto const a = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]) / 2;
+        for (auto d = 0; d < 3; ++d)
+        {
+            r.centroid[d] += c[d] * a;
+            r.normal[d] += n[d];
+        }
+        r.area += a;
+    };
+
+    moments mesh;
+    for (index_value_t f = 0; f < t.size(); ++f)
+        add_face(mesh, f);
+    for (auto d = 0; d < 3; ++d)
+        mesh.centroid[d] /= std::max(mesh.area, 1e-30);
+
+    // sort clusters: facing away from the mesh center first (Sander et al.)
+    auto const c_cnt = index_value_t(cluster_starts.size()) - 1;
+    std::vector<std::pair<double, index_value_t>> cluster_keys(c_cnt);
+    for (index_value_t c = 0; c < c_cnt; ++c)
+    {
+        moments r;
+        for (auto i = cluster_starts[c]; i < cluster_starts[c + 1]; ++i)
+            add_face(r, order[i]);
+
+        auto const n_len = std::sqrt(r.normal[0] * r.normal[0] + r.normal[1] * r.normal[1] + r.normal[2] * r.normal[2]);
+        auto key = 0.0;
+        if (r.area > 0 && n_len > 0)
+            for (auto d = 0; d < 3; ++d)
+                key += (r.centroid[d] / r.area - mesh.centroid[d]) * r.normal[d] / n_len;
+
+        cluster_keys[c] = {-key, c};
+    }
+    std::sort(cluster_keys.begin(), cluster_keys.end());
+
+    std::vector<index_value_t> sorted_order;
+    sorted_order.reserve(order.size());
+    for (auto const& kvp : cluster_keys)
+        for (auto i = cluster_starts[kvp.second]; i < cluster_starts[kvp.second + 1]; ++i)
+            sorted_order.push_back(order[i]);
+
+    apply_rendering_layout(m, sorted_order);
+}
+
+std::vector<index_value_t> polymesh::cache_coherent_face_layout(const polymesh::Mesh& m)
 {
     if (m.faces().empty())
         return {};
@@ -50,12 +349,12 @@ std::vector<int> polymesh::cache_coherent_face_layout(const polymesh::Mesh& m)
 
         bool is_leaf() const { return children.empty(); }
 
-        void assign_idx(int& next_idx, std::vector<int>& indices) const
+        void assign_idx(index_value_t& next_idx, std::vector<index_value_t>& indices) const
         {
             if (is_leaf())
             {
-                POLYMESH_ASSERT((int)rep < (int)indices.size());
-                indices[(int)rep] = next_idx++;
+                POLYMESH_ASSERT(rep.value < index_value_t(indices.size()));
+                indices[rep.value] = next_idx++;
             }
             else
             {
@@ -111,15 +410,15 @@ std::vector<int> polymesh::cache_coherent_face_layout(const polymesh::Mesh& m)
             if (f0 > f1)
                 std::swap(f0, f1);
 
-            cluster_neighbors[(int)f0 * fcnt + (int)f1] += w;
+            cluster_neighbors[f0.value * fcnt + f1.value] += w;
         }
 
         // create new edges
         edges.clear();
         for (auto const& kvp : cluster_neighbors)
         {
-            auto f0 = face_index(int(kvp.first / fcnt));
-            auto f1 = face_index(int(kvp.first % fcnt));
+            auto f0 = face_index(index_value_t(kvp.first / fcnt));
+            auto f1 = face_index(index_value_t(kvp.first % fcnt));
             edges.push_back({kvp.second, {f0, f1}});
         }
         sort(edges.begin(), edges.end());
@@ -138,8 +437,8 @@ std::vector<int> polymesh::cache_coherent_face_layout(const polymesh::Mesh& m)
     }
 
     // distribute indices
-    std::vector<int> new_indices(m.all_faces().size());
-    int next_idx = 0;
+    std::vector<index_value_t> new_indices(m.all_faces().size());
+    index_value_t next_idx = 0;
     for (auto const& kvp : cluster_centers)
         kvp.second->assign_idx(next_idx, new_indices);
     POLYMESH_ASSERT(next_idx == m.faces().size());
@@ -151,7 +450,7 @@ std::vector<int> polymesh::cache_coherent_face_layout(const polymesh::Mesh& m)
     return new_indices;
 }
 
-std::vector<int> polymesh::cache_coherent_vertex_layout(const polymesh::Mesh& m)
+std::vector<index_value_t> polymesh::cache_coherent_vertex_layout(const polymesh::Mesh& m)
 {
     if (m.vertices().empty())
         return {};
@@ -170,12 +469,12 @@ std::vector<int> polymesh::cache_coherent_vertex_layout(const polymesh::Mesh& m)
 
         bool is_leaf() const { return children.empty(); }
 
-        void assign_idx(int& next_idx, std::vector<int>& indices) const
+        void assign_idx(index_value_t& next_idx, std::vector<index_value_t>& indices) const
         {
             if (is_leaf())
             {
-                POLYMESH_ASSERT((int)rep < (int)indices.size());
-                indices[(int)rep] = next_idx++;
+                POLYMESH_ASSERT(rep.value < index_value_t(indices.size()));
+                indices[rep.value] = next_idx++;
             }
             else
             {
@@ -231,15 +530,15 @@ std::vector<int> polymesh::cache_coherent_vertex_layout(const polymesh::Mesh& m)
             if (f0 > f1)
                 std::swap(f0, f1);
 
-            cluster_neighbors[(int)f0 * vcnt + (int)f1] += w;
+            cluster_neighbors[f0.value * vcnt + f1.value] += w;
         }
 
         // create new edges
         edges.clear();
         for (auto const& kvp : cluster_neighbors)
         {
-            auto f0 = vertex_index(int(kvp.first / vcnt));
-            auto f1 = vertex_index(int(kvp.first % vcnt));
+            auto f0 = vertex_index(index_value_t(kvp.first / vcnt));
+            auto f1 = vertex_index(index_value_t(kvp.first % vcnt));
             edges.push_back({kvp.second, {f0, f1}});
         }
         sort(edges.begin(), edges.end());
@@ -258,8 +557,8 @@ std::vector<int> polymesh::cache_coherent_vertex_layout(const polymesh::Mesh& m)
     }
 
     // distribute indices
-    std::vector<int> new_indices(m.all_vertices().size());
-    int next_idx = 0;
+    std::vector<index_value_t> new_indices(m.all_vertices().size());
+    index_value_t next_idx = 0;
     for (auto const& kvp : cluster_centers)
         kvp.second->assign_idx(next_idx, new_indices);
     POLYMESH_ASSERT(next_idx == m.vertices().size());
@@ -273,30 +572,12 @@ std::vector<int> polymesh::cache_coherent_vertex_layout(const polymesh::Mesh& m)
 
 void polymesh::optimize_edges_for_faces(polymesh::Mesh& m)
 {
-    std::vector<std::pair<int, int>> face_edge_indices;
-    for (auto e : m.edges())
-    {
-        auto fA = e.faceA();
-        auto fB = e.faceB();
-        auto f = fA.is_invalid() ? (int)fB : fB.is_invalid() ? (int)fA : std::min((int)fA, (int)fB);
-        face_edge_indices.emplace_back(f, (int)e);
-    }
-
-    // sort by face idx
-    sort(face_edge_indices.begin(), face_edge_indices.end());
-
-    // extract edge indices
-    std::vector<int> permutation(face_edge_indices.size());
-    for (auto i = 0u; i < face_edge_indices.size(); ++i)
-        permutation[face_edge_indices[i].second] = i;
-
-    // apply permutation
-    m.edges().permute(permutation);
+    m.edges().permute(face_ordered_edge_layout(m));
 }
 
 void polymesh::optimize_edges_for_vertices(polymesh::Mesh& m)
 {
-    std::vector<std::pair<int, int>> vertex_edge_indices;
+    std::vector<std::pair<index_value_t, index_value_t>> vertex_edge_indices;
     for (auto e : m.edges())
         vertex_edge_indices.emplace_back(std::min(e.vertexA().idx.value, e.vertexB().idx.value), e.idx.value);
 
@@ -304,7 +585,7 @@ void polymesh::optimize_edges_for_vertices(polymesh::Mesh& m)
     sort(vertex_edge_indices.begin(), vertex_edge_indices.end());
 
     // extract edge indices
-    std::vector<int> permutation(vertex_edge_indices.size());
+    std::vector<index_value_t> permutation(vertex_edge_indices.size());
     for (auto i = 0u; i < vertex_edge_indices.size(); ++i)
         permutation[vertex_edge_indices[i].second] = i;
 
@@ -314,7 +595,7 @@ void polymesh::optimize_edges_for_vertices(polymesh::Mesh& m)
 
 void polymesh::optimize_faces_for_vertices(polymesh::Mesh& m)
 {
-    std::vector<std::pair<int, int>> vertex_face_indices;
+    std::vector<std::pair<index_value_t, index_value_t>> vertex_face_indices;
     for (auto f : m.faces())
     {
         vertex_handle vv;
@@ -322,7 +603,7 @@ void polymesh::optimize_faces_for_vertices(polymesh::Mesh& m)
         for (auto v : f.vertices())
         {
             ++cnt;
-            if (vv.is_invalid() || (int)v < (int)vv)
+            if (vv.is_invalid() || v.idx.value < vv.idx.value)
                 vv = v;
         }
         vertex_face_indices.emplace_back(vv.idx.value, f.idx.value);
@@ -332,7 +613,7 @@ void polymesh::optimize_faces_for_vertices(polymesh::Mesh& m)
     sort(vertex_face_indices.begin(), vertex_face_indices.end());
 
     // extract face indices
-    std::vector<int> permutation(vertex_face_indices.size());
+    std::vector<index_value_t> permutation(vertex_face_indices.size());
     for (auto i = 0u; i < vertex_face_indices.size(); ++i)
         permutation[vertex_face_indices[i].second] = i;
 
@@ -342,7 +623,7 @@ void polymesh::optimize_faces_for_vertices(polymesh::Mesh& m)
 
 void polymesh::optimize_vertices_for_faces(polymesh::Mesh& m)
 {
-    std::vector<std::pair<int, int>> face_vertex_indices;
+    std::vector<std::pair<index_value_t, index_value_t>> face_vertex_indices;
     for (auto v : m.vertices())
     {
         face_handle ff;
@@ -353,7 +634,7 @@ void polymesh::optimize_vertices_for_faces(polymesh::Mesh& m)
                 continue;
 
             ++cnt;
-            if (ff.is_invalid() || (int)f < (int)ff)
+            if (ff.is_invalid() || f.idx.value < ff.idx.value)
                 ff = f;
         }
         face_vertex_indices.emplace_back(ff.idx.value, v.idx.value);
@@ -363,10 +644,228 @@ void polymesh::optimize_vertices_for_faces(polymesh::Mesh& m)
     sort(face_vertex_indices.begin(), face_vertex_indices.end());
 
     // extract vertex indices
-    std::vector<int> permutation(face_vertex_indices.size());
+    std::vector<index_value_t> permutation(face_vertex_indices.size());
     for (auto i = 0u; i < face_vertex_indices.size(); ++i)
         permutation[face_vertex_indices[i].second] = i;
 
     // apply permutation
     m.vertices().permute(permutation);
 }
+
+std::vector<index_value_t> polymesh::vertex_cache_face_layout(const polymesh::Mesh& m, int cache_size)
+{
+    if (m.faces().empty())
+        return {};
+    POLYMESH_ASSERT(m.faces().size() == m.all_faces().size() && "non-compact currently not supported");
+
+    auto const t = face_vertices_of(m);
+    return remapping_of(tipsify(t, m.all_vertices().size(), cache_size));
+}
+
+std::vector<index_value_t> polymesh::first_use_vertex_layout(const polymesh::Mesh& m)
+{
+    std::vector<index_value_t> new_indices(m.all_vertices().size(), -1);
+    index_value_t next_idx = 0;
+    for (auto f : m.faces())
+        for (auto v : f.vertices())
+            if (new_indices[v.idx.value] < 0)
+                new_indices[v.idx.value] = next_idx++;
+
+    for (auto& i : new_indices)
+        if (i < 0)
+            i = next_idx++;
+
+    return new_indices;
+}
+
+float polymesh::average_cache_miss_ratio(const polymesh::Mesh& m, int cache_size)
+{
+    auto const t = face_vertices_of(m);
+    std::vector<index_value_t> order(t.size());
+    index_value_t tris = 0;
+    for (index_value_t f = 0; f < t.size(); ++f)
+    {
+        order[f] = f;
+        tris += t.triangle_count(f);
+    }
+
+    if (tris == 0)
+        return 0;
+
+    return float(simulate_vertex_cache(t, order, m.all_vertices().size(), cache_size)) / tris;
+}
+
+float polymesh::average_transform_to_vertex_ratio(const polymesh::Mesh& m, int cache_size)
+{
+    auto const t = face_vertices_of(m);
+    std::vector<index_value_t> order(t.size());
+    for (index_value_t f = 0; f < t.size(); ++f)
+        order[f] = f;
+
+    index_value_t used_vertices = 0;
+    for (auto v : m.vertices())
+        if (!v.is_isolated())
+            ++used_vertices;
+
+    if (used_vertices == 0)
+        return 0;
+
+    return float(simulate_vertex_cache(t, order, m.all_vertices().size(), cache_size)) / used_vertices;
+}
+
+std::vector<index_value_t> polymesh::face_ordered_edge_layout(const polymesh::Mesh& m)
+{
+    auto const e_cnt = m.all_edges().size();
+    auto const f_cnt = m.all_faces().size();
+    auto const ll = low_level_api(m);
+
+    // counting sort by smallest adjacent face (bucket 0: no faces, bucket f_cnt + 1: removed)
+    std::vector<index_value_t> buckets(e_cnt);
+    std::vector<index_value_t> offsets(f_cnt + 3, 0);
+    for (index_value_t i = 0; i < e_cnt; ++i)
+    {
+        auto const e = edge_index(i);
+        auto b = f_cnt + 1;
+        if (!ll.is_removed(e))
+        {
+            auto const fA = ll.face_of(ll.halfedge_of(e, 0));
+            auto const fB = ll.face_of(ll.halfedge_of(e, 1));
+            auto const f = fA.is_invalid() ? fB.value : fB.is_invalid() ? fA.value : std::min(fA.value, fB.value);
+            b = f + 1;
+        }
+        buckets[i] = b;
+        ++offsets[b + 1];
+    }
+
+    for (index_value_t b = 0; b < f_cnt + 2; ++b)
+        offsets[b + 1] += offsets[b];
+
+    std::vector<index_value_t> new_indices(e_cnt);
+    for (index_value_t i = 0; i < e_cnt; ++i)
+        new_indices[i] = offsets[buckets[i]]++;
+
+    return new_indices;
+}
+
+namespace
+{
+/// spreads the lower 21 bits of x to every third bit
+uint64_t spread_bits_3(uint32_t x)
+{
+    auto v = uint64_t(x) & 0x1fffff;
+    v = (v | v << 32) & 0x1f00000000ffffull;
+    v = (v | v << 16) & 0x1f0000ff0000ffull;
+    v = (v | v << 8) & 0x100f00f00f00f00full;
+    v = (v | v << 4) & 0x10c30c30c30c30c3ull;
+    v = (v | v << 2) & 0x1249249249249249ull;
+    return v;
+}
+}
+
+uint64_t polymesh::detail::morton_key(uint32_t x, uint32_t y, uint32_t z)
+{
+    return spread_bits_3(x) << 2 | spread_bits_3(y) << 1 | spread_bits_3(z); //
+}
+
+uint64_t polymesh::detail::hilbert_key(uint32_t x, uint32_t y, uint32_t z)
+{
+    // Skilling: "Programming the Hilbert curve" (2004), axes to transposed Hilbert index
+    uint32_t X[3] = {x & 0x1fffff, y & 0x1fffff, z & 0x1fffff};
+    uint32_t const M = 1u << 20;
+
+    // inverse undo
+    for (auto Q = M; Q > 1; Q >>= 1)
+    {
+        auto const P = Q - 1;
+        for (auto i = 0; i < 3; ++i)
+        {
+            if (X[i] & Q)
+                X[0] ^= P; // invert
+            else
+            {
+                auto const t = (X[0] ^ X[i]) & P; // exchange
+                X[0] ^= t;
+                X[i] ^= t;
+            }
+        }
+    }
+
+    // gray encode
+    X[1] ^= X[0];
+    X[2] ^= X[1];
+    uint32_t t = 0;
+    for (auto Q = M; Q > 1; Q >>= 1)
+        if (X[2] & Q)
+            t ^= Q - 1;
+    for (auto& c : X)
+        c ^= t;
+
+    // the transposed index interleaves to the actual one (X[0] holds the most significant bit of each triple)
+    return morton_key(X[0], X[1], X[2]);
+}
+
+std::vector<index_value_t> polymesh::detail::layout_from_keys(std::vector<uint64_t> const& keys, executor const& exec)
+{
+    auto const n = index_value_t(keys.size());
+    auto const chunk_cnt = detail::chunk_count(exec, n);
+
+    // only digits that differ between keys need a pass
+    std::vector<uint64_t> chunk_diffs(chunk_cnt, 0);
+    detail::parallel_chunks(exec, n, [&](int chunk, index_value_t begin, index_value_t end) {
+        uint64_t diff = 0;
+        for (auto i = begin; i < end; ++i)
+            diff |= keys[i] ^ keys[0];
+        chunk_diffs[chunk] = diff;
+    });
+    uint64_t diff = 0;
+    for (auto d : chunk_diffs)
+        diff |= d;
+
+    // LSD radix sort of (key, index) with 8 bit digits
+    // each chunk scatters its elements to precomputed (digit, chunk) ranges, i.e. the result is stable and independent of the executor
+    std::vector<uint64_t> keys_in = keys;
+    std::vector<uint64_t> keys_out(n);
+    std::vector<index_value_t> idx_in(n);
+    std::vector<index_value_t> idx_out(n);
+    detail::parallel_for(exec, n, [&](index_value_t i) { idx_in[i] = i; });
+
+    std::vector<std::array<index_value_t, 256>> histograms(chunk_cnt);
+    for (auto shift = 0; shift < 64; shift += 8)
+    {
+        if (((diff >> shift) & 0xff) == 0)
+            continue;
+
+        detail::parallel_chunks(exec, n, [&](int chunk, index_value_t begin, index_value_t end) {
+            auto& h = histograms[chunk];
+            h.fill(0);
+            for (auto i = begin; i < end; ++i)
+                ++h[(keys_in[i] >> shift) & 0xff];
+        });
+
+        index_value_t sum = 0;
+        for (auto d = 0; d < 256; ++d)
+            for (auto& h : histograms)
+            {
+                auto const cnt = h[d];
+                h[d] = sum;
+                sum += cnt;
+            }
+
+        detail::parallel_chunks(exec, n, [&](int chunk, index_value_t begin, index_value_t end) {
+            auto& h = histograms[chunk];
+            for (auto i = begin; i < end; ++i)
+            {
+                auto const p = h[(keys_in[i] >> shift) & 0xff]++;
+                keys_out[p] = keys_in[i];
+                idx_out[p] = idx_in[i];
+            }
+        });
+
+        std::swap(keys_in, keys_out);
+        std::swap(idx_in, idx_out);
+    }
+
+    std::vector<index_value_t> new_indices(n);
+    detail::parallel_for(exec, n, [&](index_value_t i) { new_indices[idx_in[i]] = i; });
+    return new_indices;
+}
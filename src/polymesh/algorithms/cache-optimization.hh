@@ -1,8 +1,13 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
 #include <vector>
 
 #include <polymesh/Mesh.hh>
+#include <polymesh/detail/bounds.hh>
+#include <polymesh/parallel.hh>
 
 namespace polymesh
 {
@@ -15,8 +20,17 @@ void optimize_for_face_traversal(Mesh& m);
 void optimize_for_vertex_traversal(Mesh& m);
 
 /// Optimizes mesh layout for indexed face rendering
-// TODO: not implemented
-void optimize_for_rendering(Mesh& m);
+/// faces are ordered for the post-transform vertex cache (see vertex_cache_face_layout),
+/// vertices by first use in that order, and edges by faces
+/// NOTE: requires a compact mesh
+void optimize_for_rendering(Mesh& m, int cache_size = 16);
+
+/// Same as optimize_for_rendering(m, cache_size) but additionally reduces overdraw:
+/// the face order is split into clusters (at cache flushes and wherever the cluster ACMR is below overdraw_threshold * global ACMR)
+/// which are then sorted such that outward-facing clusters come first (i.e. likely occluders are drawn early)
+/// higher thresholds mean smaller clusters, i.e. less overdraw but more cache misses
+template <class Pos3>
+void optimize_for_rendering(Mesh& m, vertex_attribute<Pos3> const& pos, int cache_size = 16, float overdraw_threshold = 1.05f);
 
 /// optimizes edge indices for a given face neighborhood
 void optimize_edges_for_faces(Mesh& m);
@@ -31,10 +45,176 @@ void optimize_faces_for_vertices(Mesh& m);
 /// Calculates a cache-coherent face layout in O(n log n) time
 /// Can be applied using m.faces().permute(...)
 /// Returns remapping [curr_idx] = new_idx
-std::vector<int> cache_coherent_face_layout(Mesh const& m);
+std::vector<index_value_t> cache_coherent_face_layout(Mesh const& m);
 
 /// Calculates a cache-coherent vertex layout in O(n log n) time
 /// Can be applied using m.vertices().permute(...)
 /// Returns remapping [curr_idx] = new_idx
-std::vector<int> cache_coherent_vertex_layout(Mesh const& m);
+std::vector<index_value_t> cache_coherent_vertex_layout(Mesh const& m);
+
+/// Calculates a face layout for a FIFO post-transform vertex cache of the given size in O(n) time (Tipsify, Sander et al. 2007)
+/// Can be applied using m.faces().permute(...)
+/// Returns remapping [curr_idx] = new_idx
+std::vector<index_value_t> vertex_cache_face_layout(Mesh const& m, int cache_size = 16);
+
+/// Calculates a vertex layout where vertices are ordered by their first use in the current face order
+/// (isolated vertices are moved to the end)
+/// Can be applied using m.vertices().permute(...)
+/// Returns remapping [curr_idx] = new_idx
+std::vector<index_value_t> first_use_vertex_layout(Mesh const& m);
+
+/// Average cache miss ratio: transformed vertices per triangle when rendering the faces in index order
+/// with a FIFO post-transform vertex cache of the given size (polygons count as fans of triangles)
+/// Ranges from ~0.5 (optimal for large meshes) to 3 (no reuse)
+float average_cache_miss_ratio(Mesh const& m, int cache_size = 16);
+
+/// Average transform to vertex ratio: transformed vertices per (non-isolated) vertex (see average_cache_miss_ratio)
+/// 1 is optimal
+float average_transform_to_vertex_ratio(Mesh const& m, int cache_size = 16);
+
+/// space-filling curves for spatial layouts
+enum class space_filling_curve
+{
+    morton,  ///< Z-order curve, cheapest to compute
+    hilbert, ///< better locality (consecutive cells are always adjacent)
+};
+
+/// Calculates a vertex layout along a space-filling curve through the vertex positions
+/// Keys are computed in parallel and radix-sorted, i.e. O(n) time (much faster than cache_coherent_vertex_layout)
+/// Also works for non-compact meshes (removed vertices are moved to the end)
+/// Can be applied using m.vertices().permute(...)
+/// Returns remapping [curr_idx] = new_idx
+template <class Pos3>
+std::vector<index_value_t> spatial_vertex_layout(Mesh const& m,
+                                                 vertex_attribute<Pos3> const& pos,
+                                                 space_filling_curve curve = space_filling_curve::hilbert,
+                                                 executor const& exec = executor::default_pool());
+
+/// Same as spatial_vertex_layout but along the face centroids
+/// Can be applied using m.faces().permute(...)
+/// Returns remapping [curr_idx] = new_idx
+template <class Pos3>
+std::vector<index_value_t> spatial_face_layout(Mesh const& m,
+                                               vertex_attribute<Pos3> const& pos,
+                                               space_filling_curve curve = space_filling_curve::hilbert,
+                                               executor const& exec = executor::default_pool());
+
+/// Calculates an edge layout where edges are ordered by their smallest adjacent face index in O(n) time
+/// (edges without faces come first, removed ones last)
+/// halfedges are stored per edge and thus follow the edge order
+/// Can be applied using m.edges().permute(...)
+/// Returns remapping [curr_idx] = new_idx
+std::vector<index_value_t> face_ordered_edge_layout(Mesh const& m);
+
+/// Reorders vertices and faces along a space-filling curve (see spatial_vertex_layout) and edges (and halfedges) by faces
+/// i.e. a single call makes vertex, face, and edge traversals memory-coherent
+template <class Pos3>
+void optimize_spatial_layout(Mesh& m,
+                             vertex_attribute<Pos3> const& pos,
+                             space_filling_curve curve = space_filling_curve::hilbert,
+                             executor const& exec = executor::default_pool());
+
+// ======================== IMPLEMENTATION ========================
+
+namespace detail
+{
+/// optimize_for_rendering with overdraw reduction based on the given positions (indexed by vertex index)
+void optimize_for_rendering_overdraw(Mesh& m, std::vector<std::array<double, 3>> const& pos, int cache_size, float overdraw_threshold);
+
+/// keys of 3D cells with 21 bit coordinates
+uint64_t morton_key(uint32_t x, uint32_t y, uint32_t z);
+uint64_t hilbert_key(uint32_t x, uint32_t y, uint32_t z);
+
+/// returns the remapping [curr_idx] = new_idx that sorts the keys (stable, via parallel radix sort)
+std::vector<index_value_t> layout_from_keys(std::vector<uint64_t> const& keys, executor const& exec);
+
+/// layout of size elements along the curve, position_of(i, p) writes the double[3] position of element i
+/// and returns false for removed elements (which are moved to the end)
+template <class Pos3, class PositionF>
+std::vector<index_value_t> spatial_layout(Mesh const& m, vertex_attribute<Pos3> const& pos, index_value_t size, space_filling_curve curve, executor const& exec, PositionF&& position_of)
+{
+    auto constexpr max_coord = double((1 << 21) - 1);
+
+    std::vector<uint64_t> keys(size, ~uint64_t(0));
+    if (!m.vertices().empty())
+    {
+        // uniform scaling, i.e. cells are cubes
+        auto const bb = vertex_bounds<double>(m, pos, exec);
+        auto const extent = std::max(bb[3] - bb[0], std::max(bb[4] - bb[1], bb[5] - bb[2]));
+        auto const scale = extent > 0 ? max_coord / extent : 0.0;
+        auto const quantize = [&](double v, int d) { return uint32_t(std::min(std::max((v - bb[d]) * scale, 0.0), max_coord)); };
+
+        detail::parallel_for(exec, size, [&](index_value_t i) {
+            double p[3];
+            if (!position_of(i, p))
+                return;
+
+            auto const x = quantize(p[0], 0);
+            auto const y = quantize(p[1], 1);
+            auto const z = quantize(p[2], 2);
+            keys[i] = curve == space_filling_curve::morton ? morton_key(x, y, z) : hilbert_key(x, y, z);
+        });
+    }
+
+    return layout_from_keys(keys, exec);
+}
+}
+
+template <class Pos3>
+std::vector<index_value_t> spatial_vertex_layout(Mesh const& m, vertex_attribute<Pos3> const& pos, space_filling_curve curve, executor const& exec)
+{
+    return detail::spatial_layout(m, pos, m.all_vertices().size(), curve, exec, [&](index_value_t i, double* p) {
+        auto const v = m[vertex_index(i)];
+        if (v.is_removed())
+            return false;
+
+        auto const& pv = pos[v];
+        for (auto d = 0; d < 3; ++d)
+            p[d] = double(pv[d]);
+        return true;
+    });
+}
+
+template <class Pos3>
+std::vector<index_value_t> spatial_face_layout(Mesh const& m, vertex_attribute<Pos3> const& pos, space_filling_curve curve, executor const& exec)
+{
+    return detail::spatial_layout(m, pos, m.all_faces().size(), curve, exec, [&](index_value_t i, double* p) {
+        auto const f = m[face_index(i)];
+        if (f.is_removed())
+            return false;
+
+        p[0] = p[1] = p[2] = 0;
+        auto cnt = 0;
+        for (auto v : f.vertices())
+        {
+            auto const& pv = pos[v];
+            for (auto d = 0; d < 3; ++d)
+                p[d] += double(pv[d]);
+            ++cnt;
+        }
+        for (auto d = 0; d < 3; ++d)
+            p[d] /= cnt;
+        return true;
+    });
+}
+
+template <class Pos3>
+void optimize_spatial_layout(Mesh& m, vertex_attribute<Pos3> const& pos, space_filling_curve curve, executor const& exec)
+{
+    permute_scratch scratch;
+    auto const face_layout = spatial_face_layout(m, pos, curve, exec);
+    m.vertices().permute(spatial_vertex_layout(m, pos, curve, exec), exec, &scratch);
+    m.faces().permute(face_layout, exec, &scratch);
+    m.edges().permute(face_ordered_edge_layout(m), exec, &scratch);
+}
+
+template <class Pos3>
+void optimize_for_rendering(Mesh& m, vertex_attribute<Pos3> const& pos, int cache_size, float overdraw_threshold)
+{
+    std::vector<std::array<double, 3>> p(m.all_vertices().size());
+    for (auto v : m.vertices())
+        p[v.idx.value] = {{double(pos[v][0]), double(pos[v][1]), double(pos[v][2])}};
+
+    detail::optimize_for_rendering_overdraw(m, p, cache_size, overdraw_threshold);
+}
 }
@@ -1,16 +1,32 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
 #include <limits>
-#include <queue>
 #include <utility>
 #include <vector>
 
 #include <polymesh/Mesh.hh>
+#include <polymesh/detail/indexed_heap.hh>
 #include <polymesh/detail/random.hh>
 #include <polymesh/fields.hh>
+#include <polymesh/parallel.hh>
 
 namespace polymesh
 {
+/// counters collected by decimate (see decimate_config::stats)
+struct decimate_stats
+{
+    int collapses = 0;          ///< performed halfedge collapses
+    int rejected_collapses = 0; ///< candidates that failed the topology / normal checks
+    int stale_pops = 0;         ///< candidates that referred to removed halfedges (only if the mesh is changed from outside)
+    int heap_updates = 0;       ///< insertions and key changes of the candidate queue
+    int heap_peak_size = 0;     ///< maximum number of queued candidates
+    int rounds = 0;             ///< number of batches (decimate_parallel only)
+};
+
 /**
  * Default configuration for incremental decimation
  *
@@ -28,6 +44,9 @@ namespace polymesh
  *   merge(ErrorF const& a, ErrorF const& b) -> ErrorF
  *   is_collapse_allowed(pm::halfedge_handle h) -> bool
  *   collapsed_pos(pm::halfedge_handle h, ErrorF const& e) -> Pos3
+ *
+ * Custom configs may provide:
+ *   stats (decimate_stats*, counters are written there if not null)
  */
 template <class Pos3, class ErrorF>
 struct decimate_config
@@ -45,6 +64,9 @@ struct decimate_config
     /// (0 means 0°, 1 means 90°)
     scalar_t max_normal_dev = scalar_t(1);
 
+    /// if not null, decimate writes its counters there
+    decimate_stats* stats = nullptr;
+
     /// returns true if decimation should be stopped (can be static or member function)
     bool should_stop(pm::Mesh const& m, error_value_t curr_error) const
     {
@@ -101,6 +123,31 @@ void decimate(pm::Mesh& m, //
               pm::vertex_attribute<ErrorF>& errors,
               ConfigT const& config);
 
+/**
+ * Parallel version of decimate based on batches of independent collapses
+ *
+ * Each round
+ *   - (re-)scores all changed halfedges in parallel
+ *   - picks the best collapse of each vertex and keeps the lowest batch_fraction of them
+ *   - selects those whose neighborhoods (1-rings of both vertices) do not overlap with a better one (in a few passes)
+ *   - validates them in parallel with the same checks as decimate (flips, normal deviation, link condition)
+ *   - applies them in order of increasing error (until config.should_stop)
+ *
+ * Results are deterministic (independent of the executor), but quality is slightly worse than decimate
+ * because collapses are not strictly performed in order of increasing error.
+ * Larger batch_fraction means fewer rounds (better scaling) but lower quality.
+ *
+ * NOTE: the config functions (except should_stop) are called concurrently
+ *       collapses themselves are applied sequentially (they are cheap compared to scoring and validation)
+ */
+template <class Pos3, class ErrorF, class ConfigT = decimate_config<Pos3, ErrorF>>
+void decimate_parallel(pm::Mesh& m, //
+                       pm::vertex_attribute<Pos3>& pos,
+                       pm::vertex_attribute<ErrorF>& errors,
+                       ConfigT const& config,
+                       executor const& exec = executor::default_pool(),
+                       float batch_fraction = 0.1f);
+
 /// calls decimate with a default configuration that decimates until a target vertex count is reached
 template <class Pos3, class ErrorF>
 void decimate_down_to(pm::Mesh& m, //
@@ -124,160 +171,413 @@ void decimate_up_to_error(pm::Mesh& m, //
 
 // ======================== IMPLEMENTATION ========================
 
-template <class Pos3, class ErrorF, class ConfigT>
-void decimate(pm::Mesh& m, //
-              pm::vertex_attribute<Pos3>& pos,
-              pm::vertex_attribute<ErrorF>& errors,
-              ConfigT const& config)
+namespace detail
 {
-    using error_value_t = std::decay_t<decltype(std::declval<ErrorF>()(std::declval<Pos3>()))>;
+template <class ConfigT>
+auto decimate_stats_of(ConfigT const& config, int) -> decltype(static_cast<decimate_stats*>(config.stats))
+{
+    return config.stats;
+}
+template <class ConfigT>
+decimate_stats* decimate_stats_of(ConfigT const&, long)
+{
+    return nullptr;
+}
 
-    struct entry
-    {
-        error_value_t error;
-        pm::halfedge_index halfedge;
-        int gen;
-        Pos3 pos;
+/// computes the error and optimal position of collapsing h (returns false if h must not be collapsed)
+template <class Pos3, class ErrorF, class ConfigT, class ErrorValueT>
+bool decimate_score(pm::halfedge_handle h,
+                    pm::vertex_attribute<Pos3> const& pos,
+                    pm::vertex_attribute<ErrorF> const& errors,
+                    ConfigT const& config,
+                    ErrorValueT& error,
+                    Pos3& p)
+{
+    auto const v_to = h.vertex_to();
+    auto const v_from = h.vertex_from();
 
-        bool operator<(entry const& rhs) const { return error > rhs.error; }
-    };
+    if (v_from.is_boundary() || !config.is_collapse_allowed(h))
+        return false; // cannot enqueue if boundary
 
-    std::priority_queue<entry> queue;
+    auto const Q = config.merge(errors[v_to], errors[v_from]);
+    p = v_to.is_boundary() ? pos[v_to] : config.collapsed_pos(h, Q);
+    error = config.eval(p, Q);
+    return true;
+}
 
-    auto gen = 0;
-    auto edge_gen = m.halfedges().make_attribute(0);
-    auto vreach = m.vertices().make_attribute(-1);
+/// checks if h can be collapsed such that vertex_to is moved to q
+/// (no valence 2 vertices, no flipped normals, bounded normal deviation, link condition)
+/// reached is scratch memory
+template <class Pos3, class ScalarT>
+bool decimate_can_collapse(pm::halfedge_handle h, Pos3 q, pm::vertex_attribute<Pos3> const& pos, ScalarT max_normal_dev, std::vector<vertex_index>& reached)
+{
+    auto const v_to = h.vertex_to();
+    auto const v_from = h.vertex_from();
 
-    auto const enqueue = [&](pm::halfedge_handle h) {
-        if (!config.is_collapse_allowed(h))
-            return;
+    reached.clear();
 
-        auto const v_to = h.vertex_to();
-        auto const v_from = h.vertex_from();
+    auto const p_to = pos[v_to];
+    auto const p_from = pos[v_from];
 
-        if (v_from.is_boundary())
-            return; // cannot enqueue if boundary
+    // cannot collapse to valence 2 vertex
+    auto const v_ok_0 = h.next().vertex_to();
+    auto const v_ok_1 = h.opposite().prev().vertex_from();
 
-        auto const Q = config.merge(errors[v_to], errors[v_from]);
-        auto const p = v_to.is_boundary() ? pos[v_to] : config.collapsed_pos(h, Q);
-        queue.push({config.eval(p, Q), h, edge_gen[h], p});
-    };
+    if (v_ok_0 == v_ok_1)
+        return false; // valence-2
 
-    auto const can_be_collapsed = [&](pm::halfedge_handle h, Pos3 q) -> bool {
-        auto const v_to = h.vertex_to();
-        auto const v_from = h.vertex_from();
+    // check flipped normals and certain topological constraints
+    for (auto hh : v_to.outgoing_halfedges())
+    {
+        auto const v0 = hh.vertex_to();
+        auto const v1 = hh.next().vertex_to();
 
-        ++gen;
+        if (v0 == v_from || v1 == v_from)
+            continue; // these faces will be removed during collapse
 
-        auto const p_to = pos[v_to];
-        auto const p_from = pos[v_from];
+        auto const p0 = pos[v0];
+        auto const p1 = pos[v1];
 
-        // cannot collapse to valence 2 vertex
-        auto const v_ok_0 = h.next().vertex_to();
-        auto const v_ok_1 = h.opposite().prev().vertex_from();
+        auto const n_before = cross(p0 - p_to, p1 - p_to);
+        auto const n_after = cross(p0 - q, p1 - q);
+        auto const dot_before_after = dot(n_before, n_after);
 
-        if (v_ok_0 == v_ok_1)
-            return false; // valence-2
+        if (dot_before_after <= 0)
+            return false; // no flips
 
-        // check flipped normals and certain topological constraints
-        for (auto hh : v_to.outgoing_halfedges())
-        {
-            auto const v0 = hh.vertex_to();
-            auto const v1 = hh.next().vertex_to();
+        if (dot_before_after * dot_before_after < dot(n_before, n_before) * dot(n_after, n_after) * (1 - max_normal_dev))
+            return false; // too much normal deviation
 
-            if (v0 == v_from || v1 == v_from)
-                continue; // these faces will be removed during collapse
+        reached.push_back(v0);
+    }
 
-            auto const p0 = pos[v0];
-            auto const p1 = pos[v1];
+    for (auto hh : v_from.outgoing_halfedges())
+    {
+        auto v0 = hh.vertex_to();
+        auto v1 = hh.next().vertex_to();
 
-            auto const n_before = cross(p0 - p_to, p1 - p_to);
-            auto const n_after = cross(p0 - q, p1 - q);
-            auto const dot_before_after = dot(n_before, n_after);
+        if (v0 != v_ok_0 && v0 != v_ok_1 && std::find(reached.begin(), reached.end(), v0.idx) != reached.end())
+            return false; // more connections than expected
 
-            if (dot_before_after <= 0)
-                return false; // no flips
+        if (v0 == v_to || v1 == v_to)
+            continue; // these faces will be removed during collapse
 
-            if (dot_before_after * dot_before_after < dot(n_before, n_before) * dot(n_after, n_after) * (1 - config.max_normal_dev))
-                return false; // too much normal deviation
+        auto p0 = pos[v0];
+        auto p1 = pos[v1];
 
-            vreach[v0] = gen;
-        }
+        auto n_before = cross(p0 - p_from, p1 - p_from);
+        auto n_after = cross(p0 - q, p1 - q);
+        auto dot_before_after = dot(n_before, n_after);
 
-        for (auto hh : v_from.outgoing_halfedges())
-        {
-            auto v0 = hh.vertex_to();
-            auto v1 = hh.next().vertex_to();
+        if (dot_before_after <= 0)
+            return false; // no flips
 
-            if (vreach[v0] == gen && v0 != v_ok_0 && v0 != v_ok_1)
-                return false; // more connections than expected
+        if (dot_before_after * dot_before_after < dot(n_before, n_before) * dot(n_after, n_after) * (1 - max_normal_dev))
+            return false; // too much normal deviation
+    }
 
-            if (v0 == v_to || v1 == v_to)
-                continue; // these faces will be removed during collapse
+    // finally: error below threshold, topology OK.
+    return true;
+}
 
-            auto p0 = pos[v0];
-            auto p1 = pos[v1];
+/// order-preserving 64 bit key of (error, halfedge) (smaller error first, ties broken by index)
+template <class ErrorValueT>
+uint64_t decimate_key(ErrorValueT error, pm::halfedge_index h)
+{
+    auto const f = float(error);
+    uint32_t bits;
+    std::memcpy(&bits, &f, sizeof(bits));
+    bits = (bits & 0x80000000u) ? ~bits : bits | 0x80000000u;
+    return (uint64_t(bits) << 32) | uint32_t(h.value);
+}
+}
 
-            auto n_before = cross(p0 - p_from, p1 - p_from);
-            auto n_after = cross(p0 - q, p1 - q);
-            auto dot_before_after = dot(n_before, n_after);
+template <class Pos3, class ErrorF, class ConfigT>
+void decimate(pm::Mesh& m, //
+              pm::vertex_attribute<Pos3>& pos,
+              pm::vertex_attribute<ErrorF>& errors,
+              ConfigT const& config)
+{
+    using error_value_t = std::decay_t<decltype(std::declval<ErrorF>()(std::declval<Pos3>()))>;
 
-            if (dot_before_after <= 0)
-                return false; // no flips
+    // candidate halfedges ordered by collapse error
+    // (every halfedge is queued at most once, its optimal position is cached in collapse_pos)
+    detail::indexed_heap<error_value_t> queue(m.all_halfedges().size());
+    auto collapse_pos = m.halfedges().make_attribute<Pos3>();
 
-            if (dot_before_after * dot_before_after < dot(n_before, n_before) * dot(n_after, n_after) * (1 - config.max_normal_dev))
-                return false; // too much normal deviation
+    decimate_stats stats;
+
+    std::vector<vertex_index> reached;
+
+    auto const update = [&](pm::halfedge_handle h) {
+        error_value_t error;
+        if (!detail::decimate_score(h, pos, errors, config, error, collapse_pos[h]))
+        {
+            queue.remove(h.idx.value);
+            return;
         }
 
-        // finally: error below threshold, topology OK.
-        return true;
+        queue.push_or_update(h.idx.value, error);
+
+        ++stats.heap_updates;
+        stats.heap_peak_size = std::max(stats.heap_peak_size, queue.size());
     };
 
     // initial edges
     for (auto h : m.halfedges())
-        enqueue(h);
+        update(h);
 
     // decimate
     while (!queue.empty())
     {
         // get best element
-        auto entry = queue.top();
-        queue.pop();
-        pm::halfedge_handle h = m[entry.halfedge];
+        pm::halfedge_handle h = m[pm::halfedge_index(queue.top_id())];
 
         // exit condition
-        if (config.should_stop(m, entry.error))
+        if (config.should_stop(m, queue.top_key()))
             break;
 
+        queue.pop();
+
         // deleted halfedge
         if (h.is_removed())
+        {
+            ++stats.stale_pops;
             continue;
-
-        auto const v_to = h.vertex_to();
-
-        // invalid entry
-        if (edge_gen[h] != entry.gen)
-            continue;
+        }
 
         // check if collapse valid
-        if (!can_be_collapsed(h, entry.pos))
+        // (rejected candidates are re-queued once their neighborhood changes)
+        if (!detail::decimate_can_collapse(h, collapse_pos[h], pos, config.max_normal_dev, reached))
+        {
+            ++stats.rejected_collapses;
             continue;
+        }
+
+        auto const v_to = h.vertex_to();
+        auto const v_from = h.vertex_from();
+
+        // the collapse removes or changes all halfedges incident to v_from and v_to
+        for (auto const v : {v_from, v_to})
+            for (auto const hh : v.outgoing_halfedges())
+            {
+                queue.remove(hh.idx.value);
+                queue.remove(hh.opposite().idx.value);
+            }
 
         // perform collapse
         POLYMESH_ASSERT(!h.edge().is_boundary());
-        POLYMESH_ASSERT(!h.vertex_from().is_boundary());
-        errors[v_to] = config.merge(errors[v_to], errors[h.vertex_from()]);
-        pos[v_to] = entry.pos;
+        POLYMESH_ASSERT(!v_from.is_boundary());
+        errors[v_to] = config.merge(errors[v_to], errors[v_from]);
+        pos[v_to] = collapse_pos[h];
         m.halfedges().collapse(h);
+        ++stats.collapses;
+
+        // enqueue changed halfedges
+        for (auto const hh : v_to.outgoing_halfedges())
+        {
+            update(hh);
+            update(hh.opposite());
+        }
+    }
+
+    if (auto const out_stats = detail::decimate_stats_of(config, 0))
+        *out_stats = stats;
+}
+
+template <class Pos3, class ErrorF, class ConfigT>
+void decimate_parallel(pm::Mesh& m, //
+                       pm::vertex_attribute<Pos3>& pos,
+                       pm::vertex_attribute<ErrorF>& errors,
+                       ConfigT const& config,
+                       executor const& exec,
+                       float batch_fraction)
+{
+    using error_value_t = std::decay_t<decltype(std::declval<ErrorF>()(std::declval<Pos3>()))>;
+    auto constexpr no_key = std::numeric_limits<uint64_t>::max();
+
+    auto const v_cnt = m.all_vertices().size();
+    POLYMESH_ASSERT(uint64_t(m.all_halfedges().size()) <= (uint64_t(1) << 32) && "collapse keys store 32 bit halfedge indices");
+
+    // per halfedge: collapse key (no_key if not allowed), error, and position
+    auto h_key = m.halfedges().make_attribute<uint64_t>(no_key);
+    auto h_error = m.halfedges().make_attribute<error_value_t>();
+    auto h_pos = m.halfedges().make_attribute<Pos3>();
+
+    // per vertex: best outgoing collapse, claim of the neighborhood, and round in which a neighborhood was locked
+    std::vector<uint64_t> best(v_cnt, no_key);
+    std::vector<std::atomic<uint64_t>> claims(v_cnt);
+    std::vector<int> locked(v_cnt, 0);
+    for (auto& c : claims)
+        c.store(no_key, std::memory_order_relaxed);
+
+    std::vector<halfedge_index> candidates;
+    std::vector<halfedge_index> selected;
+    std::vector<halfedge_index> dirty;
+    std::vector<vertex_index> dirty_vertices;
+    std::vector<char> state;
+
+    decimate_stats stats;
+
+    auto const score = [&](pm::halfedge_handle h) {
+        h_key[h] = detail::decimate_score(h, pos, errors, config, h_error[h], h_pos[h]) ? detail::decimate_key(h_error[h], h.idx) : no_key;
+    };
+
+    auto const update_best = [&](pm::vertex_handle v) {
+        auto k = no_key;
+        for (auto h : v.outgoing_halfedges())
+            k = std::min(k, h_key[h]);
+        best[v.idx.value] = k;
+    };
 
-        // update edge gens and enqueue new entries
-        for (auto const ee : v_to.edges())
+    // calls f(v) for all vertices whose 1-ring is touched by collapsing h
+    auto const for_each_neighborhood_vertex = [&](pm::halfedge_handle h, auto&& f) {
+        f(h.vertex_from().idx);
+        for (auto v : h.vertex_from().adjacent_vertices())
+            f(v.idx);
+        for (auto v : h.vertex_to().adjacent_vertices())
+            f(v.idx);
+    };
+
+    // initial scores
+    m.halfedges().parallel_for_each(score, exec);
+    m.vertices().parallel_for_each(update_best, exec);
+
+    // NOTE: the globally best candidate is always independent, thus every round either collapses or rejects (and drops) candidates
+    auto const fraction = std::clamp(batch_fraction, 0.f, 1.f);
+    auto const max_passes = 4;
+    auto stop = false;
+    while (!stop)
+    {
+        ++stats.rounds;
+
+        // best candidates
+        candidates.clear();
+        for (auto v : m.vertices())
+            if (best[v.idx.value] != no_key)
+                candidates.push_back(halfedge_index(index_value_t(uint32_t(best[v.idx.value]))));
+
+        if (candidates.empty())
+            break;
+
+        auto const batch_size = std::max(index_value_t(1), index_value_t(double(candidates.size()) * fraction));
+        if (batch_size < index_value_t(candidates.size()))
+        {
+            std::nth_element(candidates.begin(), candidates.begin() + batch_size, candidates.end(),
+                             [&](halfedge_index a, halfedge_index b) { return h_key[a] < h_key[b]; });
+            candidates.resize(batch_size);
+        }
+
+        // select a maximal set of valid collapses with disjoint neighborhoods
+        // each pass: claim neighborhoods (smallest key wins), validate winners, lock their neighborhoods, drop blocked candidates
+        selected.clear();
+        dirty_vertices.clear();
+        for (auto pass = 0; pass < max_passes && !candidates.empty(); ++pass)
         {
-            edge_gen[ee.halfedgeA()]++;
-            edge_gen[ee.halfedgeB()]++;
-            enqueue(ee.halfedgeA());
-            enqueue(ee.halfedgeB());
+            auto const cnt = index_value_t(candidates.size());
+
+            detail::parallel_for(exec, cnt, [&](index_value_t i) {
+                auto const h = m[candidates[i]];
+                auto const k = h_key[h];
+                for_each_neighborhood_vertex(h, [&](vertex_index v) {
+                    auto& c = claims[v.value];
+                    auto curr = c.load(std::memory_order_relaxed);
+                    while (k < curr && !c.compare_exchange_weak(curr, k, std::memory_order_relaxed))
+                    {
+                    }
+                });
+            });
+
+            // 0: lost, 1: valid winner, 2: rejected winner
+            state.assign(cnt, 0);
+            detail::parallel_chunks(exec, cnt, [&](int, index_value_t begin, index_value_t end) {
+                std::vector<vertex_index> reached;
+                for (auto i = begin; i < end; ++i)
+                {
+                    auto const h = m[candidates[i]];
+                    auto const k = h_key[h];
+                    auto is_winner = true;
+                    for_each_neighborhood_vertex(h, [&](vertex_index v) { is_winner &= claims[v.value].load(std::memory_order_relaxed) == k; });
+
+                    if (is_winner)
+                        state[i] = detail::decimate_can_collapse(h, h_pos[h], pos, config.max_normal_dev, reached) ? 1 : 2;
+                }
+            });
+
+            // lock neighborhoods of valid winners (disjoint by construction) and reset claims
+            detail::parallel_for(exec, cnt, [&](index_value_t i) {
+                for_each_neighborhood_vertex(m[candidates[i]], [&](vertex_index v) {
+                    claims[v.value].store(no_key, std::memory_order_relaxed);
+                    if (state[i] == 1)
+                        locked[v.value] = stats.rounds;
+                });
+            });
+
+            // keep remaining candidates that do not touch a locked neighborhood
+            index_value_t remaining = 0;
+            for (index_value_t i = 0; i < cnt; ++i)
+            {
+                auto const h = m[candidates[i]];
+                if (state[i] == 1)
+                    selected.push_back(h);
+                else if (state[i] == 2)
+                {
+                    ++stats.rejected_collapses;
+                    h_key[h] = no_key; // re-scored once the neighborhood changes
+                    dirty_vertices.push_back(h.vertex_from());
+                }
+                else
+                {
+                    auto is_free = true;
+                    for_each_neighborhood_vertex(h, [&](vertex_index v) { is_free &= locked[v.value] != stats.rounds; });
+                    if (is_free)
+                        candidates[remaining++] = h;
+                }
+            }
+            candidates.resize(remaining);
         }
+
+        // apply in order of increasing error
+        std::sort(selected.begin(), selected.end(), [&](halfedge_index a, halfedge_index b) { return h_key[a] < h_key[b]; });
+        dirty.clear();
+        for (auto const hi : selected)
+        {
+            auto const h = m[hi];
+            if (config.should_stop(m, h_error[h]))
+            {
+                stop = true;
+                break;
+            }
+
+            auto const v_to = h.vertex_to();
+            auto const v_from = h.vertex_from();
+
+            POLYMESH_ASSERT(!h.edge().is_boundary());
+            POLYMESH_ASSERT(!v_from.is_boundary());
+            errors[v_to] = config.merge(errors[v_to], errors[v_from]);
+            pos[v_to] = h_pos[h];
+            m.halfedges().collapse(h);
+            ++stats.collapses;
+
+            for (auto const hh : v_to.outgoing_halfedges())
+            {
+                dirty.push_back(hh);
+                dirty.push_back(hh.opposite());
+                dirty_vertices.push_back(hh.vertex_to());
+            }
+            dirty_vertices.push_back(v_to);
+        }
+
+        // re-score changed halfedges and update best candidates of affected vertices
+        // (neighborhoods are disjoint, thus dirty contains no duplicates, dirty_vertices might)
+        detail::parallel_for(exec, index_value_t(dirty.size()), [&](index_value_t i) { score(m[dirty[i]]); });
+
+        std::sort(dirty_vertices.begin(), dirty_vertices.end());
+        dirty_vertices.erase(std::unique(dirty_vertices.begin(), dirty_vertices.end()), dirty_vertices.end());
+        detail::parallel_for(exec, index_value_t(dirty_vertices.size()), [&](index_value_t i) { update_best(m[dirty_vertices[i]]); });
     }
+
+    if (auto const out_stats = detail::decimate_stats_of(config, 0))
+        *out_stats = stats;
 }
 }
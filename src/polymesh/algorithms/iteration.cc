@@ -0,0 +1,131 @@
+#include "iteration.hh"
+
+using namespace polymesh;
+
+namespace
+{
+/// turns offsets[i + 1] = count(i) into offsets[i] = sum of count(j) for j < i (offsets[0] must be 0)
+/// uses a parallel prefix sum over chunks
+void scan_counts(executor const& exec, std::vector<index_value_t>& offsets)
+{
+    auto const size = index_value_t(offsets.size()) - 1;
+    auto const chunk_cnt = detail::chunk_count(exec, size);
+
+    std::vector<index_value_t> chunk_offsets(chunk_cnt + 1, 0);
+    detail::parallel_chunks(exec, size, [&](int chunk, index_value_t begin, index_value_t end) {
+        index_value_t sum = 0;
+        for (auto i = begin; i < end; ++i)
+            sum += offsets[i + 1];
+        chunk_offsets[chunk + 1] = sum;
+    });
+
+    for (auto i = 0; i < chunk_cnt; ++i)
+        chunk_offsets[i + 1] += chunk_offsets[i];
+
+    detail::parallel_chunks(exec, size, [&](int chunk, index_value_t begin, index_value_t end) {
+        auto sum = chunk_offsets[chunk];
+        for (auto i = begin; i < end; ++i)
+        {
+            sum += offsets[i + 1];
+            offsets[i + 1] = sum;
+        }
+    });
+}
+}
+
+adjacency_snapshot::adjacency_snapshot(Mesh const& m, executor const& exec) : mMesh(&m), mVersion(m.topology_version())
+{
+    auto const ll = low_level_api(m);
+    auto const v_cnt = m.all_vertices().size();
+    auto const f_cnt = m.all_faces().size();
+
+    // count
+    mVertexOffsets.resize(v_cnt + 1);
+    mVertexFaceOffsets.resize(v_cnt + 1);
+    mFaceOffsets.resize(f_cnt + 1);
+    mVertexOffsets[0] = 0;
+    mVertexFaceOffsets[0] = 0;
+    mFaceOffsets[0] = 0;
+
+    detail::parallel_for(exec, v_cnt, [&](index_value_t i) {
+        auto const v = vertex_index(i);
+        auto cnt = 0;
+        auto f_cnt = 0;
+        if (!ll.is_removed(v) && !ll.is_isolated(v))
+        {
+            auto const h_begin = ll.outgoing_halfedge_of(v);
+            auto h = h_begin;
+            do
+            {
+                ++cnt;
+                if (ll.face_of(h).is_valid())
+                    ++f_cnt;
+                h = ll.opposite(ll.prev_halfedge_of(h));
+            } while (h != h_begin);
+        }
+        mVertexOffsets[i + 1] = cnt;
+        mVertexFaceOffsets[i + 1] = f_cnt;
+    });
+
+    detail::parallel_for(exec, f_cnt, [&](index_value_t i) {
+        auto const f = face_index(i);
+        auto cnt = 0;
+        if (!ll.is_removed(f))
+        {
+            auto const h_begin = ll.halfedge_of(f);
+            auto h = h_begin;
+            do
+            {
+                ++cnt;
+                h = ll.next_halfedge_of(h);
+            } while (h != h_begin);
+        }
+        mFaceOffsets[i + 1] = cnt;
+    });
+
+    scan_counts(exec, mVertexOffsets);
+    scan_counts(exec, mVertexFaceOffsets);
+    scan_counts(exec, mFaceOffsets);
+
+    // fill
+    mVertexVertices.resize(mVertexOffsets.back());
+    mVertexHalfedges.resize(mVertexOffsets.back());
+    mVertexFaces.resize(mVertexFaceOffsets.back());
+    mFaceVertices.resize(mFaceOffsets.back());
+
+    detail::parallel_for(exec, v_cnt, [&](index_value_t i) {
+        auto const v = vertex_index(i);
+        if (mVertexOffsets[i] == mVertexOffsets[i + 1])
+            return;
+
+        auto idx = mVertexOffsets[i];
+        auto f_idx = mVertexFaceOffsets[i];
+        auto const h_begin = ll.outgoing_halfedge_of(v);
+        auto h = h_begin;
+        do
+        {
+            mVertexVertices[idx] = ll.to_vertex_of(h);
+            mVertexHalfedges[idx] = h;
+            ++idx;
+            auto const f = ll.face_of(h);
+            if (f.is_valid())
+                mVertexFaces[f_idx++] = f;
+            h = ll.opposite(ll.prev_halfedge_of(h));
+        } while (h != h_begin);
+    });
+
+    detail::parallel_for(exec, f_cnt, [&](index_value_t i) {
+        auto const f = face_index(i);
+        if (mFaceOffsets[i] == mFaceOffsets[i + 1])
+            return;
+
+        auto idx = mFaceOffsets[i];
+        auto const h_begin = ll.halfedge_of(f);
+        auto h = h_begin;
+        do
+        {
+            mFaceVertices[idx++] = ll.to_vertex_of(h);
+            h = ll.next_halfedge_of(h);
+        } while (h != h_begin);
+    });
+}
@@ -1,9 +1,117 @@
 #pragma once
 
+#include <cstdint>
+#include <vector>
+
 #include <polymesh/Mesh.hh>
+#include <polymesh/parallel.hh>
+#include <polymesh/span.hh>
 
 // precomputed iterators for higher performance
 
 namespace polymesh
 {
+/**
+ * Immutable snapshot of the mesh adjacency in compressed sparse row (CSR) format
+ *
+ * Stores per vertex: adjacent vertices, outgoing halfedges, and (valid) adjacent faces
+ * and per face: its vertices
+ * as offset + index arrays, so neighbor access is a contiguous span instead of a halfedge walk.
+ * Intended for read-heavy loops (Laplacians, diffusion, geodesics, ...) on a fixed topology.
+ *
+ * Orders are the same as for the circulators, i.e.
+ *   snap.adjacent_vertices(v) == v.adjacent_vertices()
+ *   snap.outgoing_halfedges(v) == v.outgoing_halfedges()
+ *   snap.faces(v) == v.faces()
+ *   snap.vertices(f) == f.vertices()
+ * Removed primitives have no neighbors.
+ *
+ * The snapshot stores the mesh topology_version() and asserts that it did not change on each access
+ * (i.e. use after topological changes is detected in builds with assertions)
+ *
+ * Usage:
+ *
+ *   auto snap = pm::adjacency_snapshot(m);
+ *   for (auto v : m.vertices())
+ *   {
+ *       auto sum = pos[v] * 0;
+ *       for (auto vv : snap.adjacent_vertices(v))
+ *           sum += pos[vv];
+ *       new_pos[v] = sum / snap.valence(v);
+ *   }
+ */
+class adjacency_snapshot
+{
+public:
+    adjacency_snapshot() = default;
+    /// builds the snapshot (in parallel if the executor allows it)
+    explicit adjacency_snapshot(Mesh const& m, executor const& exec = executor::default_pool());
+
+    /// neighboring vertices of v
+    span<vertex_index const> adjacent_vertices(vertex_index v) const
+    {
+        assert_current();
+        return {mVertexVertices.data() + mVertexOffsets[v.value], mVertexVertices.data() + mVertexOffsets[v.value + 1]};
+    }
+    /// outgoing halfedges of v (same order as adjacent_vertices)
+    span<halfedge_index const> outgoing_halfedges(vertex_index v) const
+    {
+        assert_current();
+        return {mVertexHalfedges.data() + mVertexOffsets[v.value], mVertexHalfedges.data() + mVertexOffsets[v.value + 1]};
+    }
+    /// valid faces adjacent to v
+    span<face_index const> faces(vertex_index v) const
+    {
+        assert_current();
+        return {mVertexFaces.data() + mVertexFaceOffsets[v.value], mVertexFaces.data() + mVertexFaceOffsets[v.value + 1]};
+    }
+    /// vertices of f
+    span<vertex_index const> vertices(face_index f) const
+    {
+        assert_current();
+        return {mFaceVertices.data() + mFaceOffsets[f.value], mFaceVertices.data() + mFaceOffsets[f.value + 1]};
+    }
+
+    /// number of adjacent vertices
+    int valence(vertex_index v) const
+    {
+        assert_current();
+        return int(mVertexOffsets[v.value + 1] - mVertexOffsets[v.value]);
+    }
+    /// number of vertices of f
+    int size(face_index f) const
+    {
+        assert_current();
+        return int(mFaceOffsets[f.value + 1] - mFaceOffsets[f.value]);
+    }
+
+    /// raw CSR arrays (offsets have all_vertices().size() + 1 or all_faces().size() + 1 entries)
+    span<index_value_t const> vertex_offsets() const { return mVertexOffsets; }
+    span<vertex_index const> vertex_vertices() const { return mVertexVertices; }
+    span<halfedge_index const> vertex_halfedges() const { return mVertexHalfedges; }
+    span<index_value_t const> vertex_face_offsets() const { return mVertexFaceOffsets; }
+    span<face_index const> vertex_faces() const { return mVertexFaces; }
+    span<index_value_t const> face_offsets() const { return mFaceOffsets; }
+    span<vertex_index const> face_vertices() const { return mFaceVertices; }
+
+    /// true iff the topology of the mesh did not change since the snapshot was taken
+    bool is_current() const { return mMesh != nullptr && mMesh->topology_version() == mVersion; }
+    /// topology_version() of the mesh when the snapshot was taken
+    uint64_t version() const { return mVersion; }
+    Mesh const& mesh() const { return *mMesh; }
+
+private:
+    void assert_current() const { POLYMESH_ASSERT(is_current() && "mesh topology changed since the snapshot was taken (or snapshot is empty)"); }
+
+    Mesh const* mMesh = nullptr;
+    uint64_t mVersion = 0;
+
+    std::vector<index_value_t> mVertexOffsets; ///< shared by mVertexVertices and mVertexHalfedges
+    std::vector<vertex_index> mVertexVertices;
+    std::vector<halfedge_index> mVertexHalfedges;
+    std::vector<index_value_t> mVertexFaceOffsets;
+    std::vector<face_index> mVertexFaces;
+    std::vector<index_value_t> mFaceOffsets;
+    std::vector<vertex_index> mFaceVertices;
+};
 }
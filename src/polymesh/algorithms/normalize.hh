@@ -38,12 +38,11 @@ auto normalize(vertex_attribute<Pos3>& pos)
     auto s = std::max(sx, std::max(sy, sz)) * ScalarT(0.5);
     s = std::max(s, std::numeric_limits<ScalarT>::min());
     auto s_inv = 1 / s;
-    for (auto& p : pos)
-    {
+    pos.mesh().all_vertices().for_each_index(pos, [=](Pos3& p) {
         p[0] = (p[0] - cx) * s_inv;
         p[1] = (p[1] - cy) * s_inv;
         p[2] = (p[2] - cz) * s_inv;
-    }
+    });
     return normalize_result<ScalarT>{s, cx, cy, cz};
 }
 } // namespace polymesh
@@ -0,0 +1,252 @@
+#include "vertex_clustering.hh"
+
+#include <algorithm>
+#include <atomic>
+
+#include "operations.hh"
+
+using namespace polymesh;
+
+namespace
+{
+uint64_t mix_bits(uint64_t x)
+{
+    // splitmix64 finalizer
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ull;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebull;
+    x ^= x >> 31;
+    return x;
+}
+
+index_value_t hash_capacity_for(index_value_t size)
+{
+    index_value_t capacity = 64;
+    while (capacity < 2 * size)
+        capacity *= 2;
+    return capacity;
+}
+}
+
+detail::vertex_clusters detail::cluster_by_cell(Mesh const& m, span<uint64_t const> cell_keys, executor const& exec)
+{
+    auto constexpr empty_key = ~uint64_t(0); // cell keys have 63 bit
+
+    auto const ll = low_level_api(m);
+    auto const v_cnt = m.all_vertices().size();
+    POLYMESH_ASSERT(index_value_t(cell_keys.size()) == v_cnt);
+
+    // concurrent hash table (open addressing, linear probing) from cell key to the smallest vertex index in the cell
+    auto const capacity = hash_capacity_for(m.vertices().size());
+    auto const mask = uint64_t(capacity - 1);
+    std::vector<std::atomic<uint64_t>> slot_keys(capacity);
+    std::vector<std::atomic<index_value_t>> slot_reps(capacity);
+    detail::parallel_for(exec, capacity, [&](index_value_t s) {
+        slot_keys[s].store(empty_key, std::memory_order_relaxed);
+        slot_reps[s].store(v_cnt, std::memory_order_relaxed);
+    });
+
+    std::vector<index_value_t> slot_of(v_cnt, -1);
+    detail::parallel_for(exec, v_cnt, [&](index_value_t v) {
+        if (ll.is_removed(vertex_index(v)))
+            return;
+
+        auto const key = cell_keys[v];
+        auto s = mix_bits(key) & mask;
+        while (true)
+        {
+            auto k = slot_keys[s].load(std::memory_order_relaxed);
+            if (k == empty_key && slot_keys[s].compare_exchange_strong(k, key, std::memory_order_relaxed))
+                break;
+            if (k == key)
+                break;
+            s = (s + 1) & mask;
+        }
+
+        auto& rep = slot_reps[s];
+        auto curr = rep.load(std::memory_order_relaxed);
+        while (v < curr && !rep.compare_exchange_weak(curr, v, std::memory_order_relaxed))
+        {
+        }
+        slot_of[v] = index_value_t(s);
+    });
+
+    // cluster indices in order of their representatives
+    // (representative <= v, thus it is always assigned first)
+    vertex_clusters clusters;
+    clusters.cluster_of.resize(v_cnt, -1);
+    clusters.offsets.push_back(0);
+    for (index_value_t v = 0; v < v_cnt; ++v)
+    {
+        if (slot_of[v] < 0)
+            continue;
+
+        auto const rep = slot_reps[slot_of[v]].load(std::memory_order_relaxed);
+        if (rep == v)
+        {
+            clusters.cluster_of[v] = clusters.size();
+            clusters.offsets.push_back(0);
+        }
+        else
+            clusters.cluster_of[v] = clusters.cluster_of[rep];
+
+        ++clusters.offsets[clusters.cluster_of[v] + 1];
+    }
+
+    // members via counting sort (stable, thus sorted by index)
+    auto const c_cnt = clusters.size();
+    for (index_value_t c = 0; c < c_cnt; ++c)
+        clusters.offsets[c + 1] += clusters.offsets[c];
+
+    clusters.members.resize(clusters.offsets.back());
+    std::vector<index_value_t> fill(clusters.offsets.begin(), clusters.offsets.end() - 1);
+    for (index_value_t v = 0; v < v_cnt; ++v)
+        if (clusters.cluster_of[v] >= 0)
+            clusters.members[fill[clusters.cluster_of[v]]++] = v;
+
+    return clusters;
+}
+
+index_value_t detail::rebuild_clustered_mesh(Mesh& m, vertex_clusters const& clusters, executor const& exec)
+{
+    auto const ll = low_level_api(m);
+    auto const f_cnt = m.all_faces().size();
+    auto const c_cnt = clusters.size();
+    auto const rep_of = [&](vertex_index v) { return clusters.representative(clusters.cluster_of[v.value]); };
+
+    // remapped faces (with consecutive duplicates merged)
+    std::vector<index_value_t> offsets(f_cnt + 1, 0);
+    detail::parallel_for(exec, f_cnt, [&](index_value_t f) {
+        if (ll.is_removed(face_index(f)))
+            return;
+
+        auto cnt = 0;
+        auto const h_begin = ll.halfedge_of(face_index(f));
+        auto h = h_begin;
+        do
+        {
+            ++cnt;
+            h = ll.next_halfedge_of(h);
+        } while (h != h_begin);
+        offsets[f + 1] = cnt;
+    });
+    for (index_value_t f = 0; f < f_cnt; ++f)
+        offsets[f + 1] += offsets[f];
+
+    std::vector<index_value_t> indices(offsets.back());
+    std::vector<int> sizes(f_cnt, 0); // 0 for degenerated faces
+    std::vector<uint64_t> hashes(f_cnt, 0);
+    detail::parallel_for(exec, f_cnt, [&](index_value_t f) {
+        if (offsets[f] == offsets[f + 1])
+            return;
+
+        auto const is = indices.data() + offsets[f];
+        auto cnt = 0;
+        auto const h_begin = ll.halfedge_of(face_index(f));
+        auto h = h_begin;
+        do
+        {
+            auto const r = rep_of(ll.to_vertex_of(h));
+            if (cnt == 0 || is[cnt - 1] != r)
+                is[cnt++] = r;
+            h = ll.next_halfedge_of(h);
+        } while (h != h_begin);
+
+        while (cnt > 1 && is[0] == is[cnt - 1])
+            --cnt;
+
+        if (cnt < 3)
+            return;
+
+        // order-independent hash (duplicates might be rotated or flipped)
+        auto hash = uint64_t(cnt);
+        for (index_value_t i = 0; i < cnt; ++i)
+            hash += mix_bits(uint64_t(is[i]));
+
+        sizes[f] = cnt;
+        hashes[f] = hash;
+    });
+
+    // drop duplicated faces (first one is kept)
+    auto const same_vertices = [&](index_value_t fa, index_value_t fb) {
+        auto const cnt = sizes[fa];
+        if (sizes[fb] != cnt)
+            return false;
+
+        std::vector<index_value_t> a(indices.begin() + offsets[fa], indices.begin() + offsets[fa] + cnt);
+        std::vector<index_value_t> b(indices.begin() + offsets[fb], indices.begin() + offsets[fb] + cnt);
+        std::sort(a.begin(), a.end());
+        std::sort(b.begin(), b.end());
+        return a == b;
+    };
+
+    index_value_t kept_cnt = 0;
+    for (index_value_t f = 0; f < f_cnt; ++f)
+        if (sizes[f] > 0)
+            ++kept_cnt;
+
+    auto const capacity = hash_capacity_for(kept_cnt);
+    auto const mask = uint64_t(capacity - 1);
+    std::vector<index_value_t> slots(capacity, -1);
+    std::vector<int> face_sizes;
+    std::vector<index_value_t> face_indices;
+    face_sizes.reserve(kept_cnt);
+    face_indices.reserve(offsets.back());
+    for (index_value_t f = 0; f < f_cnt; ++f)
+    {
+        if (sizes[f] == 0)
+            continue;
+
+        auto s = mix_bits(hashes[f]) & mask;
+        auto is_duplicate = false;
+        while (slots[s] >= 0)
+        {
+            auto const ff = slots[s];
+            if (hashes[ff] == hashes[f] && same_vertices(ff, f))
+            {
+                is_duplicate = true;
+                break;
+            }
+            s = (s + 1) & mask;
+        }
+
+        if (is_duplicate)
+            continue;
+
+        slots[s] = f;
+        face_sizes.push_back(sizes[f]);
+        face_indices.insert(face_indices.end(), indices.begin() + offsets[f], indices.begin() + offsets[f] + sizes[f]);
+    }
+
+    // clusters that had faces before (their representative is removed if it loses all of them)
+    std::vector<char> had_faces(c_cnt, false);
+    detail::parallel_for(exec, c_cnt, [&](index_value_t c) {
+        for (auto i = clusters.offsets[c]; i < clusters.offsets[c + 1]; ++i)
+            if (!ll.is_isolated(vertex_index(clusters.members[i])))
+            {
+                had_faces[c] = true;
+                break;
+            }
+    });
+
+    // rebuild
+    remove_edges_and_faces(m);
+    ll.clear_removed_edge_vector();
+    ll.clear_removed_face_vector();
+    m.build_from_polygons(face_sizes, face_indices);
+
+    // remove merged vertices
+    index_value_t removed = 0;
+    for (auto v : m.vertices())
+    {
+        auto const c = clusters.cluster_of[v.idx.value];
+        if (clusters.representative(c) != v.idx.value || (had_faces[c] && v.is_isolated()))
+        {
+            m.vertices().remove(v);
+            ++removed;
+        }
+    }
+
+    return removed;
+}
@@ -0,0 +1,178 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include <polymesh/Mesh.hh>
+#include <polymesh/detail/bounds.hh>
+#include <polymesh/fields.hh>
+#include <polymesh/parallel.hh>
+#include <polymesh/span.hh>
+
+namespace polymesh
+{
+/**
+ * Vertex clustering simplification (Rossignac-Borrel) on a uniform grid
+ *
+ * All vertices within the same cube of side length cell_size are merged into a single vertex.
+ * Runs in O(n) (cells are found via a concurrent hash table, faces are rebuilt in bulk)
+ * and is meant as a fast first reduction of very large meshes (e.g. before decimate).
+ *
+ * The representative of each cell is its vertex with the smallest index, it keeps all its vertex attributes.
+ * Its position is
+ *   - the mean of all cell vertices (first overload)
+ *   - the error-minimizing position of the summed errors, i.e. closest_point(sum of errors) (second overload)
+ *     (falls back to the mean if the minimizer lies outside the cell, errors of the representative become the sum)
+ *     ErrorF has the same requirements as for decimate (ErrorF + ErrorF, closest_point(ErrorF))
+ *
+ * Faces are remapped to the representatives, faces that become degenerated or duplicated are dropped,
+ * as are faces that would make the mesh non-manifold.
+ * All other vertices are removed (as well as representatives that lost all their faces).
+ *
+ * Returns the number of removed vertices.
+ *
+ * Example usage:
+ *     Mesh m;
+ *     vertex_attribute<tg::pos3> pos;
+ *     load(file, m, pos);
+ *     cluster_vertices(m, pos, 0.01f);
+ *     m.compactify();
+ *
+ * NOTE: results are deterministic (independent of the executor)
+ * NOTE: at most 2^21 cells per axis are supported, coarser cells are used otherwise
+ * NOTE: preserves vertex attributes of representatives ONLY!
+ *       face/edge/halfedge attributes are UNDEFINED (faces are re-created in their original order though)
+ */
+template <class Pos3>
+index_value_t cluster_vertices(Mesh& m, vertex_attribute<Pos3>& pos, scalar_of<Pos3> cell_size, executor const& exec = executor::default_pool());
+template <class Pos3, class ErrorF>
+index_value_t cluster_vertices(Mesh& m,
+                               vertex_attribute<Pos3>& pos,
+                               vertex_attribute<ErrorF>& errors,
+                               scalar_of<Pos3> cell_size,
+                               executor const& exec = executor::default_pool());
+
+// ======================== IMPLEMENTATION ========================
+
+namespace detail
+{
+/// vertices grouped by grid cell
+struct vertex_clusters
+{
+    std::vector<index_value_t> cluster_of; ///< per vertex (including removed ones, -1 for those)
+    std::vector<index_value_t> offsets;    ///< cluster c consists of members[offsets[c] .. offsets[c + 1])
+    std::vector<index_value_t> members;    ///< sorted by index per cluster, i.e. the first one is the representative
+
+    index_value_t size() const { return index_value_t(offsets.size()) - 1; }
+    index_value_t representative(index_value_t c) const { return members[offsets[c]]; }
+};
+
+/// packs the (clamped) cell coordinates into a 63 bit key
+inline uint64_t cluster_cell_key(int64_t x, int64_t y, int64_t z)
+{
+    auto constexpr max_coord = (int64_t(1) << 21) - 1;
+    auto const clamp = [](int64_t c) { return uint64_t(c < 0 ? 0 : c > max_coord ? max_coord : c); };
+    return clamp(x) | clamp(y) << 21 | clamp(z) << 42;
+}
+
+/// groups all valid vertices by their cell key (cell_keys is indexed by vertex index)
+vertex_clusters cluster_by_cell(Mesh const& m, span<uint64_t const> cell_keys, executor const& exec);
+
+/// replaces all vertices by their cluster representatives and rebuilds the faces
+/// returns the number of removed vertices
+index_value_t rebuild_clustered_mesh(Mesh& m, vertex_clusters const& clusters, executor const& exec);
+
+/// computes cell keys and clusters, sets positions via set_pos(clusters, c, p_min, cell_size), and rebuilds the mesh
+template <class Pos3, class SetPosF>
+index_value_t cluster_vertices_impl(Mesh& m, vertex_attribute<Pos3> const& pos, scalar_of<Pos3> cell_size, executor const& exec, SetPosF&& set_pos)
+{
+    using scalar_t = scalar_of<Pos3>;
+
+    POLYMESH_ASSERT(cell_size > 0 && "cell size must be positive");
+    if (m.vertices().empty())
+        return 0;
+
+    auto const v_cnt = m.all_vertices().size();
+    auto const bb = detail::vertex_bounds<scalar_t>(m, pos, exec);
+    auto const p_min = field3<Pos3>::make_pos(bb[0], bb[1], bb[2]);
+
+    // keep within 2^21 cells per axis
+    auto const max_extent = std::max(bb[3] - bb[0], std::max(bb[4] - bb[1], bb[5] - bb[2]));
+    cell_size = std::max(cell_size, max_extent / scalar_t((1 << 21) - 1));
+
+    auto const inv_size = 1 / cell_size;
+    std::vector<uint64_t> cell_keys(v_cnt);
+    m.vertices().parallel_for_each(
+        [&](vertex_handle v) {
+            auto const& p = pos[v];
+            cell_keys[v.idx.value] = cluster_cell_key(int64_t(std::floor((p[0] - bb[0]) * inv_size)), //
+                                                      int64_t(std::floor((p[1] - bb[1]) * inv_size)), //
+                                                      int64_t(std::floor((p[2] - bb[2]) * inv_size)));
+        },
+        exec);
+
+    auto const clusters = cluster_by_cell(m, cell_keys, exec);
+
+    detail::parallel_for(exec, clusters.size(), [&](index_value_t c) { set_pos(clusters, c, p_min, cell_size); });
+
+    return rebuild_clustered_mesh(m, clusters, exec);
+}
+
+/// mean position of all members of cluster c
+template <class Pos3>
+Pos3 cluster_mean(vertex_attribute<Pos3> const& pos, vertex_clusters const& clusters, index_value_t c)
+{
+    using scalar_t = scalar_of<Pos3>;
+
+    scalar_t x = 0, y = 0, z = 0;
+    for (auto i = clusters.offsets[c]; i < clusters.offsets[c + 1]; ++i)
+    {
+        auto const& p = pos[vertex_index(clusters.members[i])];
+        x += p[0];
+        y += p[1];
+        z += p[2];
+    }
+    auto const s = 1 / scalar_t(clusters.offsets[c + 1] - clusters.offsets[c]);
+    return field3<Pos3>::make_pos(x * s, y * s, z * s);
+}
+}
+
+template <class Pos3>
+index_value_t cluster_vertices(Mesh& m, vertex_attribute<Pos3>& pos, scalar_of<Pos3> cell_size, executor const& exec)
+{
+    return detail::cluster_vertices_impl(m, pos, cell_size, exec, [&](detail::vertex_clusters const& clusters, index_value_t c, Pos3 const&, scalar_of<Pos3>) {
+        // representative is never read by other clusters
+        pos[vertex_index(clusters.representative(c))] = detail::cluster_mean(pos, clusters, c);
+    });
+}
+
+template <class Pos3, class ErrorF>
+index_value_t cluster_vertices(Mesh& m, vertex_attribute<Pos3>& pos, vertex_attribute<ErrorF>& errors, scalar_of<Pos3> cell_size, executor const& exec)
+{
+    return detail::cluster_vertices_impl(m, pos, cell_size, exec, [&](detail::vertex_clusters const& clusters, index_value_t c, Pos3 const& p_min, scalar_of<Pos3> size) {
+        auto const rep = vertex_index(clusters.representative(c));
+        auto const begin = clusters.offsets[c];
+        auto const end = clusters.offsets[c + 1];
+
+        auto Q = errors[rep];
+        for (auto i = begin + 1; i < end; ++i)
+            Q = Q + errors[vertex_index(clusters.members[i])];
+
+        // cell of the representative (slightly enlarged)
+        auto p = closest_point(Q);
+        auto inside = true;
+        for (auto d = 0; d < 3; ++d)
+        {
+            auto const lo = p_min[d] + std::floor((pos[rep][d] - p_min[d]) / size) * size;
+            auto const eps = size * scalar_of<Pos3>(0.01);
+            if (!(lo - eps <= p[d] && p[d] <= lo + size + eps)) // also catches NaN
+                inside = false;
+        }
+
+        pos[rep] = inside ? p : detail::cluster_mean(pos, clusters, c);
+        errors[rep] = Q;
+    });
+}
+}
@@ -2,19 +2,31 @@
 
 #include <algorithm>
 #include <cstddef>
+#include <type_traits>
 #include <vector>
 
 #include "assert.hh"
+#include "fwd.hh"
 
 // Helper for mesh-based attribute bookkeeping
 
 namespace polymesh
 {
 class Mesh;
+class executor;
+class memory_resource;
+struct permute_scratch;
 
 template <class MeshT>
 struct low_level_api_base;
 
+namespace detail
+{
+/// attribute data that can be sub-allocated from an attribute pool (see detail/attribute_pool.hh)
+template <class T>
+constexpr bool is_poolable_attribute = std::is_trivially_copyable_v<T> && alignof(T) <= 64;
+}
+
 template <class tag>
 struct primitive_attribute_base
 {
@@ -29,10 +41,11 @@ private:
 protected:
     primitive_attribute_base() = default;
     primitive_attribute_base(Mesh const* mesh) : mMesh(mesh) {} // no registration, it's too early!
-    virtual void resize_from(int old_size) = 0;
+    virtual void resize_from(index_value_t old_size) = 0;
     virtual void clear_with_default() = 0;
-    virtual void apply_remapping(std::vector<int> const& map) = 0;
-    virtual void apply_transpositions(std::vector<std::pair<int, int>> const& ts) = 0;
+    virtual void apply_remapping(std::vector<index_value_t> const& map) = 0;
+    /// data_new[i] = data_old[new_to_old[i]] (a permutation of all elements, see detail/permutation.hh)
+    virtual void apply_gather(std::vector<index_value_t> const& new_to_old, permute_scratch& scratch, executor const& exec) = 0;
     virtual size_t byte_size() const = 0;
     virtual size_t allocated_byte_size() const = 0;
 
@@ -41,6 +54,9 @@ protected:
     void register_attr();
     void deregister_attr();
 
+    /// the resource for the attribute data (pooled if enabled and poolable, see smart_collection::enable_attribute_pool)
+    memory_resource* data_resource(bool poolable) const;
+
     friend class Mesh;
 
     template <class MeshT>
@@ -60,5 +76,11 @@ public:
         POLYMESH_ASSERT(mMesh && "not attached to a mesh");
         return *mMesh;
     }
+
+    /// raw bytes of all elements (including removed ones), raw_stride() bytes per element
+    /// returns nullptr if the data cannot be copied bytewise (i.e. is not trivially copyable)
+    /// (used for binary serialization, see formats/pm.hh)
+    virtual std::byte const* raw_data_ptr() const { return nullptr; }
+    virtual size_t raw_stride() const { return 0; }
 };
 } // namespace polymesh
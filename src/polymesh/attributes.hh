@@ -1,10 +1,12 @@
 #pragma once
 
 #include <cstddef>
+#include <type_traits>
 #include <vector>
 
 #include <polymesh/attribute_base.hh>
 #include <polymesh/cursors.hh>
+#include <polymesh/detail/permutation.hh>
 #include <polymesh/detail/unique_array.hh>
 #include <polymesh/ranges.hh>
 #include <polymesh/span.hh>
@@ -72,11 +74,20 @@ public:
     AttrT* data() { return mData.get(); }
     AttrT const* data() const { return mData.get(); }
 
-    int size() const;
-    int capacity() const;
+    index_value_t size() const;
+    index_value_t capacity() const;
     size_t byte_size() const override { return size() * sizeof(AttrT); }
     size_t allocated_byte_size() const override { return capacity() * sizeof(AttrT); }
 
+    std::byte const* raw_data_ptr() const override
+    {
+        if constexpr (std::is_trivially_copyable_v<AttrT>)
+            return reinterpret_cast<std::byte const*>(mData.get());
+        else
+            return nullptr;
+    }
+    size_t raw_stride() const override { return std::is_trivially_copyable_v<AttrT> ? sizeof(AttrT) : 0; }
+
     attribute_iterator<primitive_attribute> begin() { return {0, size(), *this}; }
     attribute_iterator<primitive_attribute const&> begin() const { return {0, size(), *this}; }
     end_iterator end() const { return {}; }
@@ -107,6 +118,9 @@ public:
     /// sets each attribute to f(primitive)
     template <class FuncT>
     void compute(FuncT&& f);
+    /// same as compute(f) but f is called in parallel (see smart_collection::parallel_for_each)
+    template <class FuncT>
+    void parallel_compute(FuncT&& f, executor const& exec = executor::default_pool());
 
     template <class FuncT>
     auto view(FuncT&& f) & -> attribute_view<primitive_attribute<tag, AttrT>&, FuncT>;
@@ -125,7 +139,7 @@ public:
     /// copies as much data as possible from the given range of data
     void copy_from(span<AttrT const> data);
     /// copies as much data as possible from the given array
-    void copy_from(AttrT const* data, int cnt);
+    void copy_from(AttrT const* data, index_value_t cnt);
     /// copies as much data as possible from the given attribute
     void copy_from(attribute<AttrT> const& data);
 
@@ -149,11 +163,11 @@ protected:
     AttrT mDefaultValue;
 
 protected:
-    void resize_from(int old_size) override;
+    void resize_from(index_value_t old_size) override;
     void clear_with_default() override;
 
-    void apply_remapping(std::vector<int> const& map) override;
-    void apply_transpositions(std::vector<std::pair<int, int>> const& ts) override;
+    void apply_remapping(std::vector<index_value_t> const& map) override;
+    void apply_gather(std::vector<index_value_t> const& new_to_old, permute_scratch& scratch, executor const& exec) override;
 
     template <class MeshT>
     friend struct low_level_attribute_api;
@@ -33,7 +33,7 @@ public:
     bool merge(index_t i, index_t j);
 
     /// returns the size of the partition of i
-    int size_of(index_t i);
+    index_value_t size_of(index_t i);
 
     /// returns the root element of the partition of i
     index_t root_of(index_t i);
@@ -42,7 +42,7 @@ public:
     void clear();
 
     /// returns the number of partitions
-    int size() const;
+    index_value_t size() const;
 
     // partition
 public:
@@ -51,7 +51,7 @@ public:
         // methods
     public:
         /// returns the size of this partition
-        int size() { return p.size_of(i); }
+        index_value_t size() { return p.size_of(i); }
         /// returns the root (representative) element of this partition
         index_t root() { return p.root_of(i); }
         /// returns true iff this index is the representative
@@ -80,8 +80,8 @@ public:
 
 private:
     attribute<index_t> parents;
-    attribute<int> sizes;
-    int partitions;
+    attribute<index_value_t> sizes;
+    index_value_t partitions;
 };
 
 // ======== IMPLEMENTATION ========
@@ -113,13 +113,13 @@ bool partitioning<tag>::merge(index_t i, index_t j)
 }
 
 template <class tag>
-int partitioning<tag>::size_of(index_t i)
+index_value_t partitioning<tag>::size_of(index_t i)
 {
     return sizes[root_of(i)];
 }
 
 template <class tag>
-int partitioning<tag>::size() const
+index_value_t partitioning<tag>::size() const
 {
     return partitions;
 }
@@ -142,7 +142,7 @@ void partitioning<tag>::clear()
     auto const& m = parents.mesh();
     auto s = parents.size();
     auto ll = low_level_api(m);
-    for (auto i = 0; i < s; ++i)
+    for (index_value_t i = 0; i < s; ++i)
     {
         auto idx = index_t(i);
         parents[idx] = idx;
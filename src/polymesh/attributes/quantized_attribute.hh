@@ -0,0 +1,383 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+#include <polymesh/Mesh.hh>
+#include <polymesh/attributes.hh>
+#include <polymesh/detail/bounds.hh>
+#include <polymesh/parallel.hh>
+#include <polymesh/span.hh>
+
+namespace polymesh
+{
+/**
+ * Quantized attributes store a compact encoding of each value and decode it on access
+ *
+ * The encoding is defined by a codec (see below), provided are:
+ *  - aabb_codec<Pos3>: 3 x 16 bit fixed point relative to a bounding box (6 instead of 12 byte, for positions)
+ *  - octahedral_codec<Vec3>: unit vectors as 2 x 16 bit octahedral coordinates (4 instead of 12 byte, for normals)
+ *  - half_codec<VecN>: each component as a 16 bit half float (4 instead of 8 byte for 2D, e.g. texture coordinates)
+ *
+ * The encoded values live in a normal attribute, thus quantized attributes are registered with the mesh
+ * and follow all of its changes (compactify, permute, clear, attribute pools, ...)
+ *
+ * Usage:
+ *
+ *   auto qpos = pm::quantize_positions(pos);  // bounding box of pos, 16 bit per coordinate
+ *   auto qn = pm::quantize_normals(normals); // normals: halfedge_attribute<tg::vec3>
+ *
+ *   tg::pos3 p = qpos[v];                     // decodes
+ *   qpos.set(v, p);                           // encodes (clamped to the bounding box)
+ *   auto view = qpos.view();                  // attribute_view that decodes on access
+ *
+ *   // bulk decode for hot loops (a block of consecutive primitives at a time, including removed ones)
+ *   tg::pos3 block[256];
+ *   qpos.decode_block(first, block);
+ *
+ *   vertex_attribute<tg::pos3> full = qpos.decode(); // full precision copy
+ *
+ * A codec is any (cheap to copy) type with
+ *   using value_t = ...;   // decoded type
+ *   using encoded_t = ...; // stored type (should be trivially copyable)
+ *   encoded_t encode(value_t const& v) const;
+ *   value_t decode(encoded_t const& e) const;
+ * encode and decode are called in tight loops over contiguous data and should be small branch-free inline functions
+ *
+ * NOTE: new primitives start with encoded_t{} (e.g. the min corner for aabb_codec, +z for octahedral_codec)
+ * NOTE: value types only need operator[] and default construction (e.g. std::array, tg, glm)
+ */
+template <class tag, class CodecT>
+struct quantized_primitive_attribute
+{
+    template <class A>
+    using attribute = typename primitive<tag>::template attribute<A>;
+    using index_t = typename primitive<tag>::index;
+    using handle_t = typename primitive<tag>::handle;
+    using tag_t = tag;
+
+    using codec_t = CodecT;
+    using value_t = typename CodecT::value_t;
+    using encoded_t = typename CodecT::encoded_t;
+
+    // data access
+public:
+    value_t operator[](index_t i) const { return mCodec.decode(mData[i]); }
+    value_t operator[](handle_t h) const { return mCodec.decode(mData[h]); }
+    value_t operator()(index_t i) const { return mCodec.decode(mData[i]); }
+    value_t operator()(handle_t h) const { return mCodec.decode(mData[h]); }
+
+    void set(index_t i, value_t const& v) { mData[i] = mCodec.encode(v); }
+    void set(handle_t h, value_t const& v) { mData[h] = mCodec.encode(v); }
+
+    /// a non-owning view that decodes on access (see attribute_view)
+    auto view() const& { return mData.view([c = mCodec](encoded_t const& e) { return c.decode(e); }); }
+    void view() const&& = delete;
+
+    /// the underlying attribute of encoded values (e.g. for serialization)
+    attribute<encoded_t> const& encoded() const { return mData; }
+    attribute<encoded_t>& encoded() { return mData; }
+    CodecT const& codec() const { return mCodec; }
+
+    Mesh const& mesh() const { return mData.mesh(); }
+    index_value_t size() const { return mData.size(); }
+    size_t byte_size() const { return mData.byte_size(); }
+    size_t allocated_byte_size() const { return mData.allocated_byte_size(); }
+
+    /// true iff this attribute is still attached to a mesh
+    /// do not use the attribute if not valid
+    bool is_valid() const { return mData.is_valid(); }
+
+    // bulk encode / decode
+public:
+    /// decodes the values of [first, first + out.size()) into out (removed primitives included)
+    void decode_block(index_value_t first, span<value_t> out) const
+    {
+        POLYMESH_ASSERT(0 <= first && first + index_value_t(out.size()) <= size() && "out of bounds");
+        auto const c = mCodec;
+        auto const in = mData.data() + first;
+        auto const o = out.data();
+        for (size_t i = 0; i < out.size(); ++i)
+            o[i] = c.decode(in[i]);
+    }
+    /// encodes in into [first, first + in.size()) (removed primitives included)
+    void encode_block(index_value_t first, span<value_t const> in)
+    {
+        POLYMESH_ASSERT(0 <= first && first + index_value_t(in.size()) <= size() && "out of bounds");
+        auto const c = mCodec;
+        auto const out = mData.data() + first;
+        auto const i_ptr = in.data();
+        for (size_t i = 0; i < in.size(); ++i)
+            out[i] = c.encode(i_ptr[i]);
+    }
+
+    /// encodes all values of src (which must belong to the same mesh)
+    void encode_from(primitive_attribute<tag, value_t> const& src, executor const& exec = executor::default_pool())
+    {
+        POLYMESH_ASSERT(&src.mesh() == &mesh() && "attribute belongs to a different mesh");
+        detail::parallel_chunks(exec, size(), [&](int, index_value_t begin, index_value_t end) {
+            encode_block(begin, span<value_t const>(src.data() + begin, size_t(end - begin)));
+        });
+    }
+    /// decodes all values into dst (which must belong to the same mesh)
+    void decode_to(primitive_attribute<tag, value_t>& dst, executor const& exec = executor::default_pool()) const
+    {
+        POLYMESH_ASSERT(&dst.mesh() == &mesh() && "attribute belongs to a different mesh");
+        detail::parallel_chunks(exec, size(), [&](int, index_value_t begin, index_value_t end) {
+            decode_block(begin, span<value_t>(dst.data() + begin, size_t(end - begin)));
+        });
+    }
+    /// returns a new full precision attribute with all decoded values
+    attribute<value_t> decode(executor const& exec = executor::default_pool()) const
+    {
+        auto a = attribute<value_t>(mesh());
+        decode_to(a, exec);
+        return a;
+    }
+
+    // methods
+public:
+    /// sets all values to the encoding of v
+    void clear(value_t const& v) { mData.clear(mCodec.encode(v)); }
+
+    /// changes the codec and re-encodes all values (e.g. a new bounding box after moving vertices)
+    void set_codec(CodecT const& codec, executor const& exec = executor::default_pool())
+    {
+        auto const old_codec = mCodec;
+        mCodec = codec;
+        auto d = mData.data();
+        detail::parallel_for(exec, size(), [&](index_value_t i) { d[i] = mCodec.encode(old_codec.decode(d[i])); });
+    }
+
+    // ctor
+public:
+    quantized_primitive_attribute() = default;
+    quantized_primitive_attribute(Mesh const& mesh, CodecT codec = CodecT()) : mData(mesh), mCodec(std::move(codec)) {}
+
+    // members
+private:
+    attribute<encoded_t> mData;
+    CodecT mCodec;
+};
+
+template <class CodecT>
+using quantized_vertex_attribute = quantized_primitive_attribute<vertex_tag, CodecT>;
+template <class CodecT>
+using quantized_face_attribute = quantized_primitive_attribute<face_tag, CodecT>;
+template <class CodecT>
+using quantized_edge_attribute = quantized_primitive_attribute<edge_tag, CodecT>;
+template <class CodecT>
+using quantized_halfedge_attribute = quantized_primitive_attribute<halfedge_tag, CodecT>;
+
+namespace detail
+{
+inline uint32_t float_bits(float f)
+{
+    uint32_t u;
+    std::memcpy(&u, &f, sizeof(f));
+    return u;
+}
+inline float bits_float(uint32_t u)
+{
+    float f;
+    std::memcpy(&f, &u, sizeof(f));
+    return f;
+}
+
+/// IEEE binary16 with round-to-nearest-even, overflow to inf, nan stays nan, subnormals are supported
+inline uint16_t float_to_half(float f)
+{
+    auto x = float_bits(f);
+    auto const sign = x & 0x80000000u;
+    x ^= sign;
+
+    uint32_t h;
+    if (x >= (127u + 16) << 23) // inf, nan, or too large
+        h = x > 255u << 23 ? 0x7e00 : 0x7c00;
+    else if (x < 113u << 23) // subnormal or zero: let the fpu round into the mantissa
+        h = float_bits(bits_float(x) + 0.5f) - float_bits(0.5f);
+    else
+    {
+        auto const mant_odd = (x >> 13) & 1;
+        x += ((15u - 127) << 23) + 0xfff + mant_odd;
+        h = x >> 13;
+    }
+    return uint16_t(h | (sign >> 16));
+}
+
+inline float half_to_float(uint16_t h)
+{
+    auto const exp_mask = 0x7c00u << 13;
+    auto o = uint32_t(h & 0x7fff) << 13;
+    auto const exp = o & exp_mask;
+    o += (127u - 15) << 23;
+
+    if (exp == exp_mask) // inf or nan
+        o += (128u - 16) << 23;
+    else if (exp == 0) // subnormal or zero: renormalize via the fpu
+        o = float_bits(bits_float(o + (1u << 23)) - bits_float(113u << 23));
+
+    return bits_float(o | uint32_t(h & 0x8000) << 16);
+}
+
+template <class VecT>
+constexpr int component_count() { return int(sizeof(VecT) / sizeof(std::declval<VecT const&>()[0])); }
+}
+
+/// 3 x 16 bit fixed point coordinates relative to an axis aligned bounding box
+/// values outside the box are clamped, the maximum error per coordinate is max_error() (plus float rounding)
+template <class Pos3 = std::array<float, 3>>
+struct aabb_codec
+{
+    using value_t = Pos3;
+    using encoded_t = std::array<uint16_t, 3>;
+
+    aabb_codec() = default;
+    /// bounds: {min_x, min_y, min_z, max_x, max_y, max_z}
+    explicit aabb_codec(std::array<float, 6> const& bounds)
+    {
+        for (auto d = 0; d < 3; ++d)
+        {
+            auto const extent = bounds[d + 3] - bounds[d];
+            POLYMESH_ASSERT(extent >= 0 && "invalid bounds");
+            mMin[d] = bounds[d];
+            mStep[d] = extent / 65535.f;
+            mInvStep[d] = extent > 0 ? 65535.f / extent : 0.f;
+        }
+    }
+
+    // NOTE: components are written out instead of looping over d, the loop is not unrolled at -O2
+    //       and the resulting partial stores stall store-to-load forwarding in bulk loops
+    encoded_t encode(Pos3 const& p) const { return {{quantize(p[0], 0), quantize(p[1], 1), quantize(p[2], 2)}}; }
+    Pos3 decode(encoded_t const& e) const
+    {
+        using scalar_t = std::decay_t<decltype(std::declval<Pos3&>()[0])>;
+        Pos3 p;
+        p[0] = scalar_t(mMin[0] + float(e[0]) * mStep[0]);
+        p[1] = scalar_t(mMin[1] + float(e[1]) * mStep[1]);
+        p[2] = scalar_t(mMin[2] + float(e[2]) * mStep[2]);
+        return p;
+    }
+
+    /// largest distance between a value inside the box and its decoded value (per coordinate)
+    float max_error() const { return std::max(std::max(mStep[0], mStep[1]), mStep[2]) / 2; }
+
+private:
+    uint16_t quantize(float v, int d) const { return uint16_t(std::min(std::max((v - mMin[d]) * mInvStep[d], 0.f), 65535.f) + 0.5f); }
+
+    float mMin[3] = {0, 0, 0};
+    float mStep[3] = {1 / 65535.f, 1 / 65535.f, 1 / 65535.f}; // default box is [0,1]^3
+    float mInvStep[3] = {65535.f, 65535.f, 65535.f};
+};
+
+/// unit vectors as 2 x 16 bit signed normalized octahedral coordinates
+/// (the octahedron |x| + |y| + |z| = 1 with the lower half folded over the upper one)
+/// decoded vectors are normalized, zero vectors decode to +z
+template <class Vec3 = std::array<float, 3>>
+struct octahedral_codec
+{
+    using value_t = Vec3;
+    using encoded_t = std::array<int16_t, 2>;
+
+    encoded_t encode(Vec3 const& n) const
+    {
+        auto const x = float(n[0]), y = float(n[1]), z = float(n[2]);
+        auto const l1 = std::abs(x) + std::abs(y) + std::abs(z);
+        auto const inv = l1 > 0 ? 1 / l1 : 0.f;
+        auto const u = x * inv;
+        auto const v = y * inv;
+        // lower hemisphere is folded
+        // (blended instead of branched because signs of normals are unpredictable)
+        auto const lower = float(z < 0);
+        auto const fu = std::copysign(1 - std::abs(v), u);
+        auto const fv = std::copysign(1 - std::abs(u), v);
+        return {{snorm(u + lower * (fu - u)), snorm(v + lower * (fv - v))}};
+    }
+    Vec3 decode(encoded_t const& e) const
+    {
+        using scalar_t = std::decay_t<decltype(std::declval<Vec3&>()[0])>;
+        auto u = std::max(e[0] * (1 / 32767.f), -1.f);
+        auto v = std::max(e[1] * (1 / 32767.f), -1.f);
+        auto const z = 1 - std::abs(u) - std::abs(v);
+        auto const t = (std::abs(z) - z) * 0.5f; // max(-z, 0) without a branch
+        u -= std::copysign(t, u);
+        v -= std::copysign(t, v);
+        auto const inv_len = 1 / std::sqrt(u * u + v * v + z * z);
+        Vec3 n;
+        n[0] = scalar_t(u * inv_len);
+        n[1] = scalar_t(v * inv_len);
+        n[2] = scalar_t(z * inv_len);
+        return n;
+    }
+
+private:
+    static int16_t snorm(float f) { return int16_t(std::lrint(std::min(std::max(f, -1.f), 1.f) * 32767.f)); }
+};
+
+/// each component as an IEEE 16 bit half float (11 bit precision, range +-65504)
+/// e.g. texture coordinates (max error in [0, 1] is 2^-12)
+template <class VecT = std::array<float, 2>, int N = detail::component_count<VecT>()>
+struct half_codec
+{
+    using value_t = VecT;
+    using encoded_t = std::array<uint16_t, N>;
+
+    encoded_t encode(VecT const& v) const { return encode_impl(v, std::make_index_sequence<N>()); }
+    VecT decode(encoded_t const& e) const { return decode_impl(e, std::make_index_sequence<N>()); }
+
+private:
+    // unrolled via index_sequence (see aabb_codec)
+    template <size_t... I>
+    static encoded_t encode_impl(VecT const& v, std::index_sequence<I...>)
+    {
+        return {{detail::float_to_half(float(v[I]))...}};
+    }
+    template <size_t... I>
+    static VecT decode_impl(encoded_t const& e, std::index_sequence<I...>)
+    {
+        using scalar_t = std::decay_t<decltype(std::declval<VecT&>()[0])>;
+        VecT v;
+        ((v[I] = scalar_t(detail::half_to_float(e[I]))), ...);
+        return v;
+    }
+};
+
+/// quantizes vertex positions relative to their bounding box (of all valid vertices)
+/// NOTE: for a mesh without vertices, the box is [0,1]^3
+template <class Pos3>
+quantized_vertex_attribute<aabb_codec<Pos3>> quantize_positions(vertex_attribute<Pos3> const& pos, executor const& exec = executor::default_pool())
+{
+    auto const& m = pos.mesh();
+    auto codec = aabb_codec<Pos3>();
+    if (!m.vertices().empty())
+        codec = aabb_codec<Pos3>(detail::vertex_bounds<float>(m, pos, exec));
+
+    auto q = quantized_vertex_attribute<aabb_codec<Pos3>>(m, codec);
+    q.encode_from(pos, exec);
+    return q;
+}
+
+/// quantizes unit vectors (e.g. vertex or halfedge normals) via octahedral_codec
+template <class tag, class Vec3>
+quantized_primitive_attribute<tag, octahedral_codec<Vec3>> quantize_normals(primitive_attribute<tag, Vec3> const& n,
+                                                                           executor const& exec = executor::default_pool())
+{
+    auto q = quantized_primitive_attribute<tag, octahedral_codec<Vec3>>(n.mesh());
+    q.encode_from(n, exec);
+    return q;
+}
+
+/// stores each component as a half float (e.g. texture coordinates)
+template <class tag, class VecT>
+quantized_primitive_attribute<tag, half_codec<VecT>> quantize_half(primitive_attribute<tag, VecT> const& a,
+                                                                  executor const& exec = executor::default_pool())
+{
+    auto q = quantized_primitive_attribute<tag, half_codec<VecT>>(a.mesh());
+    q.encode_from(a, exec);
+    return q;
+}
+}
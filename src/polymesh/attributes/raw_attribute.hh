@@ -87,11 +87,13 @@ public:
         return mData.get();
     }
 
-    int size() const { return primitive<tag>::all_size(*this->mMesh); }
+    index_value_t size() const { return primitive<tag>::all_size(*this->mMesh); }
     int stride() const { return mStride; }
-    int capacity() const { return primitive<tag>::capacity(*this->mMesh); }
+    index_value_t capacity() const { return primitive<tag>::capacity(*this->mMesh); }
     size_t byte_size() const override { return size() * mStride; }
     size_t allocated_byte_size() const override { return capacity() * mStride; }
+    std::byte const* raw_data_ptr() const override { return mData.get(); }
+    size_t raw_stride() const override { return mStride; }
 
     /// true iff this attribute is still attached to a mesh
     /// do not use the attribute if not valid
@@ -139,7 +141,7 @@ public:
         this->register_attr();
 
         // alloc data (zero-init)
-        this->mData.reset(new std::byte[this->capacity() * mStride]());
+        this->mData = unique_array<std::byte>(this->capacity() * mStride, this->data_resource(true));
     }
 
     // members
@@ -148,7 +150,7 @@ protected:
     size_t mStride = 0; ///< number of bytes per element
 
 protected:
-    void resize_from(int old_size) override
+    void resize_from(index_value_t old_size) override
     {
         // mesh is already resized, thus capacity() and size() return new values
         // old_size is size before resize
@@ -157,29 +159,22 @@ protected:
         auto shared_size = std::min(this->size(), old_size);
         POLYMESH_ASSERT(shared_size <= new_capacity && "size cannot exceed capacity");
 
-        // alloc new data
-        auto new_data = new_capacity > 0 ? new std::byte[new_capacity * mStride]() : nullptr;
-
-        // copy shared region to new data
-        if (shared_size > 0)
-            std::memcpy(new_data, this->mData.get(), shared_size * mStride);
-
-        // replace old data
-        this->mData.reset(new_data);
+        // realloc (possibly in-place) and zero the rest
+        auto const shared_bytes = std::min(size_t(shared_size) * mStride, this->mData.size());
+        this->mData.reallocate(new_capacity * mStride, shared_bytes);
+        std::memset(this->mData.get() + shared_bytes, 0, new_capacity * mStride - shared_bytes);
     }
     void clear_with_default() override { std::memset(this->mData.get(), 0, byte_size()); }
 
-    void apply_remapping(std::vector<int> const& map) override
+    void apply_remapping(std::vector<index_value_t> const& map) override
     {
         // TODO: could be made faster by special casing a few stride sizes
-        for (auto i = 0u; i < map.size(); ++i)
-            std::memcpy(&this->mData[i], &this->mData[map[i]], mStride);
+        for (size_t i = 0; i < map.size(); ++i)
+            std::memcpy(this->mData.get() + i * mStride, this->mData.get() + size_t(map[i]) * mStride, mStride);
     }
-    void apply_transpositions(std::vector<std::pair<int, int>> const& ts) override
+    void apply_gather(std::vector<index_value_t> const& new_to_old, permute_scratch& scratch, executor const& exec) override
     {
-        for (auto t : ts)
-            for (auto i = 0u; i < mStride; ++i)
-                swap(this->mData[t.first * mStride + i], this->mData[t.second * mStride + i]);
+        detail::permute_bytes_by_gather(this->mData.get(), mStride, new_to_old, scratch, exec);
     }
 
     template <class MeshT>
@@ -194,7 +189,7 @@ public:
         this->register_attr();
 
         // alloc data
-        this->mData.reset(new std::byte[this->capacity() * mStride]());
+        this->mData = unique_array<std::byte>(this->capacity() * mStride, this->data_resource(true));
 
         // copy valid data
         std::memcpy(this->mData.get(), rhs.mData.get(), rhs.byte_size());
@@ -227,15 +222,11 @@ public:
         this->mStride = rhs.mStride;
         this->register_attr();
 
-        // realloc if new capacity
+        // realloc if new capacity (or the new mesh uses a different memory resource)
         auto new_capacity_bytes = this->capacity() * mStride;
-        if (old_capacity_bytes != new_capacity_bytes)
-        {
-            if (new_capacity_bytes == 0)
-                this->mData.reset();
-            else
-                this->mData.reset(new std::byte[new_capacity_bytes]());
-        }
+        auto const resource = this->data_resource(true);
+        if (old_capacity_bytes != new_capacity_bytes || this->mData.resource() != resource)
+            this->mData = unique_array<std::byte>(new_capacity_bytes, resource);
 
         // copy valid AND defaulted data
         std::memcpy(this->mData.get(), rhs.mData.get(), new_capacity_bytes);
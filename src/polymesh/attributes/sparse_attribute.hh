@@ -0,0 +1,569 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <polymesh/Mesh.hh>
+#include <polymesh/attributes.hh>
+#include <polymesh/detail/bits.hh>
+#include <polymesh/detail/unique_ptr.hh>
+
+namespace polymesh
+{
+/**
+ * Sparse attributes only store values for primitives that were explicitly set,
+ * all other primitives have the default value (without consuming memory)
+ *
+ * Two storages are provided:
+ *  - hashed_[primitive]_attribute<T>: a hash map, memory is proportional to the number of set values
+ *    (best for very few, scattered values, e.g. feature vertices or constraints)
+ *  - paged_[primitive]_attribute<T>: pages of 4096 values that are allocated on the first write
+ *    (best for clustered values, e.g. a selected region, access is almost as fast as for a normal attribute)
+ *
+ * Like normal attributes, they are registered with the mesh and follow its changes (compactify, permute, clear, ...)
+ *
+ * Usage:
+ *
+ *   pm::paged_vertex_attribute<float> weight(m, 1.0f);
+ *   weight[v] = 3.0f;                 // non-const access creates the value (like std::map)
+ *   float w = weight.get(v);          // read-only access, unset primitives return the default value
+ *   weight.erase(v);                  // back to default
+ *   weight.for_each([&](pm::vertex_index v, float& w) { ... }); // only visits set values
+ *
+ * NOTE: unlike normal attributes, sparse attributes are not smart ranges (they cannot iterate over all primitives)
+ * NOTE: values of removed primitives are kept until compactify (same as for normal attributes)
+ */
+template <class tag, class AttrT>
+struct hashed_primitive_attribute : primitive_attribute_base<tag>
+{
+    using index_t = typename primitive<tag>::index;
+    using handle_t = typename primitive<tag>::handle;
+    using tag_t = tag;
+
+    // data access
+public:
+    /// read-only access, returns the default value for unset primitives
+    AttrT const& get(index_t i) const
+    {
+        POLYMESH_ASSERT(i.is_valid());
+        auto it = mData.find(i.value);
+        return it == mData.end() ? mDefaultValue : it->second;
+    }
+    AttrT const& get(handle_t h) const { return get(checked_index(h)); }
+
+    /// mutable access, creates the value (with the default value) if unset
+    AttrT& operator[](index_t i)
+    {
+        POLYMESH_ASSERT(i.is_valid() && i.value < this->size() && "out of bounds");
+        return mData.try_emplace(i.value, mDefaultValue).first->second;
+    }
+    AttrT& operator[](handle_t h) { return operator[](checked_index(h)); }
+    AttrT const& operator[](index_t i) const { return get(i); }
+    AttrT const& operator[](handle_t h) const { return get(h); }
+
+    AttrT& operator()(index_t i) { return operator[](i); }
+    AttrT& operator()(handle_t h) { return operator[](h); }
+    AttrT const& operator()(index_t i) const { return get(i); }
+    AttrT const& operator()(handle_t h) const { return get(h); }
+
+    void set(index_t i, AttrT value) { operator[](i) = std::move(value); }
+    void set(handle_t h, AttrT value) { operator[](h) = std::move(value); }
+
+    /// true iff a value is stored for the primitive
+    bool contains(index_t i) const { return mData.count(i.value) > 0; }
+    bool contains(handle_t h) const { return contains(checked_index(h)); }
+
+    /// resets the primitive to the default value (frees its storage)
+    void erase(index_t i) { mData.erase(i.value); }
+    void erase(handle_t h) { erase(checked_index(h)); }
+
+    /// calls f(index, value) for all set values (in unspecified order)
+    /// NOTE: f must not set or erase values of this attribute
+    template <class F>
+    void for_each(F&& f)
+    {
+        for (auto& [i, v] : mData)
+            f(index_t(i), v);
+    }
+    template <class F>
+    void for_each(F&& f) const
+    {
+        for (auto const& [i, v] : mData)
+            f(index_t(i), v);
+    }
+
+    /// number of set values
+    index_value_t count() const { return index_value_t(mData.size()); }
+    AttrT const& default_value() const { return mDefaultValue; }
+
+    index_value_t size() const { return primitive<tag>::all_size(*this->mMesh); }
+    index_value_t capacity() const { return primitive<tag>::capacity(*this->mMesh); }
+    size_t byte_size() const override { return mData.size() * sizeof(entry); }
+    /// NOTE: estimated, the node layout of the hash map is implementation defined
+    size_t allocated_byte_size() const override
+    {
+        return mData.bucket_count() * sizeof(void*) + mData.size() * (sizeof(entry) + sizeof(void*) + sizeof(size_t));
+    }
+
+    /// true iff this attribute is still attached to a mesh
+    /// do not use the attribute if not valid
+    bool is_valid() const { return this->mMesh != nullptr; }
+
+    // methods
+public:
+    /// resets all primitives to the default value (frees all storage)
+    void clear() { std::unordered_map<index_value_t, AttrT>().swap(mData); }
+    /// resets all primitives to the given value (which becomes the new default)
+    void clear(AttrT const& value)
+    {
+        clear();
+        mDefaultValue = value;
+    }
+
+    // public ctor
+public:
+    hashed_primitive_attribute() = default;
+    hashed_primitive_attribute(Mesh const& mesh, AttrT const& def_value = AttrT())
+      : primitive_attribute_base<tag>(&mesh), mDefaultValue(def_value)
+    {
+        this->register_attr();
+    }
+
+    // members
+protected:
+    using entry = std::pair<index_value_t const, AttrT>;
+
+    std::unordered_map<index_value_t, AttrT> mData;
+    AttrT mDefaultValue;
+
+    index_t checked_index(handle_t h) const
+    {
+        POLYMESH_ASSERT(this->mMesh == h.mesh && "Handle belongs to a different mesh");
+        return h.idx;
+    }
+
+    /// new_data[i] = old_data[new_to_old[i]] for i < new_to_old.size(), everything else is dropped
+    void gather(std::vector<index_value_t> const& new_to_old)
+    {
+        if (mData.empty())
+            return;
+
+        std::unordered_map<index_value_t, AttrT> data;
+        data.reserve(mData.size());
+        for (size_t i = 0; i < new_to_old.size(); ++i)
+        {
+            auto it = mData.find(new_to_old[i]);
+            if (it != mData.end())
+            {
+                data.emplace(index_value_t(i), std::move(it->second));
+                mData.erase(it);
+                if (mData.empty())
+                    break;
+            }
+        }
+        mData = std::move(data);
+    }
+
+protected:
+    void resize_from(index_value_t old_size) override
+    {
+        // mesh is already resized, thus size() returns the new value
+        // only shrinking can drop values
+        auto shared_size = std::min(this->size(), old_size);
+        if (shared_size >= old_size)
+            return;
+
+        for (auto it = mData.begin(); it != mData.end();)
+            if (it->first >= shared_size)
+                it = mData.erase(it);
+            else
+                ++it;
+    }
+    void clear_with_default() override { clear(); }
+
+    void apply_remapping(std::vector<index_value_t> const& map) override { gather(map); }
+    void apply_gather(std::vector<index_value_t> const& new_to_old, permute_scratch&, executor const&) override { gather(new_to_old); }
+
+    // move & copy
+public:
+    hashed_primitive_attribute(hashed_primitive_attribute const& rhs) // copy
+      : primitive_attribute_base<tag>(rhs.mMesh), mData(rhs.mData), mDefaultValue(rhs.mDefaultValue)
+    {
+        this->register_attr();
+    }
+    hashed_primitive_attribute(hashed_primitive_attribute&& rhs) noexcept // move
+      : primitive_attribute_base<tag>(rhs.mMesh), mData(std::move(rhs.mData)), mDefaultValue(std::move(rhs.mDefaultValue))
+    {
+        rhs.deregister_attr();
+        this->register_attr();
+    }
+    hashed_primitive_attribute& operator=(hashed_primitive_attribute const& rhs) // copy assign
+    {
+        if (this == &rhs) // prevent self-copy
+            return *this;
+
+        this->deregister_attr();
+        this->mMesh = rhs.mMesh;
+        this->register_attr();
+
+        mData = rhs.mData;
+        mDefaultValue = rhs.mDefaultValue;
+        return *this;
+    }
+    hashed_primitive_attribute& operator=(hashed_primitive_attribute&& rhs) noexcept // move assign
+    {
+        if (this == &rhs) // prevent self-move
+            return *this;
+
+        this->deregister_attr();
+        this->mMesh = rhs.mMesh;
+        this->register_attr();
+
+        mData = std::move(rhs.mData);
+        mDefaultValue = std::move(rhs.mDefaultValue);
+        rhs.deregister_attr();
+        return *this;
+    }
+};
+
+/// see hashed_primitive_attribute for the interface
+/// pages of page_size values are allocated from the mesh memory resource on the first write and freed when they become empty
+/// unset values inside allocated pages hold the default value, thus reading is a page lookup and a load (no branch on the value)
+template <class tag, class AttrT>
+struct paged_primitive_attribute : primitive_attribute_base<tag>
+{
+    using index_t = typename primitive<tag>::index;
+    using handle_t = typename primitive<tag>::handle;
+    using tag_t = tag;
+
+    static constexpr int page_size = 4096;
+
+    // data access
+public:
+    /// read-only access, returns the default value for unset primitives
+    AttrT const& get(index_t i) const
+    {
+        POLYMESH_ASSERT(i.is_valid());
+        auto const pi = size_t(i.value / page_size);
+        if (pi >= mPages.size() || mPages[pi] == nullptr)
+            return mDefaultValue;
+        return mPages[pi]->values[i.value % page_size];
+    }
+    AttrT const& get(handle_t h) const { return get(checked_index(h)); }
+
+    /// mutable access, creates the value (with the default value) if unset
+    AttrT& operator[](index_t i)
+    {
+        POLYMESH_ASSERT(i.is_valid() && i.value < this->size() && "out of bounds");
+        auto& p = page_of(i.value);
+        auto const o = i.value % page_size;
+        auto& mask = p.mask[o / 64];
+        auto const bit = uint64_t(1) << (o % 64);
+        if (!(mask & bit))
+        {
+            mask |= bit;
+            ++p.count;
+            ++mCount;
+        }
+        return p.values[o];
+    }
+    AttrT& operator[](handle_t h) { return operator[](checked_index(h)); }
+    AttrT const& operator[](index_t i) const { return get(i); }
+    AttrT const& operator[](handle_t h) const { return get(h); }
+
+    AttrT& operator()(index_t i) { return operator[](i); }
+    AttrT& operator()(handle_t h) { return operator[](h); }
+    AttrT const& operator()(index_t i) const { return get(i); }
+    AttrT const& operator()(handle_t h) const { return get(h); }
+
+    void set(index_t i, AttrT value) { operator[](i) = std::move(value); }
+    void set(handle_t h, AttrT value) { operator[](h) = std::move(value); }
+
+    /// true iff a value is stored for the primitive
+    bool contains(index_t i) const
+    {
+        POLYMESH_ASSERT(i.is_valid());
+        auto const pi = size_t(i.value / page_size);
+        if (pi >= mPages.size() || mPages[pi] == nullptr)
+            return false;
+        auto const o = i.value % page_size;
+        return (mPages[pi]->mask[o / 64] >> (o % 64)) & 1;
+    }
+    bool contains(handle_t h) const { return contains(checked_index(h)); }
+
+    /// resets the primitive to the default value (frees the page if it becomes empty)
+    void erase(index_t i)
+    {
+        if (!contains(i))
+            return;
+
+        auto const pi = size_t(i.value / page_size);
+        auto& p = *mPages[pi];
+        auto const o = i.value % page_size;
+        p.mask[o / 64] &= ~(uint64_t(1) << (o % 64));
+        p.values[o] = mDefaultValue;
+        --mCount;
+        if (--p.count == 0)
+            mPages[pi].reset();
+    }
+    void erase(handle_t h) { erase(checked_index(h)); }
+
+    /// calls f(index, value) for all set values (in ascending index order)
+    /// skips unallocated pages and empty 64-value blocks
+    /// NOTE: f must not set or erase values of this attribute
+    template <class F>
+    void for_each(F&& f)
+    {
+        for_each_impl(*this, f);
+    }
+    template <class F>
+    void for_each(F&& f) const
+    {
+        for_each_impl(*this, f);
+    }
+
+    /// number of set values
+    index_value_t count() const { return mCount; }
+    /// number of allocated pages
+    int page_count() const
+    {
+        auto c = 0;
+        for (auto const& p : mPages)
+            c += p != nullptr;
+        return c;
+    }
+    AttrT const& default_value() const { return mDefaultValue; }
+
+    index_value_t size() const { return primitive<tag>::all_size(*this->mMesh); }
+    index_value_t capacity() const { return primitive<tag>::capacity(*this->mMesh); }
+    size_t byte_size() const override { return size_t(mCount) * sizeof(AttrT); }
+    size_t allocated_byte_size() const override
+    {
+        return mPages.capacity() * sizeof(mPages[0]) + size_t(page_count()) * (sizeof(page) + page_size * sizeof(AttrT));
+    }
+
+    /// true iff this attribute is still attached to a mesh
+    /// do not use the attribute if not valid
+    bool is_valid() const { return this->mMesh != nullptr; }
+
+    // methods
+public:
+    /// resets all primitives to the default value (frees all pages)
+    void clear()
+    {
+        for (auto& p : mPages)
+            p.reset();
+        mCount = 0;
+    }
+    /// resets all primitives to the given value (which becomes the new default)
+    void clear(AttrT const& value)
+    {
+        clear();
+        mDefaultValue = value;
+    }
+
+    // public ctor
+public:
+    paged_primitive_attribute() = default;
+    paged_primitive_attribute(Mesh const& mesh, AttrT const& def_value = AttrT())
+      : primitive_attribute_base<tag>(&mesh), mDefaultValue(def_value)
+    {
+        this->register_attr();
+        mPages.resize(page_count_for(this->capacity()));
+    }
+
+    // members
+protected:
+    struct page
+    {
+        unique_array<AttrT> values; ///< page_size values, unset ones hold the default value
+        uint64_t mask[page_size / 64] = {};
+        int count = 0;
+    };
+
+    std::vector<unique_ptr<page>> mPages; ///< covers the capacity, nullptr for pages without set values
+    index_value_t mCount = 0;
+    AttrT mDefaultValue;
+
+    static size_t page_count_for(index_value_t capacity) { return size_t((capacity + page_size - 1) / page_size); }
+
+    index_t checked_index(handle_t h) const
+    {
+        POLYMESH_ASSERT(this->mMesh == h.mesh && "Handle belongs to a different mesh");
+        return h.idx;
+    }
+
+    page* new_page() const
+    {
+        auto p = new page();
+        p->values = unique_array<AttrT>(page_size, this->data_resource(false));
+        for (auto i = 0; i < page_size; ++i)
+            p->values[i] = mDefaultValue;
+        return p;
+    }
+    page& page_of(index_value_t i)
+    {
+        auto& p = mPages[size_t(i / page_size)];
+        if (p == nullptr)
+            p.reset(new_page());
+        return *p;
+    }
+
+    template <class Self, class F>
+    static void for_each_impl(Self& self, F& f)
+    {
+        for (auto pi = 0u; pi < self.mPages.size(); ++pi)
+        {
+            auto p = self.mPages[pi].get();
+            if (p == nullptr)
+                continue;
+
+            auto const base = index_value_t(pi) * page_size;
+            for (auto b = 0; b < page_size / 64; ++b)
+                detail::for_each_set_bit(p->mask[b], [&](int bit) {
+                    auto const o = b * 64 + bit;
+                    f(index_t(base + o), p->values[o]);
+                });
+        }
+    }
+
+    /// new_data[i] = old_data[new_to_old[i]] for i < new_to_old.size(), everything else is dropped
+    void gather(std::vector<index_value_t> const& new_to_old)
+    {
+        if (mCount == 0)
+            return;
+
+        auto old_pages = std::move(mPages);
+        mPages = std::vector<unique_ptr<page>>(old_pages.size());
+        mCount = 0;
+
+        for (size_t i = 0; i < new_to_old.size(); ++i)
+        {
+            auto const src = new_to_old[i];
+            auto const p = old_pages[size_t(src / page_size)].get();
+            if (p == nullptr)
+                continue; // fast path: nothing set in this page
+
+            auto const o = src % page_size;
+            if ((p->mask[o / 64] >> (o % 64)) & 1)
+                operator[](index_t(index_value_t(i))) = std::move(p->values[o]);
+        }
+    }
+
+    /// resets all values at indices >= first
+    void erase_from(index_value_t first)
+    {
+        for (auto pi = page_count_for(first); pi < mPages.size(); ++pi)
+            if (mPages[pi] != nullptr)
+            {
+                mCount -= mPages[pi]->count;
+                mPages[pi].reset();
+            }
+
+        if (first % page_size != 0 && mPages[size_t(first / page_size)] != nullptr)
+        {
+            auto const end = std::min(page_count_for(first), mPages.size()) * page_size;
+            for (auto i = first; i < index_value_t(end); ++i)
+                erase(index_t(i));
+        }
+    }
+
+protected:
+    void resize_from(index_value_t old_size) override
+    {
+        // mesh is already resized, thus capacity() and size() return new values
+        auto shared_size = std::min(this->size(), old_size);
+        if (mCount > 0 && shared_size < old_size)
+            erase_from(shared_size);
+
+        mPages.resize(page_count_for(this->capacity()));
+    }
+    void clear_with_default() override { clear(); }
+
+    void apply_remapping(std::vector<index_value_t> const& map) override { gather(map); }
+    void apply_gather(std::vector<index_value_t> const& new_to_old, permute_scratch&, executor const&) override { gather(new_to_old); }
+
+    void copy_pages_from(paged_primitive_attribute const& rhs)
+    {
+        mPages.clear();
+        mPages.resize(page_count_for(this->capacity()));
+        for (auto pi = 0u; pi < rhs.mPages.size(); ++pi)
+            if (auto rp = rhs.mPages[pi].get())
+            {
+                auto p = new_page();
+                for (auto i = 0; i < page_size; ++i)
+                    p->values[i] = rp->values[i];
+                std::copy(std::begin(rp->mask), std::end(rp->mask), std::begin(p->mask));
+                p->count = rp->count;
+                mPages[pi].reset(p);
+            }
+        mCount = rhs.mCount;
+    }
+
+    // move & copy
+public:
+    paged_primitive_attribute(paged_primitive_attribute const& rhs) // copy
+      : primitive_attribute_base<tag>(rhs.mMesh), mDefaultValue(rhs.mDefaultValue)
+    {
+        this->register_attr();
+        copy_pages_from(rhs);
+    }
+    paged_primitive_attribute(paged_primitive_attribute&& rhs) noexcept // move
+      : primitive_attribute_base<tag>(rhs.mMesh), mPages(std::move(rhs.mPages)), mCount(rhs.mCount), mDefaultValue(std::move(rhs.mDefaultValue))
+    {
+        rhs.mCount = 0;
+        rhs.deregister_attr();
+        this->register_attr();
+    }
+    paged_primitive_attribute& operator=(paged_primitive_attribute const& rhs) // copy assign
+    {
+        if (this == &rhs) // prevent self-copy
+            return *this;
+
+        this->deregister_attr();
+        this->mMesh = rhs.mMesh;
+        this->register_attr();
+
+        mDefaultValue = rhs.mDefaultValue;
+        copy_pages_from(rhs);
+        return *this;
+    }
+    paged_primitive_attribute& operator=(paged_primitive_attribute&& rhs) noexcept // move assign
+    {
+        if (this == &rhs) // prevent self-move
+            return *this;
+
+        this->deregister_attr();
+        this->mMesh = rhs.mMesh;
+        this->register_attr();
+
+        mPages = std::move(rhs.mPages);
+        mCount = rhs.mCount;
+        mDefaultValue = std::move(rhs.mDefaultValue);
+        rhs.mCount = 0;
+        rhs.deregister_attr();
+        return *this;
+    }
+};
+
+template <class AttrT>
+using hashed_vertex_attribute = hashed_primitive_attribute<vertex_tag, AttrT>;
+template <class AttrT>
+using hashed_face_attribute = hashed_primitive_attribute<face_tag, AttrT>;
+template <class AttrT>
+using hashed_edge_attribute = hashed_primitive_attribute<edge_tag, AttrT>;
+template <class AttrT>
+using hashed_halfedge_attribute = hashed_primitive_attribute<halfedge_tag, AttrT>;
+
+template <class AttrT>
+using paged_vertex_attribute = paged_primitive_attribute<vertex_tag, AttrT>;
+template <class AttrT>
+using paged_face_attribute = paged_primitive_attribute<face_tag, AttrT>;
+template <class AttrT>
+using paged_edge_attribute = paged_primitive_attribute<edge_tag, AttrT>;
+template <class AttrT>
+using paged_halfedge_attribute = paged_primitive_attribute<halfedge_tag, AttrT>;
+}
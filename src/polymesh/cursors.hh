@@ -1,5 +1,6 @@
 #pragma once
 
+#include "assert.hh"
 #include "primitives.hh"
 #include "tmp.hh"
 
@@ -15,10 +16,10 @@ struct primitive_index
     using index_t = typename primitive<tag>::index;
     using handle_t = typename primitive<tag>::handle;
 
-    int value = -1;
+    index_value_t value = -1;
 
     primitive_index() = default;
-    explicit primitive_index(int idx) : value(idx) {}
+    explicit primitive_index(index_value_t idx) : value(idx) {}
 
     bool is_valid() const { return value >= 0; }
     bool is_invalid() const { return value < 0; }
@@ -38,7 +39,15 @@ struct primitive_index
     bool operator!=(handle_t const& rhs) const { return value != rhs.idx.value; }
 #endif
 
-    explicit operator int() const { return value; }
+    explicit operator index_value_t() const { return value; }
+#ifdef POLYMESH_INDEX_64
+    /// narrowing conversion for code that stores indices as int
+    explicit operator int() const
+    {
+        POLYMESH_ASSERT(value == index_value_t(int(value)) && "index does not fit into an int");
+        return int(value);
+    }
+#endif
 
     /// creates a handle from this idx and the given mesh
     handle_t of(Mesh const& m) const { return handle_t(&m, index_t(value)); }
@@ -87,7 +96,10 @@ struct primitive_handle
     bool operator==(index_t const& rhs) const { return idx == rhs; }
     bool operator!=(index_t const& rhs) const { return idx != rhs; }
 
-    explicit operator int() const { return (int)idx; }
+    explicit operator index_value_t() const { return idx.value; }
+#ifdef POLYMESH_INDEX_64
+    explicit operator int() const { return int(idx); }
+#endif
     operator index_t() const { return idx; }
 
     /// indexes this primitive by a functor
@@ -0,0 +1,195 @@
+#include "attribute_pool.hh"
+
+#include <algorithm>
+#include <cstring>
+
+#include <polymesh/assert.hh>
+
+using namespace polymesh;
+
+namespace
+{
+constexpr size_t slot_alignment = 64; // cache line
+}
+
+detail::attribute_pool::attribute_pool(memory_resource* upstream, index_value_t capacity) : mUpstream(upstream), mCapacity(capacity)
+{
+    POLYMESH_ASSERT(upstream);
+}
+
+detail::attribute_pool::~attribute_pool()
+{
+    POLYMESH_ASSERT(mColumns.empty() && "pooled attributes must not outlive their mesh");
+    POLYMESH_ASSERT(!mOldSlab && "missing end_resize");
+
+    if (mSlab)
+        mUpstream->deallocate(mSlab, mSlabSize, slot_alignment);
+}
+
+size_t detail::attribute_pool::column_bytes(size_t element_size, index_value_t capacity)
+{
+    return (element_size * size_t(capacity) + slot_alignment - 1) / slot_alignment * slot_alignment;
+}
+
+detail::attribute_pool::column* detail::attribute_pool::find(void const* p)
+{
+    for (auto& c : mColumns)
+        if (c.ptr == p)
+            return &c;
+    return nullptr;
+}
+
+std::byte* detail::attribute_pool::slab_alloc(size_t bytes)
+{
+    bytes = (bytes + slot_alignment - 1) / slot_alignment * slot_alignment;
+    if (mSlabSize - mSlabUsed < bytes)
+        return nullptr;
+
+    auto p = mSlab + mSlabUsed;
+    mSlabUsed += bytes;
+    return p;
+}
+
+int detail::attribute_pool::column_count() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return int(mColumns.size());
+}
+
+void detail::attribute_pool::reserve(size_t bytes_per_element, int attribute_count)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mReservedBytesPerElement = std::max(mReservedBytesPerElement, bytes_per_element);
+    mReservedColumns = std::max(mReservedColumns, attribute_count);
+
+    // no live columns: the whole slab is free again, allocate it for the current capacity right away
+    if (mColumns.empty() && !mOldSlab)
+    {
+        mSlabUsed = 0;
+
+        auto const size = column_bytes(mReservedBytesPerElement, mCapacity) + size_t(mReservedColumns) * slot_alignment;
+        if (mCapacity > 0 && size > mSlabSize)
+        {
+            if (mSlab)
+                mUpstream->deallocate(mSlab, mSlabSize, slot_alignment);
+            mSlab = static_cast<std::byte*>(mUpstream->allocate(size, slot_alignment));
+            mSlabSize = size;
+        }
+    }
+}
+
+void* detail::attribute_pool::allocate(size_t bytes, size_t alignment)
+{
+    POLYMESH_ASSERT(alignment <= slot_alignment && "over-aligned attribute types cannot be pooled");
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    // element size is only known for arrays of the current capacity
+    auto const is_column = mCapacity > 0 && bytes % size_t(mCapacity) == 0;
+
+    auto p = is_column ? slab_alloc(bytes) : nullptr;
+    auto const in_slab = p != nullptr;
+    if (!p)
+        p = static_cast<std::byte*>(mUpstream->allocate(bytes, std::max(alignment, slot_alignment)));
+
+    mColumns.push_back({p, is_column ? bytes / size_t(mCapacity) : 0, nullptr, in_slab});
+    return p;
+}
+
+void detail::attribute_pool::deallocate(void* p, size_t bytes, size_t alignment)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    auto c = find(p);
+    POLYMESH_ASSERT(c && "not allocated from this pool");
+
+    // slab memory is reclaimed on the next resize (or once no column is left)
+    if (!c->in_slab)
+        mUpstream->deallocate(p, bytes, std::max(alignment, slot_alignment));
+
+    *c = mColumns.back();
+    mColumns.pop_back();
+
+    if (mColumns.empty() && !mOldSlab)
+        mSlabUsed = 0;
+}
+
+void* detail::attribute_pool::reallocate(void* p, size_t old_bytes, size_t new_bytes, size_t alignment, size_t keep_bytes)
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+
+    // prepared slot: only the column itself has to be copied
+    auto c = p ? find(p) : nullptr;
+    if (c && c->next_ptr && c->element_size * size_t(mCapacity) == new_bytes)
+    {
+        auto const src = c->ptr;
+        auto const dst = c->next_ptr;
+        auto const was_in_slab = c->in_slab;
+        c->ptr = dst;
+        c->next_ptr = nullptr;
+        c->in_slab = true;
+
+        // columns are copied in parallel
+        lock.unlock();
+        std::memcpy(dst, src, keep_bytes);
+        if (!was_in_slab)
+            mUpstream->deallocate(src, old_bytes, std::max(alignment, slot_alignment));
+        return dst;
+    }
+    lock.unlock();
+
+    // NOTE: the old slab is alive until end_resize, so the generic copy is safe
+    return memory_resource::reallocate(p, old_bytes, new_bytes, alignment, keep_bytes);
+}
+
+bool detail::attribute_pool::begin_resize(index_value_t new_capacity)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    POLYMESH_ASSERT(!mOldSlab && "resizes cannot be nested");
+    if (new_capacity == mCapacity)
+        return false;
+
+    mOldSlab = mSlab;
+    mOldSlabSize = mSlabSize;
+
+    // one allocation for all columns (plus room for expected attributes)
+    size_t live_bytes = 0;
+    size_t live_bytes_per_element = 0;
+    int live_columns = 0;
+    for (auto const& c : mColumns)
+        if (c.element_size > 0)
+        {
+            live_bytes += column_bytes(c.element_size, new_capacity);
+            live_bytes_per_element += c.element_size;
+            ++live_columns;
+        }
+    size_t reserved_bytes = 0;
+    if (mReservedBytesPerElement > live_bytes_per_element)
+        reserved_bytes = column_bytes(mReservedBytesPerElement - live_bytes_per_element, new_capacity) //
+                         + size_t(std::max(0, mReservedColumns - live_columns)) * slot_alignment;
+
+    mCapacity = new_capacity;
+    mSlabSize = live_bytes + reserved_bytes;
+    mSlabUsed = 0;
+    mSlab = mSlabSize > 0 ? static_cast<std::byte*>(mUpstream->allocate(mSlabSize, slot_alignment)) : nullptr;
+
+    for (auto& c : mColumns)
+        if (c.element_size > 0)
+            c.next_ptr = slab_alloc(c.element_size * size_t(new_capacity));
+
+    return true;
+}
+
+void detail::attribute_pool::end_resize()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    for (auto const& c : mColumns)
+        POLYMESH_ASSERT(!c.next_ptr && "column was not reallocated during the resize");
+
+    if (mOldSlab)
+        mUpstream->deallocate(mOldSlab, mOldSlabSize, slot_alignment);
+    mOldSlab = nullptr;
+    mOldSlabSize = 0;
+}
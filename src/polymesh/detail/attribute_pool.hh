@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+#include <polymesh/fwd.hh>
+#include <polymesh/memory_resource.hh>
+
+namespace polymesh
+{
+class executor;
+}
+
+namespace polymesh::detail
+{
+/**
+ * Pooled storage for all (trivially copyable) attributes of one primitive kind
+ *
+ * The attribute arrays ("columns") are sub-allocated from a single slab that is sized for the current capacity.
+ * When the capacity changes, the mesh calls begin_resize, which allocates ONE new slab and lays out all columns,
+ * then every attribute reallocates (possibly in parallel), which only copies its column into the prepared slot,
+ * and end_resize releases the old slab.
+ *
+ * reserve() makes room for attributes that are created later (see smart_collection::enable_attribute_pool)
+ * Allocations that do not fit into the slab are taken from upstream and moved into the slab on the next resize.
+ *
+ * NOTE: owned by the Mesh, thus pooled attributes must not outlive their mesh
+ */
+class attribute_pool final : public memory_resource
+{
+public:
+    attribute_pool(memory_resource* upstream, index_value_t capacity);
+    ~attribute_pool() override;
+
+    attribute_pool(attribute_pool const&) = delete;
+    attribute_pool& operator=(attribute_pool const&) = delete;
+
+    void* allocate(size_t bytes, size_t alignment) override;
+    void deallocate(void* p, size_t bytes, size_t alignment) override;
+    void* reallocate(void* p, size_t old_bytes, size_t new_bytes, size_t alignment, size_t keep_bytes) override;
+
+    /// allocates the slab for new_capacity elements and assigns a slot to every column
+    /// returns false (and does nothing) if the capacity is unchanged
+    bool begin_resize(index_value_t new_capacity);
+    /// releases the old slab (all columns must have been reallocated)
+    void end_resize();
+
+    /// expected total bytes per element and number of attributes (only increases)
+    /// (the slab is sized for these on the next resize, so that new attributes do not need separate allocations)
+    void reserve(size_t bytes_per_element, int attribute_count);
+
+    /// if set, the mesh resizes pooled attributes in parallel
+    void set_executor(executor const* exec) { mExecutor = exec; }
+    executor const* get_executor() const { return mExecutor; }
+
+    index_value_t capacity() const { return mCapacity; }
+    /// number of live columns
+    int column_count() const;
+
+private:
+    struct column
+    {
+        std::byte* ptr;
+        size_t element_size;
+        std::byte* next_ptr; ///< prepared slot during a resize (nullptr otherwise)
+        bool in_slab;        ///< false if allocated from upstream
+    };
+
+    /// nullptr if p is not a live column
+    column* find(void const* p);
+    /// bytes of a column with the given element size at the given capacity (rounded to cache lines)
+    static size_t column_bytes(size_t element_size, index_value_t capacity);
+    /// sub-allocates from the slab, nullptr if it does not fit
+    std::byte* slab_alloc(size_t bytes);
+
+    memory_resource* mUpstream;
+    index_value_t mCapacity;
+    size_t mReservedBytesPerElement = 0;
+    int mReservedColumns = 0;
+    executor const* mExecutor = nullptr;
+
+    std::byte* mSlab = nullptr;
+    size_t mSlabSize = 0;
+    size_t mSlabUsed = 0;
+
+    // during a resize
+    std::byte* mOldSlab = nullptr;
+    size_t mOldSlabSize = 0;
+
+    std::vector<column> mColumns;
+    mutable std::mutex mMutex;
+};
+}
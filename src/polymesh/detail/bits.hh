@@ -0,0 +1,129 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+#include <polymesh/fwd.hh>
+#include <polymesh/macros.hh>
+
+#ifdef POLYMESH_COMPILER_MSVC
+#include <intrin.h>
+#endif
+
+namespace polymesh::detail
+{
+/// index of the lowest set bit (bits must not be zero)
+inline int lowest_bit(uint64_t bits)
+{
+#ifdef POLYMESH_COMPILER_MSVC
+    unsigned long i;
+    _BitScanForward64(&i, bits);
+    return int(i);
+#else
+    return __builtin_ctzll(bits);
+#endif
+}
+
+/// index of the highest set bit (bits must not be zero)
+inline int highest_bit(uint64_t bits)
+{
+#ifdef POLYMESH_COMPILER_MSVC
+    unsigned long i;
+    _BitScanReverse64(&i, bits);
+    return int(i);
+#else
+    return 63 - __builtin_clzll(bits);
+#endif
+}
+
+/// calls f(i) for every set bit i in ascending order
+template <class F>
+void for_each_set_bit(uint64_t bits, F&& f)
+{
+    while (bits)
+    {
+        f(lowest_bit(bits));
+        bits &= bits - 1;
+    }
+}
+
+/// smallest j >= i with an unset bit j, or size if there is none in [i, size)
+/// bits beyond word_count * 64 count as unset, returns i if i >= size
+inline index_value_t next_unset_bit(uint64_t const* words, index_value_t word_count, index_value_t i, index_value_t size)
+{
+    if (i >= size)
+        return i;
+
+    auto w = i >> 6;
+    if (w >= word_count)
+        return i;
+
+    auto bits = ~words[w] & (~uint64_t(0) << (i & 63));
+    while (bits == 0)
+    {
+        if (++w >= word_count)
+            return (w << 6) < size ? (w << 6) : size;
+        bits = ~words[w];
+    }
+
+    auto const j = (w << 6) + lowest_bit(bits);
+    return j < size ? j : size;
+}
+
+/// largest j <= i with an unset bit j, or -1 if there is none
+/// bits beyond word_count * 64 count as unset
+inline index_value_t prev_unset_bit(uint64_t const* words, index_value_t word_count, index_value_t i)
+{
+    if (i < 0)
+        return i;
+
+    auto w = i >> 6;
+    if (w >= word_count)
+        return i;
+
+    auto bits = ~words[w] & (~uint64_t(0) >> (63 - (i & 63)));
+    while (bits == 0)
+    {
+        if (--w < 0)
+            return -1;
+        bits = ~words[w];
+    }
+
+    return (w << 6) + highest_bit(bits);
+}
+
+/// bits of words[word] that are unset and below size (i.e. bit j <-> index 64 * word + j)
+/// bits beyond word_count * 64 count as unset
+inline uint64_t unset_bits_of_word(uint64_t const* words, index_value_t word_count, index_value_t word, index_value_t size)
+{
+    auto const first = word << 6;
+    if (first >= size)
+        return 0;
+
+    auto bits = size - first >= 64 ? ~uint64_t(0) : (uint64_t(1) << (size - first)) - 1;
+    if (word < word_count)
+        bits &= ~words[word];
+    return bits;
+}
+
+/// bit j of the result is bit j / 2 of bits (each bit is duplicated)
+inline uint64_t duplicate_bits(uint32_t bits)
+{
+    uint64_t x = bits;
+    x = (x | x << 16) & 0x0000FFFF0000FFFFull;
+    x = (x | x << 8) & 0x00FF00FF00FF00FFull;
+    x = (x | x << 4) & 0x0F0F0F0F0F0F0F0Full;
+    x = (x | x << 2) & 0x3333333333333333ull;
+    x = (x | x << 1) & 0x5555555555555555ull;
+    return x | x << 1;
+}
+
+/// true if multi-byte values are stored least significant byte first
+inline bool is_native_little_endian()
+{
+    uint16_t x = 1;
+    uint8_t b;
+    std::memcpy(&b, &x, 1);
+    return b == 1;
+}
+}
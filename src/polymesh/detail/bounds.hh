@@ -0,0 +1,54 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <vector>
+
+#include <polymesh/Mesh.hh>
+#include <polymesh/parallel.hh>
+
+namespace polymesh
+{
+namespace detail
+{
+/// component-wise bounding box {min_x, min_y, min_z, max_x, max_y, max_z} of all valid vertices (computed in parallel)
+/// (Pos3 only needs operator[], i.e. no min/max)
+/// the mesh must contain at least one vertex
+template <class ScalarT, class Pos3>
+std::array<ScalarT, 6> vertex_bounds(Mesh const& m, vertex_attribute<Pos3> const& pos, executor const& exec)
+{
+    POLYMESH_ASSERT(!m.vertices().empty());
+
+    auto const v_cnt = m.all_vertices().size();
+    std::vector<std::array<ScalarT, 6>> chunk_bbs(chunk_count(exec, v_cnt));
+    parallel_chunks(exec, v_cnt, [&](int chunk, index_value_t begin, index_value_t end) {
+        auto const inf = std::numeric_limits<ScalarT>::max();
+        std::array<ScalarT, 6> r = {{inf, inf, inf, -inf, -inf, -inf}};
+        for (auto i = begin; i < end; ++i)
+        {
+            auto const v = m[vertex_index(i)];
+            if (v.is_removed())
+                continue;
+
+            auto const& p = pos[v];
+            for (auto d = 0; d < 3; ++d)
+            {
+                r[d] = std::min(r[d], ScalarT(p[d]));
+                r[d + 3] = std::max(r[d + 3], ScalarT(p[d]));
+            }
+        }
+        chunk_bbs[chunk] = r;
+    });
+
+    auto bb = chunk_bbs[0];
+    for (auto const& r : chunk_bbs)
+        for (auto d = 0; d < 3; ++d)
+        {
+            bb[d] = std::min(bb[d], r[d]);
+            bb[d + 3] = std::max(bb[d + 3], r[d + 3]);
+        }
+    return bb;
+}
+}
+}
@@ -978,7 +978,7 @@ bool add_delaunay_triangulation_delabella(Mesh& m, float const* pos)
     POLYMESH_ASSERT(m.is_compact());
 
     delabella::IDelaBella* idb = delabella::IDelaBella::Create();
-    auto verts = idb->Triangulate(m.vertices().size(), pos + 0, pos + 1, 2 * sizeof(float));
+    auto verts = idb->Triangulate(int(m.vertices().size()), pos + 0, pos + 1, 2 * sizeof(float));
 
     if (verts > 0)
     {
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include <polymesh/assert.hh>
+
+namespace polymesh
+{
+namespace detail
+{
+/// 4-ary min-heap over ids in [0, id_count) with update and removal of arbitrary ids
+/// every id is contained at most once, the position of each id is tracked
+/// (in contrast to std::priority_queue, changed keys do not create stale entries)
+template <class KeyT>
+struct indexed_heap
+{
+public:
+    explicit indexed_heap(int id_count = 0) : positions(id_count, -1) {}
+
+    bool empty() const { return entries.empty(); }
+    int size() const { return int(entries.size()); }
+    bool contains(int id) const { return positions[id] >= 0; }
+
+    /// id and key of the minimum
+    int top_id() const
+    {
+        POLYMESH_ASSERT(!empty());
+        return entries[0].id;
+    }
+    KeyT const& top_key() const
+    {
+        POLYMESH_ASSERT(!empty());
+        return entries[0].key;
+    }
+
+    /// inserts the id or changes its key (if already contained)
+    void push_or_update(int id, KeyT key)
+    {
+        auto p = positions[id];
+        if (p < 0)
+        {
+            p = int(entries.size());
+            entries.push_back({std::move(key), id});
+            positions[id] = p;
+            sift_up(p);
+        }
+        else if (key < entries[p].key)
+        {
+            entries[p].key = std::move(key);
+            sift_up(p);
+        }
+        else
+        {
+            entries[p].key = std::move(key);
+            sift_down(p);
+        }
+    }
+
+    /// removes the id if contained
+    void remove(int id)
+    {
+        auto const p = positions[id];
+        if (p < 0)
+            return;
+
+        positions[id] = -1;
+        if (p == int(entries.size()) - 1)
+        {
+            entries.pop_back();
+            return;
+        }
+
+        entries[p] = std::move(entries.back());
+        entries.pop_back();
+        positions[entries[p].id] = p;
+
+        if (p > 0 && entries[p].key < entries[parent(p)].key)
+            sift_up(p);
+        else
+            sift_down(p);
+    }
+
+    void pop() { remove(top_id()); }
+
+    void clear()
+    {
+        for (auto const& e : entries)
+            positions[e.id] = -1;
+        entries.clear();
+    }
+
+private:
+    struct entry
+    {
+        KeyT key;
+        int id;
+    };
+
+    static int parent(int p) { return (p - 1) / 4; }
+
+    void sift_up(int p)
+    {
+        auto e = std::move(entries[p]);
+        while (p > 0)
+        {
+            auto const pp = parent(p);
+            if (!(e.key < entries[pp].key))
+                break;
+
+            entries[p] = std::move(entries[pp]);
+            positions[entries[p].id] = p;
+            p = pp;
+        }
+        positions[e.id] = p;
+        entries[p] = std::move(e);
+    }
+
+    void sift_down(int p)
+    {
+        auto const s = int(entries.size());
+        auto e = std::move(entries[p]);
+        while (true)
+        {
+            auto const c_begin = 4 * p + 1;
+            if (c_begin >= s)
+                break;
+
+            auto const c_end = c_begin + 4 < s ? c_begin + 4 : s;
+            auto c_min = c_begin;
+            for (auto c = c_begin + 1; c < c_end; ++c)
+                if (entries[c].key < entries[c_min].key)
+                    c_min = c;
+
+            if (!(entries[c_min].key < e.key))
+                break;
+
+            entries[p] = std::move(entries[c_min]);
+            positions[entries[p].id] = p;
+            p = c_min;
+        }
+        positions[e.id] = p;
+        entries[p] = std::move(e);
+    }
+
+private:
+    std::vector<entry> entries;
+    std::vector<int> positions; ///< -1 if not contained
+};
+}
+}
@@ -0,0 +1,69 @@
+#include "mapped_file.hh"
+
+#include <fstream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace polymesh;
+
+detail::mapped_file::mapped_file(std::string const& filename, bool sequential)
+{
+#ifndef _WIN32
+    auto fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+        return;
+
+    struct stat st;
+    if (::fstat(fd, &st) == 0)
+    {
+        mSize = size_t(st.st_size);
+        if (mSize == 0)
+            mValid = true;
+        else
+        {
+            auto p = ::mmap(nullptr, mSize, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED)
+            {
+                mData = static_cast<std::byte const*>(p);
+                mValid = true;
+                mMapped = true;
+
+                // files are typically consumed front to back
+                ::madvise(p, mSize, sequential ? MADV_SEQUENTIAL : MADV_RANDOM);
+            }
+        }
+    }
+
+    ::close(fd); // the mapping stays valid
+
+    if (mValid)
+        return;
+#endif
+
+    // fallback: read everything
+    std::ifstream file(filename, std::ios_base::binary | std::ios_base::ate);
+    if (!file.good())
+        return;
+
+    mBuffer.resize(size_t(file.tellg()));
+    file.seekg(0);
+    if (!file.read(reinterpret_cast<char*>(mBuffer.data()), std::streamsize(mBuffer.size())))
+        return;
+
+    mData = mBuffer.data();
+    mSize = mBuffer.size();
+    mValid = true;
+}
+
+detail::mapped_file::~mapped_file()
+{
+#ifndef _WIN32
+    if (mMapped)
+        ::munmap(const_cast<std::byte*>(mData), mSize);
+#endif
+}
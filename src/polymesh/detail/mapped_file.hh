@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace polymesh::detail
+{
+/// read-only view of a whole file
+/// (memory-mapped where supported, read into a buffer otherwise)
+/// sequential files are read ahead aggressively, others are accessed randomly (e.g. lookup tables)
+struct mapped_file
+{
+    explicit mapped_file(std::string const& filename, bool sequential = true);
+    ~mapped_file();
+
+    mapped_file(mapped_file const&) = delete;
+    mapped_file& operator=(mapped_file const&) = delete;
+
+    /// false if the file could not be opened or mapped
+    bool is_valid() const { return mValid; }
+    std::byte const* data() const { return mData; }
+    char const* chars() const { return reinterpret_cast<char const*>(mData); }
+    size_t size() const { return mSize; }
+
+private:
+    std::byte const* mData = nullptr;
+    size_t mSize = 0;
+    bool mValid = false;
+    bool mMapped = false;
+    std::vector<std::byte> mBuffer;
+};
+}
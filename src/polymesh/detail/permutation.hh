@@ -1,34 +1,78 @@
 #pragma once
 
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <type_traits>
 #include <vector>
 
+#include <polymesh/parallel.hh>
+
 namespace polymesh
 {
+/// Reusable memory for permutations (see primitive collection permute(p, exec, scratch))
+/// Arrays and attributes are permuted via parallel gathers into the scratch buffer (which is then copied back)
+/// Arrays with more than max_bytes (and attributes that are not trivially copyable) are permuted in-place
+/// by following the cycles of the permutation instead (sequential, needs only one bit per element)
+struct permute_scratch
+{
+    /// maximum size of the gather buffer
+    size_t max_bytes = std::numeric_limits<size_t>::max();
+
+    /// inverse permutations (the content is unspecified between calls)
+    std::vector<index_value_t> new_to_old;
+    std::vector<index_value_t> halfedge_new_to_old;
+
+    /// returns a buffer of at least size bytes (aligned for all scalar types) or nullptr if size > max_bytes
+    std::byte* buffer(size_t size)
+    {
+        if (size > max_bytes)
+            return nullptr;
+
+        if (size > mSize)
+        {
+            auto const cnt = (size + sizeof(std::max_align_t) - 1) / sizeof(std::max_align_t);
+            mBuffer.reset(new std::max_align_t[cnt]);
+            mSize = cnt * sizeof(std::max_align_t);
+        }
+        return reinterpret_cast<std::byte*>(mBuffer.get());
+    }
+
+    /// currently allocated bytes
+    size_t capacity() const { return mSize; }
+
+private:
+    std::unique_ptr<std::max_align_t[]> mBuffer;
+    size_t mSize = 0;
+};
+
 namespace detail
 {
-/// Applies a permutation that is given by a remapping
-/// p[curr_idx] = new_idx
-/// Calculates the necessary transpositions and calls s(i, j) for each of it
-template <class Swap>
-void apply_permutation(std::vector<int> const& p, Swap&& s);
+/// Computes new_to_old[p[i]] = i for a remapping p[curr_idx] = new_idx
+void invert_permutation(std::vector<index_value_t> const& p, std::vector<index_value_t>& new_to_old, executor const& exec);
 
-/// Returns true if the parameter is actually a permutation
-bool is_valid_permutation(std::vector<int> const& p);
+/// Permutes data such that data_new[i] = data_old[new_to_old[i]]
+/// (gathers into the scratch buffer if possible, follows cycles in-place otherwise)
+template <class T>
+void permute_by_gather(T* data, std::vector<index_value_t> const& new_to_old, permute_scratch& scratch, executor const& exec);
+
+/// Same as permute_by_gather for untyped elements of stride bytes
+void permute_bytes_by_gather(std::byte* data, size_t stride, std::vector<index_value_t> const& new_to_old, permute_scratch& scratch, executor const& exec);
 
-/// Returns a list of transpositions that result in the given remapping
-/// p[curr_idx] = new_idx
-std::vector<std::pair<int, int>> transpositions_of(std::vector<int> const& p);
+/// Returns true if the parameter is actually a permutation
+bool is_valid_permutation(std::vector<index_value_t> const& p);
 
 // ======== IMPLEMENTATION ========
 
-inline bool is_valid_permutation(std::vector<int> const& p)
+inline bool is_valid_permutation(std::vector<index_value_t> const& p)
 {
-    std::vector<int> r(p.size(), -1);
+    std::vector<index_value_t> r(p.size(), -1);
 
-    for (auto i = 0u; i < p.size(); ++i)
+    for (size_t i = 0; i < p.size(); ++i)
     {
         auto pi = p[i];
-        if (pi < 0 || pi >= (int)p.size())
+        if (pi < 0 || pi >= index_value_t(p.size()))
             return false; // out of bound
 
         if (r[pi] != -1)
@@ -40,39 +84,83 @@ inline bool is_valid_permutation(std::vector<int> const& p)
     return true;
 }
 
-template <class Swap>
-void apply_permutation(std::vector<int> const& p, Swap&& s)
+inline void invert_permutation(std::vector<index_value_t> const& p, std::vector<index_value_t>& new_to_old, executor const& exec)
 {
-    auto size = p.size();
-    std::vector<bool> visited(size, false);
-    for (auto pi = 0u; pi < size; ++pi)
-    {
-        auto i = pi;
+    new_to_old.resize(p.size());
+    parallel_for(exec, index_value_t(p.size()), [&](index_value_t i) { new_to_old[p[i]] = i; });
+}
 
-        if (visited[i])
+/// calls move(dst, src) for all element moves of an in-place permutation by cycle following
+template <class MoveF, class SaveF, class RestoreF>
+void follow_permutation_cycles(std::vector<index_value_t> const& new_to_old, MoveF&& move, SaveF&& save, RestoreF&& restore)
+{
+    auto const size = index_value_t(new_to_old.size());
+    std::vector<bool> done(size, false);
+    for (index_value_t i = 0; i < size; ++i)
+    {
+        if (done[i] || new_to_old[i] == i)
             continue;
 
-        visited[i] = true;
-        i = p[i];
-        while (!visited[i])
+        // data_new[j] = data_old[new_to_old[j]] along the cycle starting at i
+        save(i);
+        auto j = i;
+        while (true)
         {
-            // mark
-            visited[i] = true;
+            done[j] = true;
+            auto const k = new_to_old[j];
+            if (k == i)
+                break;
+            move(j, k);
+            j = k;
+        }
+        restore(j);
+    }
+}
 
-            // swap
-            s(pi, i);
+template <class T>
+void permute_by_gather(T* data, std::vector<index_value_t> const& new_to_old, permute_scratch& scratch, executor const& exec)
+{
+    auto const size = index_value_t(new_to_old.size());
 
-            // advance
-            i = p[i];
+    if constexpr (std::is_trivially_copyable_v<T> && alignof(T) <= alignof(std::max_align_t))
+    {
+        if (auto const buffer = scratch.buffer(size * sizeof(T)))
+        {
+            auto const tmp = reinterpret_cast<T*>(buffer);
+            parallel_for(exec, size, [&](index_value_t i) { tmp[i] = data[new_to_old[i]]; });
+            parallel_chunks(exec, size, [&](int, index_value_t begin, index_value_t end) { std::memcpy(data + begin, tmp + begin, (end - begin) * sizeof(T)); });
+            return;
         }
     }
+
+    T saved;
+    follow_permutation_cycles(
+        new_to_old,                                                                      //
+        [&](index_value_t dst, index_value_t src) { data[dst] = std::move(data[src]); }, //
+        [&](index_value_t i) { saved = std::move(data[i]); },                            //
+        [&](index_value_t i) { data[i] = std::move(saved); });
 }
 
-inline std::vector<std::pair<int, int>> transpositions_of(std::vector<int> const& p)
+inline void permute_bytes_by_gather(std::byte* data, size_t stride, std::vector<index_value_t> const& new_to_old, permute_scratch& scratch, executor const& exec)
 {
-    std::vector<std::pair<int, int>> ts;
-    apply_permutation(p, [&](int i, int j) { ts.emplace_back(i, j); });
-    return ts;
+    auto const size = index_value_t(new_to_old.size());
+
+    if (auto const tmp = scratch.buffer(size * stride))
+    {
+        parallel_chunks(exec, size, [&](int, index_value_t begin, index_value_t end) {
+            for (auto i = begin; i < end; ++i)
+                std::memcpy(tmp + i * stride, data + size_t(new_to_old[i]) * stride, stride);
+        });
+        parallel_chunks(exec, size, [&](int, index_value_t begin, index_value_t end) { std::memcpy(data + begin * stride, tmp + begin * stride, (end - begin) * stride); });
+        return;
+    }
+
+    std::vector<std::byte> saved(stride);
+    follow_permutation_cycles(
+        new_to_old,                                                                                                                   //
+        [&](index_value_t dst, index_value_t src) { std::memcpy(data + size_t(dst) * stride, data + size_t(src) * stride, stride); }, //
+        [&](index_value_t i) { std::memcpy(saved.data(), data + size_t(i) * stride, stride); },                                       //
+        [&](index_value_t i) { std::memcpy(data + size_t(i) * stride, saved.data(), stride); });
 }
 }
 }
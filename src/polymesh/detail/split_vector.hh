@@ -11,25 +11,21 @@ namespace polymesh
 {
 namespace detail
 {
-inline void reserve(int, int) {}
+inline void reserve(index_value_t, index_value_t) {}
 
 template <class TFirst, class... TRest>
-void reserve(int old_size, int new_capacity, TFirst& ptr, TRest&... rest_ptrs)
+void reserve(index_value_t old_size, index_value_t new_capacity, TFirst& ptr, TRest&... rest_ptrs)
 {
     POLYMESH_ASSERT(new_capacity >= old_size && "cannot reserve less than the current number of elements");
 
-    using element_t = typename TFirst::element_type;
-
-    auto new_ptr = new element_t[new_capacity];
-    std::copy(ptr.get(), ptr.get() + old_size, new_ptr);
-
-    ptr.reset(new_ptr);
+    // indices are trivially copyable: realloc-style (possibly in-place), new elements are uninitialized
+    ptr.reallocate(new_capacity, old_size);
 
     reserve(old_size, new_capacity, rest_ptrs...);
 }
 
 template <class... TS>
-void shrink_to_fit(int& size, int& capacity, TS&... ptrs)
+void shrink_to_fit(index_value_t& size, index_value_t& capacity, TS&... ptrs)
 {
     if (capacity > size)
     {
@@ -39,11 +35,11 @@ void shrink_to_fit(int& size, int& capacity, TS&... ptrs)
 }
 
 template <class... TS>
-bool resize(int& size, int& capacity, int new_size, TS&... ptrs)
+bool resize(index_value_t& size, index_value_t& capacity, index_value_t new_size, TS&... ptrs)
 {
     if (new_size > capacity)
     {
-        capacity = std::max(new_size, std::max(2 * capacity, 16));
+        capacity = std::max(new_size, std::max(2 * capacity, index_value_t(16)));
         reserve(size, capacity, ptrs...);
         size = new_size;
         return true;
@@ -55,14 +51,14 @@ bool resize(int& size, int& capacity, int new_size, TS&... ptrs)
 
 /// Like push_back, but doesn't initialize the added element
 template <class... TS>
-bool alloc_back(int& size, int& capacity, TS&... ptrs)
+bool alloc_back(index_value_t& size, index_value_t& capacity, TS&... ptrs)
 {
-    POLYMESH_ASSERT(size < std::numeric_limits<int>::max() && "polymesh only supports 2^31 primitives");
+    POLYMESH_ASSERT(size < std::numeric_limits<index_value_t>::max() && "index overflow (define POLYMESH_INDEX_64 for more than 2^31 primitives)");
     size++;
 
     if (size > capacity)
     {
-        capacity = std::max(2 * capacity, 16);
+        capacity = std::max(2 * capacity, index_value_t(16));
         reserve(size - 1, capacity, ptrs...);
         return true;
     }
@@ -81,7 +77,7 @@ void deallocate(TFirst& ptr, TRest&... rest_ptrs)
 
 /// Unlike std::vector::clear, this also deallocates the storage
 template <class... TS>
-void clear(int& size, int& capacity, TS&... ptrs)
+void clear(index_value_t& size, index_value_t& capacity, TS&... ptrs)
 {
     size = 0;
     capacity = 0;
@@ -98,7 +94,7 @@ struct split_vector_range
 };
 
 template <class T>
-split_vector_range<T> range(int size, unique_array<T>& ptr)
+split_vector_range<T> range(index_value_t size, unique_array<T>& ptr)
 {
     return {ptr.get(), ptr.get() + size};
 }
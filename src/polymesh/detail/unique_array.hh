@@ -1,35 +1,59 @@
 #pragma once
 
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+
 #include <polymesh/assert.hh>
+#include <polymesh/fwd.hh>
+#include <polymesh/memory_resource.hh>
 
 namespace polymesh
 {
 /// lightweight replacement for unique_ptr<T[]>
+/// memory is obtained from a memory_resource (the global heap by default)
+/// the resource is kept when the array is reset and taken over when it is moved
 template <class T>
 struct unique_array
 {
     using element_type = T;
 
     unique_array() = default;
-    explicit unique_array(int size) { ptr = new T[size](); }
-    ~unique_array()
+    explicit unique_array(memory_resource* resource) : mResource(resource) { POLYMESH_ASSERT(resource); }
+    /// allocates size value-initialized elements
+    explicit unique_array(size_t size, memory_resource* resource = memory_resource::heap()) : mResource(resource)
+    {
+        allocate(size);
+        std::uninitialized_value_construct_n(ptr, size);
+    }
+    /// allocates size default-initialized elements (i.e. no initialization for trivial types)
+    static unique_array uninitialized(size_t size, memory_resource* resource)
     {
-        delete[] ptr;
-        ptr = nullptr; // for safety
+        unique_array a(resource);
+        a.allocate(size);
+        std::uninitialized_default_construct_n(a.ptr, size);
+        return a;
     }
+    ~unique_array() { reset(); }
 
     // proper move
     unique_array(unique_array&& rhs) noexcept
     {
         ptr = rhs.ptr;
+        mSize = rhs.mSize;
+        mResource = rhs.mResource;
         rhs.ptr = nullptr;
+        rhs.mSize = 0;
     }
     unique_array& operator=(unique_array&& rhs) noexcept
     {
         // self-move results in moved-from state
-        delete[] ptr;
+        reset();
         ptr = rhs.ptr;
+        mSize = rhs.mSize;
+        mResource = rhs.mResource;
         rhs.ptr = nullptr;
+        rhs.mSize = 0;
 
         return *this;
     }
@@ -41,24 +65,69 @@ struct unique_array
     T* get() noexcept { return ptr; }
     T const* get() const noexcept { return ptr; }
 
-    T& operator[](int i) noexcept
+    /// number of allocated elements
+    size_t size() const noexcept { return mSize; }
+    memory_resource* resource() const noexcept { return mResource; }
+
+    T& operator[](index_value_t i) noexcept
     {
         POLYMESH_ASSERT(ptr);
         return ptr[i];
     }
-    T const& operator[](int i) const noexcept
+    T const& operator[](index_value_t i) const noexcept
     {
         POLYMESH_ASSERT(ptr);
         return ptr[i];
     }
 
-    void reset(T* new_ptr = nullptr)
+    /// changes the number of elements to new_size, the first keep elements are preserved
+    /// trivially copyable types are reallocated via the resource (possibly in-place, e.g. realloc/mremap)
+    /// and the remaining elements are left uninitialized, other types are moved and default-initialized
+    void reallocate(size_t new_size, size_t keep)
     {
-        delete[] ptr;
-        ptr = new_ptr;
+        POLYMESH_ASSERT(keep <= mSize && keep <= new_size && "can only keep existing elements");
+
+        if constexpr (std::is_trivially_copyable_v<T>)
+        {
+            if (new_size == mSize)
+                return;
+
+            ptr = static_cast<T*>(mResource->reallocate(ptr, mSize * sizeof(T), new_size * sizeof(T), alignof(T), keep * sizeof(T)));
+            mSize = new_size;
+        }
+        else
+        {
+            auto a = uninitialized(new_size, mResource);
+            std::move(ptr, ptr + keep, a.ptr);
+            *this = std::move(a);
+        }
+    }
+
+    /// destroys all elements and frees the memory (the resource is kept)
+    void reset()
+    {
+        if (!ptr)
+            return;
+
+        if constexpr (!std::is_trivially_destructible_v<T>)
+            std::destroy_n(ptr, mSize);
+        mResource->deallocate(ptr, mSize * sizeof(T), alignof(T));
+        ptr = nullptr;
+        mSize = 0;
     }
 
 private:
+    void allocate(size_t size)
+    {
+        if (size > 0)
+        {
+            ptr = static_cast<T*>(mResource->allocate(size * sizeof(T), alignof(T)));
+            mSize = size;
+        }
+    }
+
     T* ptr = nullptr;
+    size_t mSize = 0;
+    memory_resource* mResource = memory_resource::heap();
 };
 }
@@ -2,9 +2,11 @@
 
 #include <map>
 #include <string>
+#include <type_traits>
 
 #include <polymesh/assert.hh>
 #include <polymesh/attributes.hh>
+#include <polymesh/attributes/raw_attribute.hh>
 #include <polymesh/detail/unique_ptr.hh>
 
 namespace polymesh
@@ -17,12 +19,16 @@ namespace polymesh
 ///   attribute_collection ac;
 ///
 ///   // insert attributes
-///   // NOTE: copies the attribute!
-///   // TODO: support std::move
+///   // NOTE: copies the attribute (unless it is moved in)
 ///   ac["aPosition"] = m.vertices().make_attribute<glm::vec3>();
 ///
 ///   // access attributes (must exist)
 ///   auto aPos = ac["aPosition"].vertex<glm::vec3>();
+///
+///   // raw attributes (e.g. from read_pm) are moved in
+///   // and converted on first typed access (the type must have the same size as the stride)
+///   ac["aColor"] = raw_vertex_attribute(m, 4);
+///   auto aColor = ac["aColor"].vertex<std::array<uint8_t, 4>>();
 struct attribute_collection
 {
     struct accessor;
@@ -70,33 +76,71 @@ public:
             return *this;
         }
 
+        template <class AttrT>
+        accessor& operator=(vertex_attribute<AttrT>&& a)
+        {
+            ref.mVertexAttrs[name].reset(new vertex_attribute<AttrT>(std::move(a)));
+            return *this;
+        }
+        template <class AttrT>
+        accessor& operator=(face_attribute<AttrT>&& a)
+        {
+            ref.mFaceAttrs[name].reset(new face_attribute<AttrT>(std::move(a)));
+            return *this;
+        }
+        template <class AttrT>
+        accessor& operator=(edge_attribute<AttrT>&& a)
+        {
+            ref.mEdgeAttrs[name].reset(new edge_attribute<AttrT>(std::move(a)));
+            return *this;
+        }
+        template <class AttrT>
+        accessor& operator=(halfedge_attribute<AttrT>&& a)
+        {
+            ref.mHalfedgeAttrs[name].reset(new halfedge_attribute<AttrT>(std::move(a)));
+            return *this;
+        }
+
+        accessor& operator=(raw_primitive_attribute<vertex_tag>&& a)
+        {
+            ref.mVertexAttrs[name].reset(new raw_primitive_attribute<vertex_tag>(std::move(a)));
+            return *this;
+        }
+        accessor& operator=(raw_primitive_attribute<face_tag>&& a)
+        {
+            ref.mFaceAttrs[name].reset(new raw_primitive_attribute<face_tag>(std::move(a)));
+            return *this;
+        }
+        accessor& operator=(raw_primitive_attribute<edge_tag>&& a)
+        {
+            ref.mEdgeAttrs[name].reset(new raw_primitive_attribute<edge_tag>(std::move(a)));
+            return *this;
+        }
+        accessor& operator=(raw_primitive_attribute<halfedge_tag>&& a)
+        {
+            ref.mHalfedgeAttrs[name].reset(new raw_primitive_attribute<halfedge_tag>(std::move(a)));
+            return *this;
+        }
+
         template <class AttrT>
         vertex_attribute<AttrT>& vertex()
         {
-            auto pa = ref.mVertexAttrs.at(name).get();
-            POLYMESH_ASSERT(pa && "non-existent attribute");
-            return *dynamic_cast<vertex_attribute<AttrT>*>(pa);
+            return typed_attribute<AttrT>(ref.mVertexAttrs, name);
         }
         template <class AttrT>
         face_attribute<AttrT>& face()
         {
-            auto pa = ref.mFaceAttrs.at(name).get();
-            POLYMESH_ASSERT(pa && "non-existent attribute");
-            return *dynamic_cast<face_attribute<AttrT>*>(pa);
+            return typed_attribute<AttrT>(ref.mFaceAttrs, name);
         }
         template <class AttrT>
         edge_attribute<AttrT>& edge()
         {
-            auto pa = ref.mEdgeAttrs.at(name).get();
-            POLYMESH_ASSERT(pa && "non-existent attribute");
-            return *dynamic_cast<edge_attribute<AttrT>*>(pa);
+            return typed_attribute<AttrT>(ref.mEdgeAttrs, name);
         }
         template <class AttrT>
         halfedge_attribute<AttrT>& halfedge()
         {
-            auto pa = ref.mHalfedgeAttrs.at(name).get();
-            POLYMESH_ASSERT(pa && "non-existent attribute");
-            return *dynamic_cast<halfedge_attribute<AttrT>*>(pa);
+            return typed_attribute<AttrT>(ref.mHalfedgeAttrs, name);
         }
     };
     struct const_accessor
@@ -107,33 +151,51 @@ public:
         template <class AttrT>
         vertex_attribute<AttrT>& vertex()
         {
-            auto pa = ref.mVertexAttrs.at(name).get();
-            POLYMESH_ASSERT(pa && "non-existent attribute");
-            return *dynamic_cast<vertex_attribute<AttrT>*>(pa);
+            // raw-to-typed conversion only changes the representation, not the content
+            return typed_attribute<AttrT>(const_cast<attribute_collection&>(ref).mVertexAttrs, name);
         }
         template <class AttrT>
         face_attribute<AttrT>& face()
         {
-            auto pa = ref.mFaceAttrs.at(name).get();
-            POLYMESH_ASSERT(pa && "non-existent attribute");
-            return *dynamic_cast<face_attribute<AttrT>*>(pa);
+            // raw-to-typed conversion only changes the representation, not the content
+            return typed_attribute<AttrT>(const_cast<attribute_collection&>(ref).mFaceAttrs, name);
         }
         template <class AttrT>
         edge_attribute<AttrT>& edge()
         {
-            auto pa = ref.mEdgeAttrs.at(name).get();
-            POLYMESH_ASSERT(pa && "non-existent attribute");
-            return *dynamic_cast<edge_attribute<AttrT>*>(pa);
+            // raw-to-typed conversion only changes the representation, not the content
+            return typed_attribute<AttrT>(const_cast<attribute_collection&>(ref).mEdgeAttrs, name);
         }
         template <class AttrT>
         halfedge_attribute<AttrT>& halfedge()
         {
-            auto pa = ref.mHalfedgeAttrs.at(name).get();
-            POLYMESH_ASSERT(pa && "non-existent attribute");
-            return *dynamic_cast<halfedge_attribute<AttrT>*>(pa);
+            // raw-to-typed conversion only changes the representation, not the content
+            return typed_attribute<AttrT>(const_cast<attribute_collection&>(ref).mHalfedgeAttrs, name);
         }
     };
 
+private:
+    /// returns the named attribute as typed attribute
+    /// raw attributes are replaced by a typed copy on first access
+    template <class AttrT, class tag>
+    static typename primitive<tag>::template attribute<AttrT>& typed_attribute(std::map<std::string, unique_ptr<primitive_attribute_base<tag>>>& attrs,
+                                                                                std::string const& name)
+    {
+        using attribute_t = typename primitive<tag>::template attribute<AttrT>;
+
+        auto& pa = attrs.at(name);
+        POLYMESH_ASSERT(pa.get() && "non-existent attribute");
+
+        if constexpr (std::is_trivially_copyable_v<AttrT>)
+            if (auto raw = dynamic_cast<raw_primitive_attribute<tag>*>(pa.get()))
+            {
+                POLYMESH_ASSERT(size_t(raw->stride()) == sizeof(AttrT) && "attribute type does not match stored stride");
+                pa.reset(new attribute_t(raw->template to<AttrT>()));
+            }
+
+        return *dynamic_cast<attribute_t*>(pa.get());
+    }
+
 private:
     std::map<std::string, unique_ptr<primitive_attribute_base<vertex_tag>>> mVertexAttrs;
     std::map<std::string, unique_ptr<primitive_attribute_base<face_tag>>> mFaceAttrs;
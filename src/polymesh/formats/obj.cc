@@ -1,8 +1,15 @@
 #include "obj.hh"
 
+#include <algorithm>
+#include <charconv>
+#include <cstring>
 #include <fstream>
 #include <iostream>
-#include <sstream>
+#include <iterator>
+#include <string_view>
+
+#include <polymesh/detail/mapped_file.hh>
+#include <polymesh/parallel.hh>
 
 namespace polymesh
 {
@@ -21,6 +28,14 @@ bool read_obj(const std::string& filename, Mesh& mesh, vertex_attribute<std::arr
     return reader.error_faces() == 0;
 }
 
+template <class ScalarT>
+bool read_obj(std::string const& filename, Mesh& mesh, vertex_attribute<std::array<ScalarT, 3>>& position, executor const& exec)
+{
+    obj_reader<ScalarT> reader(filename, mesh, exec);
+    position = reader.get_positions().map([](std::array<ScalarT, 4> const& p) { return std::array<ScalarT, 3>{{p[0], p[1], p[2]}}; });
+    return reader.error_faces() == 0;
+}
+
 template <class ScalarT>
 obj_writer<ScalarT>::obj_writer(const std::string& filename)
 {
@@ -141,8 +156,8 @@ void obj_writer<ScalarT>::write_mesh(vertex_attribute<std::array<ScalarT, 4>> co
         *out << "f";
         for (auto h : f.halfedges())
         {
-            auto vi = int(h.vertex_to());
-            auto hi = int(h);
+            auto vi = h.vertex_to().idx.value;
+            auto hi = h.idx.value;
             *out << " ";
             *out << base_v + vi;
             if (tex_coord || normal)
@@ -159,54 +174,120 @@ void obj_writer<ScalarT>::write_mesh(vertex_attribute<std::array<ScalarT, 4>> co
     }
 }
 
+namespace
+{
+struct obj_corner
+{
+    index_value_t v = 0;
+    index_value_t t = 0;
+    index_value_t n = 0;
+};
+
+/// all records of a line-aligned part of an obj file
 template <class ScalarT>
-obj_reader<ScalarT>::obj_reader(const std::string& filename, Mesh& mesh) : positions(mesh), tex_coords(mesh), normals(mesh)
+struct obj_chunk
 {
-    std::ifstream file(filename);
-    if (!file.good())
-        std::cerr << "Cannot read from file `" << filename << "'" << std::endl;
-    else
-        parse(file, mesh);
+    std::vector<std::array<ScalarT, 4>> positions;
+    std::vector<std::array<ScalarT, 3>> tex_coords;
+    std::vector<std::array<ScalarT, 3>> normals;
+
+    std::vector<int> face_sizes;
+    std::vector<obj_corner> corners;
+
+    std::vector<int> line_sizes;
+    std::vector<index_value_t> line_indices;
+
+    std::vector<int> small_faces;                       ///< line nrs (in chunk) of faces with less than 3 vertices
+    std::vector<std::pair<int, std::string>> bad_lines; ///< (line nr in chunk, line) of unknown records
+    int line_count = 0;
+};
+
+inline bool is_blank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+inline char const* skip_blanks(char const* p, char const* end)
+{
+    while (p != end && is_blank(*p))
+        ++p;
+    return p;
 }
 
-template <class ScalarT>
-obj_reader<ScalarT>::obj_reader(std::istream& in, Mesh& mesh) : positions(mesh), tex_coords(mesh), normals(mesh)
+template <class T>
+bool parse_number(char const*& p, char const* end, T& value)
 {
-    parse(in, mesh);
+    p = skip_blanks(p, end);
+    if (p != end && *p == '+')
+        ++p;
+
+    auto r = std::from_chars(p, end, value);
+    if (r.ec != std::errc())
+        return false;
+
+    p = r.ptr;
+    return true;
 }
 
-template <class ScalarT>
-void obj_reader<ScalarT>::parse(std::istream& in, Mesh& mesh)
+/// parses up to N numbers, returns how many were read
+template <size_t N, class ScalarT>
+int parse_numbers(char const* p, char const* end, std::array<ScalarT, N>& values)
 {
-    mesh.clear();
+    for (auto i = 0u; i < N; ++i)
+        if (!parse_number(p, end, values[i]))
+            return int(i);
+    return int(N);
+}
 
-    std::vector<std::array<ScalarT, 3>> raw_tex_coords;
-    std::vector<std::array<ScalarT, 3>> raw_normals;
+/// parses an index directly at p (without skipping blanks, thus never reads into the next token)
+inline void parse_index(char const*& p, char const* end, index_value_t& value)
+{
+    auto r = std::from_chars(p, end, value);
+    if (r.ec == std::errc())
+        p = r.ptr;
+}
 
-    struct face
+/// parses one "v", "v/", "v/t", "v//n", or "v/t/n" token
+inline obj_corner parse_corner(char const*& p, char const* end)
+{
+    obj_corner c;
+    parse_index(p, end, c.v);
+    if (p != end && *p == '/')
     {
-        int v = 0;
-        int t = 0;
-        int n = 0;
-        vertex_handle vh;
-    };
-
-    std::vector<face> poly;
-    std::vector<halfedge_handle> poly_hs;
-    std::vector<vertex_index> poly_vs;
-    std::string fs;
-
-    std::string line_s;
-    auto line_nr = 0;
-    while (std::getline(in, line_s))
+        ++p;
+        if (p != end && *p != '/')
+            parse_index(p, end, c.t);
+        if (p != end && *p == '/')
+        {
+            ++p;
+            parse_index(p, end, c.n);
+        }
+    }
+
+    // skip rest of token
+    while (p != end && !is_blank(*p))
+        ++p;
+    return c;
+}
+
+template <class ScalarT>
+void parse_chunk(char const* p, char const* end, obj_chunk<ScalarT>& chunk)
+{
+    while (p != end)
     {
-        ++line_nr;
-        while (line_s.size() > 0 && (line_s.back() == '\r' || line_s.back() == ' ' || line_s.back() == '\t'))
-            line_s.pop_back();
-        std::istringstream line(line_s);
-        std::string type;
+        auto line_end = static_cast<char const*>(std::memchr(p, '\n', size_t(end - p)));
+        if (!line_end)
+            line_end = end;
+
+        auto const line_begin = p;
+        p = line_end == end ? end : line_end + 1;
+        ++chunk.line_count;
 
-        line >> type;
+        while (line_end != line_begin && is_blank(line_end[-1]))
+            --line_end;
+
+        auto type_begin = skip_blanks(line_begin, line_end);
+        auto type_end = type_begin;
+        while (type_end != line_end && !is_blank(*type_end))
+            ++type_end;
+        auto const type = std::string_view(type_begin, size_t(type_end - type_begin));
 
         // empty lines
         if (type.empty())
@@ -219,140 +300,56 @@ void obj_reader<ScalarT>::parse(std::istream& in, Mesh& mesh)
         // vertices
         else if (type == "v")
         {
-            auto v = mesh.vertices().add();
-
-            std::array<ScalarT, 4> p;
-            p[3] = 1.0f;
-
-            line >> p[0];
-            line >> p[1];
-            line >> p[2];
-            ScalarT w;
-            line >> w;
-            if (line.good())
-                p[3] = w;
-
-            positions[v] = p;
+            std::array<ScalarT, 4> v = {{0, 0, 0, 1}};
+            if (parse_numbers(type_end, line_end, v) < 4)
+                v[3] = 1; // w is optional
+            chunk.positions.push_back(v);
         }
 
         // textures
         else if (type == "vt")
         {
-            std::array<ScalarT, 3> t;
-            t[2] = 1.0f;
-
-            line >> t[0];
-            line >> t[1];
-            ScalarT z;
-            line >> z;
-            if (line.good())
-                t[2] = z;
-
-            raw_tex_coords.push_back(t);
+            std::array<ScalarT, 3> t = {{0, 0, 1}};
+            if (parse_numbers(type_end, line_end, t) < 3)
+                t[2] = 1; // w is optional
+            chunk.tex_coords.push_back(t);
         }
 
         // normals
         else if (type == "vn")
         {
-            std::array<ScalarT, 3> n;
-            line >> n[0];
-            line >> n[1];
-            line >> n[2];
-            raw_normals.push_back(n);
+            std::array<ScalarT, 3> n = {{0, 0, 0}};
+            parse_numbers(type_end, line_end, n);
+            chunk.normals.push_back(n);
         }
 
         // faces
         else if (type == "f")
         {
-            poly_hs.clear();
-            poly_vs.clear();
-            poly.clear();
-
-            while (line.good())
-            {
-                fs.clear();
-                line >> fs;
-                int sc = 0;
-                auto first_s = fs.find_first_of('/');
-                auto last_s = fs.find_last_of('/');
-                for (auto& c : fs)
-                    if (c == '/')
-                    {
-                        c = ' ';
-                        ++sc;
-                    }
-
-                std::istringstream ss(fs);
-                face f;
-                switch (sc)
-                {
-                case 0:
-                    ss >> f.v;
-                    break;
-
-                case 1:
-                    ss >> f.v;
-                    ss >> f.t;
-                    break;
-
-                case 2:
-                    ss >> f.v;
-                    if (first_s + 1 != last_s) // "1//2"
-                        ss >> f.t;
-                    ss >> f.n;
-                    break;
-                }
-
-                f.vh = mesh.handle_of(vertex_index(f.v - 1));
-                poly.push_back(f);
-                poly_vs.push_back(f.vh);
-            }
-
-            if (poly.size() < 3)
-            {
-                std::cerr << "faces with less than 3 vertices are not supported. Use lines instead." << std::endl;
-                continue;
-            }
+            auto const corner_start = chunk.corners.size();
+            for (auto c = skip_blanks(type_end, line_end); c != line_end; c = skip_blanks(c, line_end))
+                chunk.corners.push_back(parse_corner(c, line_end));
 
-            if (!mesh.faces().can_add(poly_vs))
+            auto const cnt = int(chunk.corners.size() - corner_start);
+            if (cnt < 3)
             {
-                n_error_faces++;
+                chunk.corners.resize(corner_start);
+                chunk.small_faces.push_back(chunk.line_count);
                 continue;
             }
 
-            poly_hs.resize(poly.size());
-            for (auto i = 0u; i < poly.size(); ++i)
-            {
-                auto const& f0 = poly[i];
-                auto const& f1 = poly[(i + 1) % poly.size()];
-                auto v0 = f0.vh;
-                auto v1 = f1.vh;
-                auto hh = mesh.halfedges().add_or_get(v0, v1);
-                poly_hs[i] = hh;
-
-                if (f1.t > 0)
-                    tex_coords[hh] = raw_tex_coords[size_t(f1.t - 1)];
-                if (f1.n > 0)
-                    normals[hh] = raw_normals[size_t(f1.n - 1)];
-            }
-
-            mesh.faces().add(poly_hs);
+            chunk.face_sizes.push_back(cnt);
         }
 
         // lines
         else if (type == "l")
         {
-            int i0, i1;
-            line >> i0;
-            line >> i1;
-            mesh.edges().add_or_get(mesh[vertex_index(i0 - 1)], mesh[vertex_index(i1 - 1)]);
-
-            while (line.good())
-            {
-                i0 = i1;
-                line >> i1;
-                mesh.edges().add_or_get(mesh[vertex_index(i0 - 1)], mesh[vertex_index(i1 - 1)]);
-            }
+            auto const index_start = chunk.line_indices.size();
+            auto c = type_end;
+            index_value_t i;
+            while (parse_number(c, line_end, i))
+                chunk.line_indices.push_back(i);
+            chunk.line_sizes.push_back(int(chunk.line_indices.size() - index_start));
         }
 
         // not implemented
@@ -369,23 +366,212 @@ void obj_reader<ScalarT>::parse(std::istream& in, Mesh& mesh)
 
         else
         {
-            std::cerr << "Unable to parse line " << line_nr << ": " << line_s << std::endl;
+            chunk.bad_lines.emplace_back(chunk.line_count, std::string(line_begin, line_end));
+        }
+    }
+}
+
+/// concatenates (and consumes) the given member of all chunks into a single vector
+template <class ChunkT, class T>
+std::vector<T> gather(executor const& exec, std::vector<ChunkT>& chunks, std::vector<T> ChunkT::*member)
+{
+    if (chunks.size() == 1)
+        return std::move(chunks[0].*member);
+
+    std::vector<size_t> offsets(chunks.size() + 1, 0);
+    for (auto i = 0u; i < chunks.size(); ++i)
+        offsets[i + 1] = offsets[i] + (chunks[i].*member).size();
+
+    std::vector<T> r(offsets.back());
+    exec.run(int(chunks.size()), [&](int i) { std::copy((chunks[i].*member).begin(), (chunks[i].*member).end(), r.begin() + offsets[i]); });
+    return r;
+}
+}
+
+template <class ScalarT>
+obj_reader<ScalarT>::obj_reader(const std::string& filename, Mesh& mesh) : obj_reader(filename, mesh, executor::sequential())
+{
+}
+
+template <class ScalarT>
+obj_reader<ScalarT>::obj_reader(const std::string& filename, Mesh& mesh, executor const& exec)
+  : positions(mesh), tex_coords(mesh), normals(mesh)
+{
+    detail::mapped_file file(filename);
+    if (!file.is_valid())
+        std::cerr << "Cannot read from file `" << filename << "'" << std::endl;
+    else
+        parse(file.chars(), file.size(), mesh, exec);
+}
+
+template <class ScalarT>
+obj_reader<ScalarT>::obj_reader(std::istream& in, Mesh& mesh) : positions(mesh), tex_coords(mesh), normals(mesh)
+{
+    auto const content = std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    parse(content.data(), content.size(), mesh, executor::sequential());
+}
+
+template <class ScalarT>
+void obj_reader<ScalarT>::parse(char const* data, size_t size, Mesh& mesh, executor const& exec)
+{
+    mesh.clear();
+
+    // split into line-aligned chunks
+    auto const min_chunk_size = size_t(1) << 20;
+    auto const chunk_cnt = exec.is_sequential() ? 1 : int(std::max(size_t(1), std::min(size_t(4 * exec.concurrency()), size / min_chunk_size)));
+
+    std::vector<char const*> chunk_begin(chunk_cnt + 1);
+    chunk_begin[0] = data;
+    chunk_begin[chunk_cnt] = data + size;
+    for (auto i = 1; i < chunk_cnt; ++i)
+    {
+        auto p = std::max(chunk_begin[i - 1], data + size * i / chunk_cnt);
+        auto nl = static_cast<char const*>(std::memchr(p, '\n', size_t(data + size - p)));
+        chunk_begin[i] = nl ? nl + 1 : data + size;
+    }
+
+    // parse
+    std::vector<obj_chunk<ScalarT>> chunks(chunk_cnt);
+    exec.run(chunk_cnt, [&](int i) { parse_chunk(chunk_begin[i], chunk_begin[i + 1], chunks[i]); });
+
+    // report problems (in file order)
+    auto line_offset = 0;
+    for (auto const& c : chunks)
+    {
+        n_error_faces += int(c.small_faces.size());
+
+        auto small_it = c.small_faces.begin();
+        for (auto const& l : c.bad_lines)
+        {
+            for (; small_it != c.small_faces.end() && *small_it < l.first; ++small_it)
+                std::cerr << "faces with less than 3 vertices are not supported. Use lines instead." << std::endl;
+            std::cerr << "Unable to parse line " << line_offset + l.first << ": " << l.second << std::endl;
+        }
+        for (; small_it != c.small_faces.end(); ++small_it)
+            std::cerr << "faces with less than 3 vertices are not supported. Use lines instead." << std::endl;
+
+        line_offset += c.line_count;
+    }
+
+    // vertices
+    auto const raw_positions = gather(exec, chunks, &obj_chunk<ScalarT>::positions);
+    auto const raw_tex_coords = gather(exec, chunks, &obj_chunk<ScalarT>::tex_coords);
+    auto const raw_normals = gather(exec, chunks, &obj_chunk<ScalarT>::normals);
+    auto const face_sizes = gather(exec, chunks, &obj_chunk<ScalarT>::face_sizes);
+    auto const corners = gather(exec, chunks, &obj_chunk<ScalarT>::corners);
+    auto const line_sizes = gather(exec, chunks, &obj_chunk<ScalarT>::line_sizes);
+    auto const line_indices = gather(exec, chunks, &obj_chunk<ScalarT>::line_indices);
+    chunks.clear();
+
+    auto const v_cnt = index_value_t(raw_positions.size());
+    auto ll = low_level_api(mesh);
+    ll.alloc_primitives(v_cnt, 0, 0);
+    detail::parallel_for(exec, v_cnt, [&](index_value_t i) {
+        ll.outgoing_halfedge_of(vertex_index(i)) = halfedge_index::invalid;
+        positions[vertex_index(i)] = raw_positions[size_t(i)];
+    });
+
+    // faces (with invalid indices are errors)
+    std::vector<int> valid_sizes;
+    std::vector<index_value_t> valid_offsets;
+    std::vector<index_value_t> indices;
+    valid_sizes.reserve(face_sizes.size());
+    valid_offsets.reserve(face_sizes.size());
+    indices.reserve(corners.size());
+    auto has_halfedge_attributes = false;
+    {
+        index_value_t offset = 0;
+        for (auto s : face_sizes)
+        {
+            auto valid = true;
+            for (auto c = offset; c < offset + s; ++c)
+            {
+                auto const& corner = corners[size_t(c)];
+                valid &= 1 <= corner.v && corner.v <= v_cnt;
+                has_halfedge_attributes |= corner.t > 0 || corner.n > 0;
+            }
+
+            if (valid)
+            {
+                valid_sizes.push_back(s);
+                valid_offsets.push_back(offset);
+                for (auto c = offset; c < offset + s; ++c)
+                    indices.push_back(corners[size_t(c)].v - 1);
+            }
+            else
+                n_error_faces++;
+
+            offset += s;
+        }
+    }
+
+    auto const skipped = mesh.build_from_polygons(valid_sizes, indices);
+    n_error_faces += int(skipped.size());
+
+    // tex coords and normals belong to the halfedge pointing to the corner
+    if (has_halfedge_attributes)
+    {
+        auto next_skipped = skipped.begin();
+        index_value_t f = 0;
+        for (index_value_t i = 0; i < index_value_t(valid_sizes.size()); ++i)
+        {
+            if (next_skipped != skipped.end() && *next_skipped == i)
+            {
+                ++next_skipped;
+                continue;
+            }
+
+            auto const s = valid_sizes[size_t(i)];
+            auto const face_corners = corners.data() + valid_offsets[size_t(i)];
+
+            // find corner of the first halfedge (vertices of a face are unique)
+            auto h = ll.halfedge_of(face_index(f++));
+            auto const v = ll.to_vertex_of(h).value + 1;
+            auto c = 0;
+            while (face_corners[c].v != v)
+                ++c;
+
+            for (auto k = 0; k < s; ++k)
+            {
+                auto const& corner = face_corners[(c + k) % s];
+                if (corner.t > 0 && corner.t <= index_value_t(raw_tex_coords.size()))
+                    tex_coords[h] = raw_tex_coords[size_t(corner.t - 1)];
+                if (corner.n > 0 && corner.n <= index_value_t(raw_normals.size()))
+                    normals[h] = raw_normals[size_t(corner.n - 1)];
+                h = ll.next_halfedge_of(h);
+            }
+        }
+    }
+
+    // lines
+    index_value_t line_start = 0;
+    for (auto s : line_sizes)
+    {
+        for (auto i = line_start + 1; i < line_start + s; ++i)
+        {
+            auto i0 = line_indices[size_t(i - 1)];
+            auto i1 = line_indices[size_t(i)];
+            if (1 <= i0 && i0 <= v_cnt && 1 <= i1 && i1 <= v_cnt && i0 != i1)
+                mesh.edges().add_or_get(mesh[vertex_index(i0 - 1)], mesh[vertex_index(i1 - 1)]);
         }
+        line_start += s;
     }
 
     if (n_error_faces > 0)
     {
-        std::cerr << "skipped " << n_error_faces << " face(s) because mesh would become non-manifold" << std::endl;
+        std::cerr << "skipped " << n_error_faces << " face(s) because they are invalid or mesh would become non-manifold" << std::endl;
     }
 }
 
 template void write_obj<float>(std::string const& filename, vertex_attribute<std::array<float, 3>> const& position);
 template bool read_obj<float>(std::string const& filename, Mesh& mesh, vertex_attribute<std::array<float, 3>>& position);
+template bool read_obj<float>(std::string const& filename, Mesh& mesh, vertex_attribute<std::array<float, 3>>& position, executor const& exec);
 template struct obj_reader<float>;
 template struct obj_writer<float>;
 
 template void write_obj<double>(std::string const& filename, vertex_attribute<std::array<double, 3>> const& position);
 template bool read_obj<double>(std::string const& filename, Mesh& mesh, vertex_attribute<std::array<double, 3>>& position);
+template bool read_obj<double>(std::string const& filename, Mesh& mesh, vertex_attribute<std::array<double, 3>>& position, executor const& exec);
 template struct obj_reader<double>;
 template struct obj_writer<double>;
 
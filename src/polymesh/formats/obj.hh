@@ -11,6 +11,9 @@ template <class ScalarT>
 void write_obj(std::string const& filename, vertex_attribute<std::array<ScalarT, 3>> const& position);
 template <class ScalarT>
 bool read_obj(std::string const& filename, Mesh& mesh, vertex_attribute<std::array<ScalarT, 3>>& position);
+/// same as read_obj but the file is parsed in parallel chunks via the executor (see parallel.hh)
+template <class ScalarT>
+bool read_obj(std::string const& filename, Mesh& mesh, vertex_attribute<std::array<ScalarT, 3>>& position, executor const& exec);
 
 template <class ScalarT>
 struct obj_writer
@@ -33,18 +36,23 @@ private:
     std::ostream* tmp_out = nullptr;
     std::ostream* out = nullptr;
 
-    int vertex_idx = 1;
-    int texture_idx = 1;
-    int normal_idx = 1;
+    index_value_t vertex_idx = 1;
+    index_value_t texture_idx = 1;
+    index_value_t normal_idx = 1;
 };
 
 // clears the given mesh before adding data
 // obj must be manifold
 // no negative indices
+// lines ("l") are added after all faces
+//
+// the file is memory-mapped (or read at once), parsed in line-aligned chunks (in parallel if an executor is given),
+// and the faces are added via Mesh::build_from_polygons
 template <class ScalarT>
 struct obj_reader
 {
     obj_reader(std::string const& filename, Mesh& mesh);
+    obj_reader(std::string const& filename, Mesh& mesh, executor const& exec);
     obj_reader(std::istream& in, Mesh& mesh);
 
     // get properties of the obj
@@ -53,11 +61,11 @@ public:
     halfedge_attribute<std::array<ScalarT, 3>> const& get_tex_coords() const { return tex_coords; }
     halfedge_attribute<std::array<ScalarT, 3>> const& get_normals() const { return normals; }
 
-    /// Number of faces that could not be added
+    /// Number of faces that could not be added (invalid indices, less than 3 vertices, or non-manifold)
     int error_faces() const { return n_error_faces; }
 
 private:
-    void parse(std::istream& in, Mesh& mesh);
+    void parse(char const* data, size_t size, Mesh& mesh, executor const& exec);
 
     vertex_attribute<std::array<ScalarT, 4>> positions;
     halfedge_attribute<std::array<ScalarT, 3>> tex_coords;
@@ -55,12 +55,12 @@ bool read_off(std::istream& input, Mesh& mesh, vertex_attribute<std::array<Scala
         return false;
 
     // read counts
-    int v_cnt, f_cnt, e_cnt;
+    index_value_t v_cnt, f_cnt, e_cnt;
     input >> v_cnt >> f_cnt >> e_cnt;
     (void)e_cnt; // unused
 
     // read vertices
-    for (auto i = 0; i < v_cnt; ++i)
+    for (index_value_t i = 0; i < v_cnt; ++i)
     {
         auto v = mesh.vertices().add();
         auto& pos = v[position];
@@ -70,14 +70,14 @@ bool read_off(std::istream& input, Mesh& mesh, vertex_attribute<std::array<Scala
     // read faces
     auto non_manifold = 0;
     std::vector<vertex_handle> vs;
-    for (auto i = 0; i < f_cnt; ++i)
+    for (index_value_t i = 0; i < f_cnt; ++i)
     {
         int valence;
         input >> valence;
         vs.resize(valence);
         for (auto vi = 0; vi < valence; ++vi)
         {
-            int v;
+            index_value_t v;
             input >> v;
             vs[vi] = mesh[vertex_index(v)];
         }
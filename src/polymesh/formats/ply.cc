@@ -1,3 +1,855 @@
 #include "ply.hh"
 
-// TODO
+#include <algorithm>
+#include <charconv>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <sstream>
+#include <type_traits>
+#include <vector>
+
+#include <polymesh/detail/bits.hh>
+#include <polymesh/detail/mapped_file.hh>
+
+/*
+    ply
+    format (ascii|binary_little_endian|binary_big_endian) 1.0
+    comment ...
+    element <name> <count>
+    property <type> <name>
+    property list <count type> <value type> <name>
+    ...
+    end_header
+    <data, element by element, property by property>
+
+    types: char uchar short ushort int uint float double
+           (or int8 uint8 int16 uint16 int32 uint32 float32 float64)
+ */
+
+namespace polymesh
+{
+namespace
+{
+enum class ply_type
+{
+    invalid,
+    int8,
+    uint8,
+    int16,
+    uint16,
+    int32,
+    uint32,
+    float32,
+    float64,
+};
+
+enum class ply_format
+{
+    ascii,
+    binary_little_endian,
+    binary_big_endian,
+};
+
+ply_type parse_ply_type(std::string const& s)
+{
+    if (s == "char" || s == "int8")
+        return ply_type::int8;
+    if (s == "uchar" || s == "uint8")
+        return ply_type::uint8;
+    if (s == "short" || s == "int16")
+        return ply_type::int16;
+    if (s == "ushort" || s == "uint16")
+        return ply_type::uint16;
+    if (s == "int" || s == "int32")
+        return ply_type::int32;
+    if (s == "uint" || s == "uint32")
+        return ply_type::uint32;
+    if (s == "float" || s == "float32")
+        return ply_type::float32;
+    if (s == "double" || s == "float64")
+        return ply_type::float64;
+    return ply_type::invalid;
+}
+
+char const* ply_type_name(ply_type t)
+{
+    switch (t)
+    {
+    case ply_type::int8:
+        return "char";
+    case ply_type::uint8:
+        return "uchar";
+    case ply_type::int16:
+        return "short";
+    case ply_type::uint16:
+        return "ushort";
+    case ply_type::int32:
+        return "int";
+    case ply_type::uint32:
+        return "uint";
+    case ply_type::float32:
+        return "float";
+    case ply_type::float64:
+        return "double";
+    default:
+        return "invalid";
+    }
+}
+
+/// calls f(T()) where T is the C++ type of the ply type
+template <class F>
+void visit_ply_type(ply_type t, F&& f)
+{
+    switch (t)
+    {
+    case ply_type::int8:
+        f(int8_t());
+        break;
+    case ply_type::uint8:
+        f(uint8_t());
+        break;
+    case ply_type::int16:
+        f(int16_t());
+        break;
+    case ply_type::uint16:
+        f(uint16_t());
+        break;
+    case ply_type::int32:
+        f(int32_t());
+        break;
+    case ply_type::uint32:
+        f(uint32_t());
+        break;
+    case ply_type::float32:
+        f(float());
+        break;
+    case ply_type::float64:
+        f(double());
+        break;
+    default:
+        POLYMESH_ASSERT(false && "invalid type");
+        break;
+    }
+}
+
+template <class T>
+ply_type ply_type_of()
+{
+    if constexpr (std::is_same_v<T, int8_t>)
+        return ply_type::int8;
+    else if constexpr (std::is_same_v<T, uint8_t>)
+        return ply_type::uint8;
+    else if constexpr (std::is_same_v<T, int16_t>)
+        return ply_type::int16;
+    else if constexpr (std::is_same_v<T, uint16_t>)
+        return ply_type::uint16;
+    else if constexpr (std::is_same_v<T, int32_t>)
+        return ply_type::int32;
+    else if constexpr (std::is_same_v<T, uint32_t>)
+        return ply_type::uint32;
+    else if constexpr (std::is_same_v<T, float>)
+        return ply_type::float32;
+    else if constexpr (std::is_same_v<T, double>)
+        return ply_type::float64;
+    else
+        return ply_type::invalid;
+}
+
+size_t ply_type_size(ply_type t)
+{
+    auto s = size_t(0);
+    visit_ply_type(t, [&](auto v) { s = sizeof(v); });
+    return s;
+}
+
+/// converts a value stored (in native byte order) at src
+template <class T>
+T ply_value_as(ply_type t, std::byte const* src)
+{
+    T r = T();
+    visit_ply_type(t, [&](auto v) {
+        std::memcpy(&v, src, sizeof(v));
+        r = T(v);
+    });
+    return r;
+}
+
+struct ply_property
+{
+    std::string name;
+    ply_type type = ply_type::invalid;
+    ply_type count_type = ply_type::invalid; ///< only valid for lists
+
+    bool is_list() const { return count_type != ply_type::invalid; }
+};
+
+struct ply_element
+{
+    std::string name;
+    index_value_t count = 0;
+    std::vector<ply_property> properties;
+
+    bool has_lists() const
+    {
+        return std::any_of(properties.begin(), properties.end(), [](ply_property const& p) { return p.is_list(); });
+    }
+};
+
+struct ply_header
+{
+    ply_format format = ply_format::ascii;
+    std::vector<ply_element> elements;
+    size_t data_offset = 0;
+};
+
+bool parse_ply_header(char const* data, size_t size, ply_header& header)
+{
+    auto pos = size_t(0);
+    auto next_line = [&](std::string& line) {
+        if (pos >= size)
+            return false;
+
+        auto nl = static_cast<char const*>(std::memchr(data + pos, '\n', size - pos));
+        auto end = nl ? size_t(nl - data) : size;
+        line.assign(data + pos, end - pos);
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+        pos = nl ? end + 1 : size;
+        return true;
+    };
+
+    std::string line;
+    if (!next_line(line) || line != "ply")
+    {
+        std::cerr << "not a ply file" << std::endl;
+        return false;
+    }
+
+    auto has_format = false;
+    while (next_line(line))
+    {
+        std::istringstream ss(line);
+        std::string keyword;
+        ss >> keyword;
+
+        if (keyword == "format")
+        {
+            std::string format;
+            ss >> format;
+            if (format == "ascii")
+                header.format = ply_format::ascii;
+            else if (format == "binary_little_endian")
+                header.format = ply_format::binary_little_endian;
+            else if (format == "binary_big_endian")
+                header.format = ply_format::binary_big_endian;
+            else
+            {
+                std::cerr << "unknown ply format: " << format << std::endl;
+                return false;
+            }
+            has_format = true;
+        }
+        else if (keyword == "element")
+        {
+            ply_element e;
+            ss >> e.name >> e.count;
+            if (!ss || e.count < 0)
+            {
+                std::cerr << "invalid ply element: " << line << std::endl;
+                return false;
+            }
+            header.elements.push_back(e);
+        }
+        else if (keyword == "property")
+        {
+            if (header.elements.empty())
+            {
+                std::cerr << "ply property without element: " << line << std::endl;
+                return false;
+            }
+
+            ply_property p;
+            std::string type;
+            ss >> type;
+            if (type == "list")
+            {
+                std::string count_type;
+                ss >> count_type >> type;
+                p.count_type = parse_ply_type(count_type);
+                if (p.count_type == ply_type::invalid)
+                {
+                    std::cerr << "invalid ply property: " << line << std::endl;
+                    return false;
+                }
+            }
+            p.type = parse_ply_type(type);
+            ss >> p.name;
+            if (!ss || p.type == ply_type::invalid)
+            {
+                std::cerr << "invalid ply property: " << line << std::endl;
+                return false;
+            }
+            header.elements.back().properties.push_back(p);
+        }
+        else if (keyword == "end_header")
+        {
+            header.data_offset = pos;
+            if (!has_format)
+                std::cerr << "ply file has no format line" << std::endl;
+            return has_format;
+        }
+        else if (keyword == "comment" || keyword == "obj_info" || keyword.empty())
+            continue;
+        else
+        {
+            std::cerr << "unknown ply header line: " << line << std::endl;
+            return false;
+        }
+    }
+
+    std::cerr << "ply header is not terminated by end_header" << std::endl;
+    return false;
+}
+
+/// reads binary values in file byte order
+struct ply_binary_source
+{
+    char const* p;
+    char const* end;
+    bool swap;
+
+    bool read(ply_type t, std::byte* dst)
+    {
+        auto const s = ply_type_size(t);
+        if (size_t(end - p) < s)
+            return false;
+
+        std::memcpy(dst, p, s);
+        p += s;
+        if (swap)
+            std::reverse(dst, dst + s);
+        return true;
+    }
+};
+
+/// reads whitespace-separated ascii values
+struct ply_ascii_source
+{
+    char const* p;
+    char const* end;
+
+    bool read(ply_type t, std::byte* dst)
+    {
+        while (p != end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n'))
+            ++p;
+
+        auto ok = false;
+        visit_ply_type(t, [&](auto v) {
+            auto r = std::from_chars(p, end, v);
+            ok = r.ec == std::errc();
+            p = r.ptr;
+            std::memcpy(dst, &v, sizeof(v));
+        });
+        return ok;
+    }
+};
+
+/// destination of a single property
+struct ply_sink
+{
+    std::byte* data = nullptr;    ///< column storage (value i at data + i * type size)
+    int position_component = -1; ///< 0, 1, 2 for x, y, z
+    bool face_indices = false;
+};
+
+/// reads an element value by value (works for all formats and list properties)
+template <class SourceT, class ScalarT>
+bool read_ply_element(SourceT& src,
+                      ply_element const& e,
+                      std::vector<ply_sink> const& sinks,
+                      std::array<ScalarT, 3>* positions,
+                      std::vector<int>& face_sizes,
+                      std::vector<index_value_t>& indices)
+{
+    std::byte tmp[8];
+    for (index_value_t i = 0; i < e.count; ++i)
+        for (auto pi = 0u; pi < e.properties.size(); ++pi)
+        {
+            auto const& prop = e.properties[pi];
+            auto const& sink = sinks[pi];
+
+            if (prop.is_list())
+            {
+                if (!src.read(prop.count_type, tmp))
+                    return false;
+
+                auto const cnt = ply_value_as<int64_t>(prop.count_type, tmp);
+                if (cnt < 0 || cnt > INT_MAX)
+                    return false;
+
+                if (sink.face_indices)
+                    face_sizes.push_back(int(cnt));
+                for (auto j = 0; j < cnt; ++j)
+                {
+                    if (!src.read(prop.type, tmp))
+                        return false;
+
+                    if (sink.face_indices)
+                    {
+                        auto const idx = ply_value_as<int64_t>(prop.type, tmp);
+                        indices.push_back(idx < 0 || idx > std::numeric_limits<index_value_t>::max() ? -1 : index_value_t(idx));
+                    }
+                }
+            }
+            else
+            {
+                auto const dst = sink.data ? sink.data + size_t(i) * ply_type_size(prop.type) : tmp;
+                if (!src.read(prop.type, dst))
+                    return false;
+
+                if (sink.position_component >= 0)
+                    positions[i][sink.position_component] = ply_value_as<ScalarT>(prop.type, dst);
+            }
+        }
+
+    return true;
+}
+
+/// reads a binary element without list properties column by column
+template <class ScalarT>
+bool read_ply_fixed_element(char const*& p, char const* end, bool swap, ply_element const& e, std::vector<ply_sink> const& sinks, std::array<ScalarT, 3>* positions)
+{
+    auto record_size = size_t(0);
+    for (auto const& prop : e.properties)
+        record_size += ply_type_size(prop.type);
+
+    auto const cnt = size_t(e.count);
+    if (record_size > 0 && size_t(end - p) / record_size < cnt)
+        return false;
+
+    auto offset = size_t(0);
+    for (auto pi = 0u; pi < e.properties.size(); ++pi)
+    {
+        auto const& prop = e.properties[pi];
+        auto const& sink = sinks[pi];
+        auto const s = ply_type_size(prop.type);
+
+        if (sink.data)
+        {
+            for (auto i = size_t(0); i < cnt; ++i)
+                std::memcpy(sink.data + i * s, p + i * record_size + offset, s);
+            if (swap)
+                for (auto i = size_t(0); i < cnt; ++i)
+                    std::reverse(sink.data + i * s, sink.data + (i + 1) * s);
+        }
+
+        if (sink.position_component >= 0)
+            visit_ply_type(prop.type, [&](auto v) {
+                for (auto i = size_t(0); i < cnt; ++i)
+                {
+                    std::memcpy(&v, p + i * record_size + offset, sizeof(v));
+                    if (swap)
+                        std::reverse(reinterpret_cast<std::byte*>(&v), reinterpret_cast<std::byte*>(&v) + sizeof(v));
+                    positions[i][sink.position_component] = ScalarT(v);
+                }
+            });
+
+        offset += s;
+    }
+
+    p += cnt * record_size;
+    return true;
+}
+
+template <class ScalarT>
+bool read_ply_data(char const* data, size_t size, Mesh& mesh, vertex_attribute<std::array<ScalarT, 3>>& position, attribute_collection* attrs)
+{
+    mesh.clear();
+
+    ply_header header;
+    if (!parse_ply_header(data, size, header))
+        return false;
+
+    auto const swap = header.format != ply_format::ascii && (header.format == ply_format::binary_little_endian) != detail::is_native_little_endian();
+
+    // vertices
+    index_value_t v_cnt = 0;
+    for (auto const& e : header.elements)
+        if (e.name == "vertex")
+        {
+            v_cnt = e.count;
+            break;
+        }
+
+    auto ll = low_level_api(mesh);
+    ll.alloc_primitives(v_cnt, 0, 0);
+    for (index_value_t i = 0; i < v_cnt; ++i)
+        ll.outgoing_halfedge_of(vertex_index(i)) = halfedge_index::invalid;
+
+    // read elements
+    struct face_column
+    {
+        std::string name;
+        ply_type type;
+        std::vector<std::byte> data;
+    };
+    std::vector<face_column> face_columns;
+    std::vector<int> face_sizes;
+    std::vector<index_value_t> indices;
+
+    auto p = data + header.data_offset;
+    auto const end = data + size;
+    auto has_vertices = false;
+    auto has_faces = false;
+    for (auto const& e : header.elements)
+    {
+        std::vector<ply_sink> sinks(e.properties.size());
+
+        if (e.name == "vertex" && !has_vertices)
+        {
+            has_vertices = true;
+            for (auto i = 0u; i < e.properties.size(); ++i)
+            {
+                auto const& prop = e.properties[i];
+                if (prop.is_list())
+                    continue;
+
+                if (prop.name == "x" || prop.name == "y" || prop.name == "z")
+                    sinks[i].position_component = prop.name[0] - 'x';
+                else if (attrs)
+                    visit_ply_type(prop.type, [&](auto v) {
+                        auto a = vertex_attribute<decltype(v)>(mesh);
+                        sinks[i].data = reinterpret_cast<std::byte*>(a.data());
+                        (*attrs)[prop.name] = std::move(a); // data pointer stays valid
+                    });
+            }
+        }
+        else if (e.name == "face" && !has_faces)
+        {
+            has_faces = true;
+            face_columns.reserve(e.properties.size());
+            for (auto i = 0u; i < e.properties.size(); ++i)
+            {
+                auto const& prop = e.properties[i];
+                if (prop.is_list())
+                    sinks[i].face_indices = prop.name == "vertex_indices" || prop.name == "vertex_index";
+                else if (attrs)
+                {
+                    face_columns.push_back({prop.name, prop.type, std::vector<std::byte>(size_t(e.count) * ply_type_size(prop.type))});
+                    sinks[i].data = face_columns.back().data.data();
+                }
+            }
+        }
+
+        auto const positions = e.name == "vertex" ? position.data() : nullptr;
+
+        auto ok = true;
+        if (header.format == ply_format::ascii)
+        {
+            ply_ascii_source src = {p, end};
+            ok = read_ply_element(src, e, sinks, positions, face_sizes, indices);
+            p = src.p;
+        }
+        else if (!e.has_lists())
+            ok = read_ply_fixed_element(p, end, swap, e, sinks, positions);
+        else
+        {
+            ply_binary_source src = {p, end, swap};
+            ok = read_ply_element(src, e, sinks, positions, face_sizes, indices);
+            p = src.p;
+        }
+
+        if (!ok)
+        {
+            std::cerr << "ply file is truncated or corrupt (in element '" << e.name << "')" << std::endl;
+            mesh.clear();
+            return false;
+        }
+    }
+
+    // faces (invalid indices are errors)
+    std::vector<int> valid_sizes;
+    std::vector<index_value_t> valid_faces;
+    std::vector<index_value_t> valid_indices;
+    valid_sizes.reserve(face_sizes.size());
+    valid_indices.reserve(indices.size());
+    auto n_error_faces = 0;
+    {
+        index_value_t offset = 0;
+        for (index_value_t f = 0; f < index_value_t(face_sizes.size()); ++f)
+        {
+            auto const s = face_sizes[size_t(f)];
+            auto const valid = s >= 3 && std::all_of(indices.begin() + offset, indices.begin() + offset + s, [&](index_value_t i) { return 0 <= i && i < v_cnt; });
+            if (valid)
+            {
+                valid_sizes.push_back(s);
+                valid_faces.push_back(f);
+                valid_indices.insert(valid_indices.end(), indices.begin() + offset, indices.begin() + offset + s);
+            }
+            else
+                ++n_error_faces;
+            offset += s;
+        }
+    }
+
+    auto const skipped = mesh.build_from_polygons(valid_sizes, valid_indices);
+    n_error_faces += int(skipped.size());
+
+    // face attributes
+    for (auto const& c : face_columns)
+        visit_ply_type(c.type, [&](auto v) {
+            using T = decltype(v);
+            auto a = face_attribute<T>(mesh);
+            auto next_skipped = skipped.begin();
+            index_value_t f = 0;
+            for (index_value_t i = 0; i < index_value_t(valid_faces.size()); ++i)
+            {
+                if (next_skipped != skipped.end() && *next_skipped == i)
+                {
+                    ++next_skipped;
+                    continue;
+                }
+
+                std::memcpy(&a[face_index(f++)], c.data.data() + size_t(valid_faces[size_t(i)]) * sizeof(T), sizeof(T));
+            }
+            (*attrs)[c.name] = std::move(a);
+        });
+
+    if (n_error_faces > 0)
+    {
+        std::cerr << "skipped " << n_error_faces << " face(s) because they are invalid or the mesh would become non-manifold" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/// a scalar attribute that is written as property
+struct ply_column
+{
+    std::string name;
+    ply_type type;
+    std::byte const* data;
+};
+
+template <class tag, class T>
+bool add_ply_column_of_type(std::vector<ply_column>& columns, std::string const& name, primitive_attribute_base<tag> const* a)
+{
+    auto ta = dynamic_cast<typename primitive<tag>::template attribute<T> const*>(a);
+    if (!ta)
+        return false;
+
+    columns.push_back({name, ply_type_of<T>(), reinterpret_cast<std::byte const*>(ta->data())});
+    return true;
+}
+
+template <class tag>
+std::vector<ply_column> ply_columns_of(std::map<std::string, unique_ptr<primitive_attribute_base<tag>>> const& attrs, Mesh const& mesh)
+{
+    std::vector<ply_column> columns;
+    for (auto const& kvp : attrs)
+    {
+        auto const a = kvp.second.get();
+        if (&a->mesh() != &mesh)
+        {
+            std::cerr << "skipping attribute '" << kvp.first << "' because it belongs to a different mesh" << std::endl;
+            continue;
+        }
+
+        auto const ok = add_ply_column_of_type<tag, int8_t>(columns, kvp.first, a) || //
+                        add_ply_column_of_type<tag, uint8_t>(columns, kvp.first, a) || //
+                        add_ply_column_of_type<tag, int16_t>(columns, kvp.first, a) || //
+                        add_ply_column_of_type<tag, uint16_t>(columns, kvp.first, a) || //
+                        add_ply_column_of_type<tag, int32_t>(columns, kvp.first, a) || //
+                        add_ply_column_of_type<tag, uint32_t>(columns, kvp.first, a) || //
+                        add_ply_column_of_type<tag, float>(columns, kvp.first, a) || //
+                        add_ply_column_of_type<tag, double>(columns, kvp.first, a);
+        if (!ok)
+            std::cerr << "skipping attribute '" << kvp.first << "' because it has no scalar ply type" << std::endl;
+    }
+    return columns;
+}
+
+/// appends a value to the data buffer (binary or as ascii text)
+struct ply_writer
+{
+    bool binary;
+    std::vector<char> buffer;
+
+    template <class T>
+    void write(T v)
+    {
+        if (binary)
+        {
+            auto const s = buffer.size();
+            buffer.resize(s + sizeof(v));
+            std::memcpy(buffer.data() + s, &v, sizeof(v));
+        }
+        else
+        {
+            char tmp[64];
+            auto r = std::to_chars(tmp, tmp + sizeof(tmp), std::conditional_t<sizeof(T) == 1, int, T>(v));
+            buffer.insert(buffer.end(), tmp, r.ptr);
+        }
+    }
+
+    void write(ply_type t, std::byte const* src)
+    {
+        visit_ply_type(t, [&](auto v) {
+            std::memcpy(&v, src, sizeof(v));
+            write(v);
+        });
+    }
+
+    void separator()
+    {
+        if (!binary)
+            buffer.push_back(' ');
+    }
+    void end_line()
+    {
+        if (!binary)
+            buffer.back() = '\n';
+    }
+
+    void flush_to(std::ostream& out, size_t threshold)
+    {
+        if (buffer.size() < threshold)
+            return;
+        out.write(buffer.data(), std::streamsize(buffer.size()));
+        buffer.clear();
+    }
+};
+}
+
+template <class ScalarT>
+bool write_ply(std::string const& filename, vertex_attribute<std::array<ScalarT, 3>> const& position, attribute_collection const* attrs, bool binary)
+{
+    std::ofstream file(filename, std::ios_base::binary);
+    if (!file.good())
+    {
+        std::cerr << "could not open " << filename << " for writing" << std::endl;
+        return false;
+    }
+
+    write_ply(file, position, attrs, binary);
+    return file.good();
+}
+
+template <class ScalarT>
+void write_ply(std::ostream& out, vertex_attribute<std::array<ScalarT, 3>> const& position, attribute_collection const* attrs, bool binary)
+{
+    auto const& mesh = position.mesh();
+
+    std::vector<ply_column> v_columns;
+    std::vector<ply_column> f_columns;
+    if (attrs)
+    {
+        v_columns = ply_columns_of(attrs->vertex_attributes(), mesh);
+        f_columns = ply_columns_of(attrs->face_attributes(), mesh);
+    }
+
+    index_value_t max_face_size = 0;
+    for (auto f : mesh.faces())
+        max_face_size = std::max(max_face_size, f.vertices().size());
+    auto const count_type = max_face_size <= 255 ? ply_type::uint8 : ply_type::int32;
+
+    // header
+    out << "ply\n";
+    if (binary)
+        out << "format " << (detail::is_native_little_endian() ? "binary_little_endian" : "binary_big_endian") << " 1.0\n";
+    else
+        out << "format ascii 1.0\n";
+    out << "comment written by polymesh\n";
+    out << "element vertex " << mesh.all_vertices().size() << "\n";
+    for (auto c : {"x", "y", "z"})
+        out << "property " << ply_type_name(ply_type_of<ScalarT>()) << " " << c << "\n";
+    for (auto const& c : v_columns)
+        out << "property " << ply_type_name(c.type) << " " << c.name << "\n";
+    out << "element face " << mesh.faces().size() << "\n";
+    out << "property list " << ply_type_name(count_type) << " int vertex_indices\n";
+    for (auto const& c : f_columns)
+        out << "property " << ply_type_name(c.type) << " " << c.name << "\n";
+    out << "end_header\n";
+
+    // data (written in blocks)
+    auto const block_size = size_t(1) << 20;
+    ply_writer w = {binary, {}};
+    w.buffer.reserve(block_size + 1024);
+
+    for (auto v : mesh.all_vertices())
+    {
+        auto const& p = position[v];
+        for (auto i = 0; i < 3; ++i)
+        {
+            w.write(p[i]);
+            w.separator();
+        }
+        for (auto const& c : v_columns)
+        {
+            w.write(c.type, c.data + size_t(v.idx.value) * ply_type_size(c.type));
+            w.separator();
+        }
+        w.end_line();
+        w.flush_to(out, block_size);
+    }
+
+    for (auto f : mesh.faces())
+    {
+        auto const cnt = f.vertices().size();
+        if (count_type == ply_type::uint8)
+            w.write(uint8_t(cnt));
+        else
+            w.write(int32_t(cnt));
+        w.separator();
+        for (auto v : f.vertices())
+        {
+            w.write(int32_t(v.idx.value));
+            w.separator();
+        }
+        for (auto const& c : f_columns)
+        {
+            w.write(c.type, c.data + size_t(f.idx.value) * ply_type_size(c.type));
+            w.separator();
+        }
+        w.end_line();
+        w.flush_to(out, block_size);
+    }
+
+    w.flush_to(out, 0);
+}
+
+template <class ScalarT>
+bool read_ply(std::string const& filename, Mesh& mesh, vertex_attribute<std::array<ScalarT, 3>>& position, attribute_collection* attrs)
+{
+    detail::mapped_file file(filename);
+    if (!file.is_valid())
+    {
+        std::cerr << "Cannot read from file `" << filename << "'" << std::endl;
+        return false;
+    }
+
+    return read_ply_data(file.chars(), file.size(), mesh, position, attrs);
+}
+
+template <class ScalarT>
+bool read_ply(std::istream& input, Mesh& mesh, vertex_attribute<std::array<ScalarT, 3>>& position, attribute_collection* attrs)
+{
+    auto const content = std::string(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+    return read_ply_data(content.data(), content.size(), mesh, position, attrs);
+}
+
+template bool write_ply<float>(std::string const& filename, vertex_attribute<std::array<float, 3>> const& position, attribute_collection const* attrs, bool binary);
+template void write_ply<float>(std::ostream& out, vertex_attribute<std::array<float, 3>> const& position, attribute_collection const* attrs, bool binary);
+template bool read_ply<float>(std::string const& filename, Mesh& mesh, vertex_attribute<std::array<float, 3>>& position, attribute_collection* attrs);
+template bool read_ply<float>(std::istream& input, Mesh& mesh, vertex_attribute<std::array<float, 3>>& position, attribute_collection* attrs);
+
+template bool write_ply<double>(std::string const& filename, vertex_attribute<std::array<double, 3>> const& position, attribute_collection const* attrs, bool binary);
+template void write_ply<double>(std::ostream& out, vertex_attribute<std::array<double, 3>> const& position, attribute_collection const* attrs, bool binary);
+template bool read_ply<double>(std::string const& filename, Mesh& mesh, vertex_attribute<std::array<double, 3>>& position, attribute_collection* attrs);
+template bool read_ply<double>(std::istream& input, Mesh& mesh, vertex_attribute<std::array<double, 3>>& position, attribute_collection* attrs);
+} // namespace polymesh
@@ -1,15 +1,32 @@
 #pragma once
 
+#include <array>
 #include <iosfwd>
 #include <string>
 
 #include <polymesh/Mesh.hh>
+#include <polymesh/ext/attribute_collection.hh>
 
 namespace polymesh
 {
-// TODO
-// void write_ply(std::string const& filename, Mesh const& mesh, vertex_attribute<glm::vec3> const& position);
-// void write_ply(std::ostream& out, Mesh const& mesh, vertex_attribute<glm::vec3> const& position);
-// bool read_off(std::string const& filename, Mesh& mesh, vertex_attribute<glm::vec3>& position);
-// bool read_off(std::istream& input, Mesh& mesh, vertex_attribute<glm::vec3>& position);
-}
+/// Writes a ply file (binary in native byte order or ascii)
+/// Writes all vertices (including removed ones) and all valid faces
+/// If attrs is given, all vertex and face attributes of scalar type (int8_t ... uint32_t, float, double) are written as properties
+template <class ScalarT>
+bool write_ply(std::string const& filename, vertex_attribute<std::array<ScalarT, 3>> const& position, attribute_collection const* attrs = nullptr, bool binary = true);
+template <class ScalarT>
+void write_ply(std::ostream& out, vertex_attribute<std::array<ScalarT, 3>> const& position, attribute_collection const* attrs = nullptr, bool binary = true);
+
+/// Reads a ply file (ascii, binary_little_endian, or binary_big_endian)
+/// Positions are read from the "x", "y", "z" vertex properties
+/// Faces are read from the "vertex_indices" (or "vertex_index") list property and added via Mesh::build_from_polygons
+/// If attrs is given, all other non-list vertex and face properties are added as typed attributes named after the property
+///   (e.g. attrs["red"].vertex<uint8_t>() or attrs["confidence"].vertex<float>())
+/// Other elements and list properties are skipped
+/// Binary payloads are read in bulk (property columns are copied with a fixed stride if an element has no list properties)
+/// Returns false if the file could not be read or if any face was skipped (e.g. because it would be non-manifold)
+template <class ScalarT>
+bool read_ply(std::string const& filename, Mesh& mesh, vertex_attribute<std::array<ScalarT, 3>>& position, attribute_collection* attrs = nullptr);
+template <class ScalarT>
+bool read_ply(std::istream& input, Mesh& mesh, vertex_attribute<std::array<ScalarT, 3>>& position, attribute_collection* attrs = nullptr);
+} // namespace polymesh
@@ -0,0 +1,419 @@
+#include "pm.hh"
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+#include <polymesh/detail/mapped_file.hh>
+
+/*
+    header (128 bytes)
+        CHAR[8]   - magic "POLYMESH"
+        UINT32    - version
+        UINT32    - byte order mark (0x01020304 in writer byte order)
+        UINT32    - size of an index in bytes (4, or 8 with POLYMESH_INDEX_64, files are only read with the same size)
+        UINT32    - number of sections
+        INT64[3]  - number of vertices, faces, halfedges (including removed ones)
+        INT64[3]  - number of removed vertices, faces, halfedges
+        UINT64    - offset of section table
+        CHAR[48]  - reserved
+
+    section table (40 bytes per section)
+        UINT32    - kind (see section_kind)
+        UINT32    - stride (bytes per element)
+        UINT64    - offset of data (64 byte aligned)
+        UINT64    - size of data in bytes
+        UINT64    - offset of name
+        UINT32    - size of name
+        UINT32    - reserved
+
+    names, data (each data block starts at a 64 byte aligned offset)
+ */
+
+namespace polymesh
+{
+namespace
+{
+constexpr char pm_magic[8] = {'P', 'O', 'L', 'Y', 'M', 'E', 'S', 'H'};
+constexpr uint32_t pm_version = 1;
+constexpr uint32_t pm_byte_order_mark = 0x01020304;
+constexpr uint64_t pm_alignment = 64;
+
+enum class section_kind : uint32_t
+{
+    vertex_to_outgoing_halfedge = 0,
+    face_to_halfedge = 1,
+    halfedge_to_vertex = 2,
+    halfedge_to_face = 3,
+    halfedge_to_next_halfedge = 4,
+    halfedge_to_prev_halfedge = 5,
+
+    vertex_attribute = 6,
+    face_attribute = 7,
+    edge_attribute = 8,
+    halfedge_attribute = 9,
+};
+
+struct pm_header
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order_mark;
+    uint32_t index_size;
+    uint32_t section_count;
+    int64_t vertex_count;
+    int64_t face_count;
+    int64_t halfedge_count;
+    int64_t removed_vertex_count;
+    int64_t removed_face_count;
+    int64_t removed_halfedge_count;
+    uint64_t section_table_offset;
+    char reserved[48];
+};
+static_assert(sizeof(pm_header) == 128, "unexpected header layout");
+
+struct pm_section
+{
+    uint32_t kind;
+    uint32_t stride;
+    uint64_t offset;
+    uint64_t byte_size;
+    uint64_t name_offset;
+    uint32_t name_size;
+    uint32_t reserved;
+};
+static_assert(sizeof(pm_section) == 40, "unexpected section layout");
+
+uint64_t align_up(uint64_t offset) { return (offset + pm_alignment - 1) / pm_alignment * pm_alignment; }
+
+struct section_data
+{
+    section_kind kind;
+    uint32_t stride;
+    std::byte const* data;
+    uint64_t byte_size;
+    std::string const* name; // nullptr for topology
+};
+
+template <class tag>
+void add_attribute_sections(std::vector<section_data>& sections,
+                            section_kind kind,
+                            std::map<std::string, unique_ptr<primitive_attribute_base<tag>>> const& attrs,
+                            Mesh const& mesh)
+{
+    for (auto const& kvp : attrs)
+    {
+        auto const& a = *kvp.second.get();
+        if (&a.mesh() != &mesh)
+        {
+            std::cerr << "skipping attribute '" << kvp.first << "' because it belongs to a different mesh" << std::endl;
+            continue;
+        }
+        if (a.raw_stride() == 0)
+        {
+            std::cerr << "skipping attribute '" << kvp.first << "' because it is not trivially copyable" << std::endl;
+            continue;
+        }
+        if (a.raw_stride() > UINT32_MAX)
+        {
+            std::cerr << "skipping attribute '" << kvp.first << "' because of unsupported element size" << std::endl;
+            continue;
+        }
+
+        auto const byte_size = uint64_t(primitive<tag>::all_size(mesh)) * a.raw_stride();
+        sections.push_back({kind, uint32_t(a.raw_stride()), a.raw_data_ptr(), byte_size, &kvp.first});
+    }
+}
+
+template <class tag>
+bool read_attribute_section(Mesh& mesh, attribute_collection& attrs, std::string const& name, pm_section const& s, std::byte const* data)
+{
+    if (s.stride > uint32_t(std::numeric_limits<int>::max()) || uint64_t(primitive<tag>::all_size(mesh)) * s.stride != s.byte_size)
+    {
+        std::cerr << "attribute '" << name << "' has an invalid size" << std::endl;
+        return false;
+    }
+
+    auto a = raw_primitive_attribute<tag>(mesh, int(s.stride));
+
+    if (s.byte_size > 0)
+        std::memcpy(a.data_ptr(), data + s.offset, s.byte_size);
+
+    attrs[name] = std::move(a);
+    return true;
+}
+}
+
+bool write_pm(std::string const& filename, Mesh const& mesh, attribute_collection const& attrs)
+{
+    auto ll = low_level_api(mesh);
+
+    auto const v_cnt = mesh.all_vertices().size();
+    auto const f_cnt = mesh.all_faces().size();
+    auto const h_cnt = mesh.all_halfedges().size();
+
+    std::vector<section_data> sections;
+    auto add_topology = [&](section_kind kind, index_value_t cnt, auto get_first) {
+        auto data = cnt > 0 ? reinterpret_cast<std::byte const*>(&get_first()) : nullptr;
+        sections.push_back({kind, uint32_t(sizeof(index_value_t)), data, size_t(cnt) * sizeof(index_value_t), nullptr});
+    };
+
+    add_topology(section_kind::vertex_to_outgoing_halfedge, v_cnt, [&]() -> auto const& { return ll.outgoing_halfedge_of(vertex_index(0)); });
+    add_topology(section_kind::face_to_halfedge, f_cnt, [&]() -> auto const& { return ll.halfedge_of(face_index(0)); });
+    add_topology(section_kind::halfedge_to_vertex, h_cnt, [&]() -> auto const& { return ll.to_vertex_of(halfedge_index(0)); });
+    add_topology(section_kind::halfedge_to_face, h_cnt, [&]() -> auto const& { return ll.face_of(halfedge_index(0)); });
+    add_topology(section_kind::halfedge_to_next_halfedge, h_cnt, [&]() -> auto const& { return ll.next_halfedge_of(halfedge_index(0)); });
+    add_topology(section_kind::halfedge_to_prev_halfedge, h_cnt, [&]() -> auto const& { return ll.prev_halfedge_of(halfedge_index(0)); });
+
+    add_attribute_sections(sections, section_kind::vertex_attribute, attrs.vertex_attributes(), mesh);
+    add_attribute_sections(sections, section_kind::face_attribute, attrs.face_attributes(), mesh);
+    add_attribute_sections(sections, section_kind::edge_attribute, attrs.edge_attributes(), mesh);
+    add_attribute_sections(sections, section_kind::halfedge_attribute, attrs.halfedge_attributes(), mesh);
+
+    // layout: header, section table, names, data
+    pm_header header = {};
+    std::memcpy(header.magic, pm_magic, sizeof(pm_magic));
+    header.version = pm_version;
+    header.byte_order_mark = pm_byte_order_mark;
+    header.index_size = sizeof(index_value_t);
+    header.section_count = uint32_t(sections.size());
+    header.vertex_count = int64_t(v_cnt);
+    header.face_count = int64_t(f_cnt);
+    header.halfedge_count = int64_t(h_cnt);
+    header.removed_vertex_count = int64_t(ll.size_removed_vertices());
+    header.removed_face_count = int64_t(ll.size_removed_faces());
+    header.removed_halfedge_count = int64_t(ll.size_removed_halfedges());
+    header.section_table_offset = sizeof(pm_header);
+
+    std::vector<pm_section> table(sections.size());
+    auto offset = uint64_t(sizeof(pm_header) + sections.size() * sizeof(pm_section));
+    for (auto i = 0u; i < sections.size(); ++i)
+    {
+        auto const& s = sections[i];
+        table[i] = {};
+        table[i].kind = uint32_t(s.kind);
+        table[i].stride = s.stride;
+        table[i].byte_size = s.byte_size;
+        if (s.name)
+        {
+            table[i].name_offset = offset;
+            table[i].name_size = uint32_t(s.name->size());
+            offset += s.name->size();
+        }
+    }
+    for (auto& s : table)
+    {
+        offset = align_up(offset);
+        s.offset = offset;
+        offset += s.byte_size;
+    }
+
+    std::ofstream file(filename, std::ios_base::binary);
+    if (!file.good())
+    {
+        std::cerr << "could not open " << filename << " for writing" << std::endl;
+        return false;
+    }
+
+    auto pos = uint64_t(0);
+    auto write = [&](void const* data, uint64_t size) {
+        file.write(static_cast<char const*>(data), std::streamsize(size));
+        pos += size;
+    };
+
+    write(&header, sizeof(header));
+    write(table.data(), table.size() * sizeof(pm_section));
+    for (auto const& s : sections)
+        if (s.name)
+            write(s.name->data(), s.name->size());
+
+    char const padding[pm_alignment] = {};
+    for (auto i = 0u; i < sections.size(); ++i)
+    {
+        write(padding, table[i].offset - pos);
+        if (table[i].byte_size > 0)
+            write(sections[i].data, table[i].byte_size);
+    }
+
+    if (!file.good())
+    {
+        std::cerr << "error while writing " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool read_pm(std::string const& filename, Mesh& mesh, attribute_collection& attrs)
+{
+    mesh.clear();
+
+    detail::mapped_file file(filename);
+    if (!file.is_valid())
+    {
+        std::cerr << "could not open " << filename << std::endl;
+        return false;
+    }
+
+    auto const data = file.data();
+    auto const size = uint64_t(file.size());
+
+    pm_header header;
+    if (size < sizeof(header))
+    {
+        std::cerr << filename << " is not a polymesh file (too small)" << std::endl;
+        return false;
+    }
+    std::memcpy(&header, data, sizeof(header));
+
+    if (std::memcmp(header.magic, pm_magic, sizeof(pm_magic)) != 0)
+    {
+        std::cerr << filename << " is not a polymesh file" << std::endl;
+        return false;
+    }
+    if (header.version != pm_version)
+    {
+        std::cerr << "unsupported polymesh file version " << header.version << " (of " << filename << ")" << std::endl;
+        return false;
+    }
+    if (header.byte_order_mark != pm_byte_order_mark || header.index_size != sizeof(index_value_t))
+    {
+        std::cerr << filename << " was written on an incompatible platform" << std::endl;
+        return false;
+    }
+    auto const valid_count = [](int64_t cnt, int64_t removed_cnt) {
+        return 0 <= cnt && cnt <= int64_t(std::numeric_limits<index_value_t>::max()) && 0 <= removed_cnt && removed_cnt <= cnt;
+    };
+    if (!valid_count(header.vertex_count, header.removed_vertex_count) || !valid_count(header.face_count, header.removed_face_count)
+        || !valid_count(header.halfedge_count, header.removed_halfedge_count) || header.halfedge_count % 2 != 0)
+    {
+        std::cerr << filename << " has invalid primitive counts" << std::endl;
+        return false;
+    }
+    if (header.section_table_offset > size || (size - header.section_table_offset) / sizeof(pm_section) < header.section_count)
+    {
+        std::cerr << filename << " is truncated" << std::endl;
+        return false;
+    }
+
+    std::vector<pm_section> table(header.section_count);
+    if (!table.empty())
+        std::memcpy(table.data(), data + header.section_table_offset, table.size() * sizeof(pm_section));
+
+    for (auto const& s : table)
+        if (s.offset > size || s.byte_size > size - s.offset || s.name_offset > size || s.name_size > size - s.name_offset)
+        {
+            std::cerr << filename << " is truncated" << std::endl;
+            return false;
+        }
+
+    // topology
+    auto ll = low_level_api(mesh);
+    auto const v_cnt = index_value_t(header.vertex_count);
+    auto const f_cnt = index_value_t(header.face_count);
+    auto const h_cnt = index_value_t(header.halfedge_count);
+    ll.alloc_primitives(v_cnt, f_cnt, h_cnt);
+
+    auto read_topology = [&](section_kind kind, auto& first, index_value_t cnt) {
+        for (auto const& s : table)
+            if (s.kind == uint32_t(kind))
+            {
+                if (s.stride != sizeof(index_value_t) || s.byte_size != size_t(cnt) * sizeof(index_value_t))
+                    return false;
+                if (cnt > 0)
+                    std::memcpy(&first, data + s.offset, s.byte_size);
+                return true;
+            }
+        return false;
+    };
+
+    auto topology_ok = true;
+    if (v_cnt > 0)
+        topology_ok &= read_topology(section_kind::vertex_to_outgoing_halfedge, ll.outgoing_halfedge_of(vertex_index(0)), v_cnt);
+    if (f_cnt > 0)
+        topology_ok &= read_topology(section_kind::face_to_halfedge, ll.halfedge_of(face_index(0)), f_cnt);
+    if (h_cnt > 0)
+    {
+        topology_ok &= read_topology(section_kind::halfedge_to_vertex, ll.to_vertex_of(halfedge_index(0)), h_cnt);
+        topology_ok &= read_topology(section_kind::halfedge_to_face, ll.face_of(halfedge_index(0)), h_cnt);
+        topology_ok &= read_topology(section_kind::halfedge_to_next_halfedge, ll.next_halfedge_of(halfedge_index(0)), h_cnt);
+        topology_ok &= read_topology(section_kind::halfedge_to_prev_halfedge, ll.prev_halfedge_of(halfedge_index(0)), h_cnt);
+    }
+    if (!topology_ok)
+    {
+        std::cerr << filename << " has missing or invalid topology sections" << std::endl;
+        mesh.clear();
+        return false;
+    }
+
+    ll.set_removed_counts(index_value_t(header.removed_vertex_count), index_value_t(header.removed_face_count), index_value_t(header.removed_halfedge_count / 2));
+
+    // attributes
+    auto ok = true;
+    for (auto const& s : table)
+    {
+        auto const name = std::string(reinterpret_cast<char const*>(data + s.name_offset), s.name_size);
+        if (s.stride == 0 && s.kind >= uint32_t(section_kind::vertex_attribute))
+        {
+            std::cerr << "attribute '" << name << "' has an invalid stride" << std::endl;
+            ok = false;
+            continue;
+        }
+
+        switch (section_kind(s.kind))
+        {
+        case section_kind::vertex_attribute:
+            ok &= read_attribute_section<vertex_tag>(mesh, attrs, name, s, data);
+            break;
+        case section_kind::face_attribute:
+            ok &= read_attribute_section<face_tag>(mesh, attrs, name, s, data);
+            break;
+        case section_kind::edge_attribute:
+            ok &= read_attribute_section<edge_tag>(mesh, attrs, name, s, data);
+            break;
+        case section_kind::halfedge_attribute:
+            ok &= read_attribute_section<halfedge_tag>(mesh, attrs, name, s, data);
+            break;
+        default:
+            break; // topology or unknown (newer minor additions are skipped)
+        }
+    }
+
+    return ok;
+}
+
+template <class ScalarT>
+bool write_pm(std::string const& filename, vertex_attribute<std::array<ScalarT, 3>> const& position)
+{
+    attribute_collection attrs;
+    attrs["position"] = position;
+    return write_pm(filename, position.mesh(), attrs);
+}
+
+template <class ScalarT>
+bool read_pm(std::string const& filename, Mesh& mesh, vertex_attribute<std::array<ScalarT, 3>>& position)
+{
+    attribute_collection attrs;
+    if (!read_pm(filename, mesh, attrs))
+        return false;
+
+    auto const& vattrs = attrs.vertex_attributes();
+    auto it = vattrs.find("position");
+    if (it == vattrs.end() || it->second.get()->raw_stride() != sizeof(std::array<ScalarT, 3>))
+    {
+        std::cerr << filename << " has no compatible 'position' attribute" << std::endl;
+        return false;
+    }
+
+    position = attrs["position"].vertex<std::array<ScalarT, 3>>();
+    return true;
+}
+
+template bool write_pm<float>(std::string const& filename, vertex_attribute<std::array<float, 3>> const& position);
+template bool read_pm<float>(std::string const& filename, Mesh& mesh, vertex_attribute<std::array<float, 3>>& position);
+
+template bool write_pm<double>(std::string const& filename, vertex_attribute<std::array<double, 3>> const& position);
+template bool read_pm<double>(std::string const& filename, Mesh& mesh, vertex_attribute<std::array<double, 3>>& position);
+} // namespace polymesh
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <array>
+#include <string>
+
+#include <polymesh/Mesh.hh>
+#include <polymesh/ext/attribute_collection.hh>
+
+namespace polymesh
+{
+/// Native binary polymesh format (*.pm)
+///
+/// Stores the topology arrays (including removed primitives) and all named attributes of an attribute collection
+/// as 64 byte aligned sections of raw bytes.
+/// Loading memory-maps the file and copies each section with a single memcpy,
+/// i.e. there is no parsing and no face insertion.
+///
+/// NOTE: data is stored in native byte order and memory layout (files are only portable between compatible platforms)
+///       attributes that are not trivially copyable are skipped
+///       attributes are loaded as raw attributes and converted on first typed access, e.g. attrs["position"].vertex<tg::pos3>()
+bool write_pm(std::string const& filename, Mesh const& mesh, attribute_collection const& attrs);
+/// clears the mesh before loading, attributes are added to attrs (replacing existing ones with the same name)
+bool read_pm(std::string const& filename, Mesh& mesh, attribute_collection& attrs);
+
+/// convenience versions that only store the positions (as "position" attribute)
+template <class ScalarT>
+bool write_pm(std::string const& filename, vertex_attribute<std::array<ScalarT, 3>> const& position);
+template <class ScalarT>
+bool read_pm(std::string const& filename, Mesh& mesh, vertex_attribute<std::array<ScalarT, 3>>& position);
+} // namespace polymesh
@@ -1,9 +1,16 @@
 #include "stl.hh"
 
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <fstream>
 #include <iostream>
+#include <limits>
 #include <sstream>
+#include <vector>
+
+#include <polymesh/detail/mapped_file.hh>
+#include <polymesh/parallel.hh>
 
 /*
     UINT8[80] – Header
@@ -33,7 +40,7 @@ void write_stl_binary(std::ostream& out, vertex_attribute<std::array<ScalarT, 3>
     auto const& mesh = position.mesh();
 
     char header[80] = {};
-    uint32_t n_triangles = mesh.faces().size();
+    auto const n_triangles = uint32_t(mesh.faces().size());
 
     out.write(header, sizeof(header));
     out.write((char const*)&n_triangles, sizeof(n_triangles));
@@ -174,11 +181,10 @@ static ScalarT read_real_with_nan(std::istream& input)
     return f;
 }
 
+/// parses an ascii stl into three positions per triangle and one normal per triangle
 template <class ScalarT>
-bool read_stl_ascii(std::istream& input, Mesh& mesh, vertex_attribute<std::array<ScalarT, 3>>& position, face_attribute<std::array<ScalarT, 3>>* normals)
+static bool parse_stl_ascii(std::istream& input, std::vector<std::array<ScalarT, 3>>& corners, std::vector<std::array<ScalarT, 3>>& face_normals)
 {
-    mesh.clear();
-
     std::string s;
     input >> s;
 
@@ -198,19 +204,13 @@ bool read_stl_ascii(std::istream& input, Mesh& mesh, vertex_attribute<std::array
     {
         POLYMESH_ASSERT(s == "facet" || s == "faced");
 
-        vertex_handle v[3];
-        v[0] = mesh.vertices().add();
-        v[1] = mesh.vertices().add();
-        v[2] = mesh.vertices().add();
-        auto f = mesh.faces().add(v);
-
         input >> s;
         POLYMESH_ASSERT(s == "normal");
         std::array<ScalarT, 3> n;
         n[0] = read_real_with_nan<ScalarT>(input);
         n[1] = read_real_with_nan<ScalarT>(input);
         n[2] = read_real_with_nan<ScalarT>(input);
-        f[normals] = n;
+        face_normals.push_back(n);
 
         input >> s;
         POLYMESH_ASSERT(s == "outer");
@@ -225,7 +225,7 @@ bool read_stl_ascii(std::istream& input, Mesh& mesh, vertex_attribute<std::array
             p[0] = read_real_with_nan<ScalarT>(input);
             p[1] = read_real_with_nan<ScalarT>(input);
             p[2] = read_real_with_nan<ScalarT>(input);
-            position[v[i]] = p;
+            corners.push_back(p);
         }
 
         input >> s;
@@ -240,6 +240,276 @@ bool read_stl_ascii(std::istream& input, Mesh& mesh, vertex_attribute<std::array
     return true;
 }
 
+template <class ScalarT>
+bool read_stl_ascii(std::istream& input, Mesh& mesh, vertex_attribute<std::array<ScalarT, 3>>& position, face_attribute<std::array<ScalarT, 3>>* normals)
+{
+    mesh.clear();
+
+    std::vector<std::array<ScalarT, 3>> corners;
+    std::vector<std::array<ScalarT, 3>> face_normals;
+    if (!parse_stl_ascii(input, corners, face_normals))
+        return false;
+
+    for (auto i = 0u; i < face_normals.size(); ++i)
+    {
+        vertex_handle v[3];
+        v[0] = mesh.vertices().add();
+        v[1] = mesh.vertices().add();
+        v[2] = mesh.vertices().add();
+        auto f = mesh.faces().add(v);
+
+        f[normals] = face_normals[i];
+        for (auto j = 0; j < 3; ++j)
+            position[v[j]] = corners[i * 3 + j];
+    }
+
+    return true;
+}
+
+namespace
+{
+/// bitwise key of a position (-0 and +0 are considered equal)
+template <class T>
+std::array<T, 3> weld_key(std::array<T, 3> p)
+{
+    for (auto& v : p)
+        if (v == T(0))
+            v = T(0);
+    return p;
+}
+
+template <class T>
+uint32_t weld_hash(std::array<T, 3> const& p)
+{
+    uint64_t h = 0;
+    for (auto const& v : p)
+    {
+        uint64_t bits = 0;
+        std::memcpy(&bits, &v, sizeof(v));
+        h = (h ^ bits) * 0x9E3779B97F4A7C15ull;
+        h ^= h >> 29;
+    }
+    return uint32_t(h ^ (h >> 32));
+}
+
+/// welds corners with equal (weld_key) positions
+/// afterwards, vertex_of[c] is the vertex of corner c (vertices are numbered in order of first appearance)
+/// returns the first corner of each vertex
+///
+/// the hash table is partitioned by hash value so that partitions can be processed in parallel
+template <class PosF>
+std::vector<index_value_t> weld_corners(executor const& exec, index_value_t corner_cnt, PosF&& pos_of, std::vector<index_value_t>& vertex_of)
+{
+    auto key_of = [&](index_value_t c) { return weld_key(pos_of(c)); };
+
+    std::vector<uint32_t> hashes(corner_cnt);
+    detail::parallel_for(exec, corner_cnt, [&](index_value_t c) { hashes[c] = weld_hash(key_of(c)); });
+
+    // vertex_of[c] = first corner with the same key
+    vertex_of.resize(corner_cnt);
+    auto const partition_cnt = exec.is_sequential() ? 1 : int(std::max(index_value_t(1), std::min(index_value_t(exec.concurrency()), corner_cnt >> 16)));
+    exec.run(partition_cnt, [&](int p) {
+        auto in_partition = [&](uint32_t h) { return int(uint64_t(h) * partition_cnt >> 32) == p; };
+
+        auto cnt = size_t(0);
+        for (auto h : hashes)
+            cnt += in_partition(h);
+
+        // open addressing with linear probing, at most 2/3 full
+        struct entry
+        {
+            uint32_t hash;
+            index_value_t corner;
+        };
+        auto capacity = size_t(16);
+        while (capacity < cnt + cnt / 2 + 1)
+            capacity *= 2;
+        auto const mask = capacity - 1;
+        std::vector<entry> table(capacity, {0, -1});
+
+        for (index_value_t c = 0; c < corner_cnt; ++c)
+        {
+            auto const h = hashes[c];
+            if (!in_partition(h))
+                continue;
+
+            auto const key = key_of(c);
+            for (auto i = h & mask;; i = (i + 1) & mask)
+            {
+                auto& e = table[i];
+                if (e.corner < 0)
+                {
+                    e = {h, c};
+                    vertex_of[c] = c;
+                    break;
+                }
+
+                if (e.hash == h)
+                {
+                    auto const other_key = key_of(e.corner);
+                    if (std::memcmp(&key, &other_key, sizeof(key)) == 0)
+                    {
+                        vertex_of[c] = e.corner;
+                        break;
+                    }
+                }
+            }
+        }
+    });
+
+    // number vertices in order of first appearance
+    // first corners are temporarily encoded as -(vertex + 1)
+    auto const chunk_cnt = detail::chunk_count(exec, corner_cnt);
+    std::vector<index_value_t> chunk_offsets(chunk_cnt + 1, 0);
+    detail::parallel_chunks(exec, corner_cnt, [&](int chunk, index_value_t begin, index_value_t end) {
+        index_value_t cnt = 0;
+        for (auto c = begin; c < end; ++c)
+            cnt += vertex_of[c] == c;
+        chunk_offsets[chunk + 1] = cnt;
+    });
+    for (auto i = 0; i < chunk_cnt; ++i)
+        chunk_offsets[i + 1] += chunk_offsets[i];
+
+    std::vector<index_value_t> first_corners(chunk_offsets.back());
+    detail::parallel_chunks(exec, corner_cnt, [&](int chunk, index_value_t begin, index_value_t end) {
+        auto v = chunk_offsets[chunk];
+        for (auto c = begin; c < end; ++c)
+            if (vertex_of[c] == c)
+            {
+                first_corners[v] = c;
+                vertex_of[c] = -(v + 1);
+                ++v;
+            }
+    });
+    detail::parallel_for(exec, corner_cnt, [&](index_value_t c) {
+        if (vertex_of[c] >= 0)
+            vertex_of[c] = -(vertex_of[vertex_of[c]] + 1);
+    });
+    detail::parallel_for(exec, index_value_t(first_corners.size()), [&](index_value_t v) { vertex_of[first_corners[v]] = v; });
+
+    return first_corners;
+}
+
+/// creates the vertices and triangles of a welded triangle soup
+/// returns false if any triangle had to be skipped
+template <class ScalarT, class PosF, class NormalF>
+bool build_welded(executor const& exec,
+                  index_value_t triangle_cnt,
+                  PosF&& pos_of,
+                  NormalF&& normal_of,
+                  Mesh& mesh,
+                  vertex_attribute<std::array<ScalarT, 3>>& position,
+                  face_attribute<std::array<ScalarT, 3>>* normals)
+{
+    std::vector<index_value_t> vertex_of;
+    auto const first_corners = weld_corners(exec, triangle_cnt * 3, pos_of, vertex_of);
+
+    auto const v_cnt = index_value_t(first_corners.size());
+    auto ll = low_level_api(mesh);
+    ll.alloc_primitives(v_cnt, 0, 0);
+    detail::parallel_for(exec, v_cnt, [&](index_value_t v) {
+        ll.outgoing_halfedge_of(vertex_index(v)) = halfedge_index::invalid;
+        auto const p = pos_of(first_corners[v]);
+        position[vertex_index(v)] = {ScalarT(p[0]), ScalarT(p[1]), ScalarT(p[2])};
+    });
+
+    auto const skipped = mesh.build_from_triangles(vertex_of);
+
+    if (normals)
+    {
+        auto next_skipped = skipped.begin();
+        index_value_t f = 0;
+        for (index_value_t t = 0; t < triangle_cnt; ++t)
+        {
+            if (next_skipped != skipped.end() && *next_skipped == t)
+            {
+                ++next_skipped;
+                continue;
+            }
+
+            auto const n = normal_of(t);
+            (*normals)[face_index(f++)] = {ScalarT(n[0]), ScalarT(n[1]), ScalarT(n[2])};
+        }
+    }
+
+    if (!skipped.empty())
+    {
+        std::cerr << "skipped " << skipped.size() << " triangle(s) because they are degenerate or the mesh would become non-manifold" << std::endl;
+        return false;
+    }
+    return true;
+}
+}
+
+template <class ScalarT>
+bool read_stl_welded(std::string const& filename, Mesh& mesh, vertex_attribute<std::array<ScalarT, 3>>& position, face_attribute<std::array<ScalarT, 3>>* normals)
+{
+    return read_stl_welded(filename, mesh, position, executor::sequential(), normals);
+}
+
+template <class ScalarT>
+bool read_stl_welded(std::string const& filename,
+                     Mesh& mesh,
+                     vertex_attribute<std::array<ScalarT, 3>>& position,
+                     executor const& exec,
+                     face_attribute<std::array<ScalarT, 3>>* normals)
+{
+    mesh.clear();
+
+    {
+        std::ifstream file(filename);
+        if (!file.good())
+            return false;
+
+        if (is_ascii_stl(file))
+        {
+            std::vector<std::array<ScalarT, 3>> corners;
+            std::vector<std::array<ScalarT, 3>> face_normals;
+            if (!parse_stl_ascii(file, corners, face_normals))
+                return false;
+
+            return build_welded(
+                exec, index_value_t(face_normals.size()), [&](index_value_t c) { return corners[c]; }, [&](index_value_t t) { return face_normals[t]; }, mesh, position, normals);
+        }
+    }
+
+    detail::mapped_file file(filename);
+    if (!file.is_valid())
+        return false;
+
+    // see format description at the top
+    size_t const header_size = 80 + sizeof(uint32_t);
+    size_t const record_size = sizeof(std::array<float, 3>) * 4 + sizeof(uint16_t);
+
+    uint32_t n_triangles = 0;
+    if (file.size() >= header_size)
+        std::memcpy(&n_triangles, file.data() + 80, sizeof(n_triangles));
+
+    size_t fs_expect = header_size + size_t(n_triangles) * record_size;
+    if (file.size() < header_size || fs_expect != file.size())
+    {
+        std::cerr << "Expected file size mismatch: " << fs_expect << " vs " << file.size() << " bytes (file corrupt or wrong format?)" << std::endl;
+        return false;
+    }
+    if (int64_t(n_triangles) > int64_t(std::numeric_limits<index_value_t>::max() / 3))
+    {
+        std::cerr << "too many triangles: " << n_triangles << std::endl;
+        return false;
+    }
+
+    // records are read in-place from the mapping
+    auto const records = file.data() + header_size;
+    auto read_vec3 = [&](size_t offset) {
+        std::array<float, 3> v;
+        std::memcpy(&v, records + offset, sizeof(v));
+        return v;
+    };
+
+    return build_welded(
+        exec, index_value_t(n_triangles), [&](index_value_t c) { return read_vec3(size_t(c / 3) * record_size + sizeof(std::array<float, 3>) * (1 + c % 3)); },
+        [&](index_value_t t) { return read_vec3(size_t(t) * record_size); }, mesh, position, normals);
+}
+
 bool is_ascii_stl(std::istream& input)
 {
     auto savp = input.tellg();
@@ -291,6 +561,12 @@ template bool read_stl<float>(std::string const& filename, Mesh& mesh, vertex_at
 template bool read_stl<float>(std::istream& input, Mesh& mesh, vertex_attribute<std::array<float, 3>>& position, face_attribute<std::array<float, 3>>* normals);
 template bool read_stl_binary<float>(std::istream& input, Mesh& mesh, vertex_attribute<std::array<float, 3>>& position, face_attribute<std::array<float, 3>>* normals);
 template bool read_stl_ascii<float>(std::istream& input, Mesh& mesh, vertex_attribute<std::array<float, 3>>& position, face_attribute<std::array<float, 3>>* normals);
+template bool read_stl_welded<float>(std::string const& filename, Mesh& mesh, vertex_attribute<std::array<float, 3>>& position, face_attribute<std::array<float, 3>>* normals);
+template bool read_stl_welded<float>(std::string const& filename,
+                                     Mesh& mesh,
+                                     vertex_attribute<std::array<float, 3>>& position,
+                                     executor const& exec,
+                                     face_attribute<std::array<float, 3>>* normals);
 
 template void write_stl_binary<double>(std::string const& filename,
                                        vertex_attribute<std::array<double, 3>> const& position,
@@ -300,4 +576,10 @@ template bool read_stl<double>(std::string const& filename, Mesh& mesh, vertex_a
 template bool read_stl<double>(std::istream& input, Mesh& mesh, vertex_attribute<std::array<double, 3>>& position, face_attribute<std::array<double, 3>>* normals);
 template bool read_stl_binary<double>(std::istream& input, Mesh& mesh, vertex_attribute<std::array<double, 3>>& position, face_attribute<std::array<double, 3>>* normals);
 template bool read_stl_ascii<double>(std::istream& input, Mesh& mesh, vertex_attribute<std::array<double, 3>>& position, face_attribute<std::array<double, 3>>* normals);
+template bool read_stl_welded<double>(std::string const& filename, Mesh& mesh, vertex_attribute<std::array<double, 3>>& position, face_attribute<std::array<double, 3>>* normals);
+template bool read_stl_welded<double>(std::string const& filename,
+                                     Mesh& mesh,
+                                     vertex_attribute<std::array<double, 3>>& position,
+                                     executor const& exec,
+                                     face_attribute<std::array<double, 3>>* normals);
 } // namespace polymesh
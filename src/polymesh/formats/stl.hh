@@ -23,5 +23,20 @@ bool read_stl_binary(std::istream& input, Mesh& mesh, vertex_attribute<std::arra
 template <class ScalarT>
 bool read_stl_ascii(std::istream& input, Mesh& mesh, vertex_attribute<std::array<ScalarT, 3>>& position, face_attribute<std::array<ScalarT, 3>>* normals = nullptr);
 
+
+/// Reads an stl file and welds vertices with identical positions while loading
+/// (instead of creating 3 new vertices per triangle, see read_stl)
+/// -0 and +0 are considered identical, degenerate and non-manifold triangles are skipped
+/// binary files are memory-mapped and welding can be parallelized via the executor (see parallel.hh)
+/// returns false if the file could not be read or if any triangle was skipped
+template <class ScalarT>
+bool read_stl_welded(std::string const& filename, Mesh& mesh, vertex_attribute<std::array<ScalarT, 3>>& position, face_attribute<std::array<ScalarT, 3>>* normals = nullptr);
+template <class ScalarT>
+bool read_stl_welded(std::string const& filename,
+                     Mesh& mesh,
+                     vertex_attribute<std::array<ScalarT, 3>>& position,
+                     executor const& exec,
+                     face_attribute<std::array<ScalarT, 3>>* normals = nullptr);
+
 bool is_ascii_stl(std::istream& input);
 } // namespace polymesh
@@ -0,0 +1,771 @@
+#include "streaming.hh"
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <limits>
+#include <unordered_map>
+
+#include <polymesh/detail/bits.hh>
+#include <polymesh/detail/mapped_file.hh>
+
+using namespace polymesh;
+
+namespace
+{
+/// binary temporary files only hold index_value_t records:
+///   faces: vertex count followed by the (input) vertex indices
+///   chunk vertices: input vertex indices
+///   imports: pairs of (input vertex index, output vertex index)
+
+/// appends binary values to a file through a buffer
+struct binary_appender
+{
+    std::ofstream out;
+    std::vector<char> buffer;
+
+    explicit binary_appender(std::string const& path) : out(path, std::ios_base::binary) { buffer.reserve(1 << 20); }
+
+    template <class T>
+    void write(T const& v)
+    {
+        auto const s = buffer.size();
+        buffer.resize(s + sizeof(T));
+        std::memcpy(buffer.data() + s, &v, sizeof(T));
+        if (buffer.size() >= (1 << 20))
+            flush();
+    }
+
+    void flush()
+    {
+        out.write(buffer.data(), std::streamsize(buffer.size()));
+        buffer.clear();
+    }
+
+    bool close()
+    {
+        flush();
+        out.close();
+        return !out.fail();
+    }
+};
+
+/// buffered appends to many files, a file is only opened while its buffer is flushed
+/// (thus the number of open files is constant and the memory is buckets * capacity)
+struct bucket_writer
+{
+    std::vector<std::string> paths;
+    std::vector<std::vector<index_value_t>> buffers;
+    size_t capacity = 0;
+    bool ok = true;
+
+    bucket_writer(std::vector<std::string> bucket_paths, size_t capacity) : paths(std::move(bucket_paths)), buffers(paths.size()), capacity(capacity) {}
+
+    void push(int bucket, index_value_t v)
+    {
+        auto& b = buffers[size_t(bucket)];
+        b.push_back(v);
+        if (b.size() >= capacity)
+            flush(bucket);
+    }
+
+    void flush(int bucket)
+    {
+        auto& b = buffers[size_t(bucket)];
+        if (b.empty())
+            return;
+
+        std::ofstream out(paths[size_t(bucket)], std::ios_base::binary | std::ios_base::app);
+        out.write(reinterpret_cast<char const*>(b.data()), std::streamsize(b.size() * sizeof(index_value_t)));
+        ok &= !out.fail();
+
+        // free the memory, the bucket might not be used again for a while
+        std::vector<index_value_t>().swap(b);
+    }
+
+    void flush_all()
+    {
+        for (auto i = 0; i < int(buffers.size()); ++i)
+            flush(i);
+    }
+};
+
+/// reads a whole (possibly missing) binary file of index_value_t
+std::vector<index_value_t> read_records(std::string const& path)
+{
+    std::vector<index_value_t> r;
+    std::ifstream in(path, std::ios_base::binary | std::ios_base::ate);
+    if (!in.good())
+        return r;
+
+    r.resize(size_t(in.tellg()) / sizeof(index_value_t));
+    in.seekg(0);
+    in.read(reinterpret_cast<char*>(r.data()), std::streamsize(r.size() * sizeof(index_value_t)));
+    return r;
+}
+
+/// interleaves the lower 7 bits of x, y, z
+uint32_t morton_code(uint32_t x, uint32_t y, uint32_t z)
+{
+    auto const spread = [](uint32_t v) {
+        v &= 0x7f;
+        v = (v | (v << 8)) & 0x0000f00f;
+        v = (v | (v << 4)) & 0x000c30c3;
+        v = (v | (v << 2)) & 0x00249249;
+        return v;
+    };
+    return spread(x) | (spread(y) << 1) | (spread(z) << 2);
+}
+
+/// the histogram grid has at most 128^3 cells (and Morton codes of 21 bit)
+int constexpr max_grid_res = 128;
+
+inline bool is_blank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+inline char const* skip_blanks(char const* p, char const* end)
+{
+    while (p != end && is_blank(*p))
+        ++p;
+    return p;
+}
+
+/// writes the shortest round-trip representation of v
+inline void append_number(std::vector<char>& buffer, float v)
+{
+    char tmp[32];
+    auto r = std::to_chars(tmp, tmp + sizeof(tmp), v);
+    buffer.insert(buffer.end(), tmp, r.ptr);
+}
+inline void append_number(std::vector<char>& buffer, index_value_t v)
+{
+    char tmp[32];
+    auto r = std::to_chars(tmp, tmp + sizeof(tmp), v);
+    buffer.insert(buffer.end(), tmp, r.ptr);
+}
+
+void flush_to(std::ofstream& out, std::vector<char>& buffer, size_t threshold)
+{
+    if (buffer.size() < threshold)
+        return;
+    out.write(buffer.data(), std::streamsize(buffer.size()));
+    buffer.clear();
+}
+
+std::string unique_dir_name()
+{
+    auto const t = std::chrono::steady_clock::now().time_since_epoch().count();
+    return "polymesh-stream-" + std::to_string(t);
+}
+}
+
+// ================================ reader ================================
+
+chunked_obj_reader::chunked_obj_reader(std::string const& filename, streaming_settings const& settings)
+{
+    POLYMESH_ASSERT(settings.chunk_vertices > 0 && "chunks must contain at least one vertex");
+
+    std::error_code ec;
+    auto const base = settings.temp_dir.empty() ? std::filesystem::temp_directory_path(ec) : std::filesystem::path(settings.temp_dir);
+    auto const dir = base / unique_dir_name();
+    if (ec || !std::filesystem::create_directories(dir, ec))
+    {
+        std::cerr << "could not create temporary directory " << dir.string() << std::endl;
+        return;
+    }
+    mTempDir = dir.string();
+
+    if (!parse(filename))
+        return;
+
+    mPositions = std::make_unique<detail::mapped_file>(temp_file("positions"), false);
+    if (!mPositions->is_valid())
+        return;
+
+    assign_chunks(settings.chunk_vertices);
+
+    mVertexChunks = std::make_unique<detail::mapped_file>(temp_file("vertex-chunks"), false);
+    if (!mVertexChunks->is_valid())
+        return;
+
+    // the buckets buffer about as many indices as a chunk has vertices (in total)
+    auto const buffer_entries = std::max(index_value_t(256), 2 * settings.chunk_vertices / std::max(1, mChunkCount));
+    mValid = write_buckets(buffer_entries);
+}
+
+chunked_obj_reader::~chunked_obj_reader()
+{
+    // unmap before removing
+    mPositions.reset();
+    mVertexChunks.reset();
+
+    if (!mTempDir.empty())
+    {
+        std::error_code ec;
+        std::filesystem::remove_all(mTempDir, ec);
+    }
+}
+
+std::string chunked_obj_reader::temp_file(std::string const& name) const { return (std::filesystem::path(mTempDir) / name).string(); }
+
+bool chunked_obj_reader::parse(std::string const& filename)
+{
+    detail::mapped_file file(filename);
+    if (!file.is_valid())
+    {
+        std::cerr << "could not open " << filename << std::endl;
+        return false;
+    }
+
+    binary_appender positions(temp_file("positions"));
+    binary_appender faces(temp_file("faces"));
+
+    auto const inf = std::numeric_limits<float>::max();
+    mBounds = {{inf, inf, inf, -inf, -inf, -inf}};
+
+    std::vector<index_value_t> face;
+    index_value_t invalid_faces = 0;
+
+    auto p = file.chars();
+    auto const end = p + file.size();
+    while (p != end)
+    {
+        auto line_end = static_cast<char const*>(std::memchr(p, '\n', size_t(end - p)));
+        if (!line_end)
+            line_end = end;
+
+        auto l = skip_blanks(p, line_end);
+        if (line_end - l >= 2 && l[0] == 'v' && is_blank(l[1]))
+        {
+            std::array<float, 3> pos = {{0, 0, 0}};
+            l += 2;
+            for (auto& v : pos)
+            {
+                l = skip_blanks(l, line_end);
+                if (l != line_end && *l == '+')
+                    ++l;
+                l = std::from_chars(l, line_end, v).ptr;
+            }
+
+            for (auto d = 0; d < 3; ++d)
+            {
+                mBounds[d] = std::min(mBounds[d], pos[d]);
+                mBounds[d + 3] = std::max(mBounds[d + 3], pos[d]);
+            }
+            positions.write(pos);
+            ++mVertexCount;
+        }
+        else if (line_end - l >= 2 && l[0] == 'f' && is_blank(l[1]))
+        {
+            face.clear();
+            auto valid = true;
+            l += 2;
+            while ((l = skip_blanks(l, line_end)) != line_end)
+            {
+                index_value_t i = 0;
+                auto r = std::from_chars(l, line_end, i);
+                valid &= r.ec == std::errc() && i != 0;
+
+                // 1-based or relative to the current end
+                i = i < 0 ? mVertexCount + i : i - 1;
+                valid &= 0 <= i && i < mVertexCount;
+                face.push_back(i);
+
+                // skip texture and normal indices
+                l = r.ptr;
+                while (l != line_end && !is_blank(*l))
+                    ++l;
+            }
+
+            if (valid && face.size() >= 3)
+            {
+                faces.write(index_value_t(face.size()));
+                for (auto i : face)
+                    faces.write(i);
+                ++mFaceCount;
+            }
+            else
+                ++invalid_faces;
+        }
+        // other records (texture coordinates, normals, groups, ...) are ignored
+
+        p = line_end == end ? end : line_end + 1;
+    }
+
+    if (invalid_faces > 0)
+        std::cerr << "skipped " << invalid_faces << " invalid faces in " << filename << std::endl;
+
+    if (mVertexCount == 0)
+        mBounds = {};
+
+    return positions.close() && faces.close();
+}
+
+void chunked_obj_reader::assign_chunks(index_value_t chunk_vertices)
+{
+    // grid with about 64 cells per chunk
+    auto const target_cells = double(std::max(index_value_t(1), mVertexCount / chunk_vertices)) * 64;
+    auto const res = std::clamp(int(std::ceil(std::cbrt(target_cells))), 1, max_grid_res);
+
+    std::array<float, 3> scale;
+    for (auto d = 0; d < 3; ++d)
+    {
+        auto const extent = mBounds[d + 3] - mBounds[d];
+        scale[d] = extent > 0 ? float(res) / extent : 0.f;
+    }
+
+    auto const pos = reinterpret_cast<std::array<float, 3> const*>(mPositions->data());
+    auto const cell_of = [&](index_value_t v) {
+        auto const& p = pos[v];
+        int c[3];
+        for (auto d = 0; d < 3; ++d)
+            c[d] = std::min(res - 1, int((p[d] - mBounds[d]) * scale[d]));
+        return (c[2] * res + c[1]) * res + c[0];
+    };
+
+    // histogram
+    std::vector<index_value_t> cell_counts(size_t(res) * res * res);
+    for (index_value_t v = 0; v < mVertexCount; ++v)
+        ++cell_counts[size_t(cell_of(v))];
+
+    // consecutive non-empty cells in Morton order form a chunk until it would exceed the budget
+    std::vector<std::pair<uint32_t, uint32_t>> cells; // (Morton code, cell)
+    for (auto z = 0; z < res; ++z)
+        for (auto y = 0; y < res; ++y)
+            for (auto x = 0; x < res; ++x)
+            {
+                auto const cell = uint32_t((z * res + y) * res + x);
+                if (cell_counts[cell] > 0)
+                    cells.emplace_back(morton_code(uint32_t(x), uint32_t(y), uint32_t(z)), cell);
+            }
+    std::sort(cells.begin(), cells.end());
+
+    std::vector<int> cell_chunk(cell_counts.size(), 0);
+    index_value_t current = 0;
+    mChunkSizes.clear();
+    for (auto const& [code, cell] : cells)
+    {
+        auto const cnt = cell_counts[cell];
+        if (mChunkSizes.empty() || current + cnt > chunk_vertices)
+        {
+            mChunkSizes.push_back(0);
+            current = 0;
+        }
+
+        cell_chunk[cell] = int(mChunkSizes.size()) - 1;
+        mChunkSizes.back() += cnt;
+        current += cnt;
+    }
+    mChunkCount = int(mChunkSizes.size());
+
+    // vertex -> chunk map and owned vertices per chunk
+    binary_appender vertex_chunks(temp_file("vertex-chunks"));
+    std::vector<std::string> paths;
+    for (auto i = 0; i < mChunkCount; ++i)
+        paths.push_back(temp_file("chunk-" + std::to_string(i) + ".vertices"));
+    bucket_writer chunk_vertices_out(std::move(paths), size_t(std::max(index_value_t(256), 2 * chunk_vertices / std::max(1, mChunkCount))));
+
+    for (index_value_t v = 0; v < mVertexCount; ++v)
+    {
+        auto const chunk = cell_chunk[size_t(cell_of(v))];
+        vertex_chunks.write(int32_t(chunk));
+        chunk_vertices_out.push(chunk, v);
+    }
+
+    chunk_vertices_out.flush_all();
+    vertex_chunks.close();
+}
+
+bool chunked_obj_reader::write_buckets(index_value_t buffer_entries)
+{
+    std::vector<std::string> paths;
+    for (auto i = 0; i < mChunkCount; ++i)
+        paths.push_back(temp_file("chunk-" + std::to_string(i) + ".faces"));
+    bucket_writer buckets(std::move(paths), size_t(buffer_entries));
+
+    {
+        detail::mapped_file faces(temp_file("faces"));
+        if (!faces.is_valid())
+            return false;
+
+        auto const records = reinterpret_cast<index_value_t const*>(faces.data());
+        auto const record_cnt = index_value_t(faces.size() / sizeof(index_value_t));
+        std::vector<int> chunks;
+        for (index_value_t r = 0; r < record_cnt;)
+        {
+            auto const n = records[r];
+            auto const face = records + r + 1;
+
+            // every chunk owning one of the vertices needs the face
+            chunks.clear();
+            for (index_value_t i = 0; i < n; ++i)
+                chunks.push_back(chunk_of(face[i]));
+            std::sort(chunks.begin(), chunks.end());
+            chunks.erase(std::unique(chunks.begin(), chunks.end()), chunks.end());
+
+            for (auto c : chunks)
+                for (index_value_t i = 0; i <= n; ++i)
+                    buckets.push(c, records[r + i]);
+
+            r += n + 1;
+        }
+    }
+
+    buckets.flush_all();
+
+    // only the buckets are needed from now on
+    std::error_code ec;
+    std::filesystem::remove(temp_file("faces"), ec);
+
+    return buckets.ok;
+}
+
+int chunked_obj_reader::chunk_of(index_value_t input_vertex) const
+{
+    POLYMESH_ASSERT(0 <= input_vertex && input_vertex < mVertexCount && "out of bounds");
+    int32_t c;
+    std::memcpy(&c, mVertexChunks->data() + size_t(input_vertex) * sizeof(int32_t), sizeof(c));
+    return c;
+}
+
+std::array<float, 3> chunked_obj_reader::position_of(index_value_t input_vertex) const
+{
+    std::array<float, 3> p;
+    std::memcpy(&p, mPositions->data() + size_t(input_vertex) * sizeof(p), sizeof(p));
+    return p;
+}
+
+void chunked_obj_reader::load_chunk(int chunk, stream_chunk& c) const
+{
+    POLYMESH_ASSERT(mValid && "reader is not valid");
+    POLYMESH_ASSERT(0 <= chunk && chunk < mChunkCount && "out of bounds");
+
+    c.mesh.clear();
+    c.index = chunk;
+    c.error_faces = 0;
+
+    // owned vertices first, halo vertices are appended when they are first referenced
+    auto input_vertices = read_records(temp_file("chunk-" + std::to_string(chunk) + ".vertices"));
+    auto const owned_cnt = index_value_t(input_vertices.size());
+    std::unordered_map<index_value_t, index_value_t> local_of;
+    local_of.reserve(input_vertices.size() * 2);
+    for (index_value_t i = 0; i < owned_cnt; ++i)
+        local_of.emplace(input_vertices[size_t(i)], i);
+
+    auto const local_index = [&](index_value_t v) {
+        auto [it, is_new] = local_of.emplace(v, index_value_t(input_vertices.size()));
+        if (is_new)
+            input_vertices.push_back(v);
+        return it->second;
+    };
+
+    // faces owned by this chunk come first so that they win if the chunk is non-manifold
+    auto const records = read_records(temp_file("chunk-" + std::to_string(chunk) + ".faces"));
+    std::vector<int> face_sizes;
+    std::vector<index_value_t> indices;
+    index_value_t owned_face_cnt = 0;
+    for (auto pass = 0; pass < 2; ++pass)
+        for (size_t r = 0; r < records.size(); r += size_t(records[r]) + 1)
+        {
+            auto const n = records[r];
+            auto owner = -1;
+            for (index_value_t i = 1; i <= n; ++i)
+                owner = std::max(owner, chunk_of(records[r + size_t(i)]));
+
+            if ((owner == chunk) != (pass == 0))
+                continue;
+
+            face_sizes.push_back(int(n));
+            for (index_value_t i = 1; i <= n; ++i)
+                indices.push_back(local_index(records[r + size_t(i)]));
+            owned_face_cnt += pass == 0;
+        }
+
+    auto& m = c.mesh;
+    m.vertices().reserve(index_value_t(input_vertices.size()));
+    for (index_value_t i = 0; i < index_value_t(input_vertices.size()); ++i)
+    {
+        auto const v = m.vertices().add();
+        auto const iv = input_vertices[size_t(i)];
+        c.position[v] = position_of(iv);
+        c.input_index[v] = iv;
+        c.halo_vertex[v] = i >= owned_cnt;
+        c.locked[v] = i >= owned_cnt;
+    }
+
+    auto const skipped = m.build_from_polygons(face_sizes, indices);
+
+    // faces are added in input order without the skipped ones
+    auto next_skipped = skipped.begin();
+    index_value_t f_idx = 0;
+    for (index_value_t i = 0; i < index_value_t(face_sizes.size()); ++i)
+    {
+        if (next_skipped != skipped.end() && *next_skipped == i)
+        {
+            ++next_skipped;
+            c.error_faces += i < owned_face_cnt;
+            continue;
+        }
+
+        auto const f = m.faces()[f_idx++];
+        if (i >= owned_face_cnt)
+        {
+            c.halo_face[f] = true;
+            for (auto v : f.vertices())
+                c.locked[v] = true;
+        }
+    }
+}
+
+// ================================ writers ================================
+
+obj_stream_writer::obj_stream_writer(std::string const& filename) : mOut(filename, std::ios_base::binary)
+{
+    if (!mOut.good())
+        std::cerr << "could not open " << filename << " for writing" << std::endl;
+    mBuffer.reserve(1 << 20);
+}
+
+obj_stream_writer::~obj_stream_writer()
+{
+    if (mOut.is_open())
+        close();
+}
+
+index_value_t obj_stream_writer::add_vertex(std::array<float, 3> const& pos)
+{
+    mBuffer.push_back('v');
+    for (auto d = 0; d < 3; ++d)
+    {
+        mBuffer.push_back(' ');
+        append_number(mBuffer, pos[d]);
+    }
+    mBuffer.push_back('\n');
+    flush_to(mOut, mBuffer, 1 << 20);
+    return mVertexCount++;
+}
+
+bool obj_stream_writer::add_face(span<index_value_t const> vertices)
+{
+    mBuffer.push_back('f');
+    for (auto v : vertices)
+    {
+        POLYMESH_ASSERT(0 <= v && v < mVertexCount && "vertex must be added before");
+        mBuffer.push_back(' ');
+        append_number(mBuffer, index_value_t(v + 1));
+    }
+    mBuffer.push_back('\n');
+    flush_to(mOut, mBuffer, 1 << 20);
+    ++mFaceCount;
+    return true;
+}
+
+bool obj_stream_writer::close()
+{
+    flush_to(mOut, mBuffer, 0);
+    mOut.close();
+    return !mOut.fail();
+}
+
+namespace
+{
+/// width of the element counts in the ply header (patched on close)
+int constexpr ply_count_width = 20;
+
+std::string padded_count(index_value_t cnt)
+{
+    auto s = std::to_string(cnt);
+    s.resize(ply_count_width, ' ');
+    return s;
+}
+
+/// values are written in native byte order
+char const* ply_stream_format() { return detail::is_native_little_endian() ? "binary_little_endian" : "binary_big_endian"; }
+}
+
+ply_stream_writer::ply_stream_writer(std::string const& filename) : mFaceFile(filename + ".faces.tmp"), mOut(filename, std::ios_base::binary)
+{
+    if (!mOut.good())
+        std::cerr << "could not open " << filename << " for writing" << std::endl;
+
+    mFaces.open(mFaceFile, std::ios_base::binary);
+    mBuffer.reserve(1 << 20);
+    mFaceBuffer.reserve(1 << 20);
+
+    // counts are patched in close()
+    mOut << "ply\n";
+    mOut << "format " << ply_stream_format() << " 1.0\n";
+    mOut << "element vertex " << padded_count(0) << "\n";
+    mOut << "property float x\n";
+    mOut << "property float y\n";
+    mOut << "property float z\n";
+    mOut << "element face " << padded_count(0) << "\n";
+    mOut << "property list uchar uint vertex_indices\n";
+    mOut << "end_header\n";
+}
+
+ply_stream_writer::~ply_stream_writer()
+{
+    if (!mClosed)
+        close();
+}
+
+index_value_t ply_stream_writer::add_vertex(std::array<float, 3> const& pos)
+{
+    auto const s = mBuffer.size();
+    mBuffer.resize(s + sizeof(pos));
+    std::memcpy(mBuffer.data() + s, pos.data(), sizeof(pos));
+    flush_to(mOut, mBuffer, 1 << 20);
+    return mVertexCount++;
+}
+
+bool ply_stream_writer::add_face(span<index_value_t const> vertices)
+{
+    // vertex counts are stored as uchar, indices as uint
+    if (vertices.size() > 255)
+        return false;
+    for (auto v : vertices)
+        if (uint64_t(v) > std::numeric_limits<uint32_t>::max())
+            return false;
+
+    mFaceBuffer.push_back(char(uint8_t(vertices.size())));
+    for (auto v : vertices)
+    {
+        POLYMESH_ASSERT(0 <= v && v < mVertexCount && "vertex must be added before");
+        auto const i = uint32_t(v);
+        auto const s = mFaceBuffer.size();
+        mFaceBuffer.resize(s + sizeof(i));
+        std::memcpy(mFaceBuffer.data() + s, &i, sizeof(i));
+    }
+    flush_to(mFaces, mFaceBuffer, 1 << 20);
+    ++mFaceCount;
+    return true;
+}
+
+bool ply_stream_writer::close()
+{
+    if (mClosed)
+        return false;
+    mClosed = true;
+
+    flush_to(mOut, mBuffer, 0);
+    flush_to(mFaces, mFaceBuffer, 0);
+    mFaces.close();
+    auto ok = !mFaces.fail();
+
+    // append the spooled faces
+    {
+        std::ifstream faces(mFaceFile, std::ios_base::binary);
+        std::vector<char> chunk(1 << 20);
+        while (faces.good())
+        {
+            faces.read(chunk.data(), std::streamsize(chunk.size()));
+            mOut.write(chunk.data(), faces.gcount());
+        }
+    }
+    std::error_code ec;
+    std::filesystem::remove(mFaceFile, ec);
+
+    // patch the counts (the header has a fixed layout up to them)
+    auto const vertex_count_pos = std::streamoff(std::strlen("ply\nformat ") + std::strlen(ply_stream_format()) + std::strlen(" 1.0\nelement vertex "));
+    auto const face_count_pos = vertex_count_pos + ply_count_width + std::streamoff(std::strlen("\nproperty float x\nproperty float y\nproperty float z\nelement face "));
+    mOut.seekp(vertex_count_pos);
+    mOut << padded_count(mVertexCount);
+    mOut.seekp(face_count_pos);
+    mOut << padded_count(mFaceCount);
+
+    mOut.close();
+    return ok && !mOut.fail();
+}
+
+// ================================ driver ================================
+
+stream_result polymesh::process_out_of_core(chunked_obj_reader const& in, mesh_stream_writer& out, std::function<void(stream_chunk&)> const& f)
+{
+    stream_result r;
+    if (!in.is_valid())
+        return r;
+
+    auto const imports_file = [&](int chunk) { return in.temp_file("chunk-" + std::to_string(chunk) + ".imports"); };
+
+    // (input index, output index) of vertices that are referenced by faces of later chunks
+    std::vector<std::string> paths;
+    for (auto i = 0; i < in.chunk_count(); ++i)
+        paths.push_back(imports_file(i));
+    bucket_writer exports(std::move(paths), 1 << 12);
+
+    stream_chunk c;
+    auto out_index = c.mesh.vertices().make_attribute<index_value_t>(-1);
+    std::unordered_map<index_value_t, index_value_t> imported;
+    std::vector<index_value_t> face;
+    for (auto chunk = 0; chunk < in.chunk_count(); ++chunk)
+    {
+        in.load_chunk(chunk, c);
+        f(c);
+        r.error_faces += c.error_faces;
+
+        // owned vertices (including new ones)
+        for (auto v : c.mesh.vertices())
+            if (!c.halo_vertex[v])
+                out_index[v] = out.add_vertex(c.position[v]);
+
+        // halo faces of later chunks reference owned vertices
+        for (auto hf : c.mesh.faces())
+        {
+            if (!c.halo_face[hf])
+                continue;
+
+            auto owner = -1;
+            for (auto v : hf.vertices())
+                owner = std::max(owner, in.chunk_of(c.input_index[v]));
+            if (owner <= chunk)
+                continue;
+
+            for (auto v : hf.vertices())
+                if (!c.halo_vertex[v])
+                {
+                    POLYMESH_ASSERT(c.input_index[v] >= 0 && "locked vertices must not be replaced");
+                    exports.push(owner, c.input_index[v]);
+                    exports.push(owner, out_index[v]);
+                }
+        }
+
+        // vertices of earlier chunks
+        exports.flush(chunk);
+        auto const records = read_records(imports_file(chunk));
+        imported.clear();
+        for (size_t i = 0; i + 1 < records.size(); i += 2)
+            imported.emplace(records[i], records[i + 1]);
+        std::error_code ec;
+        std::filesystem::remove(imports_file(chunk), ec);
+
+        // owned faces (including new ones)
+        for (auto of : c.mesh.faces())
+        {
+            if (c.halo_face[of])
+                continue;
+
+            face.clear();
+            for (auto v : of.vertices())
+            {
+                if (!c.halo_vertex[v])
+                    face.push_back(out_index[v]);
+                else if (auto it = imported.find(c.input_index[v]); it != imported.end())
+                    face.push_back(it->second);
+                else
+                    break; // vertex is not written (yet), e.g. a face was modified that references a later chunk
+            }
+
+            if (face.size() != size_t(of.vertices().size()) || !out.add_face(face))
+                ++r.error_faces;
+        }
+    }
+
+    r.ok = exports.ok;
+    r.vertices = out.vertex_count();
+    r.faces = out.face_count();
+    return r;
+}
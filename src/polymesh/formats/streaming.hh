@@ -0,0 +1,212 @@
+#pragma once
+
+#include <array>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <polymesh/Mesh.hh>
+#include <polymesh/span.hh>
+
+namespace polymesh
+{
+namespace detail
+{
+struct mapped_file;
+}
+
+/**
+ * Out-of-core processing of meshes that do not fit into memory
+ *
+ * The mesh is split into spatially coherent chunks of at most chunk_vertices (owned) vertices.
+ * Each chunk is loaded together with its one-ring halo (all faces incident to its vertices and their vertices)
+ * into a regular Mesh, processed by a callback, and streamed to a writer.
+ * Peak memory is bounded by the chunk budget (plus memory-mapped temporary files), not by the input size.
+ *
+ * Usage:
+ *
+ *   pm::chunked_obj_reader in("city.obj", {1 << 20});
+ *   pm::ply_stream_writer out("city-smooth.ply");
+ *   pm::process_out_of_core(in, out, [](pm::stream_chunk& c) {
+ *       // c.mesh and c.position contain the chunk and its halo
+ *       // e.g. smoothing: only owned vertices are written, halo positions are the input positions
+ *       // e.g. decimation: locked vertices must not be removed
+ *   });
+ */
+struct streaming_settings
+{
+    /// maximum number of vertices owned by a chunk (halo vertices come on top)
+    /// NOTE: can be exceeded if a single grid cell contains more vertices
+    index_value_t chunk_vertices = 1 << 20;
+    /// directory for temporary files (positions, vertex -> chunk map, face buckets)
+    /// a unique subdirectory is created and removed again, empty means the system temp directory
+    std::string temp_dir;
+};
+
+/// one chunk of a chunked_obj_reader, loaded into a regular Mesh
+///
+/// every input vertex is owned by exactly one chunk and every input face by the highest chunk owning one of its vertices
+/// halo primitives are owned by other chunks and are only loaded to provide complete one-rings:
+///   - all faces incident to owned vertices are loaded, thus owned vertices have their full one-ring
+///   - positions of halo vertices are the input positions (independent of the processing order)
+///
+/// the callback may
+///   - move owned vertices (changes to halo vertices are ignored)
+///   - change the topology of owned faces as long as locked vertices and halo faces stay intact (e.g. decimation)
+///   - add vertices and faces (which are owned by this chunk)
+struct stream_chunk
+{
+    Mesh mesh;
+    vertex_attribute<std::array<float, 3>> position{mesh};
+    /// index of the vertex in the input, -1 for vertices added by the callback
+    vertex_attribute<index_value_t> input_index{mesh, -1};
+    /// true for vertices that are owned by another chunk
+    vertex_attribute<bool> halo_vertex{mesh};
+    /// true for faces that are owned by another chunk
+    face_attribute<bool> halo_face{mesh};
+    /// true for halo vertices and owned vertices incident to halo faces (their removal would break other chunks)
+    vertex_attribute<bool> locked{mesh};
+
+    /// index of this chunk
+    int index = -1;
+    /// number of owned input faces that could not be added (non-manifold) and will be missing in the output
+    index_value_t error_faces = 0;
+
+    bool is_owned(vertex_handle v) const { return !halo_vertex[v]; }
+    bool is_owned(face_handle f) const { return !halo_face[f]; }
+};
+
+/// reads an obj file (positions and faces only) in spatially coherent chunks
+///
+/// the constructor runs a pre-pass with memory independent of the mesh size:
+///   1. positions are written to a binary file, faces (with resolved indices) to another one
+///   2. a grid histogram over the bounding box is split into chunks (consecutive cells in Morton order)
+///   3. the vertex -> chunk map is written to disk
+///   4. each face is appended to the bucket of every chunk that owns one of its vertices
+/// all temporary files are removed by the destructor
+class chunked_obj_reader
+{
+public:
+    explicit chunked_obj_reader(std::string const& filename, streaming_settings const& settings = {});
+    ~chunked_obj_reader();
+
+    chunked_obj_reader(chunked_obj_reader const&) = delete;
+    chunked_obj_reader& operator=(chunked_obj_reader const&) = delete;
+
+    /// false if the file could not be read or the temporary files could not be written
+    bool is_valid() const { return mValid; }
+
+    int chunk_count() const { return mChunkCount; }
+    index_value_t vertex_count() const { return mVertexCount; }
+    index_value_t face_count() const { return mFaceCount; }
+    /// number of (owned) vertices of a chunk
+    index_value_t chunk_size(int chunk) const { return mChunkSizes[size_t(chunk)]; }
+    /// bounding box of all vertices {min_x, min_y, min_z, max_x, max_y, max_z}
+    std::array<float, 6> const& bounds() const { return mBounds; }
+
+    /// clears the chunk and loads the owned vertices of the given chunk plus its one-ring halo
+    /// owned vertices come first (in input order), followed by halo vertices
+    void load_chunk(int chunk, stream_chunk& c) const;
+
+    /// the owning chunk of an input vertex (reads the on-disk vertex -> chunk map)
+    int chunk_of(index_value_t input_vertex) const;
+
+    /// path of a file in the temporary directory
+    std::string temp_file(std::string const& name) const;
+
+private:
+    bool parse(std::string const& filename);
+    void assign_chunks(index_value_t chunk_vertices);
+    bool write_buckets(index_value_t buffer_entries);
+    std::array<float, 3> position_of(index_value_t input_vertex) const;
+
+    std::string mTempDir;
+    bool mValid = false;
+
+    int mChunkCount = 0;
+    index_value_t mVertexCount = 0;
+    index_value_t mFaceCount = 0;
+    std::vector<index_value_t> mChunkSizes;
+    std::array<float, 6> mBounds = {};
+
+    std::unique_ptr<detail::mapped_file> mPositions;
+    std::unique_ptr<detail::mapped_file> mVertexChunks;
+};
+
+/// writes vertices and faces as they are added, without keeping the mesh in memory
+class mesh_stream_writer
+{
+public:
+    virtual ~mesh_stream_writer() = default;
+
+    /// returns the index of the new vertex (counting from 0)
+    virtual index_value_t add_vertex(std::array<float, 3> const& pos) = 0;
+    /// adds a face of previously added vertices
+    /// returns false (and skips the face) if the format cannot store it
+    virtual bool add_face(span<index_value_t const> vertices) = 0;
+    /// finishes the file, returns false on errors
+    virtual bool close() = 0;
+
+    index_value_t vertex_count() const { return mVertexCount; }
+    index_value_t face_count() const { return mFaceCount; }
+
+protected:
+    index_value_t mVertexCount = 0;
+    index_value_t mFaceCount = 0;
+};
+
+/// writes "v" and "f" lines (vertices are interleaved with faces, always before their first use)
+class obj_stream_writer final : public mesh_stream_writer
+{
+public:
+    explicit obj_stream_writer(std::string const& filename);
+    ~obj_stream_writer() override;
+
+    index_value_t add_vertex(std::array<float, 3> const& pos) override;
+    bool add_face(span<index_value_t const> vertices) override;
+    bool close() override;
+
+private:
+    std::ofstream mOut;
+    std::vector<char> mBuffer;
+};
+
+/// writes a binary ply in native byte order (float positions, faces as "list uchar uint")
+/// faces with more than 255 vertices or vertex indices beyond 32 bit cannot be stored and are skipped
+/// vertices are written directly, faces are spooled to a temporary file and appended on close,
+/// the element counts in the header are patched on close
+class ply_stream_writer final : public mesh_stream_writer
+{
+public:
+    explicit ply_stream_writer(std::string const& filename);
+    ~ply_stream_writer() override;
+
+    index_value_t add_vertex(std::array<float, 3> const& pos) override;
+    bool add_face(span<index_value_t const> vertices) override;
+    bool close() override;
+
+private:
+    std::string mFaceFile;
+    std::ofstream mOut;
+    std::ofstream mFaces;
+    std::vector<char> mBuffer;
+    std::vector<char> mFaceBuffer;
+    bool mClosed = false;
+};
+
+struct stream_result
+{
+    bool ok = false;
+    index_value_t vertices = 0; ///< written vertices
+    index_value_t faces = 0;    ///< written faces
+    /// input faces that could not be added to their chunk (non-manifold), faces that referenced unwritten vertices,
+    /// or faces that the writer could not store
+    index_value_t error_faces = 0;
+};
+
+/// loads each chunk of in (with halo), calls f on it, and writes the owned vertices and faces to out
+/// chunks are processed in order, out is not closed
+stream_result process_out_of_core(chunked_obj_reader const& in, mesh_stream_writer& out, std::function<void(stream_chunk&)> const& f);
+}
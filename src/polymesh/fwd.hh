@@ -1,9 +1,20 @@
 #pragma once
 
+#include <cstdint>
+
 namespace polymesh
 {
 class Mesh;
 
+/// integer type of primitive indices, sizes, and capacities
+/// 32 bit by default, 64 bit if POLYMESH_INDEX_64 is defined (for meshes with more than 2^31 half-edges)
+/// NOTE: the 64 bit mode doubles the memory (and bandwidth) of the topology
+#ifdef POLYMESH_INDEX_64
+using index_value_t = std::int64_t;
+#else
+using index_value_t = int;
+#endif
+
 /// a tag class used to represent the primitive type "vertex"
 struct vertex_tag
 {
@@ -81,6 +92,9 @@ struct vertex_vertex_ring;
 struct halfedge_ring;
 
 struct attribute_collection;
+
+class executor;
+struct permute_scratch;
 }
 
 // alias pm
@@ -65,11 +65,11 @@ AttrT const& edge_attribute<AttrT>::operator()(halfedge_handle h) const
 template <class tag, class AttrT>
 void primitive_attribute<tag, AttrT>::copy_from(span<AttrT const> data)
 {
-    std::copy_n(data.data(), std::min(int(data.size()), this->size()), this->data());
+    std::copy_n(data.data(), std::min(index_value_t(data.size()), this->size()), this->data());
 }
 
 template <class tag, class AttrT>
-void primitive_attribute<tag, AttrT>::copy_from(const AttrT* data, int cnt)
+void primitive_attribute<tag, AttrT>::copy_from(const AttrT* data, index_value_t cnt)
 {
     std::copy_n(data, std::min(cnt, this->size()), this->data());
 }
@@ -98,18 +98,16 @@ std::vector<AttrT> primitive_attribute<tag, AttrT>::to_vector() const
 }
 
 template <class tag, class AttrT>
-void primitive_attribute<tag, AttrT>::apply_remapping(const std::vector<int>& map)
+void primitive_attribute<tag, AttrT>::apply_remapping(const std::vector<index_value_t>& map)
 {
-    for (auto i = 0u; i < map.size(); ++i)
+    for (size_t i = 0; i < map.size(); ++i)
         this->mData[i] = this->mData[map[i]];
 }
 
 template <class tag, class AttrT>
-void primitive_attribute<tag, AttrT>::apply_transpositions(std::vector<std::pair<int, int>> const& ts)
+void primitive_attribute<tag, AttrT>::apply_gather(std::vector<index_value_t> const& new_to_old, permute_scratch& scratch, executor const& exec)
 {
-    using std::swap;
-    for (auto t : ts)
-        swap(this->mData[t.first], this->mData[t.second]);
+    detail::permute_by_gather(this->mData.get(), new_to_old, scratch, exec);
 }
 
 // ==== User ctor: delegates to internal standard ctor
@@ -127,7 +125,7 @@ primitive_attribute<tag, AttrT>::primitive_attribute(const Mesh* mesh, const Att
     this->register_attr();
 
     // alloc data
-    this->mData.reset(new AttrT[this->capacity()]);
+    this->mData = unique_array<AttrT>::uninitialized(this->capacity(), this->data_resource(detail::is_poolable_attribute<AttrT>));
 
     // fill everything with default
     std::fill_n(this->mData.get(), this->capacity(), this->mDefaultValue);
@@ -144,7 +142,7 @@ primitive_attribute<tag, AttrT>::primitive_attribute(primitive_attribute const&
     this->register_attr();
 
     // alloc data
-    this->mData.reset(new AttrT[this->capacity()]);
+    this->mData = unique_array<AttrT>::uninitialized(this->capacity(), this->data_resource(detail::is_poolable_attribute<AttrT>));
 
     // copy ALL data (valid and defaulted)
     std::copy_n(rhs.mData.get(), this->capacity(), this->mData.get());
@@ -182,15 +180,11 @@ primitive_attribute<tag, AttrT>& primitive_attribute<tag, AttrT>::operator=(prim
     this->mMesh = rhs.mMesh;
     this->register_attr();
 
-    // realloc if new capacity
+    // realloc if new capacity (or the new mesh uses a different memory resource)
     auto new_capacity = this->capacity();
-    if (old_capacity != new_capacity)
-    {
-        if (new_capacity == 0)
-            this->mData.reset();
-        else
-            this->mData.reset(new AttrT[new_capacity]());
-    }
+    auto const resource = this->data_resource(detail::is_poolable_attribute<AttrT>);
+    if (old_capacity != new_capacity || this->mData.resource() != resource)
+        this->mData = unique_array<AttrT>(new_capacity, resource);
 
     // copy ALL data (valid and defaulted)
     this->mDefaultValue = rhs.mDefaultValue;
@@ -224,7 +218,7 @@ primitive_attribute<tag, AttrT>& primitive_attribute<tag, AttrT>::operator=(prim
 }
 
 template <class tag, class AttrT>
-void primitive_attribute<tag, AttrT>::resize_from(int old_size)
+void primitive_attribute<tag, AttrT>::resize_from(index_value_t old_size)
 {
     // mesh is already resized, thus capacity() and size() return new values
     // old_size is size before resize
@@ -233,17 +227,13 @@ void primitive_attribute<tag, AttrT>::resize_from(int old_size)
     auto shared_size = std::min(this->size(), old_size);
     POLYMESH_ASSERT(shared_size <= new_capacity && "size cannot exceed capacity");
 
-    // alloc new data
-    auto new_data = new_capacity > 0 ? new AttrT[new_capacity]() : nullptr;
-
-    // copy shared region to new data
-    std::copy_n(this->mData.get(), shared_size, new_data);
+    // realloc (possibly in-place for trivially copyable types)
+    // NOTE: the shared region is preserved, the rest is uninitialized (or default-constructed)
+    auto const keep = std::min<size_t>(shared_size, this->mData.size());
+    this->mData.reallocate(new_capacity, keep);
 
     // fill rest with default value
-    std::fill(new_data + shared_size, new_data + new_capacity, mDefaultValue);
-
-    // replace old data
-    this->mData.reset(new_data);
+    std::fill(this->mData.get() + keep, this->mData.get() + new_capacity, mDefaultValue);
 }
 
 template <class tag, class AttrT>
@@ -352,6 +342,12 @@ inline void Mesh::deregister_attr(primitive_attribute_base<halfedge_tag>* attr)
     attr->mPrevAttribute = nullptr;
 }
 
+template <class tag>
+memory_resource* primitive_attribute_base<tag>::data_resource(bool poolable) const
+{
+    return mMesh->attribute_resource(tag{}, poolable);
+}
+
 template <class tag>
 void primitive_attribute_base<tag>::register_attr()
 {
@@ -369,13 +365,13 @@ void primitive_attribute_base<tag>::deregister_attr()
 }
 
 template <class tag, class AttrT>
-int primitive_attribute<tag, AttrT>::size() const
+index_value_t primitive_attribute<tag, AttrT>::size() const
 {
     return primitive<tag>::all_size(*this->mMesh);
 }
 
 template <class tag, class AttrT>
-int primitive_attribute<tag, AttrT>::capacity() const
+index_value_t primitive_attribute<tag, AttrT>::capacity() const
 {
     return primitive<tag>::capacity(*this->mMesh);
 }
@@ -400,7 +396,7 @@ auto primitive_attribute<tag, AttrT>::map(FuncT&& f) const -> attribute<tmp::dec
     auto s = size();
     auto d_in = data();
     auto d_out = attr.data();
-    for (auto i = 0; i < s; ++i)
+    for (index_value_t i = 0; i < s; ++i)
         d_out[i] = f(d_in[i]);
     return attr; // copy elison
 }
@@ -413,7 +409,7 @@ auto primitive_attribute<tag, AttrT>::to() const -> attribute<T>
     auto s = size();
     auto d_in = data();
     auto d_out = attr.data();
-    for (auto i = 0; i < s; ++i)
+    for (index_value_t i = 0; i < s; ++i)
         d_out[i] = static_cast<T>(d_in[i]);
     return attr; // copy elison
 }
@@ -424,7 +420,7 @@ void primitive_attribute<tag, AttrT>::apply(FuncT&& f)
 {
     auto s = size();
     auto d = data();
-    for (auto i = 0; i < s; ++i)
+    for (index_value_t i = 0; i < s; ++i)
         f(d[i]);
 }
 
@@ -434,7 +430,15 @@ void primitive_attribute<tag, AttrT>::compute(FuncT&& f)
 {
     auto d = data();
     for (auto h : primitive<tag>::valid_collection_of(*this->mMesh))
-        d[(int)h] = f(h);
+        d[h.idx.value] = f(h);
+}
+
+template <class tag, class AttrT>
+template <class FuncT>
+void primitive_attribute<tag, AttrT>::parallel_compute(FuncT&& f, executor const& exec)
+{
+    auto d = data();
+    primitive<tag>::valid_collection_of(*this->mMesh).parallel_for_each([&](typename primitive<tag>::handle h) { d[h.idx.value] = f(h); }, exec);
 }
 
 template <class tag, class AttrT>
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <polymesh/Mesh.hh>
+#include <polymesh/detail/bits.hh>
+
+namespace polymesh
+{
+template <class tag>
+inline valid_primitive_iterator<tag>::valid_primitive_iterator(Mesh const& mesh, index_t begin, index_t end) : mesh(&mesh), current(begin), end(end)
+{
+    if (begin.value >= end.value)
+    {
+        current = end;
+        return;
+    }
+
+    version = mesh.topology_version();
+    bits = low_level_api(mesh).valid_bits_of_word(begin) & (~uint64_t(0) << (begin.value & 63));
+    current.value = begin.value & ~63;
+    find_next_bit();
+}
+
+template <class tag>
+inline void valid_primitive_iterator<tag>::advance()
+{
+    // removed primitives are skipped word-wise (see low_level_api::valid_bits_of_word)
+    bits &= bits - 1;
+
+    // primitives might have been removed during the iteration
+    if (mesh->topology_version() != version)
+    {
+        version = mesh->topology_version();
+        bits &= low_level_api(mesh).valid_bits_of_word(current);
+    }
+
+    current.value &= ~63;
+    find_next_bit();
+}
+
+template <class tag>
+inline void valid_primitive_iterator<tag>::find_next_bit()
+{
+    while (bits == 0)
+    {
+        current.value += 64;
+        if (current.value >= end.value)
+        {
+            current = end;
+            return;
+        }
+        bits = low_level_api(mesh).valid_bits_of_word(current);
+    }
+
+    current.value += detail::lowest_bit(bits);
+    if (current.value >= end.value)
+        current = end;
+}
+
+template <class tag>
+inline primitive_index_iterator<tag>::primitive_index_iterator(Mesh const* skip_mesh, index_t begin, index_t end) : mesh(skip_mesh), current(begin), end(end)
+{
+    if (mesh != nullptr && current != end)
+        current = low_level_api(mesh).next_valid_idx_from(current);
+}
+
+template <class tag>
+inline void primitive_index_iterator<tag>::advance()
+{
+    ++current.value;
+    if (mesh != nullptr && current != end)
+        current = low_level_api(mesh).next_valid_idx_from(current);
+}
+}
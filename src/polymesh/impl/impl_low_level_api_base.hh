@@ -1,6 +1,7 @@
 #pragma once
 
 #include <polymesh/Mesh.hh>
+#include <polymesh/detail/bits.hh>
 
 namespace polymesh
 {
@@ -42,93 +43,93 @@ tmp::cond_const_ref<halfedge_index, MeshT> low_level_api_base<MeshT>::outgoing_h
 
 
 template <class MeshT>
-int low_level_api_base<MeshT>::capacity_faces() const
+index_value_t low_level_api_base<MeshT>::capacity_faces() const
 {
     return m.mFacesCapacity;
 }
 
 template <class MeshT>
-int low_level_api_base<MeshT>::capacity_vertices() const
+index_value_t low_level_api_base<MeshT>::capacity_vertices() const
 {
     return m.mVerticesCapacity;
 }
 
 template <class MeshT>
-int low_level_api_base<MeshT>::capacity_halfedges() const
+index_value_t low_level_api_base<MeshT>::capacity_halfedges() const
 {
     return m.mHalfedgesCapacity;
 }
 
 template <class MeshT>
-int low_level_api_base<MeshT>::size_all_faces() const
+index_value_t low_level_api_base<MeshT>::size_all_faces() const
 {
     return m.size_all_faces();
 }
 
 template <class MeshT>
-int low_level_api_base<MeshT>::size_all_vertices() const
+index_value_t low_level_api_base<MeshT>::size_all_vertices() const
 {
     return m.size_all_vertices();
 }
 
 template <class MeshT>
-int low_level_api_base<MeshT>::size_all_edges() const
+index_value_t low_level_api_base<MeshT>::size_all_edges() const
 {
     return m.size_all_edges();
 }
 
 template <class MeshT>
-int low_level_api_base<MeshT>::size_all_halfedges() const
+index_value_t low_level_api_base<MeshT>::size_all_halfedges() const
 {
     return m.size_all_halfedges();
 }
 
 template <class MeshT>
-int low_level_api_base<MeshT>::size_valid_faces() const
+index_value_t low_level_api_base<MeshT>::size_valid_faces() const
 {
     return m.size_valid_faces();
 }
 
 template <class MeshT>
-int low_level_api_base<MeshT>::size_valid_vertices() const
+index_value_t low_level_api_base<MeshT>::size_valid_vertices() const
 {
     return m.size_valid_vertices();
 }
 
 template <class MeshT>
-int low_level_api_base<MeshT>::size_valid_edges() const
+index_value_t low_level_api_base<MeshT>::size_valid_edges() const
 {
     return m.size_valid_edges();
 }
 
 template <class MeshT>
-int low_level_api_base<MeshT>::size_valid_halfedges() const
+index_value_t low_level_api_base<MeshT>::size_valid_halfedges() const
 {
     return m.size_valid_halfedges();
 }
 
 template <class MeshT>
-int low_level_api_base<MeshT>::size_removed_faces() const
+index_value_t low_level_api_base<MeshT>::size_removed_faces() const
 {
-    return m.size_all_faces() - m.size_removed_faces();
+    return m.mRemovedFaces;
 }
 
 template <class MeshT>
-int low_level_api_base<MeshT>::size_removed_vertices() const
+index_value_t low_level_api_base<MeshT>::size_removed_vertices() const
 {
-    return m.size_all_vertices() - m.size_removed_vertices();
+    return m.mRemovedVertices;
 }
 
 template <class MeshT>
-int low_level_api_base<MeshT>::size_removed_edges() const
+index_value_t low_level_api_base<MeshT>::size_removed_edges() const
 {
-    return m.size_all_edges() - m.size_removed_edges();
+    return m.mRemovedHalfedges >> 1;
 }
 
 template <class MeshT>
-int low_level_api_base<MeshT>::size_removed_halfedges() const
+index_value_t low_level_api_base<MeshT>::size_removed_halfedges() const
 {
-    return m.size_all_halfedges() - m.size_removed_halfedges();
+    return m.mRemovedHalfedges;
 }
 
 template <class MeshT>
@@ -542,76 +543,111 @@ vertex_index low_level_api_base<MeshT>::from_vertex_of(halfedge_index idx) const
 template <class MeshT>
 vertex_index low_level_api_base<MeshT>::next_valid_idx_from(vertex_index idx) const
 {
-    auto s = size_all_vertices();
-    auto i = idx;
-    while (i.value < s && is_removed(i))
-        i.value++;
-    return i;
+    if (m.mRemovedVertices == 0)
+        return idx;
+    auto const& bits = m.mRemovedVertexBits;
+    return vertex_index(detail::next_unset_bit(bits.get(), index_value_t(bits.size()), idx.value, size_all_vertices()));
 }
 
 template <class MeshT>
 vertex_index low_level_api_base<MeshT>::prev_valid_idx_from(vertex_index idx) const
 {
-    auto i = idx;
-    while (i.value >= 0 && is_removed(i))
-        i.value--;
-    return i;
+    if (m.mRemovedVertices == 0)
+        return idx;
+    auto const& bits = m.mRemovedVertexBits;
+    return vertex_index(detail::prev_unset_bit(bits.get(), index_value_t(bits.size()), idx.value));
 }
 
 template <class MeshT>
 edge_index low_level_api_base<MeshT>::next_valid_idx_from(edge_index idx) const
 {
-    auto s = size_all_edges();
-    auto i = idx;
-    while (i.value < s && is_removed(i))
-        i.value++;
-    return i;
+    if (m.mRemovedHalfedges == 0)
+        return idx;
+    auto const& bits = m.mRemovedEdgeBits;
+    return edge_index(detail::next_unset_bit(bits.get(), index_value_t(bits.size()), idx.value, size_all_edges()));
 }
 
 template <class MeshT>
 edge_index low_level_api_base<MeshT>::prev_valid_idx_from(edge_index idx) const
 {
-    auto i = idx;
-    while (i.value >= 0 && is_removed(i))
-        i.value--;
-    return i;
+    if (m.mRemovedHalfedges == 0)
+        return idx;
+    auto const& bits = m.mRemovedEdgeBits;
+    return edge_index(detail::prev_unset_bit(bits.get(), index_value_t(bits.size()), idx.value));
 }
 
 template <class MeshT>
 face_index low_level_api_base<MeshT>::next_valid_idx_from(face_index idx) const
 {
-    auto s = size_all_faces();
-    auto i = idx;
-    while (i.value < s && is_removed(i))
-        i.value++;
-    return i;
+    if (m.mRemovedFaces == 0)
+        return idx;
+    auto const& bits = m.mRemovedFaceBits;
+    return face_index(detail::next_unset_bit(bits.get(), index_value_t(bits.size()), idx.value, size_all_faces()));
 }
 
 template <class MeshT>
 face_index low_level_api_base<MeshT>::prev_valid_idx_from(face_index idx) const
 {
-    auto i = idx;
-    while (i.value >= 0 && is_removed(i))
-        i.value--;
-    return i;
+    if (m.mRemovedFaces == 0)
+        return idx;
+    auto const& bits = m.mRemovedFaceBits;
+    return face_index(detail::prev_unset_bit(bits.get(), index_value_t(bits.size()), idx.value));
 }
 
 template <class MeshT>
 halfedge_index low_level_api_base<MeshT>::next_valid_idx_from(halfedge_index idx) const
 {
-    auto s = size_all_halfedges();
-    auto i = idx;
-    while (i.value < s && is_removed(i))
-        i.value++;
-    return i;
+    if (m.mRemovedHalfedges == 0 || idx.value >= size_all_halfedges())
+        return idx;
+
+    // a half-edge is removed iff its edge is removed
+    auto const e = idx.value >> 1;
+    auto const next_e = next_valid_idx_from(edge_index(e)).value;
+    if (next_e == e)
+        return idx;
+    return halfedge_index(next_e < size_all_edges() ? next_e << 1 : size_all_halfedges());
 }
 
 template <class MeshT>
 halfedge_index low_level_api_base<MeshT>::prev_valid_idx_from(halfedge_index idx) const
 {
-    auto i = idx;
-    while (i.value >= 0 && is_removed(i))
-        i.value--;
-    return i;
+    if (m.mRemovedHalfedges == 0 || idx.value < 0)
+        return idx;
+
+    auto const e = idx.value >> 1;
+    auto const prev_e = prev_valid_idx_from(edge_index(e)).value;
+    if (prev_e == e)
+        return idx;
+    return halfedge_index(prev_e < 0 ? -1 : (prev_e << 1) + 1);
+}
+
+template <class MeshT>
+uint64_t low_level_api_base<MeshT>::valid_bits_of_word(vertex_index idx) const
+{
+    auto const& bits = m.mRemovedVertexBits;
+    return detail::unset_bits_of_word(bits.get(), m.mRemovedVertices == 0 ? 0 : index_value_t(bits.size()), idx.value >> 6, size_all_vertices());
+}
+
+template <class MeshT>
+uint64_t low_level_api_base<MeshT>::valid_bits_of_word(edge_index idx) const
+{
+    auto const& bits = m.mRemovedEdgeBits;
+    return detail::unset_bits_of_word(bits.get(), m.mRemovedHalfedges == 0 ? 0 : index_value_t(bits.size()), idx.value >> 6, size_all_edges());
+}
+
+template <class MeshT>
+uint64_t low_level_api_base<MeshT>::valid_bits_of_word(face_index idx) const
+{
+    auto const& bits = m.mRemovedFaceBits;
+    return detail::unset_bits_of_word(bits.get(), m.mRemovedFaces == 0 ? 0 : index_value_t(bits.size()), idx.value >> 6, size_all_faces());
+}
+
+template <class MeshT>
+uint64_t low_level_api_base<MeshT>::valid_bits_of_word(halfedge_index idx) const
+{
+    // 64 half-edges are 32 edges, i.e. one half of an edge word
+    auto const w = idx.value >> 6;
+    auto const e_bits = valid_bits_of_word(edge_index(w << 5));
+    return detail::duplicate_bits(uint32_t(e_bits >> ((w & 1) << 5)));
 }
 } // namespace polymesh
@@ -9,16 +9,31 @@ inline vertex_index low_level_api_mutable::add_vertex() const { return alloc_ver
 inline vertex_index low_level_api_mutable::alloc_vertex() const { return m.alloc_vertex(); }
 inline face_index low_level_api_mutable::alloc_face() const { return m.alloc_face(); }
 inline edge_index low_level_api_mutable::alloc_edge() const { return m.alloc_edge(); }
-inline void low_level_api_mutable::alloc_primitives(int vertices, int faces, int halfedges) const { m.alloc_primitives(vertices, faces, halfedges); }
+inline void low_level_api_mutable::alloc_primitives(index_value_t vertices, index_value_t faces, index_value_t halfedges) const { m.alloc_primitives(vertices, faces, halfedges); }
 
-inline void low_level_api_mutable::reserve_vertices(int capacity) const { m.reserve_vertices(capacity); }
-inline void low_level_api_mutable::reserve_edges(int capacity) const { m.reserve_edges(capacity); }
-inline void low_level_api_mutable::reserve_halfedges(int capacity) const { m.reserve_halfedges(capacity); }
-inline void low_level_api_mutable::reserve_faces(int capacity) const { m.reserve_faces(capacity); }
+inline void low_level_api_mutable::reserve_vertices(index_value_t capacity) const { m.reserve_vertices(capacity); }
+inline void low_level_api_mutable::reserve_edges(index_value_t capacity) const { m.reserve_edges(capacity); }
+inline void low_level_api_mutable::reserve_halfedges(index_value_t capacity) const { m.reserve_halfedges(capacity); }
+inline void low_level_api_mutable::reserve_faces(index_value_t capacity) const { m.reserve_faces(capacity); }
 
-inline void low_level_api_mutable::permute_faces(const std::vector<int>& p) const { m.permute_faces(p); }
-inline void low_level_api_mutable::permute_edges(const std::vector<int>& p) const { m.permute_edges(p); }
-inline void low_level_api_mutable::permute_vertices(const std::vector<int>& p) const { m.permute_vertices(p); }
+template <class tag>
+void low_level_api_mutable::enable_attribute_pool(tag, size_t bytes_per_element, int attribute_count, executor const* exec) const
+{
+    m.enable_attribute_pool(tag{}, bytes_per_element, attribute_count, exec);
+}
+
+inline void low_level_api_mutable::permute_faces(const std::vector<index_value_t>& p, executor const& exec, permute_scratch* scratch) const
+{
+    m.permute_faces(p, exec, scratch);
+}
+inline void low_level_api_mutable::permute_edges(const std::vector<index_value_t>& p, executor const& exec, permute_scratch* scratch) const
+{
+    m.permute_edges(p, exec, scratch);
+}
+inline void low_level_api_mutable::permute_vertices(const std::vector<index_value_t>& p, executor const& exec, permute_scratch* scratch) const
+{
+    m.permute_vertices(p, exec, scratch);
+}
 
 namespace detail
 {
@@ -57,6 +72,7 @@ inline face_index low_level_api_mutable::add_face(const halfedge_handle* half_lo
 
 inline face_index low_level_api_mutable::add_face(const halfedge_index* half_loop, int vcnt, face_index res_idx) const
 {
+    ++m.mTopologyVersion;
     POLYMESH_ASSERT(vcnt >= 3 && "no support for less-than-triangular faces");
     POLYMESH_ASSERT((res_idx.is_invalid() || is_removed(res_idx)) && "resurrected index must be previously removed!");
 
@@ -65,6 +81,7 @@ inline face_index low_level_api_mutable::add_face(const halfedge_index* half_loo
     // on resurrect: fix counts
     if (res_idx.is_valid())
     {
+        Mesh::unset_removed_bit(m.mRemovedFaceBits, res_idx.value);
         m.mRemovedFaces--;
         // no mCompact change!
     }
@@ -224,6 +241,7 @@ inline halfedge_index low_level_api_mutable::add_or_get_halfedge(halfedge_index
 
 inline void low_level_api_mutable::make_adjacent(halfedge_index he_in, halfedge_index he_out) const
 {
+    ++m.mTopologyVersion;
     // see http://kaba.hilvi.org/homepage/blog/halfedge/halfedge.htm ::makeAdjacent
 
     auto he_b = next_halfedge_of(he_in);
@@ -247,6 +265,7 @@ inline void low_level_api_mutable::make_adjacent(halfedge_index he_in, halfedge_
 
 inline void low_level_api_mutable::remove_face(face_index f_idx) const
 {
+    ++m.mTopologyVersion;
     POLYMESH_ASSERT(!is_removed(f_idx));
 
     auto he_begin = halfedge_of(f_idx);
@@ -279,6 +298,7 @@ inline void low_level_api_mutable::remove_face(face_index f_idx) const
 
 inline void low_level_api_mutable::remove_edge(edge_index e_idx) const
 {
+    ++m.mTopologyVersion;
     auto h_in = halfedge_of(e_idx, 0);
     auto h_out = halfedge_of(e_idx, 1);
 
@@ -333,6 +353,7 @@ inline void low_level_api_mutable::remove_edge(edge_index e_idx) const
 
 inline void low_level_api_mutable::remove_vertex(vertex_index v_idx) const
 {
+    ++m.mTopologyVersion;
     POLYMESH_ASSERT(!is_removed(v_idx));
 
     // remove all outgoing edges
@@ -351,11 +372,24 @@ inline void low_level_api_mutable::clear_removed_edge_vector() const
     m.mHalfedgesSize = 0;
 
     m.mRemovedHalfedges = 0;
+    std::fill_n(m.mRemovedEdgeBits.get(), m.mRemovedEdgeBits.size(), 0);
+    // no mCompact change!
+}
+
+inline void low_level_api_mutable::clear_removed_face_vector() const
+{
+    POLYMESH_ASSERT(m.faces().empty() && "only works for no-face meshes");
+
+    m.mFacesSize = 0;
+
+    m.mRemovedFaces = 0;
+    std::fill_n(m.mRemovedFaceBits.get(), m.mRemovedFaceBits.size(), 0);
     // no mCompact change!
 }
 
 inline void low_level_api_mutable::fix_boundary_state_of(vertex_index v_idx) const
 {
+    ++m.mTopologyVersion;
     POLYMESH_ASSERT(!is_isolated(v_idx));
 
     auto he_begin = outgoing_halfedge_of(v_idx);
@@ -376,6 +410,7 @@ inline void low_level_api_mutable::fix_boundary_state_of(vertex_index v_idx) con
 
 inline void low_level_api_mutable::fix_boundary_state_of(face_index f_idx) const
 {
+    ++m.mTopologyVersion;
     auto he_begin = halfedge_of(f_idx);
     auto he = he_begin;
     do
@@ -394,6 +429,7 @@ inline void low_level_api_mutable::fix_boundary_state_of(face_index f_idx) const
 
 inline void low_level_api_mutable::fix_boundary_state_of_vertices(face_index f_idx) const
 {
+    ++m.mTopologyVersion;
     auto he_begin = halfedge_of(f_idx);
     auto he = he_begin;
     do
@@ -408,46 +444,55 @@ inline void low_level_api_mutable::fix_boundary_state_of_vertices(face_index f_i
 
 inline void low_level_api_mutable::set_removed(vertex_index idx) const
 {
+    ++m.mTopologyVersion;
     POLYMESH_ASSERT(!is_removed(idx) && "cannot remove an already removed entry");
     outgoing_halfedge_of(idx).value = -2;
 
     // bookkeeping
+    Mesh::set_removed_bit(m.mRemovedVertexBits, idx.value, m.mVerticesCapacity);
     m.mRemovedVertices++;
     m.mCompact = false;
 }
 
 inline void low_level_api_mutable::set_removed(face_index idx) const
 {
+    ++m.mTopologyVersion;
     POLYMESH_ASSERT(!is_removed(idx) && "cannot remove an already removed entry");
     halfedge_of(idx) = halfedge_index::invalid;
 
     // bookkeeping
+    Mesh::set_removed_bit(m.mRemovedFaceBits, idx.value, m.mFacesCapacity);
     m.mRemovedFaces++;
     m.mCompact = false;
 }
 
 inline void low_level_api_mutable::set_removed(edge_index idx) const
 {
+    ++m.mTopologyVersion;
     POLYMESH_ASSERT(!is_removed(idx) && "cannot remove an already removed entry");
     to_vertex_of(halfedge_of(idx, 0)) = vertex_index::invalid;
     to_vertex_of(halfedge_of(idx, 1)) = vertex_index::invalid;
 
     // bookkeeping
+    Mesh::set_removed_bit(m.mRemovedEdgeBits, idx.value, m.mHalfedgesCapacity >> 1);
     m.mRemovedHalfedges++;
     m.mRemovedHalfedges++;
     m.mCompact = false;
 }
 
-inline void low_level_api_mutable::set_removed_counts(int r_vertices, int r_faces, int r_edges)
+inline void low_level_api_mutable::set_removed_counts(index_value_t r_vertices, index_value_t r_faces, index_value_t r_edges)
 {
+    ++m.mTopologyVersion;
     m.mRemovedVertices = r_vertices;
     m.mRemovedFaces = r_faces;
     m.mRemovedHalfedges = r_edges * 2;
     m.mCompact = r_vertices == 0 && r_faces == 0 && r_edges == 0;
+    m.rebuild_removed_bits();
 }
 
 inline void low_level_api_mutable::connect_prev_next(halfedge_index prev, halfedge_index next) const
 {
+    ++m.mTopologyVersion;
     next_halfedge_of(prev) = next;
     prev_halfedge_of(next) = prev;
 }
@@ -461,6 +506,7 @@ inline vertex_index low_level_api_mutable::face_split(face_index f) const
 
 inline void low_level_api_mutable::face_split(face_index f, vertex_index v) const
 {
+    ++m.mTopologyVersion;
     POLYMESH_ASSERT(is_isolated(v));
     // TODO: can be made more performant
 
@@ -489,6 +535,7 @@ inline void low_level_api_mutable::face_split(face_index f, vertex_index v) cons
 
 inline halfedge_index low_level_api_mutable::face_cut(face_index f, halfedge_index h0, halfedge_index h1) const
 {
+    ++m.mTopologyVersion;
     // must be non-adjacent halfedges
     POLYMESH_ASSERT(h0 != h1);
     POLYMESH_ASSERT(next_halfedge_of(h0) != h1);
@@ -557,6 +604,7 @@ inline vertex_index low_level_api_mutable::edge_split_and_triangulate(edge_index
 
 inline void low_level_api_mutable::edge_split_and_triangulate(edge_index e, vertex_index v_new) const
 {
+    ++m.mTopologyVersion;
     POLYMESH_ASSERT(is_isolated(v_new) && "new vertex must be isolated");
 
     POLYMESH_ASSERT((is_boundary(halfedge_of(e, 0)) || next_halfedge_of(next_halfedge_of(halfedge_of(e, 0))) == prev_halfedge_of(halfedge_of(e, 0)))
@@ -668,6 +716,7 @@ inline vertex_index low_level_api_mutable::edge_split(edge_index e) const
 
 inline void low_level_api_mutable::edge_split(edge_index e, vertex_index v) const
 {
+    ++m.mTopologyVersion;
     POLYMESH_ASSERT(is_isolated(v));
 
     auto h0 = halfedge_of(e, 0);
@@ -764,6 +813,7 @@ inline vertex_index low_level_api_mutable::halfedge_split(halfedge_index h) cons
 
 inline void low_level_api_mutable::halfedge_split(halfedge_index h, vertex_index v) const
 {
+    ++m.mTopologyVersion;
     // add edge
     auto e = alloc_edge();
 
@@ -818,6 +868,7 @@ inline void low_level_api_mutable::halfedge_split(halfedge_index h, vertex_index
 
 inline face_index low_level_api_mutable::face_fill(halfedge_index h) const
 {
+    ++m.mTopologyVersion;
     POLYMESH_ASSERT(is_boundary(h));
 
     auto f = alloc_face();
@@ -851,6 +902,7 @@ inline face_index low_level_api_mutable::face_fill(halfedge_index h) const
 
 inline void low_level_api_mutable::halfedge_attach(halfedge_index h, vertex_index v) const
 {
+    ++m.mTopologyVersion;
     POLYMESH_ASSERT(is_isolated(v));
 
     auto h_next = next_halfedge_of(h);
@@ -877,6 +929,7 @@ inline void low_level_api_mutable::halfedge_attach(halfedge_index h, vertex_inde
 
 inline void low_level_api_mutable::halfedge_merge(halfedge_index h) const
 {
+    ++m.mTopologyVersion;
     auto v_center = from_vertex_of(h);
 
     POLYMESH_ASSERT(m.handle_of(v_center).adjacent_vertices().size() == 2 && "vertex_from must have valence 2");
@@ -925,6 +978,7 @@ inline void low_level_api_mutable::halfedge_merge(halfedge_index h) const
 
 inline void low_level_api_mutable::vertex_collapse(vertex_index v) const
 {
+    ++m.mTopologyVersion;
     // isolated vertices are just removed
     if (is_isolated(v))
     {
@@ -962,6 +1016,7 @@ inline void low_level_api_mutable::vertex_collapse(vertex_index v) const
 
 inline void low_level_api_mutable::halfedge_collapse(halfedge_index h) const
 {
+    ++m.mTopologyVersion;
     auto h0 = h;
     auto h1 = opposite(h);
 
@@ -1170,6 +1225,7 @@ inline void low_level_api_mutable::halfedge_collapse(halfedge_index h) const
 
 inline void low_level_api_mutable::edge_rotate_next(edge_index e) const
 {
+    ++m.mTopologyVersion;
     POLYMESH_ASSERT(!is_boundary(e) && "does not work on boundaries");
     POLYMESH_ASSERT(m.handle_of(e).vertexA().adjacent_vertices().size() > 2 && "does not work on valence <= 2 vertices");
     POLYMESH_ASSERT(m.handle_of(e).vertexB().adjacent_vertices().size() > 2 && "does not work on valence <= 2 vertices");
@@ -1220,6 +1276,7 @@ inline void low_level_api_mutable::edge_rotate_next(edge_index e) const
 
 inline void low_level_api_mutable::edge_rotate_prev(edge_index e) const
 {
+    ++m.mTopologyVersion;
     POLYMESH_ASSERT(!is_boundary(e) && "does not work on boundaries");
     POLYMESH_ASSERT(m.handle_of(e).vertexA().adjacent_vertices().size() > 2 && "does not work on valence <= 2 vertices");
     POLYMESH_ASSERT(m.handle_of(e).vertexB().adjacent_vertices().size() > 2 && "does not work on valence <= 2 vertices");
@@ -1270,6 +1327,7 @@ inline void low_level_api_mutable::edge_rotate_prev(edge_index e) const
 
 inline void low_level_api_mutable::edge_flip(edge_index e) const
 {
+    ++m.mTopologyVersion;
     POLYMESH_ASSERT(!is_boundary(e) && "does not work on boundaries");
     POLYMESH_ASSERT(m.handle_of(e).faceA().halfedges().size() == 3 && "only works for triangles");
     POLYMESH_ASSERT(m.handle_of(e).faceB().halfedges().size() == 3 && "only works for triangles");
@@ -1279,6 +1337,7 @@ inline void low_level_api_mutable::edge_flip(edge_index e) const
 
 inline void low_level_api_mutable::halfedge_rotate_next(halfedge_index h) const
 {
+    ++m.mTopologyVersion;
     POLYMESH_ASSERT(m.handle_of(h).next().next().next() != h && "does not work for triangles");
     POLYMESH_ASSERT(!m.handle_of(h).edge().is_boundary() && "does not work on boundaries");
     POLYMESH_ASSERT(m.handle_of(h).vertex_to().adjacent_vertices().size() > 2 && "does not work on valence <= 2 vertices");
@@ -1315,6 +1374,7 @@ inline void low_level_api_mutable::halfedge_rotate_next(halfedge_index h) const
 
 inline void low_level_api_mutable::halfedge_rotate_prev(halfedge_index h) const
 {
+    ++m.mTopologyVersion;
     POLYMESH_ASSERT(m.handle_of(h).prev().prev().prev() != h && "does not work for triangles");
     POLYMESH_ASSERT(!m.handle_of(h).edge().is_boundary() && "does not work on boundaries");
     POLYMESH_ASSERT(m.handle_of(h).vertex_to().adjacent_vertices().size() > 2 && "does not work on valence <= 2 vertices");
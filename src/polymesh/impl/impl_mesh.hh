@@ -9,79 +9,76 @@ namespace polymesh
 inline face_index& Mesh::face_of(halfedge_index idx)
 {
     POLYMESH_ASSERT(0 <= idx.value && idx.value < mHalfedgesSize && "out of bounds");
-    return mHalfedgeToFace[(int)idx];
+    return mHalfedgeToFace[idx.value];
 }
 inline vertex_index& Mesh::to_vertex_of(halfedge_index idx)
 {
     POLYMESH_ASSERT(0 <= idx.value && idx.value < mHalfedgesSize && "out of bounds");
-    return mHalfedgeToVertex[(int)idx];
+    return mHalfedgeToVertex[idx.value];
 }
 inline halfedge_index& Mesh::next_halfedge_of(halfedge_index idx)
 {
     POLYMESH_ASSERT(0 <= idx.value && idx.value < mHalfedgesSize && "out of bounds");
-    return mHalfedgeToNextHalfedge[(int)idx];
+    return mHalfedgeToNextHalfedge[idx.value];
 }
 inline halfedge_index& Mesh::prev_halfedge_of(halfedge_index idx)
 {
     POLYMESH_ASSERT(0 <= idx.value && idx.value < mHalfedgesSize && "out of bounds");
-    return mHalfedgeToPrevHalfedge[(int)idx];
+    return mHalfedgeToPrevHalfedge[idx.value];
 }
 inline halfedge_index& Mesh::halfedge_of(face_index idx)
 {
     POLYMESH_ASSERT(0 <= idx.value && idx.value < mFacesSize && "out of bounds");
-    return mFaceToHalfedge[(int)idx];
+    return mFaceToHalfedge[idx.value];
 }
 inline halfedge_index& Mesh::outgoing_halfedge_of(vertex_index idx)
 {
     POLYMESH_ASSERT(0 <= idx.value && idx.value < mVerticesSize && "out of bounds");
-    return mVertexToOutgoingHalfedge[(int)idx];
+    return mVertexToOutgoingHalfedge[idx.value];
 }
 
 inline face_index const& Mesh::face_of(halfedge_index idx) const
 {
     POLYMESH_ASSERT(0 <= idx.value && idx.value < mHalfedgesSize && "out of bounds");
-    return mHalfedgeToFace[(int)idx];
+    return mHalfedgeToFace[idx.value];
 }
 inline vertex_index const& Mesh::to_vertex_of(halfedge_index idx) const
 {
     POLYMESH_ASSERT(0 <= idx.value && idx.value < mHalfedgesSize && "out of bounds");
-    return mHalfedgeToVertex[(int)idx];
+    return mHalfedgeToVertex[idx.value];
 }
 inline halfedge_index const& Mesh::next_halfedge_of(halfedge_index idx) const
 {
     POLYMESH_ASSERT(0 <= idx.value && idx.value < mHalfedgesSize && "out of bounds");
-    return mHalfedgeToNextHalfedge[(int)idx];
+    return mHalfedgeToNextHalfedge[idx.value];
 }
 inline halfedge_index const& Mesh::prev_halfedge_of(halfedge_index idx) const
 {
     POLYMESH_ASSERT(0 <= idx.value && idx.value < mHalfedgesSize && "out of bounds");
-    return mHalfedgeToPrevHalfedge[(int)idx];
+    return mHalfedgeToPrevHalfedge[idx.value];
 }
 inline halfedge_index const& Mesh::halfedge_of(face_index idx) const
 {
     POLYMESH_ASSERT(0 <= idx.value && idx.value < mFacesSize && "out of bounds");
-    return mFaceToHalfedge[(int)idx];
+    return mFaceToHalfedge[idx.value];
 }
 inline halfedge_index const& Mesh::outgoing_halfedge_of(vertex_index idx) const
 {
     POLYMESH_ASSERT(0 <= idx.value && idx.value < mVerticesSize && "out of bounds");
-    return mVertexToOutgoingHalfedge[(int)idx];
+    return mVertexToOutgoingHalfedge[idx.value];
 }
 
 inline vertex_index Mesh::alloc_vertex()
 {
     auto idx = vertex_index(size_all_vertices());
+    ++mTopologyVersion;
 
     auto old_size = mVerticesSize;
     auto capacity_changed = detail::alloc_back(mVerticesSize, mVerticesCapacity, mVertexToOutgoingHalfedge);
     mVertexToOutgoingHalfedge[mVerticesSize - 1] = halfedge_index::invalid;
 
     if (capacity_changed)
-    {
-        // notify attributes
-        for (auto p = mVertexAttrs; p; p = p->mNextAttribute)
-            p->resize_from(old_size);
-    }
+        resize_vertex_attributes(old_size);
 
     return idx;
 }
@@ -89,17 +86,14 @@ inline vertex_index Mesh::alloc_vertex()
 inline face_index Mesh::alloc_face()
 {
     auto idx = face_index(size_all_faces());
+    ++mTopologyVersion;
 
     auto old_size = mFacesSize;
     auto capacity_changed = detail::alloc_back(mFacesSize, mFacesCapacity, mFaceToHalfedge);
     mFaceToHalfedge[mFacesSize - 1] = halfedge_index::invalid;
 
     if (capacity_changed)
-    {
-        // notify attributes
-        for (auto p = mFaceAttrs; p; p = p->mNextAttribute)
-            p->resize_from(old_size);
-    }
+        resize_face_attributes(old_size);
 
     return idx;
 }
@@ -107,6 +101,7 @@ inline face_index Mesh::alloc_face()
 inline edge_index Mesh::alloc_edge()
 {
     auto idx = edge_index(size_all_edges());
+    ++mTopologyVersion;
 
     auto capacity_changed = false;
     auto old_size = mHalfedgesSize;
@@ -121,20 +116,30 @@ inline edge_index Mesh::alloc_edge()
     }
 
     if (capacity_changed)
-    {
-        // notify attributes
-        for (auto p = mEdgeAttrs; p; p = p->mNextAttribute)
-            p->resize_from(old_size >> 1);
-        for (auto p = mHalfedgeAttrs; p; p = p->mNextAttribute)
-            p->resize_from(old_size);
-    }
+        resize_halfedge_attributes(old_size);
 
     return idx;
 }
 
+inline void Mesh::set_removed_bit(unique_array<uint64_t>& bits, index_value_t idx, index_value_t capacity)
+{
+    auto const w = size_t(idx >> 6);
+    if (w >= bits.size())
+    {
+        // cover the whole capacity at once (removals are usually spread over the mesh)
+        auto const old_words = bits.size();
+        auto const new_words = size_t((capacity + 63) >> 6);
+        bits.reallocate(new_words, old_words);
+        std::fill(bits.get() + old_words, bits.get() + new_words, 0);
+    }
+    bits[index_value_t(w)] |= uint64_t(1) << (idx & 63);
+}
+
+inline void Mesh::unset_removed_bit(unique_array<uint64_t>& bits, index_value_t idx) { bits[idx >> 6] &= ~(uint64_t(1) << (idx & 63)); }
+
 inline unique_ptr<Mesh> Mesh::copy() const
 {
-    auto m = create();
+    auto m = create(*mResource);
     m->copy_from(*this);
     return m;
 }
@@ -1,6 +1,12 @@
 #pragma once
 
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
 #include <polymesh/Mesh.hh>
+#include <polymesh/detail/bits.hh>
 
 namespace polymesh
 {
@@ -37,6 +43,24 @@ auto helper_add(A const& a, B const& b) -> decltype(A() + (a - A()) + (b - B()))
 {
     return A() + (a - A()) + (b - B());
 }
+
+template <class tag, class AttrT>
+AttrT* index_kernel_data(primitive_attribute<tag, AttrT>& a, Mesh const& m)
+{
+    POLYMESH_ASSERT(&a.mesh() == &m && "attribute belongs to a different mesh");
+    return a.data();
+}
+template <class tag, class AttrT>
+AttrT const* index_kernel_data(primitive_attribute<tag, AttrT> const& a, Mesh const& m)
+{
+    POLYMESH_ASSERT(&a.mesh() == &m && "attribute belongs to a different mesh");
+    return a.data();
+}
+template <class tag, class ArgsT, size_t... I>
+auto index_kernel_data(ArgsT& args, Mesh const& m, std::index_sequence<I...>)
+{
+    return std::make_tuple(index_kernel_data<tag>(std::get<I>(args), m)...);
+}
 } // namespace detail
 
 template <class this_t, class ElementT>
@@ -83,9 +107,9 @@ bool smart_range<this_t, ElementT>::all(PredT&& p) const
 
 template <class this_t, class ElementT>
 template <class PredT>
-int smart_range<this_t, ElementT>::count(PredT&& p) const
+index_value_t smart_range<this_t, ElementT>::count(PredT&& p) const
 {
-    auto cnt = 0;
+    index_value_t cnt = 0;
     for (auto&& h : *static_cast<this_t const*>(this))
         if (p(h))
             ++cnt;
@@ -93,9 +117,9 @@ int smart_range<this_t, ElementT>::count(PredT&& p) const
 }
 
 template <class this_t, class ElementT>
-int smart_range<this_t, ElementT>::count() const
+index_value_t smart_range<this_t, ElementT>::count() const
 {
-    auto cnt = 0;
+    index_value_t cnt = 0;
     for (auto&& h : *static_cast<this_t const*>(this))
     {
         (void)h; // unused
@@ -460,7 +484,7 @@ auto smart_range<this_t, ElementT>::filter(PredT&& p) -> filtered_range<ElementT
 }
 
 template <class this_t, class tag>
-int primitive_ring<this_t, tag>::size() const
+index_value_t primitive_ring<this_t, tag>::size() const
 {
     auto cnt = 0;
     for (auto&& v : *static_cast<this_t const*>(this))
@@ -481,19 +505,25 @@ bool primitive_ring<this_t, tag>::contains(handle v) const
 }
 
 template <class mesh_ptr, class tag, class iterator>
-int smart_collection<mesh_ptr, tag, iterator>::size() const
+index_value_t smart_collection<mesh_ptr, tag, iterator>::size() const
 {
     return iterator::primitive_size(*m);
 }
 
 template <class mesh_ptr, class tag, class iterator>
-void smart_collection<mesh_ptr, tag, iterator>::reserve(int capacity) const
+void smart_collection<mesh_ptr, tag, iterator>::reserve(index_value_t capacity) const
 {
     return primitive<tag>::reserve(*m, capacity);
 }
 
 template <class mesh_ptr, class tag, class iterator>
-typename smart_collection<mesh_ptr, tag, iterator>::handle smart_collection<mesh_ptr, tag, iterator>::operator[](int idx) const
+void smart_collection<mesh_ptr, tag, iterator>::enable_attribute_pool(size_t bytes_per_element, int attribute_count, executor const* exec) const
+{
+    low_level_api(*m).enable_attribute_pool(tag{}, bytes_per_element, attribute_count, exec);
+}
+
+template <class mesh_ptr, class tag, class iterator>
+typename smart_collection<mesh_ptr, tag, iterator>::handle smart_collection<mesh_ptr, tag, iterator>::operator[](index_value_t idx) const
 {
     POLYMESH_ASSERT(idx < iterator::primitive_size(*m));
     return (*m)[index(idx)];
@@ -530,7 +560,7 @@ typename primitive<tag>::template attribute<AttrT> smart_collection<mesh_ptr, ta
 
 template <class mesh_ptr, class tag, class iterator>
 template <class AttrT>
-typename primitive<tag>::template attribute<AttrT> smart_collection<mesh_ptr, tag, iterator>::make_attribute_from_data(AttrT const* data, int cnt) const
+typename primitive<tag>::template attribute<AttrT> smart_collection<mesh_ptr, tag, iterator>::make_attribute_from_data(AttrT const* data, index_value_t cnt) const
 {
     auto attr = make_attribute<AttrT>();
     attr.copy_from(data, cnt);
@@ -547,6 +577,186 @@ typename primitive<tag>::template attribute<AttrT> smart_collection<mesh_ptr, ta
     return attr; // copy elison
 }
 
+template <class mesh_ptr, class tag, class iterator>
+template <class FuncT>
+void smart_collection<mesh_ptr, tag, iterator>::for_each_in(index_value_t begin, index_value_t end, FuncT&& f) const
+{
+    if (!iterator::is_valid_only_iterator || this->m->is_compact())
+    {
+        for (auto i = begin; i < end; ++i)
+            f(handle(this->m, index(i)));
+    }
+    else
+    {
+        // skips removed primitives word-wise, the word is re-read if f removed primitives
+        auto ll = low_level_api(this->m);
+        for (auto base = begin & ~63; base < end; base += 64)
+        {
+            auto bits = ll.valid_bits_of_word(index(base));
+            if (base < begin)
+                bits &= ~uint64_t(0) << (begin - base);
+
+            while (bits != 0)
+            {
+                auto const i = base + detail::lowest_bit(bits);
+                if (i >= end)
+                    break;
+
+                auto const version = this->m->topology_version();
+                f(handle(this->m, index(i)));
+
+                bits &= bits - 1;
+                if (this->m->topology_version() != version)
+                    bits &= ll.valid_bits_of_word(index(base));
+            }
+        }
+    }
+}
+
+template <class mesh_ptr, class tag, class iterator>
+template <class FuncT>
+void smart_collection<mesh_ptr, tag, iterator>::parallel_for_each(FuncT&& f, executor const& exec) const
+{
+    detail::parallel_blocks(exec, primitive<tag>::all_size(*this->m), 1 << 10, [&](int, index_value_t begin, index_value_t end) { this->for_each_in(begin, end, f); });
+}
+
+template <class mesh_ptr, class tag, class iterator>
+template <class FuncT, class AttrT>
+typename primitive<tag>::template attribute<AttrT> smart_collection<mesh_ptr, tag, iterator>::parallel_map(FuncT&& f, executor const& exec) const
+{
+    auto attr = make_attribute<AttrT>();
+    auto d = attr.data();
+    this->parallel_for_each([&](handle h) { d[h.idx.value] = f(h); }, exec);
+    return attr; // copy elison
+}
+
+template <class mesh_ptr, class tag, class iterator>
+template <class FuncT, class CombineT>
+auto smart_collection<mesh_ptr, tag, iterator>::parallel_reduce(executor const& exec, FuncT&& f, CombineT&& combine) const
+    -> tmp::decayed_result_type_of<FuncT, handle>
+{
+    using T = tmp::decayed_result_type_of<FuncT, handle>;
+
+    // block size is fixed so that the combination order is independent of the executor
+    auto const block_size = 1 << 11;
+    auto const size = primitive<tag>::all_size(*this->m);
+    std::vector<std::optional<T>> partials(size_t(detail::block_count(size, block_size)));
+    detail::parallel_blocks(exec, size, block_size, [&](int block, index_value_t begin, index_value_t end) {
+        auto& p = partials[size_t(block)];
+        this->for_each_in(begin, end, [&](handle h) {
+            if (p.has_value())
+                p = combine(*p, f(h));
+            else
+                p = f(h);
+        });
+    });
+
+    std::optional<T> r;
+    for (auto& p : partials)
+        if (p.has_value())
+            r = r.has_value() ? combine(*r, *p) : std::move(*p);
+
+    POLYMESH_ASSERT(r.has_value() && "requires non-empty range");
+    return *r;
+}
+
+template <class mesh_ptr, class tag, class iterator>
+template <class FuncT>
+auto smart_collection<mesh_ptr, tag, iterator>::parallel_sum(FuncT&& f, executor const& exec) const -> tmp::decayed_result_type_of<FuncT, handle>
+{
+    using T = tmp::decayed_result_type_of<FuncT, handle>;
+    return this->parallel_reduce(exec, f, [](T const& a, T const& b) -> T { return a + b; });
+}
+
+template <class mesh_ptr, class tag, class iterator>
+template <class FuncT>
+auto smart_collection<mesh_ptr, tag, iterator>::parallel_min(FuncT&& f, executor const& exec) const -> tmp::decayed_result_type_of<FuncT, handle>
+{
+    using T = tmp::decayed_result_type_of<FuncT, handle>;
+    return this->parallel_reduce(exec, f, [](T const& a, T const& b) -> T { return detail::helper_min(a, b); });
+}
+
+template <class mesh_ptr, class tag, class iterator>
+template <class FuncT>
+auto smart_collection<mesh_ptr, tag, iterator>::parallel_max(FuncT&& f, executor const& exec) const -> tmp::decayed_result_type_of<FuncT, handle>
+{
+    using T = tmp::decayed_result_type_of<FuncT, handle>;
+    return this->parallel_reduce(exec, f, [](T const& a, T const& b) -> T { return detail::helper_max(a, b); });
+}
+
+template <class mesh_ptr, class tag, class iterator>
+template <class FuncT>
+auto smart_collection<mesh_ptr, tag, iterator>::parallel_aabb(FuncT&& f, executor const& exec) const
+    -> polymesh::minmax_t<tmp::decayed_result_type_of<FuncT, handle>>
+{
+    using T = polymesh::minmax_t<tmp::decayed_result_type_of<FuncT, handle>>;
+    return this->parallel_reduce(exec,
+                                 [&](handle h) -> T {
+                                     auto v = f(h);
+                                     return {v, v};
+                                 },
+                                 [](T const& a, T const& b) -> T {
+                                     return {detail::helper_min(a.min, b.min), detail::helper_max(a.max, b.max)};
+                                 });
+}
+
+template <class mesh_ptr, class tag, class iterator>
+primitive_index_range<tag> smart_collection<mesh_ptr, tag, iterator>::indices() const
+{
+    auto const skip = iterator::is_valid_only_iterator && !this->m->is_compact();
+    return {skip ? &this->mesh() : nullptr, primitive<tag>::all_size(*this->m)};
+}
+
+template <class mesh_ptr, class tag, class iterator>
+template <class... Args>
+void smart_collection<mesh_ptr, tag, iterator>::for_each_index(Args&&... attrs_and_f) const
+{
+    static_assert(sizeof...(Args) >= 1, "requires a function as last argument");
+
+    auto args = std::forward_as_tuple(attrs_and_f...);
+    auto& f = std::get<sizeof...(Args) - 1>(args);
+    auto const data = detail::index_kernel_data<tag>(args, *this->m, std::make_index_sequence<sizeof...(Args) - 1>());
+    std::apply([&](auto*... d) { this->for_each_index_in(0, primitive<tag>::all_size(*this->m), f, d...); }, data);
+}
+
+template <class mesh_ptr, class tag, class iterator>
+template <class FuncT, class... Ts>
+void smart_collection<mesh_ptr, tag, iterator>::for_each_index_in(index_value_t begin, index_value_t end, FuncT&& f, Ts*... data) const
+{
+    auto const call = [&](index_value_t i) {
+        if constexpr (std::is_invocable_v<FuncT&, index, Ts&...>)
+            f(index(i), data[i]...);
+        else
+            f(data[i]...);
+    };
+
+    if (!iterator::is_valid_only_iterator || this->m->is_compact())
+    {
+        for (auto i = begin; i < end; ++i)
+            call(i);
+    }
+    else
+    {
+        // same as for_each_in but without support for topology changes
+        auto ll = low_level_api(this->m);
+        for (auto base = begin & ~63; base < end; base += 64)
+        {
+            auto bits = ll.valid_bits_of_word(index(base));
+            if (base < begin)
+                bits &= ~uint64_t(0) << (begin - base);
+
+            while (bits != 0)
+            {
+                auto const i = base + detail::lowest_bit(bits);
+                if (i >= end)
+                    break;
+                call(i);
+                bits &= bits - 1;
+            }
+        }
+    }
+}
+
 template <class mesh_ptr, class tag, class iterator>
 iterator smart_collection<mesh_ptr, tag, iterator>::begin() const
 {
@@ -560,13 +770,13 @@ typename primitive<tag>::handle smart_collection<mesh_ptr, tag, iterator>::rando
     auto s = primitive<tag>::all_size(*this->m);
     POLYMESH_ASSERT(s > 0 && "Cannot chose from empty mesh");
 
-    typename primitive<tag>::handle h = {this->m, typename primitive<tag>::index(int(g() % s))};
+    typename primitive<tag>::handle h = {this->m, typename primitive<tag>::index(index_value_t(g() % s))};
 
     if constexpr (iterator::is_valid_only_iterator)
     {
         POLYMESH_ASSERT(primitive<tag>::valid_size(*this->m) > 0 && "Cannot chose from empty mesh");
         while (h.is_removed())
-            h = {this->m, typename primitive<tag>::index(int(g() % s))};
+            h = {this->m, typename primitive<tag>::index(index_value_t(g() % s))};
     }
 
     return h;
@@ -597,21 +807,21 @@ void halfedge_collection<iterator>::remove_edge(halfedge_handle h) const
 }
 
 template <class iterator>
-void face_collection<iterator>::permute(std::vector<int> const& p) const
+void face_collection<iterator>::permute(std::vector<index_value_t> const& p, executor const& exec, permute_scratch* scratch) const
 {
-    low_level_api(this->m).permute_faces(p);
+    low_level_api(this->m).permute_faces(p, exec, scratch);
 }
 
 template <class iterator>
-void edge_collection<iterator>::permute(std::vector<int> const& p) const
+void edge_collection<iterator>::permute(std::vector<index_value_t> const& p, executor const& exec, permute_scratch* scratch) const
 {
-    low_level_api(this->m).permute_edges(p);
+    low_level_api(this->m).permute_edges(p, exec, scratch);
 }
 
 template <class iterator>
-void vertex_collection<iterator>::permute(std::vector<int> const& p) const
+void vertex_collection<iterator>::permute(std::vector<index_value_t> const& p, executor const& exec, permute_scratch* scratch) const
 {
-    low_level_api(this->m).permute_vertices(p);
+    low_level_api(this->m).permute_vertices(p, exec, scratch);
 }
 
 
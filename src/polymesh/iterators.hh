@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstdint>
+
 #include "assert.hh"
 #include "cursors.hh"
 #include "low_level_api.hh"
@@ -36,25 +38,23 @@ struct valid_primitive_iterator : smart_iterator<valid_primitive_iterator<tag>>
 
     static constexpr bool is_valid_only_iterator = true;
 
-    valid_primitive_iterator(Mesh const& mesh, index_t begin, index_t end) : mesh(&mesh), current(begin), end(end)
-    {
-        current = low_level_api(mesh).next_valid_idx_from(begin);
-    }
+    valid_primitive_iterator(Mesh const& mesh, index_t begin, index_t end);
 
     handle_t operator*() const { return {mesh, current}; }
-    void advance()
-    {
-        ++current.value;
-        current = low_level_api(mesh).next_valid_idx_from(current);
-    }
+    void advance();
     bool is_valid() const { return current != end; }
 
-    static int primitive_size(Mesh const& m) { return primitive<tag>::valid_size(m); }
+    static index_value_t primitive_size(Mesh const& m) { return primitive<tag>::valid_size(m); }
 
 private:
+    /// current is the first index of the word of bits
+    void find_next_bit();
+
     Mesh const* mesh;
     index_t current;
     index_t end;
+    uint64_t bits = 0;    ///< not yet visited valid primitives in the word of current
+    uint64_t version = 0; ///< topology version when bits was read
 };
 
 template <typename tag>
@@ -71,7 +71,7 @@ struct all_primitive_iterator : smart_iterator<all_primitive_iterator<tag>>
     void advance() { ++current.value; }
     bool is_valid() const { return current != end; }
 
-    static int primitive_size(Mesh const& m) { return primitive<tag>::all_size(m); }
+    static index_value_t primitive_size(Mesh const& m) { return primitive<tag>::all_size(m); }
 
 private:
     Mesh const* mesh;
@@ -79,17 +79,36 @@ private:
     index_t end;
 };
 
+/// iterates over primitive indices instead of handles (see smart_collection::indices)
+template <typename tag>
+struct primitive_index_iterator : smart_iterator<primitive_index_iterator<tag>>
+{
+    using index_t = typename primitive<tag>::index;
+
+    /// skip_mesh is nullptr if no primitives have to be skipped
+    primitive_index_iterator(Mesh const* skip_mesh, index_t begin, index_t end);
+
+    index_t operator*() const { return current; }
+    void advance();
+    bool is_valid() const { return current != end; }
+
+private:
+    Mesh const* mesh; ///< only set if removed primitives are skipped
+    index_t current;
+    index_t end;
+};
+
 
 // ================= ATTRIBUTES =================
 
 template <class AttributeT>
 struct attribute_iterator : smart_iterator<attribute_iterator<AttributeT>>
 {
-    int idx;
-    int end;
+    index_value_t idx;
+    index_value_t end;
     AttributeT& attr;
 
-    attribute_iterator(int idx, int end, AttributeT& attr) : idx(idx), end(end), attr(attr) {}
+    attribute_iterator(index_value_t idx, index_value_t end, AttributeT& attr) : idx(idx), end(end), attr(attr) {}
 
     decltype(auto) operator*() const { return attr.data()[idx]; }
     void advance() { ++idx; }
@@ -4,6 +4,7 @@
 #include <vector> // TODO: replace me by span
 
 #include "cursors.hh"
+#include "parallel.hh"
 #include "tmp.hh"
 
 namespace polymesh
@@ -41,24 +42,24 @@ public:
 
     // number of primitives
 public:
-    int capacity_faces() const;
-    int capacity_vertices() const;
-    int capacity_halfedges() const;
+    index_value_t capacity_faces() const;
+    index_value_t capacity_vertices() const;
+    index_value_t capacity_halfedges() const;
 
-    int size_all_faces() const;
-    int size_all_vertices() const;
-    int size_all_edges() const;
-    int size_all_halfedges() const;
+    index_value_t size_all_faces() const;
+    index_value_t size_all_vertices() const;
+    index_value_t size_all_edges() const;
+    index_value_t size_all_halfedges() const;
 
-    int size_valid_faces() const;
-    int size_valid_vertices() const;
-    int size_valid_edges() const;
-    int size_valid_halfedges() const;
+    index_value_t size_valid_faces() const;
+    index_value_t size_valid_vertices() const;
+    index_value_t size_valid_edges() const;
+    index_value_t size_valid_halfedges() const;
 
-    int size_removed_faces() const;
-    int size_removed_vertices() const;
-    int size_removed_edges() const;
-    int size_removed_halfedges() const;
+    index_value_t size_removed_faces() const;
+    index_value_t size_removed_vertices() const;
+    index_value_t size_removed_edges() const;
+    index_value_t size_removed_halfedges() const;
 
     // byte size information
 public:
@@ -81,6 +82,12 @@ public:
     edge_index prev_valid_idx_from(edge_index idx) const;
     face_index prev_valid_idx_from(face_index idx) const;
     halfedge_index prev_valid_idx_from(halfedge_index idx) const;
+    // returns the validity of the 64 primitives starting at 64 * (idx / 64) as a bitmask (bit j <-> primitive 64 * (idx / 64) + j)
+    // removed primitives and indices beyond the size are 0 (used for word-wise iteration)
+    uint64_t valid_bits_of_word(vertex_index idx) const;
+    uint64_t valid_bits_of_word(edge_index idx) const;
+    uint64_t valid_bits_of_word(face_index idx) const;
+    uint64_t valid_bits_of_word(halfedge_index idx) const;
 
     // modification checks
 public:
@@ -199,10 +206,14 @@ struct low_level_api_mutable : low_level_api_base<Mesh>
     // allocation
 public:
     // reserves a certain number of primitives
-    void reserve_faces(int capacity) const;
-    void reserve_vertices(int capacity) const;
-    void reserve_edges(int capacity) const;
-    void reserve_halfedges(int capacity) const;
+    void reserve_faces(index_value_t capacity) const;
+    void reserve_vertices(index_value_t capacity) const;
+    void reserve_edges(index_value_t capacity) const;
+    void reserve_halfedges(index_value_t capacity) const;
+
+    /// pools the poolable attributes of the given primitive kind (see smart_collection::enable_attribute_pool)
+    template <class tag>
+    void enable_attribute_pool(tag, size_t bytes_per_element, int attribute_count, executor const* exec) const;
 
     /// Allocates a new vertex
     vertex_index alloc_vertex() const;
@@ -212,7 +223,7 @@ public:
     edge_index alloc_edge() const;
     /// Allocates a given amount of vertices, faces, and halfedges
     /// NOTE: leaves ALL of them in an unspecified state
-    void alloc_primitives(int vertices, int faces, int halfedges) const;
+    void alloc_primitives(index_value_t vertices, index_value_t faces, index_value_t halfedges) const;
 
     // adding primitives
 public:
@@ -272,18 +283,27 @@ public:
     /// clears the edge vector
     void clear_removed_edge_vector() const;
 
+    /// special purpose function:
+    /// CAUTION: only works if faces.size() == 0
+    /// clears the face vector
+    void clear_removed_face_vector() const;
+
     /// Overrides the saved number of removed primitives
+    /// (and recomputes which primitives are removed from the topology, e.g. after loading it directly)
     /// CAUTION: only use if you know what you do!
-    void set_removed_counts(int r_vertices, int r_faces, int r_edges);
+    void set_removed_counts(index_value_t r_vertices, index_value_t r_faces, index_value_t r_edges);
 
     // reordering
 public:
     /// applies an index remapping to all face indices (p[curr_idx] = new_idx)
-    void permute_faces(std::vector<int> const& p) const;
+    /// topology and attributes are gathered via the executor (sequential by default, see parallel.hh)
+    void permute_faces(std::vector<index_value_t> const& p, executor const& exec = executor::sequential(), permute_scratch* scratch = nullptr) const;
     /// applies an index remapping to all edge (and half-edge) indices (p[curr_idx] = new_idx)
-    void permute_edges(std::vector<int> const& p) const;
+    /// topology and attributes are gathered via the executor (sequential by default, see parallel.hh)
+    void permute_edges(std::vector<index_value_t> const& p, executor const& exec = executor::sequential(), permute_scratch* scratch = nullptr) const;
     /// applies an index remapping to all vertices indices (p[curr_idx] = new_idx)
-    void permute_vertices(std::vector<int> const& p) const;
+    /// topology and attributes are gathered via the executor (sequential by default, see parallel.hh)
+    void permute_vertices(std::vector<index_value_t> const& p, executor const& exec = executor::sequential(), permute_scratch* scratch = nullptr) const;
 
     // topology modification
 public:
@@ -0,0 +1,378 @@
+#include "memory_resource.hh"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <new>
+
+#include "assert.hh"
+#include "parallel.hh"
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+using namespace polymesh;
+
+namespace
+{
+class heap_resource final : public memory_resource
+{
+public:
+    void* allocate(size_t bytes, size_t alignment) override
+    {
+        if (alignment > alignof(std::max_align_t))
+            return ::operator new(bytes, std::align_val_t(alignment));
+
+        auto p = std::malloc(bytes);
+        if (!p)
+            throw std::bad_alloc();
+        return p;
+    }
+
+    void deallocate(void* p, size_t, size_t alignment) override
+    {
+        if (alignment > alignof(std::max_align_t))
+            ::operator delete(p, std::align_val_t(alignment));
+        else
+            std::free(p);
+    }
+
+    void* reallocate(void* p, size_t old_bytes, size_t new_bytes, size_t alignment, size_t keep_bytes) override
+    {
+        if (alignment > alignof(std::max_align_t) || new_bytes == 0)
+            return memory_resource::reallocate(p, old_bytes, new_bytes, alignment, keep_bytes);
+
+        // NOTE: large blocks are mmapped by most allocators and realloc remaps their pages instead of copying
+        auto new_p = std::realloc(p, new_bytes);
+        if (!new_p)
+            throw std::bad_alloc();
+        return new_p;
+    }
+};
+
+size_t round_up(size_t size, size_t alignment) { return (size + alignment - 1) / alignment * alignment; }
+
+std::byte* align_up(std::byte* p, size_t alignment)
+{
+    auto const a = uintptr_t(alignment - 1);
+    return p + ((~uintptr_t(p) + 1) & a);
+}
+}
+
+void* memory_resource::reallocate(void* p, size_t old_bytes, size_t new_bytes, size_t alignment, size_t keep_bytes)
+{
+    POLYMESH_ASSERT(keep_bytes <= old_bytes && keep_bytes <= new_bytes);
+
+    void* new_p = nullptr;
+    if (new_bytes > 0)
+    {
+        new_p = allocate(new_bytes, alignment);
+        if (keep_bytes > 0)
+            std::memcpy(new_p, p, keep_bytes);
+    }
+
+    if (p)
+        deallocate(p, old_bytes, alignment);
+
+    return new_p;
+}
+
+memory_resource* memory_resource::heap()
+{
+    static heap_resource resource;
+    return &resource;
+}
+
+struct monotonic_arena::state
+{
+    struct block
+    {
+        block* prev;
+        size_t size; ///< including this header
+    };
+
+    memory_resource* upstream;
+    size_t initial_block_size;
+    size_t next_block_size;
+    block* blocks = nullptr; ///< upstream blocks, newest first
+
+    std::byte* buffer = nullptr; ///< user buffer
+    size_t buffer_size = 0;
+
+    std::byte* curr = nullptr;
+    std::byte* end = nullptr;
+    size_t used = 0;
+
+    std::mutex mutex;
+
+    /// allocates a new block with room for bytes with the given alignment
+    void add_block(size_t bytes, size_t alignment)
+    {
+        auto const size = std::max(next_block_size, sizeof(block) + bytes + alignment);
+        auto const mem = static_cast<std::byte*>(upstream->allocate(size, alignof(std::max_align_t)));
+
+        blocks = new (mem) block{blocks, size};
+        curr = mem + sizeof(block);
+        end = mem + size;
+        next_block_size = 2 * size;
+    }
+};
+
+monotonic_arena::monotonic_arena(size_t initial_block_size, memory_resource* upstream) : mState(new state)
+{
+    mState->upstream = upstream;
+    mState->initial_block_size = std::max(initial_block_size, sizeof(state::block) + 64);
+    mState->next_block_size = mState->initial_block_size;
+}
+
+monotonic_arena::monotonic_arena(void* buffer, size_t buffer_size, memory_resource* upstream)
+  : monotonic_arena(std::max(2 * buffer_size, size_t(4096)), upstream)
+{
+    mState->buffer = static_cast<std::byte*>(buffer);
+    mState->buffer_size = buffer_size;
+    mState->curr = mState->buffer;
+    mState->end = mState->buffer + buffer_size;
+}
+
+monotonic_arena::~monotonic_arena()
+{
+    release();
+    delete mState;
+}
+
+void* monotonic_arena::allocate(size_t bytes, size_t alignment)
+{
+    POLYMESH_ASSERT(alignment > 0 && (alignment & (alignment - 1)) == 0 && "alignment must be a power of two");
+
+    auto& s = *mState;
+    std::lock_guard<std::mutex> lock(s.mutex);
+
+    auto p = s.curr ? align_up(s.curr, alignment) : nullptr;
+    if (!p || p > s.end || size_t(s.end - p) < bytes)
+    {
+        s.add_block(bytes, alignment);
+        p = align_up(s.curr, alignment);
+    }
+
+    s.used += size_t(p + bytes - s.curr);
+    s.curr = p + bytes;
+    return p;
+}
+
+void* monotonic_arena::reallocate(void* p, size_t old_bytes, size_t new_bytes, size_t alignment, size_t keep_bytes)
+{
+    {
+        auto& s = *mState;
+        std::lock_guard<std::mutex> lock(s.mutex);
+
+        // most recent allocation: grow/shrink in-place
+        auto const bp = static_cast<std::byte*>(p);
+        if (bp && bp + old_bytes == s.curr && size_t(s.end - bp) >= new_bytes)
+        {
+            s.used = s.used - old_bytes + new_bytes;
+            s.curr = bp + new_bytes;
+            return new_bytes > 0 ? p : nullptr;
+        }
+    }
+
+    return memory_resource::reallocate(p, old_bytes, new_bytes, alignment, keep_bytes);
+}
+
+void monotonic_arena::rewind()
+{
+    auto& s = *mState;
+    std::lock_guard<std::mutex> lock(s.mutex);
+
+    // keep the largest block (unless the user buffer is larger)
+    state::block* keep = nullptr;
+    for (auto b = s.blocks; b; b = b->prev)
+        if (b->size > s.buffer_size && (!keep || b->size > keep->size))
+            keep = b;
+
+    for (auto b = s.blocks; b;)
+    {
+        auto const prev = b->prev;
+        if (b != keep)
+            s.upstream->deallocate(b, b->size, alignof(std::max_align_t));
+        b = prev;
+    }
+
+    s.blocks = keep;
+    if (keep)
+    {
+        keep->prev = nullptr;
+        s.curr = reinterpret_cast<std::byte*>(keep) + sizeof(state::block);
+        s.end = reinterpret_cast<std::byte*>(keep) + keep->size;
+    }
+    else
+    {
+        s.curr = s.buffer;
+        s.end = s.buffer + s.buffer_size;
+    }
+    s.used = 0;
+}
+
+void monotonic_arena::release()
+{
+    auto& s = *mState;
+    std::lock_guard<std::mutex> lock(s.mutex);
+
+    for (auto b = s.blocks; b;)
+    {
+        auto const prev = b->prev;
+        s.upstream->deallocate(b, b->size, alignof(std::max_align_t));
+        b = prev;
+    }
+
+    s.blocks = nullptr;
+    s.curr = s.buffer;
+    s.end = s.buffer + s.buffer_size;
+    s.used = 0;
+    s.next_block_size = s.initial_block_size;
+}
+
+size_t monotonic_arena::used_bytes() const
+{
+    std::lock_guard<std::mutex> lock(mState->mutex);
+    return mState->used;
+}
+
+size_t monotonic_arena::reserved_bytes() const
+{
+    std::lock_guard<std::mutex> lock(mState->mutex);
+    size_t s = 0;
+    for (auto b = mState->blocks; b; b = b->prev)
+        s += b->size;
+    return s;
+}
+
+namespace
+{
+#ifndef _WIN32
+constexpr size_t huge_page_size = size_t(2) << 20;
+
+size_t page_size()
+{
+    static auto const size = size_t(::sysconf(_SC_PAGESIZE));
+    return size;
+}
+
+/// size of the mapping for an array of the given size
+size_t mapped_size(size_t bytes) { return round_up(bytes, page_size()); }
+
+void advise_huge_pages(void* p, size_t size)
+{
+#ifdef MADV_HUGEPAGE
+    ::madvise(p, size, MADV_HUGEPAGE);
+#else
+    (void)p;
+    (void)size;
+#endif
+}
+
+/// writes to every page of [p + first, p + size) (page-aligned), chunked like parallel algorithms over all of [p, p + size)
+/// NOTE: freshly mapped pages are zero, thus writing a zero is a pure first touch
+void touch_pages(executor const& exec, std::byte* p, size_t size, size_t first = 0)
+{
+    auto const pages = index_value_t(size / page_size());
+    auto const first_page = index_value_t(first / page_size());
+    detail::parallel_chunks(exec, pages, [&](int, index_value_t begin, index_value_t end) {
+        for (auto i = std::max(begin, first_page); i < end; ++i)
+            p[size_t(i) * page_size()] = std::byte(0);
+    });
+}
+
+/// maps size bytes aligned to huge pages (size must be a multiple of the page size)
+std::byte* map_aligned(size_t size)
+{
+    // over-allocate and trim to get a huge-page-aligned start
+    auto const raw_size = size + huge_page_size;
+    auto const raw = ::mmap(nullptr, raw_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED)
+        throw std::bad_alloc();
+
+    auto const begin = static_cast<std::byte*>(raw);
+    auto const p = align_up(begin, huge_page_size);
+    if (p > begin)
+        ::munmap(begin, size_t(p - begin));
+    if (p + size < begin + raw_size)
+        ::munmap(p + size, size_t(begin + raw_size - (p + size)));
+
+    return p;
+}
+#endif
+}
+
+large_array_resource::large_array_resource(options const& opts) : mOptions(opts)
+{
+    POLYMESH_ASSERT(opts.alignment > 0 && (opts.alignment & (opts.alignment - 1)) == 0 && "alignment must be a power of two");
+#ifdef _WIN32
+    mOptions.huge_page_threshold = 0;
+#else
+    if (mOptions.alignment > page_size())
+        mOptions.huge_page_threshold = 0; // mappings are only page-aligned after mremap
+#endif
+}
+
+void* large_array_resource::allocate(size_t bytes, size_t alignment)
+{
+#ifndef _WIN32
+    if (is_mapped(bytes))
+    {
+        auto const size = mapped_size(bytes);
+        auto const p = map_aligned(size);
+        advise_huge_pages(p, size);
+        if (mOptions.first_touch)
+            touch_pages(*mOptions.first_touch, p, size);
+        return p;
+    }
+#endif
+
+    return ::operator new(bytes, std::align_val_t(std::max(alignment, mOptions.alignment)));
+}
+
+void large_array_resource::deallocate(void* p, size_t bytes, size_t alignment)
+{
+#ifndef _WIN32
+    if (is_mapped(bytes))
+    {
+        ::munmap(p, mapped_size(bytes));
+        return;
+    }
+#endif
+
+    ::operator delete(p, std::align_val_t(std::max(alignment, mOptions.alignment)));
+}
+
+void* large_array_resource::reallocate(void* p, size_t old_bytes, size_t new_bytes, size_t alignment, size_t keep_bytes)
+{
+#if defined(__linux__) && defined(MREMAP_MAYMOVE)
+    if (p && is_mapped(old_bytes) && is_mapped(new_bytes))
+    {
+        auto const old_size = mapped_size(old_bytes);
+        auto const new_size = mapped_size(new_bytes);
+        if (old_size == new_size)
+            return p;
+
+        // moves the pages instead of copying (and grows in-place if possible)
+        auto const r = ::mremap(p, old_size, new_size, MREMAP_MAYMOVE);
+        if (r == MAP_FAILED)
+            throw std::bad_alloc();
+
+        auto const new_p = static_cast<std::byte*>(r);
+        if (new_size > old_size)
+        {
+            advise_huge_pages(new_p, new_size);
+            if (mOptions.first_touch)
+                touch_pages(*mOptions.first_touch, new_p, new_size, old_size);
+        }
+        return new_p;
+    }
+#endif
+
+    return memory_resource::reallocate(p, old_bytes, new_bytes, alignment, keep_bytes);
+}
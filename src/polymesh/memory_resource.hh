@@ -0,0 +1,145 @@
+#pragma once
+
+#include <cstddef>
+
+namespace polymesh
+{
+class executor;
+
+/**
+ * A memory resource provides the storage for mesh topology and attributes
+ *
+ * A Mesh uses the resource passed at construction (the global heap by default) for its topology arrays,
+ * every attribute registered on the mesh allocates its data from the same resource.
+ * Custom arenas / pools can be plugged in by deriving from memory_resource.
+ *
+ * Usage:
+ *
+ *   pm::monotonic_arena arena;
+ *   for (auto const& file : files)
+ *   {
+ *       pm::Mesh m(arena);
+ *       auto pos = m.vertices().make_attribute<tg::pos3>(); // also allocated from the arena
+ *       load(file, m, pos);
+ *       ...
+ *       arena.rewind(); // AFTER m and its attributes are destroyed: one bulk release, the memory is reused for the next mesh
+ *   }
+ *
+ * NOTE: the resource must outlive the mesh and all of its attributes
+ * NOTE: allocate/deallocate must be thread-safe (parallel algorithms, e.g. compactify(exec), resize attributes concurrently)
+ */
+class memory_resource
+{
+public:
+    virtual ~memory_resource() = default;
+
+    /// returns at least bytes bytes aligned to alignment (a power of two)
+    virtual void* allocate(size_t bytes, size_t alignment) = 0;
+    /// returns memory obtained by allocate(bytes, alignment) (with the same arguments)
+    virtual void deallocate(void* p, size_t bytes, size_t alignment) = 0;
+    /// resizes memory obtained by allocate(old_bytes, alignment) to new_bytes (p may be nullptr if old_bytes is 0)
+    /// only the first keep_bytes are preserved (bitwise), the rest is uninitialized
+    /// returns nullptr if new_bytes is 0
+    /// the default implementation allocates, copies, and deallocates
+    /// NOTE: only used for trivially copyable data (which is why the memory may be moved, e.g. via realloc)
+    virtual void* reallocate(void* p, size_t old_bytes, size_t new_bytes, size_t alignment, size_t keep_bytes);
+
+    /// global heap (the default for all meshes)
+    /// uses malloc/realloc/free (thus large arrays typically grow in-place via mremap) and aligned operator new for over-aligned types
+    static memory_resource* heap();
+};
+
+/**
+ * A thread-safe bump allocator for short-lived meshes
+ *
+ * Memory is requested from the upstream resource in blocks of geometrically growing size,
+ * deallocate is a no-op and everything is released at once (via rewind, release, or the destructor).
+ * Optionally, the first block is a user-provided buffer (e.g. on the stack).
+ *
+ * NOTE: memory of arrays that are reallocated (e.g. when a mesh grows) is only reclaimed on rewind/release
+ *       (unless the array is the most recent allocation, then it grows in-place),
+ *       thus reserving the final capacity beforehand reduces the footprint
+ */
+class monotonic_arena final : public memory_resource
+{
+public:
+    explicit monotonic_arena(size_t initial_block_size = 64 << 10, memory_resource* upstream = memory_resource::heap());
+    monotonic_arena(void* buffer, size_t buffer_size, memory_resource* upstream = memory_resource::heap());
+    ~monotonic_arena() override;
+
+    monotonic_arena(monotonic_arena const&) = delete;
+    monotonic_arena& operator=(monotonic_arena const&) = delete;
+
+    void* allocate(size_t bytes, size_t alignment) override;
+    void deallocate(void*, size_t, size_t) override {}
+    /// grows or shrinks in-place if p is the most recent allocation
+    void* reallocate(void* p, size_t old_bytes, size_t new_bytes, size_t alignment, size_t keep_bytes) override;
+
+    /// makes all memory available again, keeps only the largest upstream block (or the user buffer)
+    /// (avoids upstream allocations when the arena is reused for similar meshes)
+    /// CAUTION: all allocations become invalid
+    void rewind();
+    /// returns all upstream blocks
+    /// CAUTION: all allocations become invalid
+    void release();
+
+    /// bytes handed out since the last rewind/release (including alignment padding)
+    size_t used_bytes() const;
+    /// bytes currently held from upstream (excluding the user buffer)
+    size_t reserved_bytes() const;
+
+private:
+    struct state; // defined in the .cc (keeps <mutex> out of this header)
+    state* mState;
+};
+
+/**
+ * A heap for large meshes (e.g. beyond a few hundred MB)
+ *
+ * - every allocation is aligned to at least options::alignment (64 bytes by default, i.e. aligned SIMD loads of whole cache lines)
+ * - arrays of at least options::huge_page_threshold bytes are mapped directly from the OS and advised for transparent huge pages
+ *   (fewer TLB misses), growing them remaps the pages instead of copying (Linux)
+ * - optionally, newly mapped pages are first touched in parallel by options::first_touch
+ *   using the same chunking as the parallel algorithms (see parallel.hh),
+ *   thus on NUMA systems pages tend to be placed on the node of the thread that later processes the corresponding index range
+ *
+ * Usage:
+ *
+ *   pm::large_array_resource::options opts;
+ *   opts.first_touch = &pm::executor::default_pool();
+ *   pm::large_array_resource resource(opts);
+ *
+ *   pm::Mesh m(resource);
+ *
+ * NOTE: huge pages and first touch are only supported on POSIX systems, otherwise this is an aligned heap
+ * NOTE: first touch only helps if the kernels run on the same executor (and the threads are pinned)
+ */
+class large_array_resource final : public memory_resource
+{
+public:
+    struct options
+    {
+        /// minimum alignment of all allocations (a power of two)
+        size_t alignment = 64;
+        /// arrays of at least this size are mapped and advised for huge pages (0 means never)
+        size_t huge_page_threshold = size_t(2) << 20;
+        /// if non-null, newly mapped pages are touched in parallel on this executor
+        /// NOTE: the executor must outlive the resource
+        executor const* first_touch = nullptr;
+    };
+
+    large_array_resource() : large_array_resource(options{}) {}
+    explicit large_array_resource(options const& opts);
+
+    void* allocate(size_t bytes, size_t alignment) override;
+    void deallocate(void* p, size_t bytes, size_t alignment) override;
+    void* reallocate(void* p, size_t old_bytes, size_t new_bytes, size_t alignment, size_t keep_bytes) override;
+
+    options const& get_options() const { return mOptions; }
+
+private:
+    bool is_mapped(size_t bytes) const { return mOptions.huge_page_threshold > 0 && bytes >= mOptions.huge_page_threshold; }
+
+    options mOptions;
+};
+}
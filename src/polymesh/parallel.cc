@@ -0,0 +1,236 @@
+#include "parallel.hh"
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace polymesh;
+
+namespace
+{
+/// true while the current thread executes tasks of a pool
+thread_local bool tl_inside_pool = false;
+
+/**
+ * Persistent thread pool with range stealing
+ *
+ * Each participant owns a range [begin, end) of task indices packed into a single 64 bit atomic.
+ * The owner pops tasks from the front, thieves cut off the back half of the range.
+ * Both are a single CAS on the same word, thus every task is executed exactly once without locks.
+ */
+class stealing_pool
+{
+public:
+    explicit stealing_pool(int thread_count) : mRanges(size_t(thread_count))
+    {
+        mThreads.reserve(size_t(thread_count - 1));
+        for (auto t = 1; t < thread_count; ++t)
+            mThreads.emplace_back([this, t] { worker_loop(t); });
+    }
+
+    ~stealing_pool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mStop = true;
+        }
+        mWorkCond.notify_all();
+        for (auto& t : mThreads)
+            t.join();
+    }
+
+    int size() const { return int(mRanges.size()); }
+
+    void run(int count, executor::task_fn const& task)
+    {
+        if (tl_inside_pool)
+        {
+            for (auto i = 0; i < count; ++i)
+                task(i);
+            return;
+        }
+
+        std::lock_guard<std::mutex> run_lock(mRunMutex);
+
+        // initial partition: contiguous ranges
+        auto const n = size();
+        for (auto t = 0; t < n; ++t)
+            mRanges[size_t(t)].r.store(pack(int(int64_t(count) * t / n), int(int64_t(count) * (t + 1) / n)), std::memory_order_relaxed);
+
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mTask = &task;
+            mBusy = n - 1;
+            ++mGeneration;
+        }
+        mWorkCond.notify_all();
+
+        tl_inside_pool = true;
+        execute(0);
+        tl_inside_pool = false;
+
+        std::unique_lock<std::mutex> lock(mMutex);
+        mDoneCond.wait(lock, [&] { return mBusy == 0; });
+        mTask = nullptr;
+    }
+
+private:
+    static uint64_t pack(int begin, int end) { return (uint64_t(uint32_t(begin)) << 32) | uint32_t(end); }
+    static int begin_of(uint64_t r) { return int(uint32_t(r >> 32)); }
+    static int end_of(uint64_t r) { return int(uint32_t(r)); }
+
+    /// takes the first task of the own range
+    bool pop(int self, int& task_idx)
+    {
+        auto& r = mRanges[size_t(self)].r;
+        auto v = r.load(std::memory_order_relaxed);
+        while (begin_of(v) < end_of(v))
+            if (r.compare_exchange_weak(v, pack(begin_of(v) + 1, end_of(v)), std::memory_order_relaxed))
+            {
+                task_idx = begin_of(v);
+                return true;
+            }
+        return false;
+    }
+
+    /// moves the back half of the range of another participant into the own (empty) range
+    bool steal(int self)
+    {
+        auto const n = size();
+        for (auto i = 1; i < n; ++i)
+        {
+            auto& r = mRanges[size_t((self + i) % n)].r;
+            auto v = r.load(std::memory_order_relaxed);
+            while (begin_of(v) < end_of(v))
+            {
+                auto const mid = begin_of(v) + (end_of(v) - begin_of(v)) / 2;
+                if (r.compare_exchange_weak(v, pack(begin_of(v), mid), std::memory_order_relaxed))
+                {
+                    mRanges[size_t(self)].r.store(pack(mid, end_of(v)), std::memory_order_relaxed);
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    void execute(int self)
+    {
+        auto const& task = *mTask;
+        auto task_idx = 0;
+        do
+        {
+            while (pop(self, task_idx))
+                task(task_idx);
+        } while (steal(self));
+    }
+
+    void worker_loop(int self)
+    {
+        tl_inside_pool = true;
+        auto generation = uint64_t(0);
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> lock(mMutex);
+                mWorkCond.wait(lock, [&] { return mStop || mGeneration != generation; });
+                if (mStop)
+                    return;
+                generation = mGeneration;
+            }
+
+            execute(self);
+
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                --mBusy;
+                if (mBusy == 0)
+                    mDoneCond.notify_one();
+            }
+        }
+    }
+
+private:
+    // one cache line per range to avoid false sharing
+    struct alignas(64) padded_range
+    {
+        std::atomic<uint64_t> r{0};
+    };
+
+    std::vector<padded_range> mRanges;
+    std::vector<std::thread> mThreads;
+
+    std::mutex mRunMutex; ///< serializes run() calls
+
+    std::mutex mMutex;
+    std::condition_variable mWorkCond;
+    std::condition_variable mDoneCond;
+    executor::task_fn const* mTask = nullptr;
+    uint64_t mGeneration = 0;
+    int mBusy = 0;
+    bool mStop = false;
+};
+}
+
+executor executor::sequential() { return executor(1, nullptr); }
+
+executor executor::threads(int thread_count)
+{
+    if (thread_count <= 0)
+        thread_count = std::max(1, int(std::thread::hardware_concurrency()));
+
+    return executor(thread_count, [thread_count](int count, task_fn const& task) {
+        // tasks are distributed dynamically via a shared counter
+        std::atomic<int> next_task{0};
+        auto worker = [&] {
+            for (auto i = next_task++; i < count; i = next_task++)
+                task(i);
+        };
+
+        std::vector<std::thread> threads;
+        threads.reserve(std::min(thread_count, count) - 1);
+        for (auto t = 1; t < std::min(thread_count, count); ++t)
+            threads.emplace_back(worker);
+
+        worker();
+
+        for (auto& t : threads)
+            t.join();
+    });
+}
+
+executor executor::pool(int thread_count)
+{
+    if (thread_count <= 0)
+        thread_count = std::max(1, int(std::thread::hardware_concurrency()));
+
+    if (thread_count == 1)
+        return sequential();
+
+    auto pool = std::make_shared<stealing_pool>(thread_count);
+    return executor(thread_count, [pool](int count, task_fn const& task) { pool->run(count, task); });
+}
+
+executor const& executor::default_pool()
+{
+    static executor const pool = executor::pool();
+    return pool;
+}
+
+void executor::run(int count, task_fn const& task) const
+{
+    if (count <= 0)
+        return;
+
+    if (is_sequential() || count == 1)
+    {
+        for (auto i = 0; i < count; ++i)
+            task(i);
+        return;
+    }
+
+    mRun(count, task);
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <utility>
+
+#include "fwd.hh"
+
+namespace polymesh
+{
+/**
+ * An executor runs a number of independent tasks, potentially in parallel
+ *
+ * run(count, task) calls task(0), ..., task(count - 1) in arbitrary order and on arbitrary threads
+ * and returns once all of them are done
+ *
+ * Custom task systems / thread pools can be plugged in via the (concurrency, run_fn) ctor
+ * concurrency is only a hint for how many tasks should be created to keep all threads busy
+ *
+ * Usage:
+ *
+ *   m.compactify(pm::executor::threads());      // use all hardware threads
+ *   m.compactify(pm::executor::threads(4));     // use 4 threads
+ *   m.compactify(pm::executor::default_pool()); // use the persistent process-wide pool
+ *   m.compactify(pm::executor(my_pool.size(), [&](int count, auto const& task) { my_pool.run_n(count, task); }));
+ */
+class executor
+{
+public:
+    using task_fn = std::function<void(int)>;
+    using run_fn = std::function<void(int, task_fn const&)>;
+
+    /// runs all tasks on the calling thread
+    static executor sequential();
+    /// runs tasks on up to thread_count std::threads (0 means std::thread::hardware_concurrency())
+    /// NOTE: threads are started per run() call, the calling thread participates
+    static executor threads(int thread_count = 0);
+    /// runs tasks on a persistent pool of thread_count threads (0 means std::thread::hardware_concurrency())
+    /// NOTE: the calling thread participates, the pool lives as long as any copy of the returned executor
+    ///       each thread starts with a contiguous range of tasks, idle threads steal half of the remaining range of another thread (lock-free)
+    ///       runs that are issued from within a task of the pool are executed on the calling thread
+    ///       concurrent runs from different threads are serialized
+    static executor pool(int thread_count = 0);
+    /// a process-wide pool with std::thread::hardware_concurrency() threads (created on first use)
+    static executor const& default_pool();
+
+    executor(int concurrency, run_fn run) : mConcurrency(std::max(1, concurrency)), mRun(std::move(run)) {}
+
+    void run(int count, task_fn const& task) const;
+
+    int concurrency() const { return mConcurrency; }
+    bool is_sequential() const { return !mRun || mConcurrency == 1; }
+
+private:
+    int mConcurrency = 1;
+    run_fn mRun;
+};
+
+namespace detail
+{
+/// number of chunks that [0, size) is split into (at least 1)
+inline int chunk_count(executor const& exec, index_value_t size, index_value_t min_chunk_size = 1 << 12)
+{
+    if (exec.is_sequential() || size <= min_chunk_size)
+        return 1;
+
+    return int(std::max(index_value_t(1), std::min(index_value_t(4 * exec.concurrency()), size / min_chunk_size)));
+}
+
+/// [begin, end) of the i-th of chunk_cnt chunks of [0, size)
+inline std::pair<index_value_t, index_value_t> chunk_range(index_value_t size, int chunk_cnt, int i)
+{
+    auto const begin = index_value_t(int64_t(size) * i / chunk_cnt);
+    auto const end = index_value_t(int64_t(size) * (i + 1) / chunk_cnt);
+    return {begin, end};
+}
+
+/// calls f(chunk_idx, begin, end) for all chunks of [0, size) (see chunk_count)
+template <class F>
+void parallel_chunks(executor const& exec, index_value_t size, F&& f)
+{
+    auto const chunk_cnt = chunk_count(exec, size);
+    if (chunk_cnt == 1)
+    {
+        f(0, index_value_t(0), size);
+        return;
+    }
+
+    exec.run(chunk_cnt, [&](int i) {
+        auto const r = chunk_range(size, chunk_cnt, i);
+        f(i, r.first, r.second);
+    });
+}
+
+/// number of blocks of (at most) block_size elements that [0, size) is split into
+inline int block_count(index_value_t size, index_value_t block_size) { return int((int64_t(size) + block_size - 1) / block_size); }
+
+/// calls f(block_idx, begin, end) for all blocks of block_size consecutive elements of [0, size)
+/// NOTE: in contrast to parallel_chunks, the partition does not depend on the executor
+///       (used for reductions that should give the same result for every thread count)
+template <class F>
+void parallel_blocks(executor const& exec, index_value_t size, index_value_t block_size, F&& f)
+{
+    auto const block_cnt = block_count(size, block_size);
+    if (block_cnt == 1)
+    {
+        f(0, index_value_t(0), size);
+        return;
+    }
+
+    exec.run(block_cnt, [&](int i) {
+        auto const begin = i * block_size;
+        f(i, begin, std::min(size, begin + block_size));
+    });
+}
+
+/// calls f(i) for all i in [0, size), potentially in parallel
+template <class F>
+void parallel_for(executor const& exec, index_value_t size, F&& f)
+{
+    parallel_chunks(exec, size, [&](int, index_value_t begin, index_value_t end) {
+        for (auto i = begin; i < end; ++i)
+            f(i);
+    });
+}
+}
+}
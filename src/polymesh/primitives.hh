@@ -26,10 +26,10 @@ struct primitive<vertex_tag>
     template <class AttrT>
     using attribute = vertex_attribute<AttrT>;
 
-    static int all_size(Mesh const& m);
-    static int valid_size(Mesh const& m);
-    static int capacity(Mesh const& m);
-    static void reserve(Mesh& m, int capacity);
+    static index_value_t all_size(Mesh const& m);
+    static index_value_t valid_size(Mesh const& m);
+    static index_value_t capacity(Mesh const& m);
+    static void reserve(Mesh& m, index_value_t capacity);
     static all_collection all_collection_of(Mesh& m);
     static all_const_collection all_collection_of(Mesh const& m);
     static valid_collection valid_collection_of(Mesh& m);
@@ -55,10 +55,10 @@ struct primitive<face_tag>
     template <class AttrT>
     using attribute = face_attribute<AttrT>;
 
-    static int all_size(Mesh const& m);
-    static int valid_size(Mesh const& m);
-    static int capacity(Mesh const& m);
-    static void reserve(Mesh& m, int capacity);
+    static index_value_t all_size(Mesh const& m);
+    static index_value_t valid_size(Mesh const& m);
+    static index_value_t capacity(Mesh const& m);
+    static void reserve(Mesh& m, index_value_t capacity);
     static all_collection all_collection_of(Mesh& m);
     static all_const_collection all_collection_of(Mesh const& m);
     static valid_collection valid_collection_of(Mesh& m);
@@ -84,10 +84,10 @@ struct primitive<edge_tag>
     template <class AttrT>
     using attribute = edge_attribute<AttrT>;
 
-    static int all_size(Mesh const& m);
-    static int valid_size(Mesh const& m);
-    static int capacity(Mesh const& m);
-    static void reserve(Mesh& m, int capacity);
+    static index_value_t all_size(Mesh const& m);
+    static index_value_t valid_size(Mesh const& m);
+    static index_value_t capacity(Mesh const& m);
+    static void reserve(Mesh& m, index_value_t capacity);
     static all_collection all_collection_of(Mesh& m);
     static all_const_collection all_collection_of(Mesh const& m);
     static valid_collection valid_collection_of(Mesh& m);
@@ -113,10 +113,10 @@ struct primitive<halfedge_tag>
     template <class AttrT>
     using attribute = halfedge_attribute<AttrT>;
 
-    static int all_size(Mesh const& m);
-    static int valid_size(Mesh const& m);
-    static int capacity(Mesh const& m);
-    static void reserve(Mesh& m, int capacity);
+    static index_value_t all_size(Mesh const& m);
+    static index_value_t valid_size(Mesh const& m);
+    static index_value_t capacity(Mesh const& m);
+    static void reserve(Mesh& m, index_value_t capacity);
     static all_collection all_collection_of(Mesh& m);
     static all_const_collection all_collection_of(Mesh const& m);
     static valid_collection valid_collection_of(Mesh& m);
@@ -76,7 +76,7 @@ bool is_triangle_mesh(Mesh const& m);
 bool is_quad_mesh(Mesh const& m);
 
 /// returns the euler characteristic for this mesh
-int euler_characteristic(Mesh const& m);
+index_value_t euler_characteristic(Mesh const& m);
 
 /// returns true iff the mesh is closed (has no boundary)
 /// isolated vertices are ignored
@@ -255,7 +255,7 @@ inline bool is_vertex_isolated(vertex_handle v) { return v.is_isolated(); }
 inline bool is_isolated(edge_handle e) { return e.is_isolated(); }
 inline bool is_edge_isolated(edge_handle e) { return e.is_isolated(); }
 
-inline int valence(vertex_handle v) { return v.adjacent_vertices().size(); }
+inline int valence(vertex_handle v) { return int(v.adjacent_vertices().size()); }
 
 inline bool is_triangle(face_handle f) { return f.halfedges().size() == 3; }
 inline bool is_quad(face_handle f) { return f.halfedges().size() == 4; }
@@ -287,7 +287,7 @@ inline bool are_adjacent(vertex_handle v0, vertex_handle v1)
 inline bool is_triangle_mesh(Mesh const& m) { return m.faces().all(is_triangle); }
 inline bool is_quad_mesh(Mesh const& m) { return m.faces().all(is_quad); }
 
-inline int euler_characteristic(Mesh const& m) { return m.vertices().size() - m.edges().size() + m.faces().size(); }
+inline index_value_t euler_characteristic(Mesh const& m) { return m.vertices().size() - m.edges().size() + m.faces().size(); }
 
 inline bool is_closed_mesh(Mesh const& m) { return !m.halfedges().any(is_halfedge_boundary); }
 
@@ -648,8 +648,21 @@ face_attribute<typename field3<Pos3>::vec_t> triangle_normals(vertex_attribute<P
 template <class Pos3>
 face_attribute<typename field3<Pos3>::scalar_t> triangle_areas(vertex_attribute<Pos3> const& position)
 {
+    using scalar_t = typename field3<Pos3>::scalar_t;
+
+    // index-only version of triangle_area (no handles in the inner loop)
     auto const& m = position.mesh();
-    return m.faces().map([&](face_handle f) { return triangle_area(f, position); });
+    auto const ll = low_level_api(m);
+    auto const pos = position.data();
+    auto areas = m.faces().template make_attribute<scalar_t>();
+    m.faces().for_each_index(areas, [&](face_index f, scalar_t& area) {
+        auto h = ll.halfedge_of(f);
+        auto const& p0 = pos[ll.from_vertex_of(h).value];
+        auto const& p1 = pos[ll.to_vertex_of(h).value];
+        auto const& p2 = pos[ll.to_vertex_of(ll.next_halfedge_of(h)).value];
+        area = field3<Pos3>::length(field3<Pos3>::cross(p0 - p1, p0 - p2)) * field3<Pos3>::scalar(0.5f);
+    });
+    return areas;
 }
 
 template <class Pos3>
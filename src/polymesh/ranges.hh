@@ -7,6 +7,7 @@
 #include <vector>
 
 #include "iterators.hh"
+#include "parallel.hh"
 
 namespace polymesh
 {
@@ -55,10 +56,10 @@ struct smart_range
     /// returns the number of elements in this range
     /// NOTE: this is an O(n) operation, prefer size() if available
     /// TODO: maybe SFINAE to implement this via size() if available?
-    int count() const;
+    index_value_t count() const;
     /// returns the number of elements satisfying p(v) in this range
     template <class PredT>
-    int count(PredT&& p) const;
+    index_value_t count(PredT&& p) const;
 
     /// calculates min(f(e)) over all elements
     /// undefined behavior if range is empty
@@ -202,6 +203,25 @@ struct filtered_range : smart_range<filtered_range<ElementT, RangeT, PredT>, Ele
 // TODO: mapped_range
 
 
+// ================= INDICES =================
+
+/// Range over the indices of a primitive collection (see smart_collection::indices)
+/// a plain integer range if no removed primitives have to be skipped
+template <class tag>
+struct primitive_index_range : smart_range<primitive_index_range<tag>, typename primitive<tag>::index>
+{
+    using index = typename primitive<tag>::index;
+
+    primitive_index_range(Mesh const* skip_mesh, index_value_t all_size) : skip_mesh(skip_mesh), all_size(all_size) {}
+
+    primitive_index_iterator<tag> begin() const { return {skip_mesh, index(0), index(all_size)}; }
+    end_iterator end() const { return {}; }
+
+    Mesh const* skip_mesh; ///< nullptr if no removed primitives have to be skipped
+    index_value_t all_size;
+};
+
+
 // ================= COLLECTION =================
 
 template <class mesh_ptr, class tag, class iterator>
@@ -214,10 +234,23 @@ struct smart_collection : smart_range<smart_collection<mesh_ptr, tag, iterator>,
 
     /// Number of primitives (includes those marked for deletion if all_xyz collection is used)
     /// O(1) computation
-    int size() const;
+    index_value_t size() const;
 
     /// Ensures that a given number of primitives can be stored without reallocation
-    void reserve(int capacity) const;
+    void reserve(index_value_t capacity) const;
+
+    /// Opt-in: (trivially copyable) attributes of this primitive kind that are created afterwards share one allocation
+    /// a capacity change then costs one allocation plus a copy per attribute (in parallel if exec is non-null)
+    /// bytes_per_element and attribute_count reserve room for the expected attributes (so creating them does not allocate)
+    /// NOTE: pooled attributes must not outlive the mesh
+    ///       unpooled arrays of trivially copyable types grow via realloc, which can be cheaper for very large arrays
+    void enable_attribute_pool(size_t bytes_per_element = 0, int attribute_count = 0, executor const* exec = nullptr) const;
+    /// enable_attribute_pool with room for one attribute of each of the given types
+    template <class... AttrTs>
+    void declare_attributes(executor const* exec = nullptr) const
+    {
+        enable_attribute_pool((size_t(0) + ... + sizeof(AttrTs)), int(sizeof...(AttrTs)), exec);
+    }
 
     /// Creates a new primitive attribute (optionally with a default value)
     template <class AttrT>
@@ -229,11 +262,52 @@ struct smart_collection : smart_range<smart_collection<mesh_ptr, tag, iterator>,
     attribute<AttrT> make_attribute_from_data(std::vector<AttrT> const& data) const;
     /// Creates a new primitive attribute and copies the given data
     template <class AttrT>
-    attribute<AttrT> make_attribute_from_data(AttrT const* data, int cnt) const;
+    attribute<AttrT> make_attribute_from_data(AttrT const* data, index_value_t cnt) const;
     /// same as make_attribute(f, def_value)
     template <class FuncT, class AttrT = tmp::decayed_result_type_of<FuncT, handle>>
     attribute<AttrT> map(FuncT&& f, AttrT const& def_value = AttrT()) const;
 
+    // Parallel versions:
+    // the index space is split into blocks that are processed by the executor (see parallel.hh)
+    // removed primitives are skipped per block (no per-step search for the next valid primitive)
+    // f is called concurrently and must not modify shared state (writing attr[h] for the given h is fine)
+    // reductions combine fixed-size blocks in index order, thus results do not depend on the number of threads
+    // (they may differ slightly from the sequential versions for floating point values though)
+
+    /// calls f(h) for each primitive
+    template <class FuncT>
+    void parallel_for_each(FuncT&& f, executor const& exec = executor::default_pool()) const;
+    /// same as map(f) but computed in parallel
+    template <class FuncT, class AttrT = tmp::decayed_result_type_of<FuncT, handle>>
+    attribute<AttrT> parallel_map(FuncT&& f, executor const& exec = executor::default_pool()) const;
+    /// same as sum(f) but computed in parallel
+    template <class FuncT>
+    auto parallel_sum(FuncT&& f, executor const& exec = executor::default_pool()) const -> tmp::decayed_result_type_of<FuncT, handle>;
+    /// same as min(f) but computed in parallel
+    template <class FuncT>
+    auto parallel_min(FuncT&& f, executor const& exec = executor::default_pool()) const -> tmp::decayed_result_type_of<FuncT, handle>;
+    /// same as max(f) but computed in parallel
+    template <class FuncT>
+    auto parallel_max(FuncT&& f, executor const& exec = executor::default_pool()) const -> tmp::decayed_result_type_of<FuncT, handle>;
+    /// same as aabb(f) but computed in parallel
+    template <class FuncT>
+    auto parallel_aabb(FuncT&& f, executor const& exec = executor::default_pool()) const -> polymesh::minmax_t<tmp::decayed_result_type_of<FuncT, handle>>;
+
+    // Index-only versions:
+    // indices are plain integers without the mesh pointer of handles, which keeps tight loops small and vectorizable
+
+    /// returns the indices of this collection (yields index instead of handle)
+    /// a plain integer range if the mesh is compact (or for all_xyz collections)
+    primitive_index_range<tag> indices() const;
+    /// calls f(idx, a[idx], b[idx], ...) for each primitive, where a, b, ... are attributes of this primitive kind
+    /// usage: m.faces().for_each_index(areas, normals, [&](face_index f, float& area, vec3& n) { ... });
+    /// (f(a[idx], b[idx], ...) is called instead if f does not take the index)
+    /// attribute data is passed as raw references, the attributes are only checked once (not per access)
+    /// if the mesh is compact (or for all_xyz collections), this is a plain loop over 0..size that compilers can vectorize
+    /// NOTE: f must not change the topology of the mesh
+    template <class... Args>
+    void for_each_index(Args&&... attrs_and_f) const;
+
     // Iteration:
     iterator begin() const;
     end_iterator end() const { return {}; }
@@ -247,9 +321,20 @@ struct smart_collection : smart_range<smart_collection<mesh_ptr, tag, iterator>,
 
     /// converts the given integer index into a handle
     /// CAUTION: always includes primitives marked for deletion, this is the numerical value of the handle
-    handle operator[](int idx) const;
+    handle operator[](index_value_t idx) const;
     handle operator[](index idx) const;
 
+protected:
+    /// calls f(h) for all primitives with index in [begin, end)
+    template <class FuncT>
+    void for_each_in(index_value_t begin, index_value_t end, FuncT&& f) const;
+    /// calls f(idx, data[idx]...) or f(data[idx]...) for all primitives with index in [begin, end)
+    template <class FuncT, class... Ts>
+    void for_each_index_in(index_value_t begin, index_value_t end, FuncT&& f, Ts*... data) const;
+    /// reduces all f(h) via combine(a, b) in deterministic order (see parallel_sum)
+    template <class FuncT, class CombineT>
+    auto parallel_reduce(executor const& exec, FuncT&& f, CombineT&& combine) const -> tmp::decayed_result_type_of<FuncT, handle>;
+
 protected:
     /// Backreference to mesh
     mesh_ptr m;
@@ -280,8 +365,10 @@ struct vertex_collection : smart_collection<Mesh*, vertex_tag, iterator>
 
     /// applies an index remapping to all vertex indices
     /// p[curr_idx] = new_idx
+    /// topology and attributes are gathered via the executor (sequential by default, see parallel.hh)
+    /// If scratch is provided, its memory is reused (avoids reallocations for repeated permutations, see detail/permutation.hh)
     /// NOTE: invalidates all affected handles/iterators
-    void permute(std::vector<int> const& p) const;
+    void permute(std::vector<index_value_t> const& p, executor const& exec = executor::sequential(), permute_scratch* scratch = nullptr) const;
 };
 
 /// Collection of all faces of a mesh
@@ -351,8 +438,10 @@ struct face_collection : smart_collection<Mesh*, face_tag, iterator>
 
     /// applies an index remapping to all face indices
     /// p[curr_idx] = new_idx
+    /// topology and attributes are gathered via the executor (sequential by default, see parallel.hh)
+    /// If scratch is provided, its memory is reused (avoids reallocations for repeated permutations, see detail/permutation.hh)
     /// NOTE: invalidates all affected handles/iterators
-    void permute(std::vector<int> const& p) const;
+    void permute(std::vector<index_value_t> const& p, executor const& exec = executor::sequential(), permute_scratch* scratch = nullptr) const;
 };
 
 /// Collection of all edges of a mesh
@@ -412,8 +501,10 @@ struct edge_collection : smart_collection<Mesh*, edge_tag, iterator>
 
     /// applies an index remapping to all edge indices
     /// p[curr_idx] = new_idx
+    /// topology and attributes are gathered via the executor (sequential by default, see parallel.hh)
+    /// If scratch is provided, its memory is reused (avoids reallocations for repeated permutations, see detail/permutation.hh)
     /// NOTE: invalidates all affected handles/iterators
-    void permute(std::vector<int> const& p) const;
+    void permute(std::vector<index_value_t> const& p, executor const& exec = executor::sequential(), permute_scratch* scratch = nullptr) const;
 };
 
 /// Collection of all half-edges of a mesh
@@ -556,7 +647,7 @@ struct primitive_ring : smart_range<this_t, typename primitive<tag>::handle>
 
     /// Number of elements
     /// O(result) computation
-    int size() const;
+    index_value_t size() const;
     /// Returns true if handle is contained in this ring
     bool contains(handle v) const;
 };
@@ -0,0 +1,151 @@
+#include "triangle_mesh.hh"
+
+#include <atomic>
+#include <iostream>
+
+using namespace polymesh;
+
+bool triangle_mesh::build_from_triangles(span<index_value_t const> indices, index_value_t vertex_count, executor const& exec)
+{
+    clear();
+
+    if (indices.size() % 3 != 0)
+    {
+        std::cerr << "triangle index buffer size must be a multiple of 3" << std::endl;
+        return false;
+    }
+
+    auto const h_cnt = index_value_t(indices.size());
+    for (auto i : indices)
+        if (i < 0 || i >= vertex_count)
+        {
+            std::cerr << "triangle index " << i << " out of range" << std::endl;
+            return false;
+        }
+
+    mToVertex.resize(h_cnt);
+    mOpposite.resize(h_cnt);
+    mOutgoing.resize(vertex_count);
+
+    // to_vertex(h) is the next corner of the face
+    detail::parallel_for(exec, h_cnt, [&](index_value_t h) { mToVertex[h] = vertex_index(indices[next_halfedge_of(halfedge_index(h)).value]); });
+
+    // outgoing halfedges per vertex (CSR)
+    std::vector<index_value_t> out_offsets(vertex_count + 1, 0);
+    std::vector<index_value_t> out_halfedges(h_cnt);
+    for (index_value_t h = 0; h < h_cnt; ++h)
+        ++out_offsets[indices[h] + 1];
+    for (index_value_t v = 0; v < vertex_count; ++v)
+        out_offsets[v + 1] += out_offsets[v];
+    {
+        std::vector<index_value_t> pos(out_offsets.begin(), out_offsets.end() - 1);
+        for (index_value_t h = 0; h < h_cnt; ++h)
+            out_halfedges[pos[indices[h]]++] = h;
+    }
+
+    std::atomic<bool> is_manifold{true};
+
+    // opposite of a -> b is the unique b -> a
+    detail::parallel_for(exec, h_cnt, [&](index_value_t h) {
+        auto const a = indices[h];
+        auto const b = mToVertex[h].value;
+
+        auto opp = halfedge_index::invalid;
+        for (auto i = out_offsets[b]; i < out_offsets[b + 1]; ++i)
+            if (mToVertex[out_halfedges[i]].value == a)
+            {
+                if (opp.is_valid())
+                    is_manifold = false;
+                opp = halfedge_index(out_halfedges[i]);
+            }
+        mOpposite[h] = opp;
+
+        for (auto i = out_offsets[a]; i < out_offsets[a + 1]; ++i)
+            if (out_halfedges[i] != h && mToVertex[out_halfedges[i]].value == b)
+                is_manifold = false;
+    });
+
+    // outgoing halfedge starts the fan (there must be exactly one fan)
+    detail::parallel_for(exec, vertex_count, [&](index_value_t v) {
+        auto const begin = out_offsets[v];
+        auto const end = out_offsets[v + 1];
+        if (begin == end)
+        {
+            mOutgoing[v] = halfedge_index::invalid;
+            return;
+        }
+
+        auto start = halfedge_index(out_halfedges[begin]);
+        auto open_fans = 0;
+        for (auto i = begin; i < end; ++i)
+            if (mOpposite[out_halfedges[i]].is_invalid())
+            {
+                start = halfedge_index(out_halfedges[i]);
+                ++open_fans;
+            }
+        mOutgoing[v] = start;
+
+        auto fan_size = 0;
+        for_each_outgoing_halfedge(vertex_index(v), [&](halfedge_index) { ++fan_size; });
+        if (open_fans > 1 || fan_size != end - begin)
+            is_manifold = false;
+    });
+
+    if (!is_manifold)
+    {
+        std::cerr << "triangles are not manifold or not consistently oriented" << std::endl;
+        clear();
+        return false;
+    }
+
+    return true;
+}
+
+bool triangle_mesh::build_from(Mesh const& m, executor const& exec)
+{
+    std::vector<index_value_t> indices;
+    indices.reserve(m.faces().size() * 3);
+    for (auto f : m.faces())
+    {
+        auto h = f.any_halfedge();
+        for (auto i = 0; i < 3; ++i)
+        {
+            indices.push_back(h.vertex_from().idx.value);
+            h = h.next();
+        }
+
+        if (h != f.any_halfedge())
+        {
+            std::cerr << "triangle_mesh requires a pure triangle mesh" << std::endl;
+            clear();
+            return false;
+        }
+    }
+
+    return build_from_triangles(indices, m.all_vertices().size(), exec);
+}
+
+void triangle_mesh::copy_to(Mesh& m) const
+{
+    m.clear();
+
+    auto ll = low_level_api(m);
+    ll.alloc_primitives(size_vertices(), 0, 0);
+    for (index_value_t i = 0; i < size_vertices(); ++i)
+        ll.outgoing_halfedge_of(vertex_index(i)) = halfedge_index::invalid;
+
+    std::vector<index_value_t> indices(mToVertex.size());
+    for (index_value_t h = 0; h < size_halfedges(); ++h)
+        indices[next_halfedge_of(halfedge_index(h)).value] = mToVertex[h].value;
+
+    auto const skipped = m.build_from_triangles(indices);
+    POLYMESH_ASSERT(skipped.empty() && "triangle_mesh topology is always manifold");
+    (void)skipped;
+}
+
+void triangle_mesh::clear()
+{
+    mToVertex.clear();
+    mOpposite.clear();
+    mOutgoing.clear();
+}
@@ -40,7 +40,7 @@ struct attribute_view
     decltype(auto) operator()(handle_t h) { return mFunc(mCollection(h)); }
     decltype(auto) operator()(index_t h) { return mFunc(mCollection(h)); }
 
-    int size() const { return mCollection.size(); }
+    index_value_t size() const { return mCollection.size(); }
 
     template <class F>
     auto map(F&& f) const